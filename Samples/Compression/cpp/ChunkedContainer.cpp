@@ -0,0 +1,434 @@
+﻿//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "ChunkedContainer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+    const uint8_t Magic[4] = { 'C', 'B', 'L', 'K' };
+    const uint16_t FormatVersion = 1;
+    const size_t HeaderSize = 12;
+    const size_t IndexEntrySize = 24;
+    const size_t FooterSize = 28;
+
+    // The payload is the original data.
+    const uint32_t BlockStored = 0x1;
+
+    void PutUInt16(std::vector<uint8_t> &Out, uint16_t Value)
+    {
+        Out.push_back(static_cast<uint8_t>(Value));
+        Out.push_back(static_cast<uint8_t>(Value >> 8));
+    }
+
+    void PutUInt32(std::vector<uint8_t> &Out, uint32_t Value)
+    {
+        PutUInt16(Out, static_cast<uint16_t>(Value));
+        PutUInt16(Out, static_cast<uint16_t>(Value >> 16));
+    }
+
+    void PutUInt64(std::vector<uint8_t> &Out, uint64_t Value)
+    {
+        PutUInt32(Out, static_cast<uint32_t>(Value));
+        PutUInt32(Out, static_cast<uint32_t>(Value >> 32));
+    }
+
+    uint16_t GetUInt16(const uint8_t *Data)
+    {
+        return static_cast<uint16_t>(Data[0] | (Data[1] << 8));
+    }
+
+    uint32_t GetUInt32(const uint8_t *Data)
+    {
+        return GetUInt16(Data) | (static_cast<uint32_t>(GetUInt16(Data + 2)) << 16);
+    }
+
+    uint64_t GetUInt64(const uint8_t *Data)
+    {
+        return GetUInt32(Data) | (static_cast<uint64_t>(GetUInt32(Data + 4)) << 32);
+    }
+
+    // CRC-32 (IEEE 802.3), eight bytes per step so that checking a block costs little next to
+    // decompressing it.
+    class Crc32Table
+    {
+    public:
+        Crc32Table()
+        {
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                uint32_t crc = i;
+                for (int bit = 0; bit < 8; bit++)
+                {
+                    crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+                }
+                table[0][i] = crc;
+            }
+
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                for (int slice = 1; slice < 8; slice++)
+                {
+                    table[slice][i] = (table[slice - 1][i] >> 8) ^ table[0][table[slice - 1][i] & 0xFF];
+                }
+            }
+        }
+
+        uint32_t table[8][256];
+    };
+
+    // Pass the CRC of the preceding data as Crc to continue a checksum across buffers.
+    uint32_t Crc32(const uint8_t *Data, size_t Size, uint32_t Crc = 0)
+    {
+        static const Crc32Table crcTable;
+        const auto &table = crcTable.table;
+
+        uint32_t crc = ~Crc;
+        for (; Size >= 8; Data += 8, Size -= 8)
+        {
+            uint32_t low = crc ^ GetUInt32(Data);
+            uint32_t high = GetUInt32(Data + 4);
+            crc = table[7][low & 0xFF] ^ table[6][(low >> 8) & 0xFF] ^ table[5][(low >> 16) & 0xFF] ^ table[4][low >> 24] ^
+                  table[3][high & 0xFF] ^ table[2][(high >> 8) & 0xFF] ^ table[1][(high >> 16) & 0xFF] ^ table[0][high >> 24];
+        }
+
+        for (; Size > 0; Data++, Size--)
+        {
+            crc = (crc >> 8) ^ table[0][(crc ^ *Data) & 0xFF];
+        }
+
+        return ~crc;
+    }
+
+    // Runs Task(index, codec) for every index below Count on up to ThreadCount workers, the calling
+    // thread being one of them. Workers pull the next index from a shared counter, so blocks that
+    // compress slowly don't hold the others back. The first exception stops the remaining work and
+    // is rethrown once every worker has finished.
+    void RunBlockTasks(
+        size_t Count,
+        unsigned int ThreadCount,
+        const BlockCodecFactory &Factory,
+        const std::function<void(size_t Index, BlockCodec &Codec)> &Task)
+    {
+        if (Count == 0)
+        {
+            return;
+        }
+
+        if (ThreadCount == 0)
+        {
+            ThreadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        size_t workerCount = std::min(static_cast<size_t>(ThreadCount), Count);
+        std::atomic<size_t> nextIndex(0);
+        std::atomic<bool> failed(false);
+        std::exception_ptr error;
+        std::mutex errorLock;
+
+        auto worker = [&]()
+        {
+            try
+            {
+                std::unique_ptr<BlockCodec> codec = Factory();
+                for (size_t index = nextIndex++; index < Count && !failed; index = nextIndex++)
+                {
+                    Task(index, *codec);
+                }
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(errorLock);
+                if (!error)
+                {
+                    error = std::current_exception();
+                }
+                failed = true;
+            }
+        };
+
+        std::vector<std::thread> threads;
+        try
+        {
+            for (size_t i = 1; i < workerCount; i++)
+            {
+                threads.emplace_back(worker);
+            }
+        }
+        catch (...)
+        {
+            // Could not start every thread - the ones that did start share the work.
+        }
+
+        worker();
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+size_t StoredBlockCodec::Compress(const uint8_t *, size_t, uint8_t *, size_t)
+{
+    return 0;
+}
+
+void StoredBlockCodec::Decompress(const uint8_t *, size_t, uint8_t *, size_t)
+{
+    // Stored blocks never reach the codec, so a container that needs this one to decompress is corrupt.
+    throw std::runtime_error("Chunked container block is corrupt");
+}
+
+std::vector<uint8_t> CompressChunked(
+    const uint8_t *Data,
+    size_t Size,
+    uint16_t CodecId,
+    const BlockCodecFactory &Factory,
+    uint32_t BlockSize,
+    unsigned int ThreadCount)
+{
+    if (BlockSize == 0)
+    {
+        throw std::invalid_argument("Block size must not be 0");
+    }
+
+    struct CompressedBlock
+    {
+        std::vector<uint8_t> payload;   // Empty if the block is stored.
+        uint32_t crc;
+    };
+
+    size_t blockCount = Size / BlockSize + ((Size % BlockSize) ? 1 : 0);
+    std::vector<CompressedBlock> blocks(blockCount);
+
+    RunBlockTasks(blockCount, ThreadCount, Factory, [&](size_t Index, BlockCodec &Codec)
+    {
+        const uint8_t *source = Data + Index * BlockSize;
+        size_t sourceSize = std::min(static_cast<size_t>(BlockSize), Size - Index * BlockSize);
+        CompressedBlock &block = blocks[Index];
+
+        block.crc = Crc32(source, sourceSize);
+
+        // Only keep the compressed form if it is smaller than the block itself.
+        block.payload.resize(sourceSize - 1);
+        size_t compressedSize = (sourceSize > 1) ? Codec.Compress(source, sourceSize, block.payload.data(), sourceSize - 1) : 0;
+        if (compressedSize > sourceSize - 1)
+        {
+            throw std::runtime_error("Codec overran the destination buffer");
+        }
+
+        block.payload.resize(compressedSize);
+        block.payload.shrink_to_fit();
+    });
+
+    size_t containerSize = HeaderSize + blockCount * IndexEntrySize + FooterSize;
+    for (size_t i = 0; i < blockCount; i++)
+    {
+        containerSize += blocks[i].payload.empty() ? std::min(static_cast<size_t>(BlockSize), Size - i * BlockSize) : blocks[i].payload.size();
+    }
+
+    std::vector<uint8_t> container;
+    container.reserve(containerSize);
+    container.insert(container.end(), Magic, Magic + sizeof(Magic));
+    PutUInt16(container, FormatVersion);
+    PutUInt16(container, CodecId);
+    PutUInt32(container, BlockSize);
+
+    std::vector<uint8_t> index;
+    index.reserve(blockCount * IndexEntrySize);
+    for (size_t i = 0; i < blockCount; i++)
+    {
+        const uint8_t *source = Data + i * BlockSize;
+        size_t sourceSize = std::min(static_cast<size_t>(BlockSize), Size - i * BlockSize);
+        const CompressedBlock &block = blocks[i];
+
+        PutUInt64(index, container.size());
+        if (block.payload.empty())
+        {
+            PutUInt32(index, static_cast<uint32_t>(sourceSize));
+            container.insert(container.end(), source, source + sourceSize);
+        }
+        else
+        {
+            PutUInt32(index, static_cast<uint32_t>(block.payload.size()));
+            container.insert(container.end(), block.payload.begin(), block.payload.end());
+        }
+        PutUInt32(index, static_cast<uint32_t>(sourceSize));
+        PutUInt32(index, block.crc);
+        PutUInt32(index, block.payload.empty() ? BlockStored : 0);
+    }
+
+    uint64_t indexOffset = container.size();
+    container.insert(container.end(), index.begin(), index.end());
+    PutUInt32(container, static_cast<uint32_t>(blockCount));
+    PutUInt64(container, Size);
+    PutUInt64(container, indexOffset);
+    PutUInt32(container, Crc32(index.data(), index.size(), Crc32(container.data(), HeaderSize)));
+    container.insert(container.end(), Magic, Magic + sizeof(Magic));
+
+    return container;
+}
+
+ChunkedReader::ChunkedReader(const uint8_t *Data, size_t Size) :
+    _Data(Data),
+    _CodecId(0),
+    _BlockSize(0),
+    _OriginalSize(0)
+{
+    if (Size < HeaderSize + FooterSize ||
+        memcmp(Data, Magic, sizeof(Magic)) != 0 ||
+        memcmp(Data + Size - sizeof(Magic), Magic, sizeof(Magic)) != 0)
+    {
+        throw std::runtime_error("Not a chunked container");
+    }
+
+    if (GetUInt16(Data + 4) != FormatVersion)
+    {
+        throw std::runtime_error("Unsupported chunked container version");
+    }
+
+    _CodecId = GetUInt16(Data + 6);
+    _BlockSize = GetUInt32(Data + 8);
+
+    const uint8_t *footer = Data + Size - FooterSize;
+    uint32_t blockCount = GetUInt32(footer);
+    _OriginalSize = GetUInt64(footer + 4);
+    uint64_t indexOffset = GetUInt64(footer + 12);
+
+    // The index must fill the space between the last block and the footer exactly.
+    uint64_t indexEnd = Size - FooterSize;
+    if (_BlockSize == 0 ||
+        indexOffset < HeaderSize ||
+        indexOffset > indexEnd ||
+        (indexEnd - indexOffset) / IndexEntrySize != blockCount ||
+        (indexEnd - indexOffset) % IndexEntrySize != 0 ||
+        Crc32(Data + indexOffset, static_cast<size_t>(indexEnd - indexOffset), Crc32(Data, HeaderSize)) != GetUInt32(footer + 20))
+    {
+        throw std::runtime_error("Chunked container index is corrupt");
+    }
+
+    // Every block but the last is full, and the payloads are laid out back to back.
+    _Blocks.resize(blockCount);
+    uint64_t payloadEnd = HeaderSize;
+    uint64_t originalSize = 0;
+    for (uint32_t i = 0; i < blockCount; i++)
+    {
+        const uint8_t *entry = Data + indexOffset + i * IndexEntrySize;
+        BlockEntry &block = _Blocks[i];
+        block.offset = GetUInt64(entry);
+        block.storedSize = GetUInt32(entry + 8);
+        block.originalSize = GetUInt32(entry + 12);
+        block.crc = GetUInt32(entry + 16);
+        block.flags = GetUInt32(entry + 20);
+
+        bool isLast = (i + 1 == blockCount);
+        if (block.offset != payloadEnd ||
+            block.storedSize > indexOffset - block.offset ||
+            block.originalSize == 0 ||
+            block.originalSize > _BlockSize ||
+            (!isLast && block.originalSize != _BlockSize) ||
+            (block.flags & ~BlockStored) != 0 ||
+            ((block.flags & BlockStored) != 0 && block.storedSize != block.originalSize))
+        {
+            throw std::runtime_error("Chunked container index is corrupt");
+        }
+
+        payloadEnd += block.storedSize;
+        originalSize += block.originalSize;
+    }
+
+    if (payloadEnd != indexOffset || originalSize != _OriginalSize)
+    {
+        throw std::runtime_error("Chunked container index is corrupt");
+    }
+
+    if (_OriginalSize > SIZE_MAX)
+    {
+        throw std::length_error("Chunked container is too large to fit in memory");
+    }
+}
+
+void ChunkedReader::ReadBlock(size_t Index, uint8_t *Destination, BlockCodec &Codec) const
+{
+    const BlockEntry &block = _Blocks[Index];
+    const uint8_t *payload = _Data + block.offset;
+
+    if (block.flags & BlockStored)
+    {
+        memcpy(Destination, payload, block.originalSize);
+    }
+    else
+    {
+        Codec.Decompress(payload, block.storedSize, Destination, block.originalSize);
+    }
+
+    if (Crc32(Destination, block.originalSize) != block.crc)
+    {
+        throw std::runtime_error("Chunked container block is corrupt");
+    }
+}
+
+void ChunkedReader::Read(uint64_t Offset, uint8_t *Destination, size_t Size, BlockCodec &Codec) const
+{
+    if (Offset > _OriginalSize || Size > _OriginalSize - Offset)
+    {
+        throw std::out_of_range("Read past the end of the chunked container");
+    }
+
+    // Blocks that are only partly covered go through a scratch buffer.
+    std::vector<uint8_t> scratch;
+    while (Size > 0)
+    {
+        size_t index = static_cast<size_t>(Offset / _BlockSize);
+        size_t offsetInBlock = static_cast<size_t>(Offset % _BlockSize);
+        size_t blockSize = _Blocks[index].originalSize;
+        size_t count = std::min(Size, blockSize - offsetInBlock);
+
+        if (count == blockSize)
+        {
+            ReadBlock(index, Destination, Codec);
+        }
+        else
+        {
+            scratch.resize(blockSize);
+            ReadBlock(index, scratch.data(), Codec);
+            memcpy(Destination, scratch.data() + offsetInBlock, count);
+        }
+
+        Offset += count;
+        Destination += count;
+        Size -= count;
+    }
+}
+
+std::vector<uint8_t> ChunkedReader::ReadAll(const BlockCodecFactory &Factory, unsigned int ThreadCount) const
+{
+    std::vector<uint8_t> data(static_cast<size_t>(_OriginalSize));
+
+    RunBlockTasks(_Blocks.size(), ThreadCount, Factory, [&](size_t Index, BlockCodec &Codec)
+    {
+        ReadBlock(Index, data.data() + Index * _BlockSize, Codec);
+    });
+
+    return data;
+}
@@ -0,0 +1,106 @@
+﻿//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+// Chunked container for compressed data. The input is split into fixed-size blocks that are
+// compressed independently on a pool of worker threads, and an index after the last block records
+// where each block lives, so a container can be decompressed in parallel or read at any offset
+// without decompressing the blocks before it. The block codec is supplied by the caller. This file
+// only depends on the C++ standard library.
+//
+// Layout, all integers little endian:
+//   header  magic "CBLK", version (u16), codec id (u16), block size (u32)
+//   blocks  block payloads back to back
+//   index   per block: payload offset (u64), payload size (u32), original size (u32),
+//           CRC-32 of the original data (u32), flags (u32)
+//   footer  block count (u32), original size (u64), index offset (u64), CRC-32 of the header and
+//           index (u32), magic "CBLK"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class BlockCodec
+{
+public:
+    virtual ~BlockCodec() {}
+
+    // Compresses Source into Destination and returns the compressed size, or 0 if the result doesn't
+    // fit in DestinationSize bytes. Blocks that don't compress are stored as they are.
+    virtual size_t Compress(const uint8_t *Source, size_t SourceSize, uint8_t *Destination, size_t DestinationSize) = 0;
+
+    // Decompresses Source into exactly DestinationSize bytes. Throws if the data is corrupt.
+    virtual void Decompress(const uint8_t *Source, size_t SourceSize, uint8_t *Destination, size_t DestinationSize) = 0;
+};
+
+// A codec is only used by one thread at a time - every worker creates its own.
+typedef std::function<std::unique_ptr<BlockCodec>()> BlockCodecFactory;
+
+// Codec that never compresses, so every block is stored as it is.
+class StoredBlockCodec : public BlockCodec
+{
+public:
+    size_t Compress(const uint8_t *Source, size_t SourceSize, uint8_t *Destination, size_t DestinationSize) override;
+    void Decompress(const uint8_t *Source, size_t SourceSize, uint8_t *Destination, size_t DestinationSize) override;
+};
+
+// Compresses Data into a chunked container. CodecId is recorded in the header so a reader can pick
+// the matching codec. ThreadCount 0 uses one worker per hardware thread.
+std::vector<uint8_t> CompressChunked(
+    const uint8_t *Data,
+    size_t Size,
+    uint16_t CodecId,
+    const BlockCodecFactory &Factory,
+    uint32_t BlockSize = 0x100000,
+    unsigned int ThreadCount = 0);
+
+// Reads a chunked container. The header, index and footer are validated up front and every block is
+// checked against its CRC as it is decompressed; all errors throw std::runtime_error. The container
+// data is not copied and must outlive the reader.
+class ChunkedReader
+{
+public:
+    ChunkedReader(const uint8_t *Data, size_t Size);
+
+    uint16_t GetCodecId() const { return _CodecId; }
+    uint32_t GetBlockSize() const { return _BlockSize; }
+    size_t GetBlockCount() const { return _Blocks.size(); }
+    uint64_t GetOriginalSize() const { return _OriginalSize; }
+
+    // Decompresses Size bytes starting at Offset of the original data, touching only the blocks
+    // that overlap the range.
+    void Read(uint64_t Offset, uint8_t *Destination, size_t Size, BlockCodec &Codec) const;
+
+    // Decompresses the whole container, one block per task. ThreadCount 0 uses one worker per
+    // hardware thread.
+    std::vector<uint8_t> ReadAll(const BlockCodecFactory &Factory, unsigned int ThreadCount = 0) const;
+
+private:
+    struct BlockEntry
+    {
+        uint64_t offset;        // Payload offset from the start of the container.
+        uint32_t storedSize;    // Payload size.
+        uint32_t originalSize;
+        uint32_t crc;           // CRC-32 of the original data.
+        uint32_t flags;
+    };
+
+    // Decompresses block Index into Destination, which holds the block's original size.
+    void ReadBlock(size_t Index, uint8_t *Destination, BlockCodec &Codec) const;
+
+    const uint8_t *_Data;
+    uint16_t _CodecId;
+    uint32_t _BlockSize;
+    uint64_t _OriginalSize;
+    std::vector<BlockEntry> _Blocks;
+};
@@ -2,6 +2,10 @@
 #include "MainPage.xaml.h"
 #include "SampleConfiguration.h"
 #include "CompressionUtils.h"
+#include "StreamAccumulator.h"
+
+#include <robuffer.h>
+#include <wrl.h>
 
 using namespace Windows::Storage;
 using namespace Windows::Storage::Pickers;
@@ -11,11 +15,99 @@ using namespace Windows::Storage::Compression;
 using namespace concurrency;
 
 #pragma region ReadStreamTask implementation
+// Non-owning IBuffer over a chunk of the accumulator's storage, so that the stream reads directly into
+// the result instead of into an intermediate buffer. The memory must outlive the read operation.
+class ChunkBuffer : public Microsoft::WRL::RuntimeClass<
+    Microsoft::WRL::RuntimeClassFlags<Microsoft::WRL::RuntimeClassType::WinRtClassicComMix>,
+    ABI::Windows::Storage::Streams::IBuffer,
+    Microsoft::WRL::CloakedIid<Windows::Storage::Streams::IBufferByteAccess>,
+    Microsoft::WRL::FtmBase>
+{
+    InspectableClass(L"Compression.ChunkBuffer", BaseTrust);
+
+public:
+    ChunkBuffer(byte *Data, unsigned int Capacity) :
+        _Data(Data),
+        _Capacity(Capacity),
+        _Length(0)
+    {
+    }
+
+    // IBuffer
+    IFACEMETHODIMP get_Capacity(UINT32 *Value)
+    {
+        *Value = _Capacity;
+        return S_OK;
+    }
+
+    IFACEMETHODIMP get_Length(UINT32 *Value)
+    {
+        *Value = _Length;
+        return S_OK;
+    }
+
+    IFACEMETHODIMP put_Length(UINT32 Value)
+    {
+        if (Value > _Capacity)
+        {
+            return E_INVALIDARG;
+        }
+
+        _Length = Value;
+        return S_OK;
+    }
+
+    // IBufferByteAccess
+    IFACEMETHODIMP Buffer(byte **Value)
+    {
+        *Value = _Data;
+        return S_OK;
+    }
+
+private:
+    byte *_Data;
+    unsigned int _Capacity;
+    unsigned int _Length;
+};
+
+// Returns the bytes behind a buffer returned by the stream.
+static byte *GetBufferData(IBuffer^ Buffer)
+{
+    Microsoft::WRL::ComPtr<Windows::Storage::Streams::IBufferByteAccess> bufferByteAccess;
+    HRESULT hr = reinterpret_cast<IInspectable*>(Buffer)->QueryInterface(IID_PPV_ARGS(&bufferByteAccess));
+    if (FAILED(hr))
+    {
+        throw Platform::Exception::CreateException(hr);
+    }
+
+    byte *data;
+    hr = bufferByteAccess->Buffer(&data);
+    if (FAILED(hr))
+    {
+        throw Platform::Exception::CreateException(hr);
+    }
+
+    return data;
+}
+
+// Number of bytes left in the stream if it can tell, 0 otherwise.
+static uint64_t GetRemainingSize(IInputStream^ Stream)
+{
+    auto randomAccessStream = dynamic_cast<IRandomAccessStream^>(Stream);
+    if (randomAccessStream == nullptr || randomAccessStream->Position > randomAccessStream->Size)
+    {
+        return 0;
+    }
+
+    return randomAccessStream->Size - randomAccessStream->Position;
+}
+
 // We can't derive from task because we need to initialize task_completion_event before task itself.
 struct ReadStreamTask::ReadStreamTaskImpl {
     ReadStreamTaskImpl(IInputStream^ Stream, std::vector<byte> &Destination) :
         _Destination(Destination),
-        _Reader(ref new DataReader(Stream)),
+        _Stream(Stream),
+        _StreamData(GetRemainingSize(Stream)),
         _CompletionEvent()
     {
     }
@@ -28,11 +120,8 @@ struct ReadStreamTask::ReadStreamTaskImpl {
             // Schedule resource deallocation
             std::unique_ptr<ReadStreamTaskImpl> thisHolder(this);
 
-            // Prevent user provided stream from being closed
-            _Reader->DetachStream();
-
             // Move data out
-            _Destination = std::move(_StreamData);
+            _Destination = _StreamData.Release();
 
             return _Destination.size();
         });
@@ -40,28 +129,41 @@ struct ReadStreamTask::ReadStreamTaskImpl {
 
     void ReadChunk()
     {
-        // LoadAsync itself could throw exception if IAsyncOperation couldn't be created with
+        // ReadAsync itself could throw exception if IAsyncOperation couldn't be created with
         // given parameters in a current state
         try
         {
-            // Read data into the data reader
-            _StreamData.reserve(_StreamData.size() + MinReadChunkSize);
-            create_task(_Reader->LoadAsync(static_cast<unsigned int>(_StreamData.capacity() - _StreamData.size())))
+            // Read data straight into the free space at the end of the result
+            size_t chunkSize;
+            byte *chunk = _StreamData.PrepareChunk(chunkSize);
 
-            // Then store it to the result vector
-            .then([this](task<unsigned int> BytesRead)
+            auto chunkBuffer = Microsoft::WRL::Make<ChunkBuffer>(chunk, static_cast<unsigned int>(chunkSize));
+            if (chunkBuffer == nullptr)
+            {
+                throw ref new Platform::OutOfMemoryException();
+            }
+
+            auto buffer = reinterpret_cast<IBuffer^>(static_cast<ABI::Windows::Storage::Streams::IBuffer*>(chunkBuffer.Get()));
+            create_task(_Stream->ReadAsync(buffer, static_cast<unsigned int>(chunkSize), InputStreamOptions::None))
+
+            // Then account for it in the result
+            .then([this, chunk](task<IBuffer^> ReadResult)
             {
                 try
                 {
-                    // exception is thrown here if LoadAsync operation has been completed with an error
-                    auto bytesRead = BytesRead.get();
+                    // exception is thrown here if ReadAsync operation has been completed with an error
+                    auto result = ReadResult.get();
+                    auto bytesRead = result->Length;
                     if (bytesRead)
                     {
-                        // Store chunk of data in the result vector.
-                        auto newData = ref new Platform::Array<byte>(bytesRead);
-                        _Reader->ReadBytes(newData);
+                        // Streams are allowed to return their own buffer instead of filling ours.
+                        byte *data = GetBufferData(result);
+                        if (data != chunk)
+                        {
+                            memcpy(chunk, data, bytesRead);
+                        }
 
-                        _StreamData.insert(_StreamData.end(), newData->begin(), newData->end());
+                        _StreamData.CommitChunk(bytesRead);
 
                         // Then recurse to read next chunk.
                         ReadChunk();
@@ -95,8 +197,8 @@ struct ReadStreamTask::ReadStreamTaskImpl {
 
     // All data members are accessed serially - no synchronization is done
     std::vector<byte> &_Destination;
-    DataReader^ _Reader;
-    std::vector<byte> _StreamData;
+    IInputStream^ _Stream;
+    StreamAccumulator _StreamData;
 
     task_completion_event<void> _CompletionEvent;
 };
@@ -122,3 +224,89 @@ task<size_t> ReadStreamTask::RunTask()
     return _Impl->RunTask();
 }
 #pragma endregion
+
+#pragma region ClassicBlockCodec implementation
+ClassicBlockCodec::ClassicBlockCodec(DWORD Algorithm) :
+    _Algorithm(Algorithm),
+    _Compressor(nullptr),
+    _Decompressor(nullptr)
+{
+}
+
+ClassicBlockCodec::~ClassicBlockCodec()
+{
+    if (_Compressor != nullptr)
+    {
+        CloseCompressor(_Compressor);
+    }
+
+    if (_Decompressor != nullptr)
+    {
+        CloseDecompressor(_Decompressor);
+    }
+}
+
+size_t ClassicBlockCodec::Compress(const uint8_t *Source, size_t SourceSize, uint8_t *Destination, size_t DestinationSize)
+{
+    if (_Compressor == nullptr && !CreateCompressor(_Algorithm, nullptr, &_Compressor))
+    {
+        throw std::runtime_error("Cannot create compressor");
+    }
+
+    SIZE_T compressedSize = 0;
+    if (!::Compress(_Compressor, Source, SourceSize, Destination, DestinationSize, &compressedSize))
+    {
+        // The block doesn't get any smaller - the container stores it as it is
+        if (GetLastError() == ERROR_INSUFFICIENT_BUFFER)
+        {
+            return 0;
+        }
+
+        throw std::runtime_error("Cannot compress data");
+    }
+
+    return compressedSize;
+}
+
+void ClassicBlockCodec::Decompress(const uint8_t *Source, size_t SourceSize, uint8_t *Destination, size_t DestinationSize)
+{
+    if (_Decompressor == nullptr && !CreateDecompressor(_Algorithm, nullptr, &_Decompressor))
+    {
+        throw std::runtime_error("Cannot create decompressor");
+    }
+
+    SIZE_T decompressedSize = 0;
+    if (!::Decompress(_Decompressor, Source, SourceSize, Destination, DestinationSize, &decompressedSize) ||
+        decompressedSize != DestinationSize)
+    {
+        throw std::runtime_error("Chunked container block is corrupt");
+    }
+}
+
+BlockCodecFactory GetBlockCodecFactory(CompressAlgorithm Algorithm)
+{
+    // Enumaration values of Windows::Storage::Compression::CompressAlgorithm are
+    // guaranteed to match values from compressapi.h
+    DWORD compressAlgorithm = static_cast<DWORD>(Algorithm);
+
+    // The "classic" Compression API has no null algorithm - store the blocks instead
+    if (compressAlgorithm == COMPRESS_ALGORITHM_NULL)
+    {
+        return []
+        {
+            return std::unique_ptr<BlockCodec>(new StoredBlockCodec());
+        };
+    }
+
+    // Compress algorithm should always be explicit for "classic" Compression API
+    if (compressAlgorithm == COMPRESS_ALGORITHM_INVALID)
+    {
+        compressAlgorithm = COMPRESS_ALGORITHM_XPRESS;
+    }
+
+    return [compressAlgorithm]
+    {
+        return std::unique_ptr<BlockCodec>(new ClassicBlockCodec(compressAlgorithm));
+    };
+}
+#pragma endregion
@@ -1,8 +1,11 @@
 #pragma once
 
+#include "ChunkedContainer.h"
+
 // Reads Stream into Destination. It's up to caller to ensure that Destination is not destructed until
 // ReadStreamTask::GetTask() is completed. If error is encountered during read Destination doesn't
-// change and Stream state is undefined.
+// change and Stream state is undefined. Data is read straight into storage that grows geometrically, and
+// random access streams are sized up front, so reading takes time linear in the stream length.
 // NOTE: Generally you don't need to read entire stream into memory - we only use this task in order to
 //       interoperate with Compression API style buffer compression/decompression. Recommended way to
 //       work with WinRT streams of unknown length (including Comressor/Decompressor) is processing
@@ -17,12 +20,35 @@ public:
     concurrency::task<size_t> RunTask();
 
 private:
-    static const unsigned int MinReadChunkSize = 0x10000;
-
     struct ReadStreamTaskImpl;
     ReadStreamTaskImpl *_Impl;
 };
 
+// Block codec for ChunkedContainer backed by the "classic" Compression API. Algorithm is one of the
+// COMPRESS_ALGORITHM_* values.
+class ClassicBlockCodec : public BlockCodec
+{
+public:
+    explicit ClassicBlockCodec(DWORD Algorithm);
+    ~ClassicBlockCodec();
+
+    ClassicBlockCodec(const ClassicBlockCodec&) = delete;
+    ClassicBlockCodec &operator=(const ClassicBlockCodec&) = delete;
+
+    size_t Compress(const uint8_t *Source, size_t SourceSize, uint8_t *Destination, size_t DestinationSize) override;
+    void Decompress(const uint8_t *Source, size_t SourceSize, uint8_t *Destination, size_t DestinationSize) override;
+
+private:
+    DWORD _Algorithm;
+    COMPRESSOR_HANDLE _Compressor;      // Created on first use
+    DECOMPRESSOR_HANDLE _Decompressor;  // Created on first use
+};
+
+// Returns the codec factory for a chunked container compressed with Algorithm. The codec id stored in
+// a container is the Algorithm value, so a container can be read back with
+// GetBlockCodecFactory(static_cast<CompressAlgorithm>(Reader.GetCodecId())).
+BlockCodecFactory GetBlockCodecFactory(Windows::Storage::Compression::CompressAlgorithm Algorithm);
+
 // Common context for all scenarios for simplicity - not all fields are used by every scenario
 struct ScenarioContext
 {
@@ -17,6 +17,8 @@
 #include "Scenario1.xaml.h"
 #include "CompressionUtils.h"
 #include <robuffer.h>
+#include <chrono>
+#include <thread>
 
 using namespace Windows::UI::Xaml;
 using namespace Windows::UI::Xaml::Controls;
@@ -261,6 +263,110 @@ void ::SDKTemplate::Compression::Scenario1::DoScenario(CompressAlgorithm Algorit
     });
 }
 
+void ::SDKTemplate::Compression::Scenario1::DoChunkedScenario(CompressAlgorithm Algorithm)
+{
+    Progress->Text = "";
+    rootPage->NotifyUser("Working...", NotifyType::StatusMessage);
+
+    auto context = std::make_shared<ScenarioContext>();
+    auto codecFactory = GetBlockCodecFactory(Algorithm);
+
+    auto picker = ref new Pickers::FileOpenPicker();
+    picker->FileTypeFilter->Append("*");
+
+    // First pick a test file and open it for reading
+    create_task(picker->PickSingleFileAsync()).then([=](StorageFile^ OriginalFile)
+    {
+        if (!OriginalFile)
+        {
+            throw std::runtime_error("No file has been selected");
+        }
+
+        Progress->Text += "File \"" + OriginalFile->Name + "\" has been picked\n";
+
+        return OriginalFile->OpenAsync(FileAccessMode::Read);
+    })
+
+    // Then read the whole file into memory buffer
+    .then([=](IRandomAccessStream^ OriginalStream)
+    {
+        return ReadStreamTask(OriginalStream, context->originalData).RunTask();
+    })
+
+    // Then compress it into independent blocks on a pool of worker threads
+    .then([=](size_t BytesRead)
+    {
+        Progress->Text += BytesRead + " bytes have been read from disk\n";
+
+        // Run on an independent task so we will not block the GUI (ASTA) thread while compressing
+        return task<long long>([=]
+        {
+            auto start = chrono::steady_clock::now();
+            context->compressedData = CompressChunked(
+                context->originalData.data(),
+                context->originalData.size(),
+                static_cast<uint16_t>(Algorithm),
+                codecFactory);
+            return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+        });
+    })
+
+    // Then decompress all blocks in parallel, and read one range back without touching the rest
+    .then([=](long long CompressMilliseconds)
+    {
+        Progress->Text += "Compressed into " + context->compressedData.size() + " bytes on " +
+            max(1u, thread::hardware_concurrency()) + " threads in " + CompressMilliseconds + " ms\n";
+
+        return task<long long>([=]
+        {
+            ChunkedReader reader(context->compressedData.data(), context->compressedData.size());
+            auto codec = GetBlockCodecFactory(static_cast<CompressAlgorithm>(reader.GetCodecId()));
+
+            auto start = chrono::steady_clock::now();
+            context->decompressedData = reader.ReadAll(codec);
+            auto decompressMilliseconds = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+
+            if (context->originalData != context->decompressedData)
+            {
+                throw std::runtime_error("Decompressed data doesn't match original one");
+            }
+
+            // Random access only decompresses the blocks that overlap the range
+            uint64_t offset = reader.GetOriginalSize() / 2;
+            vector<byte> range(static_cast<size_t>(min<uint64_t>(reader.GetOriginalSize() - offset, 4096)));
+            reader.Read(offset, range.data(), range.size(), *codec());
+            if (!equal(range.begin(), range.end(), context->originalData.begin() + static_cast<size_t>(offset)))
+            {
+                throw std::runtime_error("Range read from the middle of the container doesn't match original data");
+            }
+
+            return decompressMilliseconds;
+        });
+    })
+
+    // Final task based continuation is used to handle exceptions in the chain above
+    .then([=](task<long long> DecompressMilliseconds)
+    {
+        try
+        {
+            // Transport all exceptions to this thread. This task is guaranteed to be completed by now.
+            Progress->Text += "Decompressed " + context->decompressedData.size() + " bytes in " + DecompressMilliseconds.get() + " ms\n";
+            Progress->Text += "Decompressed data and a range read from the middle match original\n";
+            rootPage->NotifyUser("Done", NotifyType::StatusMessage);
+        }
+        catch (Platform::Exception ^e)
+        {
+            rootPage->NotifyUser(e->Message, NotifyType::ErrorMessage);
+        }
+        catch (const std::exception &e)
+        {
+            std::wstringstream wss;
+            wss << e.what();
+            rootPage->NotifyUser(ref new Platform::String(wss.str().c_str()), NotifyType::ErrorMessage);
+        }
+    });
+}
+
 void ::SDKTemplate::Compression::Scenario1::CompressFileButton_Click(Platform::Object^ sender, Windows::UI::Xaml::RoutedEventArgs^ e)
 {
     ComboBoxItem^ item = safe_cast<ComboBoxItem^>(CompressAlgorithmComboBox->SelectedItem);
@@ -277,7 +383,14 @@ void ::SDKTemplate::Compression::Scenario1::CompressFileButton_Click(Platform::O
         return;
     }
 
-    DoScenario(Algorithm);
+    if (ChunkedCheckBox->IsChecked != nullptr && ChunkedCheckBox->IsChecked->Value)
+    {
+        DoChunkedScenario(Algorithm);
+    }
+    else
+    {
+        DoScenario(Algorithm);
+    }
 }
 
 void ::SDKTemplate::Compression::Scenario1::CompressAlgorithmComboBox_SelectionChanged(Platform::Object^ sender, Windows::UI::Xaml::RoutedEventArgs^ e)
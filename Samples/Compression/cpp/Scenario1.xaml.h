@@ -38,6 +38,7 @@ namespace SDKTemplate
             MainPage^ rootPage;
 
             void DoScenario(Windows::Storage::Compression::CompressAlgorithm Algorithm);
+            void DoChunkedScenario(Windows::Storage::Compression::CompressAlgorithm Algorithm);
 
             void CompressAlgorithmComboBox_SelectionChanged(Platform::Object^ sender, Windows::UI::Xaml::RoutedEventArgs^ e);
             void CompressFileButton_Click(Platform::Object^ sender, Windows::UI::Xaml::RoutedEventArgs^ e);
@@ -0,0 +1,108 @@
+﻿//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "StreamAccumulator.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+const size_t StreamAccumulator::MinChunkSize;
+const size_t StreamAccumulator::MaxChunkSize;
+
+StreamAccumulator::StreamAccumulator(uint64_t ExpectedSize) :
+    _Size(0),
+    _ChunkSize(0),
+    _BytesCopied(0)
+{
+    if (ExpectedSize > 0)
+    {
+        // Leave room for the read that finds the end of the stream.
+        if (ExpectedSize > std::numeric_limits<size_t>::max() - MinChunkSize)
+        {
+            throw std::length_error("stream is too large to fit in memory");
+        }
+
+        _Storage.resize(static_cast<size_t>(ExpectedSize) + MinChunkSize);
+    }
+}
+
+StreamAccumulator::StreamAccumulator(StreamAccumulator&& Other) :
+    _Storage(std::move(Other._Storage)),
+    _Size(Other._Size),
+    _ChunkSize(Other._ChunkSize),
+    _BytesCopied(Other._BytesCopied)
+{
+    Other._Storage.clear();
+    Other._Size = 0;
+    Other._ChunkSize = 0;
+}
+
+StreamAccumulator& StreamAccumulator::operator=(StreamAccumulator&& Other)
+{
+    if (this != &Other)
+    {
+        _Storage = std::move(Other._Storage);
+        _Size = Other._Size;
+        _ChunkSize = Other._ChunkSize;
+        _BytesCopied = Other._BytesCopied;
+
+        Other._Storage.clear();
+        Other._Size = 0;
+        Other._ChunkSize = 0;
+    }
+
+    return *this;
+}
+
+uint8_t *StreamAccumulator::PrepareChunk(size_t &ChunkSize)
+{
+    if (_Storage.size() - _Size < MinChunkSize)
+    {
+        size_t newSize = std::max(_Storage.size() * 2, _Size + MinChunkSize);
+        if (newSize < _Storage.size())
+        {
+            throw std::length_error("stream is too large to fit in memory");
+        }
+
+        // Shrink to the data first so the reallocation only moves bytes that were read.
+        _Storage.resize(_Size);
+        _Storage.reserve(newSize);
+        _Storage.resize(newSize);
+        _BytesCopied += _Size;
+    }
+
+    _ChunkSize = std::min(_Storage.size() - _Size, MaxChunkSize);
+    ChunkSize = _ChunkSize;
+    return _Storage.data() + _Size;
+}
+
+void StreamAccumulator::CommitChunk(size_t BytesRead)
+{
+    if (BytesRead > _ChunkSize)
+    {
+        throw std::out_of_range("more bytes committed than the chunk holds");
+    }
+
+    _Size += BytesRead;
+    _ChunkSize = 0;
+}
+
+std::vector<uint8_t> StreamAccumulator::Release()
+{
+    _Storage.resize(_Size);
+    std::vector<uint8_t> data(std::move(_Storage));
+
+    _Storage.clear();
+    _Size = 0;
+    _ChunkSize = 0;
+    return data;
+}
@@ -0,0 +1,61 @@
+﻿//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+// Collects a stream of unknown length into one contiguous buffer. The caller reads each chunk
+// straight into the space returned by PrepareChunk, and the storage grows geometrically, so every
+// byte is written once by the read and moved at most a handful of times by reallocation. This file
+// only depends on the C++ standard library.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class StreamAccumulator
+{
+public:
+    // Reads are never offered less than MinChunkSize bytes, and never more than MaxChunkSize so a
+    // single read does not take too long. In between, chunks grow along with the data.
+    static const size_t MinChunkSize = 0x10000;
+    static const size_t MaxChunkSize = 0x1000000;
+
+    // If the length of the stream is known, pass it as ExpectedSize: a stream of that length is
+    // then read without any reallocation.
+    explicit StreamAccumulator(uint64_t ExpectedSize = 0);
+
+    StreamAccumulator(StreamAccumulator&& Other);
+    StreamAccumulator& operator=(StreamAccumulator&& Other);
+
+    StreamAccumulator(const StreamAccumulator&) = delete;
+    StreamAccumulator& operator=(const StreamAccumulator&) = delete;
+
+    // Returns where the next read should go and sets ChunkSize to the number of bytes it may
+    // write. The space stays valid until the next call to PrepareChunk or Release.
+    uint8_t *PrepareChunk(size_t &ChunkSize);
+
+    // Records that BytesRead bytes were written to the space returned by PrepareChunk.
+    void CommitChunk(size_t BytesRead);
+
+    // Moves the data out and leaves the accumulator empty.
+    std::vector<uint8_t> Release();
+
+    size_t GetSize() const { return _Size; }
+
+    // Total bytes moved when the storage was reallocated.
+    uint64_t GetBytesCopied() const { return _BytesCopied; }
+
+private:
+    // _Storage.size() is the space allocated so far, of which the first _Size bytes hold data.
+    std::vector<uint8_t> _Storage;
+    size_t _Size;
+    size_t _ChunkSize;
+    uint64_t _BytesCopied;
+};
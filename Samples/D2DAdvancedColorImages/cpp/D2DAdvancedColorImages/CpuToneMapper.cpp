@@ -0,0 +1,628 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "CpuToneMapper.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define CPU_TONEMAPPER_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace D2DAdvancedColorImages;
+
+namespace
+{
+    // Rec. 709 luminance coefficients, identical to the histogram color matrix.
+    const float sc_lumR = 0.2126f;
+    const float sc_lumG = 0.7152f;
+    const float sc_lumB = 0.0722f;
+
+    // Matrices from FilmicEffect.hlsl, stored row-major.
+    const float sc_acesInput[3][3] =
+    {
+        { 0.59719f, 0.35458f, 0.04823f },
+        { 0.07600f, 0.90834f, 0.01566f },
+        { 0.02840f, 0.13383f, 0.83777f }
+    };
+
+    const float sc_acesOutput[3][3] =
+    {
+        {  1.60475f, -0.53108f, -0.07367f },
+        { -0.10208f,  1.10813f, -0.00605f },
+        { -0.00327f, -0.07276f,  1.07602f }
+    };
+
+    // Half to float uses the "magic multiply" approach: shifting the exponent and mantissa into
+    // float position and multiplying by 2^112 rebiases normals and renormalizes denormals at once.
+    const uint32_t sc_halfMagic = (254 - 15) << 23;
+
+    inline float AsFloat(uint32_t bits)
+    {
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+
+    inline uint32_t AsUint(float f)
+    {
+        uint32_t bits;
+        memcpy(&bits, &f, sizeof(bits));
+        return bits;
+    }
+
+    inline float RrtAndOdtFit(float v)
+    {
+        float a = v * (v + 0.0245786f) - 0.000090537f;
+        float b = v * (0.983729f * v + 0.4329510f) + 0.238081f;
+        return a / b;
+    }
+
+    inline float Saturate(float v)
+    {
+        // Matches HLSL saturate, which maps NaN to 0.
+        return (v > 0.0f) ? ((v < 1.0f) ? v : 1.0f) : 0.0f;
+    }
+
+    // Maps normalized luminance to a histogram bin without evaluating pow per pixel.
+    // Bin i covers luminance values y where (i / numBins) <= y^gamma < ((i + 1) / numBins), so the
+    // lower edge of each bin is precomputed in luminance space. A coarse table indexed by the upper
+    // bits of the float provides a starting bin which is then refined against the edges.
+    class LuminanceBinner
+    {
+    public:
+        LuminanceBinner(unsigned int numBins, float gamma) :
+            m_numBins(numBins),
+            m_edges(numBins + 1),
+            m_coarse(sc_coarseEntries)
+        {
+            for (unsigned int i = 0; i <= numBins; i++)
+            {
+                double v = static_cast<double>(i) / static_cast<double>(numBins);
+                m_edges[i] = static_cast<float>(pow(v, 1.0 / static_cast<double>(gamma)));
+            }
+
+            // Guarantee that any value below 1.0 never walks past the last bin.
+            m_edges[numBins] = 1.0f;
+
+            for (uint32_t k = 0; k < sc_coarseEntries; k++)
+            {
+                float lowest = AsFloat(k << sc_coarseShift);
+                auto it = std::upper_bound(m_edges.begin(), m_edges.end() - 1, lowest);
+                m_coarse[k] = static_cast<uint16_t>(std::max<ptrdiff_t>(0, (it - m_edges.begin()) - 1));
+            }
+        }
+
+        inline unsigned int Bin(float y) const
+        {
+            // Negative, zero and NaN luminance all fall into the first bin.
+            if (!(y > 0.0f))
+            {
+                return 0;
+            }
+
+            if (y >= 1.0f)
+            {
+                return m_numBins - 1;
+            }
+
+            unsigned int bin = m_coarse[AsUint(y) >> sc_coarseShift];
+            while (y >= m_edges[bin + 1])
+            {
+                bin++;
+            }
+
+            return bin;
+        }
+
+    private:
+        // Indexing by the exponent and top 7 mantissa bits covers all of [0, 1) in 16256 entries.
+        static const uint32_t sc_coarseShift = 16;
+        static const uint32_t sc_coarseEntries = 0x3F800000 >> sc_coarseShift;
+
+        unsigned int            m_numBins;
+        std::vector<float>      m_edges;
+        std::vector<uint16_t>   m_coarse;
+    };
+
+    struct HistogramPartial
+    {
+        std::vector<uint64_t>   counts;
+        double                  luminanceSum;   // In nits.
+        uint64_t                samples;
+    };
+
+#ifdef CPU_TONEMAPPER_SSE2
+    // Converts four binary16 values held in the low 16 bits of each 32-bit lane.
+    inline __m128 HalfToFloat4(__m128i h)
+    {
+        const __m128i maskNoSign = _mm_set1_epi32(0x7FFF);
+        const __m128 magic = _mm_castsi128_ps(_mm_set1_epi32(sc_halfMagic));
+        const __m128i wasInfNan = _mm_set1_epi32(0x7BFF);
+        const __m128 expInfNan = _mm_castsi128_ps(_mm_set1_epi32(255 << 23));
+
+        __m128i expMant = _mm_and_si128(maskNoSign, h);
+        __m128i justSign = _mm_xor_si128(h, expMant);
+        __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(expMant, 13)), magic);
+        __m128i isInfNan = _mm_cmpgt_epi32(expMant, wasInfNan);
+        __m128 sign = _mm_castsi128_ps(_mm_slli_epi32(justSign, 16));
+        __m128 infNanExp = _mm_and_ps(_mm_castsi128_ps(isInfNan), expInfNan);
+        return _mm_or_ps(scaled, _mm_or_ps(sign, infNanExp));
+    }
+
+    // Loads four consecutive RGBA FP16 pixels and transposes them into R, G, B, A registers.
+    inline void LoadPixels4(const uint16_t* src, __m128& r, __m128& g, __m128& b, __m128& a)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i p01 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        __m128i p23 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 8));
+
+        r = HalfToFloat4(_mm_unpacklo_epi16(p01, zero));
+        g = HalfToFloat4(_mm_unpackhi_epi16(p01, zero));
+        b = HalfToFloat4(_mm_unpacklo_epi16(p23, zero));
+        a = HalfToFloat4(_mm_unpackhi_epi16(p23, zero));
+        _MM_TRANSPOSE4_PS(r, g, b, a);
+    }
+
+    inline void StorePixels4(float* dst, __m128 r, __m128 g, __m128 b, __m128 a)
+    {
+        _MM_TRANSPOSE4_PS(r, g, b, a);
+        _mm_storeu_ps(dst, r);
+        _mm_storeu_ps(dst + 4, g);
+        _mm_storeu_ps(dst + 8, b);
+        _mm_storeu_ps(dst + 12, a);
+    }
+
+    inline __m128 RrtAndOdtFit4(__m128 v)
+    {
+        __m128 a = _mm_sub_ps(_mm_mul_ps(v, _mm_add_ps(v, _mm_set1_ps(0.0245786f))), _mm_set1_ps(0.000090537f));
+        __m128 b = _mm_add_ps(
+            _mm_mul_ps(v, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(0.983729f), v), _mm_set1_ps(0.4329510f))),
+            _mm_set1_ps(0.238081f));
+        return _mm_div_ps(a, b);
+    }
+
+    inline __m128 Saturate4(__m128 v)
+    {
+        // Operand order makes NaN lanes resolve to 0, like HLSL saturate.
+        return _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    }
+
+    inline void MulMatrix4(const float m[3][3], __m128& r, __m128& g, __m128& b)
+    {
+        __m128 outR = _mm_add_ps(_mm_add_ps(
+            _mm_mul_ps(_mm_set1_ps(m[0][0]), r), _mm_mul_ps(_mm_set1_ps(m[0][1]), g)), _mm_mul_ps(_mm_set1_ps(m[0][2]), b));
+        __m128 outG = _mm_add_ps(_mm_add_ps(
+            _mm_mul_ps(_mm_set1_ps(m[1][0]), r), _mm_mul_ps(_mm_set1_ps(m[1][1]), g)), _mm_mul_ps(_mm_set1_ps(m[1][2]), b));
+        __m128 outB = _mm_add_ps(_mm_add_ps(
+            _mm_mul_ps(_mm_set1_ps(m[2][0]), r), _mm_mul_ps(_mm_set1_ps(m[2][1]), g)), _mm_mul_ps(_mm_set1_ps(m[2][2]), b));
+        r = outR;
+        g = outG;
+        b = outB;
+    }
+#endif
+
+    inline void LoadPixel(const uint16_t* src, float* rgba)
+    {
+        for (int c = 0; c < 4; c++)
+        {
+            rgba[c] = CpuToneMapper::HalfToFloat(src[c]);
+        }
+    }
+
+    void AccumulateRows(
+        const uint8_t* base,
+        size_t stride,
+        unsigned int width,
+        unsigned int rowBegin,
+        unsigned int rowEnd,
+        unsigned int sampleStride,
+        float nitsPerUnit,
+        float normalize,
+        const LuminanceBinner& binner,
+        HistogramPartial& out
+        )
+    {
+        for (unsigned int y = rowBegin; y < rowEnd; y += sampleStride)
+        {
+            const uint16_t* row = reinterpret_cast<const uint16_t*>(base + y * stride);
+            unsigned int x = 0;
+            double rowSum = 0.0;
+
+#ifdef CPU_TONEMAPPER_SSE2
+            if (sampleStride == 1)
+            {
+                const __m128 lumR = _mm_set1_ps(sc_lumR * nitsPerUnit);
+                const __m128 lumG = _mm_set1_ps(sc_lumG * nitsPerUnit);
+                const __m128 lumB = _mm_set1_ps(sc_lumB * nitsPerUnit);
+                alignas(16) float nits[4];
+
+                for (; x + 4 <= width; x += 4)
+                {
+                    __m128 r, g, b, a;
+                    LoadPixels4(row + x * 4, r, g, b, a);
+                    __m128 lum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, lumR), _mm_mul_ps(g, lumG)), _mm_mul_ps(b, lumB));
+                    _mm_store_ps(nits, lum);
+
+                    for (int i = 0; i < 4; i++)
+                    {
+                        out.counts[binner.Bin(nits[i] * normalize)]++;
+                        rowSum += std::max(0.0f, nits[i]);
+                    }
+                }
+            }
+#endif
+
+            for (; x < width; x += sampleStride)
+            {
+                float rgba[4];
+                LoadPixel(row + x * 4, rgba);
+                float nits = (sc_lumR * rgba[0] + sc_lumG * rgba[1] + sc_lumB * rgba[2]) * nitsPerUnit;
+                out.counts[binner.Bin(nits * normalize)]++;
+                rowSum += std::max(0.0f, nits);
+            }
+
+            out.luminanceSum += rowSum;
+            out.samples += (width + sampleStride - 1) / sampleStride;
+        }
+    }
+
+    void TonemapRows(
+        CpuTonemapKind kind,
+        const uint8_t* srcBase,
+        size_t srcStride,
+        uint8_t* dstBase,
+        size_t dstStride,
+        unsigned int width,
+        unsigned int rowBegin,
+        unsigned int rowEnd
+        )
+    {
+        for (unsigned int y = rowBegin; y < rowEnd; y++)
+        {
+            const uint16_t* src = reinterpret_cast<const uint16_t*>(srcBase + y * srcStride);
+            float* dst = reinterpret_cast<float*>(dstBase + y * dstStride);
+            unsigned int x = 0;
+
+#ifdef CPU_TONEMAPPER_SSE2
+            const __m128 one = _mm_set1_ps(1.0f);
+            for (; x + 4 <= width; x += 4)
+            {
+                __m128 r, g, b, a;
+                LoadPixels4(src + x * 4, r, g, b, a);
+
+                if (kind == CpuTonemapKind::Reinhard)
+                {
+                    // ReinhardEffect.hlsl applies x / (x + 1) to all four channels.
+                    r = _mm_div_ps(r, _mm_add_ps(r, one));
+                    g = _mm_div_ps(g, _mm_add_ps(g, one));
+                    b = _mm_div_ps(b, _mm_add_ps(b, one));
+                    a = _mm_div_ps(a, _mm_add_ps(a, one));
+                }
+                else
+                {
+                    MulMatrix4(sc_acesInput, r, g, b);
+                    r = RrtAndOdtFit4(r);
+                    g = RrtAndOdtFit4(g);
+                    b = RrtAndOdtFit4(b);
+                    MulMatrix4(sc_acesOutput, r, g, b);
+                    r = Saturate4(r);
+                    g = Saturate4(g);
+                    b = Saturate4(b);
+                }
+
+                StorePixels4(dst + x * 4, r, g, b, a);
+            }
+#endif
+
+            for (; x < width; x++)
+            {
+                float* pixel = dst + x * 4;
+                LoadPixel(src + x * 4, pixel);
+
+                if (kind == CpuTonemapKind::Reinhard)
+                {
+                    CpuToneMapper::ReinhardPixel(pixel);
+                }
+                else
+                {
+                    CpuToneMapper::FilmicPixel(pixel);
+                }
+            }
+        }
+    }
+
+    // Splits [0, rows) into contiguous bands and runs func(begin, end, bandIndex) on each.
+    template <typename Func>
+    void ParallelRows(unsigned int rows, unsigned int threadCount, unsigned int rowAlign, Func func)
+    {
+        if (threadCount <= 1)
+        {
+            func(0, rows, 0);
+            return;
+        }
+
+        unsigned int band = (rows + threadCount - 1) / threadCount;
+        band = ((band + rowAlign - 1) / rowAlign) * rowAlign;
+
+        std::vector<std::thread> workers;
+        workers.reserve(threadCount);
+        for (unsigned int t = 0; t < threadCount; t++)
+        {
+            unsigned int begin = t * band;
+            unsigned int end = std::min(rows, begin + band);
+            if (begin >= end)
+            {
+                break;
+            }
+
+            workers.emplace_back(func, begin, end, t);
+        }
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    unsigned int ResolveThreadCount(unsigned int requested, unsigned int rows)
+    {
+        unsigned int threads = requested;
+        if (threads == 0)
+        {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        // Keep at least 64 rows per thread so small images don't pay thread startup costs.
+        return std::min(threads, std::max(1u, rows / 64));
+    }
+
+    // Runs the luminance pass over the whole image and merges the per-thread results.
+    HistogramPartial AccumulateImage(
+        const uint16_t* pixels,
+        unsigned int width,
+        unsigned int height,
+        size_t stride,
+        const CpuHistogramOptions& options
+        )
+    {
+        unsigned int sampleStride = std::max(1u, options.sampleStride);
+        unsigned int threads = ResolveThreadCount(options.threadCount, (height + sampleStride - 1) / sampleStride);
+
+        LuminanceBinner binner(options.numBins, options.gamma);
+        std::vector<HistogramPartial> partials(threads);
+        for (auto& partial : partials)
+        {
+            partial.counts.assign(options.numBins, 0);
+            partial.luminanceSum = 0.0;
+            partial.samples = 0;
+        }
+
+        const uint8_t* base = reinterpret_cast<const uint8_t*>(pixels);
+        ParallelRows(height, threads, sampleStride, [&](unsigned int begin, unsigned int end, unsigned int t)
+        {
+            AccumulateRows(base, stride, width, begin, end, sampleStride,
+                options.nominalRefWhite, 1.0f / options.maxNits, binner, partials[t]);
+        });
+
+        HistogramPartial total = { std::vector<uint64_t>(options.numBins, 0), 0.0, 0 };
+        for (auto& partial : partials)
+        {
+            total.samples += partial.samples;
+            total.luminanceSum += partial.luminanceSum;
+            for (unsigned int i = 0; i < options.numBins; i++)
+            {
+                total.counts[i] += partial.counts[i];
+            }
+        }
+
+        return total;
+    }
+
+    std::vector<float> NormalizeHistogram(const HistogramPartial& total)
+    {
+        std::vector<float> histogram(total.counts.size(), 0.0f);
+        for (size_t i = 0; i < total.counts.size(); i++)
+        {
+            histogram[i] = static_cast<float>(static_cast<double>(total.counts[i]) / static_cast<double>(total.samples));
+        }
+
+        return histogram;
+    }
+}
+
+float CpuToneMapper::HalfToFloat(uint16_t half)
+{
+    uint32_t expMant = half & 0x7FFFu;
+    uint32_t sign = static_cast<uint32_t>(half & 0x8000u) << 16;
+    uint32_t bits = AsUint(AsFloat(expMant << 13) * AsFloat(sc_halfMagic));
+
+    if (expMant > 0x7BFFu)
+    {
+        bits |= 255u << 23;
+    }
+
+    return AsFloat(bits | sign);
+}
+
+void CpuToneMapper::HalfToFloat(const uint16_t* src, float* dst, size_t count)
+{
+    size_t i = 0;
+
+#ifdef CPU_TONEMAPPER_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_ps(dst + i, HalfToFloat4(_mm_unpacklo_epi16(h, zero)));
+        _mm_storeu_ps(dst + i + 4, HalfToFloat4(_mm_unpackhi_epi16(h, zero)));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        dst[i] = HalfToFloat(src[i]);
+    }
+}
+
+uint16_t CpuToneMapper::FloatToHalf(float value)
+{
+    uint32_t bits = AsUint(value);
+    uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    uint16_t result;
+    if (bits >= 0x47800000u)
+    {
+        // Overflow maps to infinity; NaN stays a quiet NaN.
+        result = (bits > 0x7F800000u) ? 0x7E00 : 0x7C00;
+    }
+    else if (bits < 0x38800000u)
+    {
+        // Denormal or zero: let the FPU round by adding a magic value that aligns the mantissa.
+        const uint32_t denormMagic = ((127 - 15) + (23 - 10) + 1) << 23;
+        result = static_cast<uint16_t>(AsUint(AsFloat(bits) + AsFloat(denormMagic)) - denormMagic);
+    }
+    else
+    {
+        // Normal: rebias the exponent and round to nearest even.
+        uint32_t mantOdd = (bits >> 13) & 1;
+        bits += (static_cast<uint32_t>(15 - 127) << 23) + 0xFFF;
+        bits += mantOdd;
+        result = static_cast<uint16_t>(bits >> 13);
+    }
+
+    return static_cast<uint16_t>(result | (sign >> 16));
+}
+
+std::vector<float> CpuToneMapper::ComputeLuminanceHistogram(
+    const uint16_t* pixels,
+    unsigned int width,
+    unsigned int height,
+    size_t stride,
+    const CpuHistogramOptions& options
+    )
+{
+    if ((pixels == nullptr) || (width == 0) || (height == 0) || (options.numBins == 0))
+    {
+        return std::vector<float>(options.numBins, 0.0f);
+    }
+
+    return NormalizeHistogram(AccumulateImage(pixels, width, height, stride, options));
+}
+
+float CpuToneMapper::ComputePercentileNits(
+    const std::vector<float>& histogram,
+    float percentile,
+    const CpuHistogramOptions& options
+    )
+{
+    if (histogram.empty())
+    {
+        return 0.0f;
+    }
+
+    unsigned int numBins = static_cast<unsigned int>(histogram.size());
+    unsigned int bin = 0;
+    float runningSum = 0.0f;
+    for (int i = numBins - 1; i >= 0; i--)
+    {
+        runningSum += histogram[i];
+        bin = i;
+
+        if (runningSum >= 1.0f - percentile)
+        {
+            break;
+        }
+    }
+
+    float binNorm = static_cast<float>(bin) / static_cast<float>(numBins);
+    return powf(binNorm, 1 / options.gamma) * options.maxNits;
+}
+
+CpuHdrMetadata CpuToneMapper::ComputeHdrMetadata(
+    const uint16_t* pixels,
+    unsigned int width,
+    unsigned int height,
+    size_t stride,
+    float maxCLLPercentile,
+    const CpuHistogramOptions& options
+    )
+{
+    CpuHdrMetadata metadata = { -1.0f, -1.0f };
+    if ((pixels == nullptr) || (width == 0) || (height == 0) || (options.numBins == 0))
+    {
+        return metadata;
+    }
+
+    // The histogram pass also accumulates total luminance, so MaxFALL comes for free.
+    HistogramPartial total = AccumulateImage(pixels, width, height, stride, options);
+
+    metadata.maxCLL = ComputePercentileNits(NormalizeHistogram(total), maxCLLPercentile, options);
+    metadata.maxCLL = (metadata.maxCLL == 0.0f) ? -1.0f : metadata.maxCLL;
+    metadata.maxFALL = static_cast<float>(total.luminanceSum / static_cast<double>(total.samples));
+
+    return metadata;
+}
+
+void CpuToneMapper::Tonemap(
+    CpuTonemapKind kind,
+    const uint16_t* src,
+    size_t srcStride,
+    float* dst,
+    size_t dstStride,
+    unsigned int width,
+    unsigned int height,
+    unsigned int threadCount
+    )
+{
+    if ((src == nullptr) || (dst == nullptr) || (width == 0) || (height == 0))
+    {
+        return;
+    }
+
+    const uint8_t* srcBase = reinterpret_cast<const uint8_t*>(src);
+    uint8_t* dstBase = reinterpret_cast<uint8_t*>(dst);
+
+    ParallelRows(height, ResolveThreadCount(threadCount, height), 1, [&](unsigned int begin, unsigned int end, unsigned int)
+    {
+        TonemapRows(kind, srcBase, srcStride, dstBase, dstStride, width, begin, end);
+    });
+}
+
+void CpuToneMapper::ReinhardPixel(float* rgba)
+{
+    for (int c = 0; c < 4; c++)
+    {
+        rgba[c] = rgba[c] / (rgba[c] + 1.0f);
+    }
+}
+
+void CpuToneMapper::FilmicPixel(float* rgba)
+{
+    float filmic[3];
+    for (int i = 0; i < 3; i++)
+    {
+        filmic[i] = sc_acesInput[i][0] * rgba[0] + sc_acesInput[i][1] * rgba[1] + sc_acesInput[i][2] * rgba[2];
+        filmic[i] = RrtAndOdtFit(filmic[i]);
+    }
+
+    for (int i = 0; i < 3; i++)
+    {
+        float v = sc_acesOutput[i][0] * filmic[0] + sc_acesOutput[i][1] * filmic[1] + sc_acesOutput[i][2] * filmic[2];
+        rgba[i] = Saturate(v);
+    }
+}
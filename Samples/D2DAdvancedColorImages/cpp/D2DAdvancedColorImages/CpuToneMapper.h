@@ -0,0 +1,107 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+// CPU reference implementation of the HDR metadata and tonemapping math used by this sample.
+// This file only depends on the C++ standard library so that it can also be built for
+// headless batch processing on machines without a GPU.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace D2DAdvancedColorImages
+{
+    // Parameters of the luminance histogram. The defaults match the D2D effect graph built in
+    // D2DAdvancedColorImagesRenderer::CreateHistogramResources.
+    struct CpuHistogramOptions
+    {
+        unsigned int    numBins = 400;
+        float           gamma = 0.1f;
+        float           maxNits = 1000000.0f;
+        float           nominalRefWhite = 80.0f;    // Nits corresponding to scRGB 1.0.
+        unsigned int    sampleStride = 1;           // 2 approximates the 0.5 D2D prescale.
+        unsigned int    threadCount = 0;            // 0 selects std::thread::hardware_concurrency.
+    };
+
+    struct CpuHdrMetadata
+    {
+        float maxCLL;   // In nits, taken at the requested percentile of the histogram.
+        float maxFALL;  // In nits, the frame average luminance.
+    };
+
+    enum class CpuTonemapKind
+    {
+        Reinhard,
+        Filmic
+    };
+
+    class CpuToneMapper
+    {
+    public:
+        // Converts a single IEEE 754 binary16 value to float, including denormals, infinities and NaN.
+        static float HalfToFloat(uint16_t half);
+
+        // Converts a run of binary16 values to float.
+        static void HalfToFloat(const uint16_t* src, float* dst, size_t count);
+
+        // Rounds a float to the nearest binary16 value.
+        static uint16_t FloatToHalf(float value);
+
+        // Builds a normalized luminance histogram (bins sum to 1.0) from scRGB FP16 RGBA pixels,
+        // equivalent to the Scale -> ColorMatrix -> GammaTransfer -> Histogram effect chain.
+        // stride is in bytes; it may be larger than width * 8 for padded rows.
+        static std::vector<float> ComputeLuminanceHistogram(
+            const uint16_t* pixels,
+            unsigned int width,
+            unsigned int height,
+            size_t stride,
+            const CpuHistogramOptions& options
+            );
+
+        // Returns the luminance in nits at the given percentile (e.g. 0.9999f) of a histogram
+        // produced by ComputeLuminanceHistogram, using the same bin search as ComputeHdrMetadata.
+        static float ComputePercentileNits(
+            const std::vector<float>& histogram,
+            float percentile,
+            const CpuHistogramOptions& options
+            );
+
+        // Computes MaxCLL (at the given percentile) and MaxFALL for scRGB FP16 RGBA pixels.
+        // MaxCLL is reported as -1.0f when the image contains no measurable luminance.
+        static CpuHdrMetadata ComputeHdrMetadata(
+            const uint16_t* pixels,
+            unsigned int width,
+            unsigned int height,
+            size_t stride,
+            float maxCLLPercentile,
+            const CpuHistogramOptions& options
+            );
+
+        // Tonemaps scRGB FP16 RGBA pixels into float RGBA, matching ReinhardEffect.hlsl
+        // and FilmicEffect.hlsl. dstStride is in bytes.
+        static void Tonemap(
+            CpuTonemapKind kind,
+            const uint16_t* src,
+            size_t srcStride,
+            float* dst,
+            size_t dstStride,
+            unsigned int width,
+            unsigned int height,
+            unsigned int threadCount = 0
+            );
+
+        // Per-pixel operators, exposed so callers can verify shader parity on individual values.
+        static void ReinhardPixel(float* rgba);
+        static void FilmicPixel(float* rgba);
+    };
+}
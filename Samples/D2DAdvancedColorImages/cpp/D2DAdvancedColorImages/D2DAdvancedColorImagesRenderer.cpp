@@ -713,8 +713,7 @@ void D2DAdvancedColorImagesRenderer::ComputeHdrMetadata()
     m_maxCLL = -1.0f;
 
     // MaxCLL is not meaningful for SDR or WCG images.
-    if ((!m_isComputeSupported) ||
-        (m_imageInfo.imageKind != AdvancedColorKind::HighDynamicRange))
+    if (m_imageInfo.imageKind != AdvancedColorKind::HighDynamicRange)
     {
         return;
     }
@@ -724,6 +723,13 @@ void D2DAdvancedColorImagesRenderer::ComputeHdrMetadata()
     // to account for extreme outliers in the image.
     float maxCLLPercent = 0.9999f;
 
+    if (!m_isComputeSupported)
+    {
+        // The GPU can't run the histogram effect, so compute the same metadata on the CPU.
+        ComputeHdrMetadataOnCpu(maxCLLPercent);
+        return;
+    }
+
     auto ctx = m_deviceResources->GetD2DDeviceContext();
 
     ctx->BeginDraw();
@@ -766,6 +772,48 @@ void D2DAdvancedColorImagesRenderer::ComputeHdrMetadata()
     m_maxCLL = (m_maxCLL == 0.0f) ? -1.0f : m_maxCLL;
 }
 
+// Fallback for GPUs without compute shader support. Operates on the decoded FP16 pixels, which
+// for floating point images are already in scRGB, so no color management pass is needed.
+void D2DAdvancedColorImagesRenderer::ComputeHdrMetadataOnCpu(float maxCLLPercent)
+{
+    if (!m_imageInfo.isFloat)
+    {
+        return;
+    }
+
+    UINT width = static_cast<UINT>(m_imageInfo.size.Width);
+    UINT height = static_cast<UINT>(m_imageInfo.size.Height);
+    UINT stride = width * 4 * sizeof(uint16_t);
+
+    std::vector<uint16_t> pixels(static_cast<size_t>(width) * height * 4);
+    DX::ThrowIfFailed(
+        m_formatConvert->CopyPixels(
+            nullptr,
+            stride,
+            static_cast<UINT>(pixels.size() * sizeof(uint16_t)),
+            reinterpret_cast<BYTE*>(pixels.data())
+            )
+        );
+
+    CpuHistogramOptions options;
+    options.numBins = sc_histNumBins;
+    options.gamma = sc_histGamma;
+    options.maxNits = static_cast<float>(sc_histMaxNits);
+    options.nominalRefWhite = sc_nominalRefWhite;
+    options.sampleStride = 2; // Matches the 0.5 prescale used by the GPU path.
+
+    CpuHdrMetadata metadata = CpuToneMapper::ComputeHdrMetadata(
+        pixels.data(),
+        width,
+        height,
+        stride,
+        maxCLLPercent,
+        options
+        );
+
+    m_maxCLL = metadata.maxCLL;
+}
+
 // Set HDR10 metadata to allow HDR displays to optimize behavior based on our content.
 void D2DAdvancedColorImagesRenderer::EmitHdrMetadata()
 {
@@ -16,6 +16,7 @@
 #include "FilmicEffect.h"
 #include "SdrOverlayEffect.h"
 #include "LuminanceHeatmapEffect.h"
+#include "CpuToneMapper.h"
 #include "RenderOptions.h"
 
 namespace D2DAdvancedColorImages
@@ -81,6 +82,7 @@ namespace D2DAdvancedColorImages
         void UpdateWhiteLevelScale(float brightnessAdjustment, float sdrWhiteLevel);
         void UpdateImageTransformState();
         void ComputeHdrMetadata();
+        void ComputeHdrMetadataOnCpu(float maxCLLPercent);
         void EmitHdrMetadata();
 
         // Cached pointer to device resources.
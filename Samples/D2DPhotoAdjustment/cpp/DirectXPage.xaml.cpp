@@ -68,6 +68,14 @@ DirectXPage::DirectXPage() :
     m_deviceResources = std::make_shared<DX::DeviceResources>();
     m_deviceResources->SetSwapChainPanel(swapChainPanel);
 
+    // While sliders are dragged the renderer shows a proxy resolution image; this timer
+    // triggers the full resolution render after the values have settled.
+    TimeSpan refineDelay;
+    refineDelay.Duration = 2500000; // 250ms in 100ns units.
+    m_refineTimer = ref new DispatcherTimer();
+    m_refineTimer->Interval = refineDelay;
+    m_refineTimer->Tick += ref new EventHandler<Object^>(this, &DirectXPage::OnRefineTimerTick);
+
     CreateRenderer();
 }
 
@@ -187,6 +195,21 @@ void DirectXPage::TryUpdateRenderer()
     {
         m_renderer->UpdatePhotoAdjustmentValues(m_properties);
         m_renderer->Draw();
+
+        // Restart the timer so the full resolution render happens once, after the last change.
+        m_refineTimer->Stop();
+        m_refineTimer->Start();
+    }
+}
+
+void DirectXPage::OnRefineTimerTick(_In_ Object^ sender, _In_ Object^ e)
+{
+    m_refineTimer->Stop();
+
+    if (m_renderer != nullptr)
+    {
+        m_renderer->RefineFullResolution();
+        m_renderer->Draw();
     }
 }
 
@@ -55,6 +55,9 @@ namespace D2DPhotoAdjustment
         void Slider_ValueChanged(_In_ Platform::Object^ sender, _In_ Windows::UI::Xaml::Controls::Primitives::RangeBaseValueChangedEventArgs^ e);
         void Reset_Click(_In_ Platform::Object^ sender, _In_ Windows::UI::Xaml::RoutedEventArgs^ e);
 
+        // Redraws at full resolution once the photo adjustment values stop changing.
+        void OnRefineTimerTick(_In_ Platform::Object^ sender, _In_ Platform::Object^ e);
+
         // XAML low-level rendering event handler.
         void OnRendering(_In_ Platform::Object^ sender, _In_ Platform::Object^ args);
 
@@ -76,6 +79,7 @@ namespace D2DPhotoAdjustment
         std::unique_ptr<PhotoAdjustmentRenderer> m_renderer; 
         bool m_isWindowVisible;
         bool m_suppressRendererUpdates;
+        Windows::UI::Xaml::DispatcherTimer^ m_refineTimer;
 
         PhotoAdjustmentProperties m_properties;
 
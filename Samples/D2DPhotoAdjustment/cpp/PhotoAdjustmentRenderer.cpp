@@ -27,13 +27,20 @@ using namespace Windows::Graphics::Display;
 using namespace Windows::Storage::Streams;
 using namespace Windows::UI::Input;
 
+// Tile pyramid configuration.
+static const uint32_t sc_tileSize = 512;
+static const uint32_t sc_minLevelSize = 256;
+static const size_t   sc_tileCacheBudget = 128 * 1024 * 1024;
+
 PhotoAdjustmentRenderer::PhotoAdjustmentRenderer(const std::shared_ptr<DX::DeviceResources>& deviceResources) :
     m_deviceResources(deviceResources),
     m_maxZoom(1.0f), // Never allow upscaling.
     m_imageSize(),
     m_panelSize(),
     m_isWindowClosed(false),
-    m_zoom()
+    m_zoom(),
+    m_proxyLevel(0),
+    m_isShowingProxy(false)
 {
     // Register to be notified if the GPU device is lost or recreated.
     m_deviceResources->RegisterDeviceNotify(this);
@@ -47,6 +54,9 @@ PhotoAdjustmentRenderer::~PhotoAdjustmentRenderer()
 {
     // Deregister device notification.
     m_deviceResources->RegisterDeviceNotify(nullptr);
+
+    // Stop the tile worker before the WIC objects it uses are released.
+    m_tileScheduler.reset();
 }
 
 void PhotoAdjustmentRenderer::CreateDeviceIndependentResources()
@@ -54,7 +64,37 @@ void PhotoAdjustmentRenderer::CreateDeviceIndependentResources()
     auto wicFactory = m_deviceResources->GetWicImagingFactory();
     auto d2dFactory = m_deviceResources->GetD2DFactory();
 
-    // Use WIC to decode the JPEG image and load it into Direct2D.
+    ComPtr<IWICBitmapFrameDecode> frame = CreateFormatConverter(&m_formatConvert);
+
+    // The tile worker decodes from its own copy of the photo, because the WIC objects behind
+    // m_formatConvert are also read by the image source on the UI thread and aren't safe to
+    // use from two threads at once.
+    CreateFormatConverter(&m_tileFormatConvert);
+
+    UINT width;
+    UINT height;
+    DX::ThrowIfFailed(m_formatConvert->GetSize(&width, &height));
+    m_imageSize = Size(static_cast<float>(width), static_cast<float>(height));
+
+    // Attempt to read the embedded color profile from the image; use sRGB if the data doesn't exist.
+    UINT actualCount;
+    DX::ThrowIfFailed(wicFactory->CreateColorContext(&m_wicColorContext));
+    DX::ThrowIfFailed(frame->GetColorContexts(1, m_wicColorContext.GetAddressOf(), &actualCount));
+
+    if (actualCount == 0)
+    {
+        m_wicColorContext->InitializeFromExifColorSpace(1); // 1 = sRGB.
+    }
+
+    CreateTilePyramid(width, height);
+}
+
+// Use WIC to decode the JPEG image and convert it to a pixel format supported by Direct2D.
+// Each call opens the file again, so the converters returned share no WIC objects.
+ComPtr<IWICBitmapFrameDecode> PhotoAdjustmentRenderer::CreateFormatConverter(_Outptr_ IWICFormatConverter** formatConvert)
+{
+    auto wicFactory = m_deviceResources->GetWicImagingFactory();
+
     ComPtr<IWICBitmapDecoder> decoder;
     DX::ThrowIfFailed(wicFactory->CreateDecoderFromFilename(
         L"Assets\\rainier.jpg",
@@ -67,10 +107,9 @@ void PhotoAdjustmentRenderer::CreateDeviceIndependentResources()
     ComPtr<IWICBitmapFrameDecode> frame;
     DX::ThrowIfFailed(decoder->GetFrame(0, &frame));
 
-    // Convert the image to a pixel format supported by Direct2D. 32bppPBGRA is
-    // guaranteed to be supported on all hardware.
-    DX::ThrowIfFailed(wicFactory->CreateFormatConverter(&m_formatConvert));
-    DX::ThrowIfFailed(m_formatConvert->Initialize(
+    // 32bppPBGRA is guaranteed to be supported on all hardware.
+    DX::ThrowIfFailed(wicFactory->CreateFormatConverter(formatConvert));
+    DX::ThrowIfFailed((*formatConvert)->Initialize(
         frame.Get(),
         GUID_WICPixelFormat32bppPBGRA,
         WICBitmapDitherTypeNone,
@@ -79,20 +118,145 @@ void PhotoAdjustmentRenderer::CreateDeviceIndependentResources()
         WICBitmapPaletteTypeCustom
         ));
 
-    UINT width;
-    UINT height;
-    DX::ThrowIfFailed(m_formatConvert->GetSize(&width, &height));
-    m_imageSize = Size(static_cast<float>(width), static_cast<float>(height));
+    return frame;
+}
 
-    // Attempt to read the embedded color profile from the image; use sRGB if the data doesn't exist.
-    UINT actualCount;
-    DX::ThrowIfFailed(wicFactory->CreateColorContext(&m_wicColorContext));
-    DX::ThrowIfFailed(frame->GetColorContexts(1, m_wicColorContext.GetAddressOf(), &actualCount));
+// Large photos are slow to run through the effect pipeline at full resolution, which makes
+// slider drags lag. The tile pyramid holds downscaled copies of the photo, decoded once in the
+// background, so edits can be previewed at a resolution matching the viewport.
+void PhotoAdjustmentRenderer::CreateTilePyramid(UINT width, UINT height)
+{
+    m_tileScheduler.reset();
+    m_levelScalers.clear();
+
+    m_tilePyramid = unique_ptr<TilePyramid>(new TilePyramid(width, height, sc_tileSize, sc_minLevelSize));
+    m_tileCache = unique_ptr<TileCache>(new TileCache(sc_tileCacheBudget));
+    m_levelScalers.resize(m_tilePyramid->GetLevelCount());
+
+    // The scalers of m_levelScalers all read from m_tileFormatConvert, so a single worker
+    // keeps them from being used at the same time.
+    m_tileScheduler = unique_ptr<TileScheduler>(new TileScheduler(
+        *m_tilePyramid,
+        *m_tileCache,
+        [this](const TileKey& key, const TileRect& rect, Tile& tile)
+        {
+            return DecodeTile(key, rect, tile);
+        },
+        1));
+}
 
-    if (actualCount == 0)
+// Called on the tile worker thread.
+bool PhotoAdjustmentRenderer::DecodeTile(const TileKey& key, const TileRect& rect, Tile& tile)
+{
+    if (key.level == 0)
     {
-        m_wicColorContext->InitializeFromExifColorSpace(1); // 1 = sRGB.
+        return false;
     }
+
+    // Each level has its own WIC scaler over m_tileFormatConvert. The scaler reads the source
+    // rows it needs through the format converter and filters them down in software, so decoding
+    // a tile of a coarse level still decodes the full resolution rows that cover it.
+    auto& scaler = m_levelScalers[key.level];
+    if (scaler == nullptr)
+    {
+        if (FAILED(m_deviceResources->GetWicImagingFactory()->CreateBitmapScaler(&scaler)) ||
+            FAILED(scaler->Initialize(
+                m_tileFormatConvert.Get(),
+                m_tilePyramid->GetLevelWidth(key.level),
+                m_tilePyramid->GetLevelHeight(key.level),
+                WICBitmapInterpolationModeFant)))
+        {
+            scaler.Reset();
+            return false;
+        }
+    }
+
+    tile.width = rect.width;
+    tile.height = rect.height;
+    tile.stride = rect.width * 4;
+    tile.pixels.resize(tile.stride * rect.height);
+
+    WICRect wicRect =
+    {
+        static_cast<INT>(rect.x),
+        static_cast<INT>(rect.y),
+        static_cast<INT>(rect.width),
+        static_cast<INT>(rect.height)
+    };
+
+    return SUCCEEDED(scaler->CopyPixels(
+        &wicRect,
+        tile.stride,
+        static_cast<UINT>(tile.pixels.size()),
+        tile.pixels.data()
+        ));
+}
+
+// Queues decoding of the proxy level for the current zoom, followed by the next coarser level
+// so that zooming out has a proxy ready as well.
+void PhotoAdjustmentRenderer::RequestProxyTiles()
+{
+    if (m_proxyLevel == 0)
+    {
+        return;
+    }
+
+    m_tileScheduler->CancelPending(TilePriority::Visible);
+    m_tileScheduler->Request(m_tilePyramid->GetTiles(m_proxyLevel), TilePriority::Visible);
+
+    if (m_proxyLevel + 1 < m_tilePyramid->GetLevelCount())
+    {
+        m_tileScheduler->Request(m_tilePyramid->GetTiles(m_proxyLevel + 1), TilePriority::Prefetch);
+    }
+}
+
+// Assembles the proxy bitmap from cached tiles. Returns false if any tile is not decoded yet,
+// in which case the full resolution pipeline is used.
+bool PhotoAdjustmentRenderer::TryCreateProxyBitmap()
+{
+    if (m_proxyBitmap != nullptr)
+    {
+        return true;
+    }
+
+    if (m_proxyLevel == 0 || m_proxyScale == nullptr || !m_tileScheduler->IsLevelResident(m_proxyLevel))
+    {
+        return false;
+    }
+
+    auto d2dContext = m_deviceResources->GetD2DDeviceContext();
+
+    // Like the WIC image source, the bitmap is treated as 96 DPI so that one image pixel is one DIP.
+    ComPtr<ID2D1Bitmap1> bitmap;
+    DX::ThrowIfFailed(d2dContext->CreateBitmap(
+        D2D1::SizeU(m_tilePyramid->GetLevelWidth(m_proxyLevel), m_tilePyramid->GetLevelHeight(m_proxyLevel)),
+        nullptr,
+        0,
+        D2D1::BitmapProperties1(
+            D2D1_BITMAP_OPTIONS_NONE,
+            D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED)),
+        &bitmap
+        ));
+
+    for (const auto& key : m_tilePyramid->GetTiles(m_proxyLevel))
+    {
+        // The tile may have been evicted since the residency check.
+        auto tile = m_tileCache->Find(key);
+        if (tile == nullptr)
+        {
+            RequestProxyTiles();
+            return false;
+        }
+
+        TileRect rect = m_tilePyramid->GetTileRect(key);
+        D2D1_RECT_U destRect = D2D1::RectU(rect.x, rect.y, rect.x + rect.width, rect.y + rect.height);
+        DX::ThrowIfFailed(bitmap->CopyFromMemory(&destRect, tile->pixels.data(), tile->stride));
+    }
+
+    m_proxyBitmap = bitmap;
+    m_proxyScale->SetInput(0, m_proxyBitmap.Get());
+
+    return true;
 }
 
 void PhotoAdjustmentRenderer::CreateDeviceDependentResources()
@@ -112,6 +276,7 @@ void PhotoAdjustmentRenderer::CreateDeviceDependentResources()
     DX::ThrowIfFailed(d2dContext->CreateEffect(CLSID_D2D1Saturation, &m_saturation));
     DX::ThrowIfFailed(d2dContext->CreateEffect(CLSID_D2D1Contrast, &m_contrast));
     DX::ThrowIfFailed(d2dContext->CreateEffect(CLSID_D2D1HighlightsShadows, &m_highlightsShadows));
+    DX::ThrowIfFailed(d2dContext->CreateEffect(CLSID_D2D1Scale, &m_proxyScale));
 
     // Chain the individual photo adjustment effects together.
     // The input to the first effect (color management) is set during UpdateZoomState.
@@ -127,6 +292,9 @@ void PhotoAdjustmentRenderer::CreateDeviceDependentResources()
     // Do one-time configuration of the photo pipeline.
     m_straighten->SetValue(D2D1_STRAIGHTEN_PROP_MAINTAIN_SIZE, TRUE);
 
+    // The proxy is only shown while values are changing, so favor speed over quality.
+    m_proxyScale->SetValue(D2D1_SCALE_PROP_INTERPOLATION_MODE, D2D1_SCALE_INTERPOLATION_MODE_LINEAR);
+
     // Consider using a higher quality mode for offline processing, like saving the image to disk.
     m_colorManagement->SetValue(D2D1_COLORMANAGEMENT_PROP_QUALITY, D2D1_COLORMANAGEMENT_QUALITY_PROOF);
 
@@ -149,6 +317,9 @@ void PhotoAdjustmentRenderer::ReleaseDeviceDependentResources()
     m_contrast.Reset();
     m_highlightsShadows.Reset();
     m_outputEffect.Reset();
+    m_proxyBitmap.Reset();
+    m_proxyScale.Reset();
+    m_isShowingProxy = false;
 }
 
 void PhotoAdjustmentRenderer::CreateWindowSizeDependentResources()
@@ -188,6 +359,26 @@ void PhotoAdjustmentRenderer::UpdateZoomState()
         ));
 
     m_colorManagement->SetInput(0, m_scaledImage.Get());
+    m_isShowingProxy = false;
+
+    // Select the proxy level matching the new zoom. m_zoom is in DIPs, so it is converted to
+    // physical pixels first; otherwise a high DPI display would get a proxy that is too coarse.
+    // Decoded tiles stay in the cache, so returning to a previous zoom doesn't decode them again.
+    float dpiX, dpiY;
+    d2dContext->GetDpi(&dpiX, &dpiY);
+    uint32_t proxyLevel = m_tilePyramid->SelectLevel(m_zoom * dpiX / 96.0f);
+    if (proxyLevel != m_proxyLevel)
+    {
+        m_proxyLevel = proxyLevel;
+        m_proxyBitmap.Reset();
+    }
+
+    if (m_proxyLevel != 0)
+    {
+        float proxyZoom = m_zoom / m_tilePyramid->GetLevelScale(m_proxyLevel);
+        m_proxyScale->SetValue(D2D1_SCALE_PROP_SCALE, D2D1::Vector2F(proxyZoom, proxyZoom));
+        RequestProxyTiles();
+    }
 
     // Adjust DIP properties for the new zoom and/or DPI.
     m_highlightsShadows->SetValue(
@@ -363,5 +554,24 @@ void PhotoAdjustmentRenderer::UpdatePhotoAdjustmentValues(PhotoAdjustmentPropert
         DX::ThrowIfFailed(m_highlightsShadows->SetValue(
             D2D1_HIGHLIGHTSANDSHADOWS_PROP_MASK_BLUR_RADIUS,
             ConvertDipProperty(m_hsMaskRadiusDips)));
+
+        // Render the pipeline from the proxy until the caller asks for the full resolution
+        // result. The proxy is scaled to the same size as m_scaledImage, so DIP-based effect
+        // properties don't need to change.
+        if (!m_isShowingProxy && TryCreateProxyBitmap())
+        {
+            m_colorManagement->SetInputEffect(0, m_proxyScale.Get());
+            m_isShowingProxy = true;
+        }
+    }
+}
+
+// Switches the pipeline back to the full resolution image once the adjustment values settle.
+void PhotoAdjustmentRenderer::RefineFullResolution()
+{
+    if (m_isShowingProxy && m_scaledImage != nullptr)
+    {
+        m_colorManagement->SetInput(0, m_scaledImage.Get());
+        m_isShowingProxy = false;
     }
 }
\ No newline at end of file
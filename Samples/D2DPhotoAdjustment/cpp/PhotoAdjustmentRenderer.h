@@ -13,6 +13,7 @@
 
 #include "Common\DeviceResources.h"
 #include "PhotoAdjustmentProperties.h"
+#include "TileScheduler.h"
 
 namespace D2DPhotoAdjustment
 {
@@ -28,6 +29,7 @@ namespace D2DPhotoAdjustment
         void ReleaseDeviceDependentResources();
         void OnColorProfileChanged(_In_ Windows::Graphics::Display::DisplayInformation^ sender);
         void UpdatePhotoAdjustmentValues(PhotoAdjustmentProperties properties);
+        void RefineFullResolution();
         void Draw();
 
         // IDeviceNotify methods handle device lost and restored.
@@ -38,6 +40,11 @@ namespace D2DPhotoAdjustment
         void UpdateZoomState();
         void UpdateDisplayColorContext(_In_ Windows::Storage::Streams::DataReader^ colorProfileDataReader);
         float ConvertDipProperty(float valueInDips);
+        Microsoft::WRL::ComPtr<IWICBitmapFrameDecode> CreateFormatConverter(_Outptr_ IWICFormatConverter** formatConvert);
+        void CreateTilePyramid(UINT width, UINT height);
+        bool DecodeTile(const TileKey& key, const TileRect& rect, Tile& tile);
+        void RequestProxyTiles();
+        bool TryCreateProxyBitmap();
 
     private:
         // Cached pointer to device resources.
@@ -59,6 +66,20 @@ namespace D2DPhotoAdjustment
         Microsoft::WRL::ComPtr<ID2D1Effect>                     m_highlightsShadows;
         Microsoft::WRL::ComPtr<ID2D1Effect>                     m_outputEffect;
 
+        // Proxy resolution image used while the adjustment values are changing.
+        Microsoft::WRL::ComPtr<ID2D1Bitmap1>                    m_proxyBitmap;
+        Microsoft::WRL::ComPtr<ID2D1Effect>                     m_proxyScale;
+
+        // Tile pyramid of the photo. Tiles are decoded on a background thread once and are kept
+        // across device loss; level 0 is never decoded since it is drawn through m_imageSource.
+        std::unique_ptr<TilePyramid>                            m_tilePyramid;
+        std::unique_ptr<TileCache>                              m_tileCache;
+        std::unique_ptr<TileScheduler>                          m_tileScheduler;
+        Microsoft::WRL::ComPtr<IWICFormatConverter>             m_tileFormatConvert;    // Only used by the tile worker.
+        std::vector<Microsoft::WRL::ComPtr<IWICBitmapScaler>>   m_levelScalers;         // Only used by the tile worker.
+        uint32_t                                                m_proxyLevel;
+        bool                                                    m_isShowingProxy;
+
         // Image view state.
         Windows::Foundation::Size                               m_imageSize;
         Windows::Foundation::Size                               m_panelSize;
@@ -0,0 +1,191 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "TilePyramid.h"
+
+#include <algorithm>
+
+using namespace D2DPhotoAdjustment;
+
+TilePyramid::TilePyramid(uint32_t width, uint32_t height, uint32_t tileSize, uint32_t minLevelSize) :
+    m_tileSize(std::max(1u, tileSize))
+{
+    minLevelSize = std::max(1u, minLevelSize);
+    width = std::max(1u, width);
+    height = std::max(1u, height);
+
+    while (true)
+    {
+        Level level =
+        {
+            width,
+            height,
+            (width + m_tileSize - 1) / m_tileSize,
+            (height + m_tileSize - 1) / m_tileSize
+        };
+        m_levels.push_back(level);
+
+        if ((width <= minLevelSize && height <= minLevelSize) || (width == 1 && height == 1))
+        {
+            break;
+        }
+
+        width = std::max(1u, (width + 1) / 2);
+        height = std::max(1u, (height + 1) / 2);
+    }
+}
+
+uint32_t TilePyramid::SelectLevel(float zoom) const
+{
+    uint32_t level = 0;
+    while ((level + 1 < GetLevelCount()) && (GetLevelScale(level + 1) >= zoom))
+    {
+        level++;
+    }
+
+    return level;
+}
+
+TileRect TilePyramid::GetTileRect(const TileKey& key) const
+{
+    const Level& level = m_levels[key.level];
+    TileRect rect;
+    rect.x = key.column * m_tileSize;
+    rect.y = key.row * m_tileSize;
+    rect.width = std::min(m_tileSize, level.width - rect.x);
+    rect.height = std::min(m_tileSize, level.height - rect.y);
+    return rect;
+}
+
+std::vector<TileKey> TilePyramid::GetTiles(uint32_t level, const TileRect& region) const
+{
+    std::vector<TileKey> tiles;
+    if (level >= GetLevelCount() || region.width == 0 || region.height == 0)
+    {
+        return tiles;
+    }
+
+    const Level& info = m_levels[level];
+    if (region.x >= info.width || region.y >= info.height)
+    {
+        return tiles;
+    }
+
+    uint32_t right = std::min(info.width, region.x + region.width);
+    uint32_t bottom = std::min(info.height, region.y + region.height);
+
+    uint32_t firstColumn = region.x / m_tileSize;
+    uint32_t lastColumn = (right - 1) / m_tileSize;
+    uint32_t firstRow = region.y / m_tileSize;
+    uint32_t lastRow = (bottom - 1) / m_tileSize;
+
+    tiles.reserve((lastColumn - firstColumn + 1) * (lastRow - firstRow + 1));
+    for (uint32_t row = firstRow; row <= lastRow; row++)
+    {
+        for (uint32_t column = firstColumn; column <= lastColumn; column++)
+        {
+            tiles.push_back({ level, column, row });
+        }
+    }
+
+    return tiles;
+}
+
+std::vector<TileKey> TilePyramid::GetTiles(uint32_t level) const
+{
+    if (level >= GetLevelCount())
+    {
+        return std::vector<TileKey>();
+    }
+
+    TileRect all = { 0, 0, m_levels[level].width, m_levels[level].height };
+    return GetTiles(level, all);
+}
+
+TileCache::TileCache(size_t budgetBytes) :
+    m_budgetBytes(budgetBytes),
+    m_residentBytes(0),
+    m_evictions(0)
+{
+}
+
+std::shared_ptr<const Tile> TileCache::Find(const TileKey& key)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    auto it = m_index.find(key);
+    if (it == m_index.end())
+    {
+        return nullptr;
+    }
+
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    return *it->second;
+}
+
+bool TileCache::Contains(const TileKey& key) const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_index.find(key) != m_index.end();
+}
+
+void TileCache::Insert(std::shared_ptr<const Tile> tile)
+{
+    if (tile == nullptr)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    auto existing = m_index.find(tile->key);
+    if (existing != m_index.end())
+    {
+        m_residentBytes -= (*existing->second)->pixels.size();
+        m_lru.erase(existing->second);
+        m_index.erase(existing);
+    }
+
+    m_residentBytes += tile->pixels.size();
+    m_lru.push_front(tile);
+    m_index[tile->key] = m_lru.begin();
+
+    // Never evict the tile that was just inserted, even if it alone exceeds the budget.
+    while (m_residentBytes > m_budgetBytes && m_lru.size() > 1)
+    {
+        auto& victim = m_lru.back();
+        m_residentBytes -= victim->pixels.size();
+        m_index.erase(victim->key);
+        m_lru.pop_back();
+        m_evictions++;
+    }
+}
+
+void TileCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_lru.clear();
+    m_index.clear();
+    m_residentBytes = 0;
+}
+
+size_t TileCache::GetResidentBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_residentBytes;
+}
+
+uint64_t TileCache::GetEvictionCount() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_evictions;
+}
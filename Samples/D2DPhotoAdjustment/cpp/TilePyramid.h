@@ -0,0 +1,141 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+// Tile pyramid layout and decoded tile cache. Level 0 is the full resolution image and each
+// following level halves both dimensions. This file only depends on the C++ standard library.
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace D2DPhotoAdjustment
+{
+    struct TileKey
+    {
+        uint32_t level;
+        uint32_t column;
+        uint32_t row;
+
+        bool operator==(const TileKey& other) const
+        {
+            return level == other.level && column == other.column && row == other.row;
+        }
+    };
+
+    struct TileKeyHash
+    {
+        size_t operator()(const TileKey& key) const
+        {
+            // Levels and grid coordinates are small, so pack them without collisions.
+            uint64_t packed = (static_cast<uint64_t>(key.level) << 48) ^
+                (static_cast<uint64_t>(key.row) << 24) ^
+                static_cast<uint64_t>(key.column);
+            return std::hash<uint64_t>()(packed);
+        }
+    };
+
+    // A rectangle in the pixel space of a single pyramid level.
+    struct TileRect
+    {
+        uint32_t x;
+        uint32_t y;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    // Decoded pixels for one tile, stored as 32bppPBGRA.
+    struct Tile
+    {
+        TileKey                 key;
+        uint32_t                width;
+        uint32_t                height;
+        uint32_t                stride;
+        std::vector<uint8_t>    pixels;
+    };
+
+    class TilePyramid
+    {
+    public:
+        // Levels are added until both dimensions of the coarsest level fit within minLevelSize.
+        TilePyramid(uint32_t width, uint32_t height, uint32_t tileSize, uint32_t minLevelSize);
+
+        uint32_t GetLevelCount() const { return static_cast<uint32_t>(m_levels.size()); }
+        uint32_t GetTileSize() const { return m_tileSize; }
+        uint32_t GetLevelWidth(uint32_t level) const { return m_levels[level].width; }
+        uint32_t GetLevelHeight(uint32_t level) const { return m_levels[level].height; }
+        uint32_t GetColumnCount(uint32_t level) const { return m_levels[level].columns; }
+        uint32_t GetRowCount(uint32_t level) const { return m_levels[level].rows; }
+        float GetLevelScale(uint32_t level) const { return 1.0f / static_cast<float>(1u << level); }
+
+        // Returns the coarsest level that still has at least as many pixels as the viewport needs
+        // when the full resolution image is drawn at the given zoom factor.
+        uint32_t SelectLevel(float zoom) const;
+
+        // Returns the pixel bounds of a tile within its level; edge tiles may be smaller than tileSize.
+        TileRect GetTileRect(const TileKey& key) const;
+
+        // Returns every tile of the level that intersects the region (in level pixels).
+        std::vector<TileKey> GetTiles(uint32_t level, const TileRect& region) const;
+
+        // Returns every tile of the level.
+        std::vector<TileKey> GetTiles(uint32_t level) const;
+
+    private:
+        struct Level
+        {
+            uint32_t width;
+            uint32_t height;
+            uint32_t columns;
+            uint32_t rows;
+        };
+
+        uint32_t            m_tileSize;
+        std::vector<Level>  m_levels;
+    };
+
+    // Thread-safe least-recently-used cache of decoded tiles with a memory budget in bytes.
+    class TileCache
+    {
+    public:
+        explicit TileCache(size_t budgetBytes);
+
+        // Returns the tile and marks it as most recently used, or nullptr if it isn't resident.
+        std::shared_ptr<const Tile> Find(const TileKey& key);
+        bool Contains(const TileKey& key) const;
+
+        // Inserts or replaces a tile, then evicts least recently used tiles until the cache fits
+        // within its budget. Tiles still referenced by callers stay alive until released.
+        void Insert(std::shared_ptr<const Tile> tile);
+
+        void Clear();
+
+        size_t GetResidentBytes() const;
+        size_t GetBudgetBytes() const { return m_budgetBytes; }
+        uint64_t GetEvictionCount() const;
+
+    private:
+        typedef std::list<std::shared_ptr<const Tile>> LruList;
+
+        mutable std::mutex                                              m_lock;
+        size_t                                                          m_budgetBytes;
+        size_t                                                          m_residentBytes;
+        uint64_t                                                        m_evictions;
+        LruList                                                         m_lru;  // Front is most recent.
+        std::unordered_map<TileKey, LruList::iterator, TileKeyHash>     m_index;
+    };
+}
@@ -0,0 +1,207 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "TileScheduler.h"
+
+#include <algorithm>
+
+using namespace D2DPhotoAdjustment;
+
+TileScheduler::TileScheduler(const TilePyramid& pyramid, TileCache& cache, DecodeFunction decode, unsigned int workerCount) :
+    m_pyramid(pyramid),
+    m_cache(cache),
+    m_decode(decode),
+    m_sequence(0),
+    m_stopping(false),
+    m_stats()
+{
+    workerCount = std::max(1u, workerCount);
+    for (unsigned int i = 0; i < workerCount; i++)
+    {
+        m_workers.emplace_back(&TileScheduler::WorkerThread, this);
+    }
+}
+
+TileScheduler::~TileScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_stopping = true;
+    }
+
+    m_workAvailable.notify_all();
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+void TileScheduler::Request(const std::vector<TileKey>& tiles, TilePriority priority)
+{
+    bool queued = false;
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        for (const auto& key : tiles)
+        {
+            if (m_inFlight.count(key) != 0 || m_cache.Contains(key))
+            {
+                continue;
+            }
+
+            // The queue can hold stale entries for a key; only the one matching m_pending is used.
+            auto pending = m_pending.find(key);
+            if (pending != m_pending.end())
+            {
+                if (priority >= pending->second)
+                {
+                    continue;
+                }
+
+                pending->second = priority;
+            }
+            else
+            {
+                m_pending[key] = priority;
+                m_stats.requested++;
+            }
+
+            m_queue.push({ priority, m_sequence++, key });
+            queued = true;
+        }
+    }
+
+    if (queued)
+    {
+        m_workAvailable.notify_all();
+    }
+}
+
+void TileScheduler::CancelPending(TilePriority minimumPriority)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    for (auto it = m_pending.begin(); it != m_pending.end();)
+    {
+        if (it->second >= minimumPriority)
+        {
+            it = m_pending.erase(it);
+            m_stats.skipped++;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    if (m_pending.empty())
+    {
+        // Nothing left is valid, so release the stale entries now instead of popping them one by one.
+        m_queue = std::priority_queue<Job>();
+        if (m_inFlight.empty())
+        {
+            m_idle.notify_all();
+        }
+    }
+}
+
+bool TileScheduler::IsLevelResident(uint32_t level) const
+{
+    for (const auto& key : m_pyramid.GetTiles(level))
+    {
+        if (!m_cache.Contains(key))
+        {
+            return false;
+        }
+    }
+
+    return level < m_pyramid.GetLevelCount();
+}
+
+void TileScheduler::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_idle.wait(lock, [this]() { return m_pending.empty() && m_inFlight.empty(); });
+}
+
+TileSchedulerStats TileScheduler::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_stats;
+}
+
+void TileScheduler::WorkerThread()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    while (true)
+    {
+        m_workAvailable.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+        if (m_stopping)
+        {
+            return;
+        }
+
+        Job job = m_queue.top();
+        m_queue.pop();
+
+        auto pending = m_pending.find(job.key);
+        if (pending == m_pending.end() || pending->second != job.priority)
+        {
+            // Cancelled, or superseded by a more urgent entry for the same key.
+            continue;
+        }
+
+        m_pending.erase(pending);
+        m_inFlight.insert(job.key);
+        lock.unlock();
+
+        bool resident = m_cache.Contains(job.key);
+        bool succeeded = false;
+        if (!resident)
+        {
+            // An exception would end the worker thread and the app with it, so it counts as a failed decode.
+            try
+            {
+                auto tile = std::make_shared<Tile>();
+                tile->key = job.key;
+                succeeded = m_decode(job.key, m_pyramid.GetTileRect(job.key), *tile);
+                if (succeeded)
+                {
+                    m_cache.Insert(tile);
+                }
+            }
+            catch (...)
+            {
+                succeeded = false;
+            }
+        }
+
+        lock.lock();
+        m_inFlight.erase(job.key);
+        if (resident)
+        {
+            m_stats.skipped++;
+        }
+        else if (succeeded)
+        {
+            m_stats.decoded++;
+        }
+        else
+        {
+            m_stats.failed++;
+        }
+
+        if (m_pending.empty() && m_inFlight.empty())
+        {
+            m_queue = std::priority_queue<Job>();
+            m_idle.notify_all();
+        }
+    }
+}
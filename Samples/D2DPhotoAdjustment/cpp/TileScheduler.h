@@ -0,0 +1,111 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+// Background tile decoding for the tile pyramid. Requests are served in priority order by a set
+// of worker threads, and decoded tiles are placed in a TileCache. This file only depends on the
+// C++ standard library.
+
+#include "TilePyramid.h"
+
+#include <condition_variable>
+#include <functional>
+#include <queue>
+#include <thread>
+#include <unordered_set>
+
+namespace D2DPhotoAdjustment
+{
+    // Lower values are decoded first.
+    enum class TilePriority
+    {
+        Visible = 0,    // Tiles needed for the proxy currently on screen.
+        Refine = 1,     // Finer tiles for the visible region.
+        Prefetch = 2    // Everything else.
+    };
+
+    struct TileSchedulerStats
+    {
+        uint64_t requested;     // Unique requests accepted into the queue.
+        uint64_t decoded;       // Tiles successfully decoded.
+        uint64_t failed;        // Decode callbacks that returned false or threw.
+        uint64_t skipped;       // Requests that were already resident or were cancelled.
+    };
+
+    class TileScheduler
+    {
+    public:
+        // Decodes the tile described by key/rect into tile. Called on worker threads; must be
+        // safe to call concurrently if more than one worker is used. Returning false or throwing
+        // counts as a failed decode.
+        typedef std::function<bool(const TileKey& key, const TileRect& rect, Tile& tile)> DecodeFunction;
+
+        TileScheduler(const TilePyramid& pyramid, TileCache& cache, DecodeFunction decode, unsigned int workerCount);
+        ~TileScheduler();
+
+        TileScheduler(const TileScheduler&) = delete;
+        TileScheduler& operator=(const TileScheduler&) = delete;
+
+        // Queues tiles that are not already resident or pending. A pending tile is promoted if it
+        // is requested again with a more urgent priority.
+        void Request(const std::vector<TileKey>& tiles, TilePriority priority);
+
+        // Drops all queued requests at or below the given urgency, e.g. when the viewport moves.
+        // Tiles already being decoded still complete.
+        void CancelPending(TilePriority minimumPriority);
+
+        // Returns true when every tile of the level is resident in the cache.
+        bool IsLevelResident(uint32_t level) const;
+
+        // Blocks until the queue is empty and no worker is decoding.
+        void WaitIdle();
+
+        TileSchedulerStats GetStats() const;
+
+    private:
+        struct Job
+        {
+            TilePriority    priority;
+            uint64_t        sequence;
+            TileKey         key;
+
+            bool operator<(const Job& other) const
+            {
+                // std::priority_queue pops the largest element, so invert the ordering.
+                if (priority != other.priority)
+                {
+                    return priority > other.priority;
+                }
+
+                return sequence > other.sequence;
+            }
+        };
+
+        void WorkerThread();
+
+        const TilePyramid&                                      m_pyramid;
+        TileCache&                                              m_cache;
+        DecodeFunction                                          m_decode;
+
+        mutable std::mutex                                      m_lock;
+        std::condition_variable                                 m_workAvailable;
+        std::condition_variable                                 m_idle;
+        std::priority_queue<Job>                                m_queue;
+        std::unordered_map<TileKey, TilePriority, TileKeyHash>  m_pending;  // Best priority per queued key.
+        std::unordered_set<TileKey, TileKeyHash>                m_inFlight;
+        uint64_t                                                m_sequence;
+        bool                                                    m_stopping;
+        TileSchedulerStats                                      m_stats;
+
+        std::vector<std::thread>                                m_workers;
+    };
+}
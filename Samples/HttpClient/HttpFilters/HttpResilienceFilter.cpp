@@ -0,0 +1,410 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+#include "HttpResilienceFilter.h"
+#include "HttpResilienceFilter.g.cpp"
+
+using namespace winrt;
+using namespace winrt::Windows::Foundation;
+using namespace winrt::Windows::Foundation::Collections;
+using namespace winrt::Windows::Web::Http;
+using namespace winrt::Windows::Web::Http::Filters;
+using namespace winrt::Windows::Web::Http::Headers;
+using ::HttpFilters::AttemptOutcome;
+using ::HttpFilters::RequestClock;
+
+namespace winrt::HttpFilters::implementation
+{
+    // Attempts of one request report their completion here, from whatever thread they complete on,
+    // and the request's coroutine waits on the event. The attempts are kept here too, so that
+    // canceling the request can reach them from any thread.
+    struct HttpResilienceFilter::AttemptRace
+    {
+        struct Completion
+        {
+            size_t attempt;
+            AsyncStatus status;
+            HttpResponseMessage response{ nullptr };
+            hresult error;
+        };
+
+        handle signal{ check_pointer(CreateEvent(nullptr, false, false, nullptr)) };
+        slim_mutex lock;
+        std::vector<IAsyncOperationWithProgress<HttpResponseMessage, HttpProgress>> attempts;
+        std::vector<Completion> completions;
+        bool isCanceled = false;
+
+        // An attempt added after the request was canceled is canceled at once.
+        void Add(IAsyncOperationWithProgress<HttpResponseMessage, HttpProgress> const& operation)
+        {
+            bool cancel;
+            {
+                slim_lock_guard guard(lock);
+                attempts.push_back(operation);
+                cancel = isCanceled;
+            }
+            if (cancel)
+            {
+                operation.Cancel();
+            }
+        }
+
+        // Canceling may complete the operation synchronously, which takes the lock, so it is never
+        // done while the lock is held.
+        void CancelAttempt(size_t attempt)
+        {
+            IAsyncOperationWithProgress<HttpResponseMessage, HttpProgress> operation{ nullptr };
+            {
+                slim_lock_guard guard(lock);
+                operation = attempts[attempt];
+            }
+            operation.Cancel();
+        }
+
+        // Called when the request is canceled, on the thread that canceled it.
+        void Cancel()
+        {
+            std::vector<IAsyncOperationWithProgress<HttpResponseMessage, HttpProgress>> outstanding;
+            {
+                slim_lock_guard guard(lock);
+                isCanceled = true;
+                outstanding = attempts;
+            }
+            for (auto& operation : outstanding)
+            {
+                operation.Cancel();
+            }
+            SetEvent(signal.get());
+        }
+
+        void Complete(size_t attempt, IAsyncOperationWithProgress<HttpResponseMessage, HttpProgress> const& operation, AsyncStatus status)
+        {
+            Completion completion{ attempt, status };
+            if (status == AsyncStatus::Completed)
+            {
+                completion.response = operation.GetResults();
+            }
+            else if (status == AsyncStatus::Error)
+            {
+                completion.error = operation.ErrorCode();
+            }
+
+            {
+                slim_lock_guard guard(lock);
+                completions.push_back(std::move(completion));
+            }
+            SetEvent(signal.get());
+        }
+
+        std::vector<Completion> TakeCompletions()
+        {
+            slim_lock_guard guard(lock);
+            return std::move(completions);
+        }
+    };
+
+    HttpResilienceFilter::HttpResilienceFilter(IHttpFilter const& innerFilter) : m_innerFilter(innerFilter)
+    {
+        if (!m_innerFilter)
+        {
+            throw hresult_invalid_argument(L"innerFilter cannot be null.");
+        }
+    }
+
+    bool HttpResilienceFilter::IsRepeatable(HttpRequestMessage const& request)
+    {
+        // Only idempotent requests can be sent more than once, and content streams can only be read once.
+        hstring method = request.Method().Method();
+        return (request.Content() == nullptr) &&
+            ((method == L"GET") || (method == L"HEAD") || (method == L"OPTIONS") || (method == L"PUT") || (method == L"DELETE"));
+    }
+
+    AttemptOutcome HttpResilienceFilter::GetOutcome(HttpResponseMessage const& response)
+    {
+        switch (response.StatusCode())
+        {
+        case HttpStatusCode::InternalServerError:
+        case HttpStatusCode::BadGateway:
+        case HttpStatusCode::ServiceUnavailable:
+        case HttpStatusCode::GatewayTimeout:
+            return AttemptOutcome::Failure;
+        default:
+            return AttemptOutcome::Success;
+        }
+    }
+
+    HttpRequestMessage HttpResilienceFilter::CopyRequestMessage(HttpRequestMessage const& request)
+    {
+        HttpRequestMessage copy(request.Method(), request.RequestUri());
+
+        // Copy the headers.
+        HttpRequestHeaderCollection headers = copy.Headers();
+        for (auto [key, value] : request.Headers())
+        {
+            if (!headers.TryAppendWithoutValidation(key, value))
+            {
+                throw hresult_error(E_FAIL, L"Unable to copy headers.");
+            }
+        }
+
+        // Copy the properties.
+        IMap<hstring, IInspectable> properties = copy.Properties();
+        for (auto [key, value] : request.Properties())
+        {
+            properties.Insert(key, value);
+        }
+
+        return copy;
+    }
+
+    HttpResponseMessage HttpResilienceFilter::CreateCircuitOpenResponse(HttpRequestMessage const& request, RequestClock::duration retryAfter)
+    {
+        // Fail without contacting the server, the way an overloaded server would.
+        HttpResponseMessage response(HttpStatusCode::ServiceUnavailable);
+        response.RequestMessage(request);
+        response.ReasonPhrase(L"Circuit Open");
+
+        auto seconds = std::chrono::ceil<std::chrono::seconds>(retryAfter);
+        response.Headers().RetryAfter(HttpDateOrDeltaHeaderValue::Parse(to_hstring(seconds.count())));
+        return response;
+    }
+
+    IAsyncOperationWithProgress<HttpResponseMessage, HttpProgress> HttpResilienceFilter::SendRequestAsync(HttpRequestMessage request)
+    {
+        auto lifetime = get_strong();
+        auto cancellation = co_await get_cancellation_token();
+        cancellation.enable_propagation();
+        auto progress = co_await get_progress_token();
+
+        Uri uri = request.RequestUri();
+        std::string host = to_string(uri.Host()) + ":" + std::to_string(uri.Port());
+
+        RequestClock::duration retryAfter;
+        bool isProbe;
+        if (!m_policy.TryStartRequest(host, RequestClock::now(), retryAfter, isProbe))
+        {
+            co_return CreateCircuitOpenResponse(request, retryAfter);
+        }
+
+        bool isRepeatable = IsRepeatable(request);
+        RequestClock::duration hedgeDelay;
+        bool canHedge = isRepeatable && m_policy.TryGetHedgeDelay(host, hedgeDelay);
+
+        // Attempts that aren't being awaited don't see the cancellation, so pass it on to them.
+        auto race = std::make_shared<AttemptRace>();
+        cancellation.callback([race]
+            {
+                race->Cancel();
+            });
+
+        std::vector<RequestClock::time_point> startTimes;
+        std::vector<bool> isOutstanding;
+        size_t outstandingCount = 0;
+
+        // If this request is the probe of a half open circuit, its first recorded attempt ends the probe.
+        auto recordAttempt = [&](AttemptOutcome outcome, RequestClock::duration latency, RequestClock::time_point now)
+        {
+            m_policy.RecordAttempt(host, outcome, latency, now, isProbe);
+            isProbe = false;
+        };
+
+        auto recordCompletion = [&](AttemptRace::Completion const& completion)
+        {
+            size_t i = completion.attempt;
+            isOutstanding[i] = false;
+            outstandingCount--;
+
+            AttemptOutcome outcome = AttemptOutcome::Canceled;
+            if (completion.status == AsyncStatus::Completed)
+            {
+                outcome = GetOutcome(completion.response);
+            }
+            else if (completion.status == AsyncStatus::Error)
+            {
+                outcome = AttemptOutcome::Failure;
+            }
+            RequestClock::time_point now = RequestClock::now();
+            recordAttempt(outcome, now - startTimes[i], now);
+            return outcome;
+        };
+
+        // Records an attempt that completed after the race was decided, unless it was already recorded
+        // as canceled, and closes its response.
+        auto discardCompletion = [&](AttemptRace::Completion const& completion)
+        {
+            if (isOutstanding[completion.attempt])
+            {
+                recordCompletion(completion);
+            }
+            if (completion.response)
+            {
+                completion.response.Close();
+            }
+        };
+
+        auto startAttempt = [&]()
+        {
+            // A request message can only be sent once, so every attempt after the first sends a copy.
+            size_t index = startTimes.size();
+            IAsyncOperationWithProgress<HttpResponseMessage, HttpProgress> operation{ nullptr };
+            try
+            {
+                operation = m_innerFilter.SendRequestAsync((index == 0) ? request : CopyRequestMessage(request));
+            }
+            catch (...)
+            {
+                // Nothing was sent. Record the attempt as canceled all the same, so that the probe is
+                // released if this request is it.
+                recordAttempt(AttemptOutcome::Canceled, RequestClock::duration::zero(), RequestClock::now());
+                throw;
+            }
+
+            race->Add(operation);
+            startTimes.push_back(RequestClock::now());
+            isOutstanding.push_back(true);
+            outstandingCount++;
+
+            // Propagate progress. Increment HttpProgress.Retries by the number of attempts sent before this one.
+            operation.Progress([progress, index](auto&&, HttpProgress data) mutable
+                {
+                    data.Retries += static_cast<uint32_t>(index);
+                    progress(data);
+                });
+            operation.Completed([race, index](auto&& sender, AsyncStatus status)
+                {
+                    race->Complete(index, sender, status);
+                });
+        };
+
+        auto cancelOutstanding = [&]()
+        {
+            // Attempts that have already completed are recorded with their real outcome.
+            for (AttemptRace::Completion& completion : race->TakeCompletions())
+            {
+                discardCompletion(completion);
+            }
+
+            for (size_t i = 0; i < startTimes.size(); i++)
+            {
+                if (isOutstanding[i])
+                {
+                    race->CancelAttempt(i);
+                    RequestClock::time_point now = RequestClock::now();
+                    recordAttempt(AttemptOutcome::Canceled, now - startTimes[i], now);
+                }
+            }
+        };
+
+        HttpResponseMessage response{ nullptr };
+        hresult error;
+        uint32_t retries = 0;
+
+        try
+        {
+            startAttempt();
+            while (true)
+            {
+                // Wait for an attempt to complete. If the request can be hedged, don't wait longer than
+                // the hedge delay before sending a duplicate.
+                bool signaled;
+                if (canHedge && (outstandingCount > 0))
+                {
+                    signaled = co_await resume_on_signal(race->signal.get(), std::chrono::duration_cast<TimeSpan>(hedgeDelay));
+                }
+                else
+                {
+                    signaled = co_await resume_on_signal(race->signal.get());
+                }
+
+                if (cancellation())
+                {
+                    throw hresult_canceled();
+                }
+
+                if (!signaled)
+                {
+                    if (m_policy.TryStartHedge(host, static_cast<uint32_t>(startTimes.size())))
+                    {
+                        startAttempt();
+                    }
+                    else
+                    {
+                        canHedge = false;
+                    }
+                    continue;
+                }
+
+                std::vector<AttemptRace::Completion> completions = race->TakeCompletions();
+                for (auto it = completions.begin(); it != completions.end(); ++it)
+                {
+                    AttemptRace::Completion& completion = *it;
+                    if (recordCompletion(completion) == AttemptOutcome::Success)
+                    {
+                        // The first good response wins the race.
+                        for (auto rest = std::next(it); rest != completions.end(); ++rest)
+                        {
+                            discardCompletion(*rest);
+                        }
+                        cancelOutstanding();
+                        if (response)
+                        {
+                            response.Close();
+                        }
+                        co_return completion.response;
+                    }
+
+                    // Keep the last failure, to report if no attempt succeeds.
+                    if (completion.status == AsyncStatus::Completed)
+                    {
+                        if (response)
+                        {
+                            response.Close();
+                        }
+                        response = completion.response;
+                    }
+                    else if (completion.status == AsyncStatus::Error)
+                    {
+                        error = completion.error;
+                    }
+                }
+
+                if (outstandingCount > 0)
+                {
+                    continue;
+                }
+
+                // Every attempt so far has failed. Try again after a backoff, if the policy allows.
+                if (isRepeatable && m_policy.TryStartRetry(host, static_cast<uint32_t>(startTimes.size())))
+                {
+                    co_await resume_after(std::chrono::duration_cast<TimeSpan>(m_policy.GetBackoff(++retries)));
+                    startAttempt();
+                    continue;
+                }
+
+                if (response)
+                {
+                    co_return response;
+                }
+                if (error < 0)
+                {
+                    throw_hresult(error);
+                }
+                throw hresult_canceled();
+            }
+        }
+        catch (...)
+        {
+            cancelOutstanding();
+            throw;
+        }
+    }
+}
@@ -0,0 +1,41 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+#include "HttpResilienceFilter.g.h"
+#include "RequestPolicy.h"
+
+namespace winrt::HttpFilters::implementation
+{
+    struct HttpResilienceFilter : HttpResilienceFilterT<HttpResilienceFilter>
+    {
+        HttpResilienceFilter(Windows::Web::Http::Filters::IHttpFilter const& innerFilter);
+        void Close() {}
+        Windows::Foundation::IAsyncOperationWithProgress<Windows::Web::Http::HttpResponseMessage, Windows::Web::Http::HttpProgress> SendRequestAsync(Windows::Web::Http::HttpRequestMessage request);
+
+    private:
+        struct AttemptRace;
+
+        Windows::Web::Http::Filters::IHttpFilter m_innerFilter;
+        ::HttpFilters::RequestPolicy m_policy{ ::HttpFilters::RequestPolicyOptions() };
+
+        static bool IsRepeatable(Windows::Web::Http::HttpRequestMessage const& request);
+        static ::HttpFilters::AttemptOutcome GetOutcome(Windows::Web::Http::HttpResponseMessage const& response);
+        static Windows::Web::Http::HttpRequestMessage CopyRequestMessage(Windows::Web::Http::HttpRequestMessage const& request);
+        static Windows::Web::Http::HttpResponseMessage CreateCircuitOpenResponse(Windows::Web::Http::HttpRequestMessage const& request, ::HttpFilters::RequestClock::duration retryAfter);
+    };
+}
+namespace winrt::HttpFilters::factory_implementation
+{
+    struct HttpResilienceFilter : HttpResilienceFilterT<HttpResilienceFilter, implementation::HttpResilienceFilter>
+    {
+    };
+}
@@ -0,0 +1,209 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "RequestPolicy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace std::chrono;
+
+namespace HttpFilters
+{
+    RequestPolicy::RequestPolicy(RequestPolicyOptions const& options, uint64_t seed) :
+        m_options(options), m_random(seed)
+    {
+        if ((options.maxAttempts == 0) ||
+            (options.baseBackoff.count() < 0) || (options.maxBackoff < options.baseBackoff) ||
+            !(options.budgetRatio >= 0) || !(options.budgetBurst >= 0) ||
+            !(options.hedgeQuantile >= 0) || !(options.hedgeQuantile < 1) || (options.minHedgeDelay.count() < 0) ||
+            (options.breakerOpenTime.count() < 0))
+        {
+            throw std::invalid_argument("The request policy options are out of range.");
+        }
+    }
+
+    RequestPolicy::HostState& RequestPolicy::GetHost(std::string const& host)
+    {
+        auto result = m_hosts.try_emplace(host);
+        if (result.second)
+        {
+            result.first->second.budget = m_options.budgetBurst;
+        }
+        return result.first->second;
+    }
+
+    bool RequestPolicy::TryStartRequest(std::string const& host, RequestClock::time_point now, RequestClock::duration& retryAfter, bool& isProbe)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        HostState& state = GetHost(host);
+        isProbe = false;
+
+        if (state.circuit == CircuitState::Open)
+        {
+            if (now < state.openUntil)
+            {
+                retryAfter = state.openUntil - now;
+                m_statistics.breakerRejections++;
+                return false;
+            }
+            state.circuit = CircuitState::HalfOpen;
+        }
+
+        if (state.circuit == CircuitState::HalfOpen)
+        {
+            // Let one request through to find out whether the host has recovered.
+            if (state.probing)
+            {
+                retryAfter = RequestClock::duration::zero();
+                m_statistics.breakerRejections++;
+                return false;
+            }
+            state.probing = true;
+            isProbe = true;
+        }
+
+        state.budget = std::min(state.budget + m_options.budgetRatio, m_options.budgetBurst);
+        m_statistics.requests++;
+        return true;
+    }
+
+    bool RequestPolicy::TryGetHedgeDelay(std::string const& host, RequestClock::duration& delay)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        HostState& state = GetHost(host);
+
+        if ((m_options.hedgeQuantile == 0) || (m_options.maxAttempts < 2) ||
+            (state.circuit != CircuitState::Closed) || (state.sampleCount < m_options.hedgeMinSamples))
+        {
+            return false;
+        }
+
+        delay = std::max<RequestClock::duration>(GetQuantile(state, m_options.hedgeQuantile), m_options.minHedgeDelay);
+        return true;
+    }
+
+    bool RequestPolicy::TryStartRetry(std::string const& host, uint32_t attempts)
+    {
+        return TryStartExtraAttempt(host, attempts, m_statistics.retries);
+    }
+
+    bool RequestPolicy::TryStartHedge(std::string const& host, uint32_t attempts)
+    {
+        return TryStartExtraAttempt(host, attempts, m_statistics.hedges);
+    }
+
+    bool RequestPolicy::TryStartExtraAttempt(std::string const& host, uint32_t attempts, uint64_t& counter)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        HostState& state = GetHost(host);
+
+        if ((attempts >= m_options.maxAttempts) || (state.circuit != CircuitState::Closed))
+        {
+            return false;
+        }
+        if (state.budget < 1)
+        {
+            m_statistics.budgetRejections++;
+            return false;
+        }
+
+        state.budget -= 1;
+        counter++;
+        return true;
+    }
+
+    RequestClock::duration RequestPolicy::GetBackoff(uint32_t retry)
+    {
+        // Full jitter spreads out the retries of clients that failed at the same moment.
+        duration<double, std::milli> limit = m_options.baseBackoff * std::pow(2.0, std::min(retry, 32U) - 1.0);
+        limit = std::min<duration<double, std::milli>>(limit, m_options.maxBackoff);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::uniform_real_distribution<double> distribution(0, limit.count());
+        return duration_cast<RequestClock::duration>(duration<double, std::milli>(distribution(m_random)));
+    }
+
+    void RequestPolicy::RecordAttempt(std::string const& host, AttemptOutcome outcome, RequestClock::duration latency, RequestClock::time_point now, bool isProbe)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        HostState& state = GetHost(host);
+
+        // Only the probe itself ends probing. Attempts of requests that were started while the circuit
+        // was closed may still be completing, and must not let a second probe through.
+        if (isProbe)
+        {
+            state.probing = false;
+        }
+
+        switch (outcome)
+        {
+        case AttemptOutcome::Success:
+            // Only successes are timed: a server that fails fast would otherwise make hedging eager.
+            AddSample(state, latency);
+            state.consecutiveFailures = 0;
+            state.circuit = CircuitState::Closed;
+            break;
+
+        case AttemptOutcome::Failure:
+            state.consecutiveFailures++;
+            if ((state.circuit == CircuitState::HalfOpen) ||
+                ((m_options.breakerFailureThreshold > 0) && (state.consecutiveFailures >= m_options.breakerFailureThreshold)))
+            {
+                state.circuit = CircuitState::Open;
+                state.openUntil = now + m_options.breakerOpenTime;
+            }
+            break;
+
+        case AttemptOutcome::Canceled:
+            // A canceled attempt tells us nothing about the host.
+            break;
+        }
+    }
+
+    RequestPolicyStatistics RequestPolicy::GetStatistics() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_statistics;
+    }
+
+    void RequestPolicy::AddSample(HostState& state, RequestClock::duration latency)
+    {
+        double microseconds = std::max(duration<double, std::micro>(latency).count(), 1.0);
+        int bucket = std::min(static_cast<int>(std::log2(microseconds) * 4), BucketCount - 1);
+        state.buckets[bucket]++;
+
+        if (++state.sampleCount >= DecayCount)
+        {
+            state.sampleCount = 0;
+            for (uint32_t& count : state.buckets)
+            {
+                count /= 2;
+                state.sampleCount += count;
+            }
+        }
+    }
+
+    RequestClock::duration RequestPolicy::GetQuantile(HostState const& state, double quantile)
+    {
+        // Use the top of the bucket, so that the estimate errs towards hedging later.
+        uint32_t rank = static_cast<uint32_t>(std::ceil(quantile * state.sampleCount));
+        uint32_t seen = 0;
+        int bucket = 0;
+        while ((bucket < BucketCount - 1) && ((seen += state.buckets[bucket]) < rank))
+        {
+            bucket++;
+        }
+        return duration_cast<RequestClock::duration>(duration<double, std::micro>(std::exp2((bucket + 1) / 4.0)));
+    }
+}
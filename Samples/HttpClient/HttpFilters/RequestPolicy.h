@@ -0,0 +1,149 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+// Decides when HttpResilienceFilter sends a request again. The policy does no I/O and takes the time
+// as a parameter, so any client can drive it. This file only depends on the C++ standard library.
+//
+// Extra attempts come in two kinds. A retry follows a failed attempt after an exponential backoff
+// with full jitter. A hedge is a duplicate sent while the first attempt is still outstanding, once it
+// has taken longer than a high percentile of recent latencies to the same host, so that one slow
+// server doesn't set the tail latency. Both draw on a per-host budget that only grows as requests are
+// made, so extra attempts add at most a fixed fraction to the load on a server that is struggling.
+// After several failures in a row, a host's circuit opens and requests to it fail at once until a
+// single probe request succeeds.
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+namespace HttpFilters
+{
+    typedef std::chrono::steady_clock RequestClock;
+
+    struct RequestPolicyOptions
+    {
+        // Attempts per request, including the first one, its retries and its hedges.
+        uint32_t maxAttempts = 3;
+
+        // The backoff before retry n is drawn uniformly from zero to baseBackoff * 2^(n-1), capped at
+        // maxBackoff.
+        std::chrono::milliseconds baseBackoff{ 50 };
+        std::chrono::milliseconds maxBackoff{ 2000 };
+
+        // Each request adds budgetRatio extra attempts to its host's budget, which holds at most
+        // budgetBurst of them and starts full.
+        double budgetRatio = 0.1;
+        double budgetBurst = 10.0;
+
+        // A hedge is sent once an attempt has been outstanding for this percentile of the host's
+        // recent successful attempts, but not before minHedgeDelay, and only once hedgeMinSamples
+        // attempts have been measured. A quantile of 0 turns hedging off.
+        double hedgeQuantile = 0.95;
+        std::chrono::milliseconds minHedgeDelay{ 10 };
+        uint32_t hedgeMinSamples = 20;
+
+        // The circuit opens after this many failed attempts in a row, and stays open for
+        // breakerOpenTime before a probe is let through. Zero turns circuit breaking off.
+        uint32_t breakerFailureThreshold = 5;
+        std::chrono::milliseconds breakerOpenTime{ 5000 };
+    };
+
+    enum class AttemptOutcome
+    {
+        Success,    // Any response that isn't a failure, including client errors.
+        Failure,    // A transient error or a server error that may succeed when repeated.
+        Canceled,   // Abandoned, for example a hedge that lost the race.
+    };
+
+    struct RequestPolicyStatistics
+    {
+        uint64_t requests = 0;
+        uint64_t retries = 0;
+        uint64_t hedges = 0;
+        uint64_t budgetRejections = 0;      // Extra attempts refused for lack of budget.
+        uint64_t breakerRejections = 0;     // Requests refused because a circuit was open.
+    };
+
+    class RequestPolicy
+    {
+    public:
+        // Throws std::invalid_argument if the options are out of range.
+        explicit RequestPolicy(RequestPolicyOptions const& options, uint64_t seed = std::random_device()());
+
+        RequestPolicy(const RequestPolicy&) = delete;
+        RequestPolicy& operator=(const RequestPolicy&) = delete;
+
+        // Called before the first attempt of a request to host. Returns false if the host's circuit
+        // is open, and sets retryAfter to the time until a probe will be let through. Otherwise sets
+        // isProbe to whether this request is the probe of a half open circuit.
+        bool TryStartRequest(std::string const& host, RequestClock::time_point now, RequestClock::duration& retryAfter, bool& isProbe);
+
+        // Returns true and sets delay if a request to host should be hedged after delay.
+        bool TryGetHedgeDelay(std::string const& host, RequestClock::duration& delay);
+
+        // Called before each retry or hedge, with the number of attempts already started. Return
+        // false if the attempt limit or the budget doesn't allow another attempt, or the host's
+        // circuit isn't closed.
+        bool TryStartRetry(std::string const& host, uint32_t attempts);
+        bool TryStartHedge(std::string const& host, uint32_t attempts);
+
+        // The time to wait before the given retry, counting from 1.
+        RequestClock::duration GetBackoff(uint32_t retry);
+
+        // Called as each attempt completes, with the time since it was started. isProbe is true only
+        // for the first attempt recorded for the probe request, which lets the next request probe
+        // unless the attempt succeeded.
+        void RecordAttempt(std::string const& host, AttemptOutcome outcome, RequestClock::duration latency, RequestClock::time_point now, bool isProbe);
+
+        RequestPolicyStatistics GetStatistics() const;
+
+    private:
+        // Latencies in buckets a quarter of an octave wide, from 1 microsecond to over a minute.
+        // Counts are halved when they reach DecayCount in total, so old samples fade out.
+        static const int BucketCount = 26 * 4;
+        static const uint32_t DecayCount = 1024;
+
+        enum class CircuitState
+        {
+            Closed,
+            Open,
+            HalfOpen,
+        };
+
+        struct HostState
+        {
+            uint32_t buckets[BucketCount] = {};
+            uint32_t sampleCount = 0;
+            double budget = 0;
+            CircuitState circuit = CircuitState::Closed;
+            uint32_t consecutiveFailures = 0;
+            RequestClock::time_point openUntil;
+            bool probing = false;
+        };
+
+        HostState& GetHost(std::string const& host);
+        bool TryStartExtraAttempt(std::string const& host, uint32_t attempts, uint64_t& counter);
+        static void AddSample(HostState& state, RequestClock::duration latency);
+        static RequestClock::duration GetQuantile(HostState const& state, double quantile);
+
+        RequestPolicyOptions m_options;
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::string, HostState> m_hosts;
+        std::mt19937_64 m_random;
+        RequestPolicyStatistics m_statistics;
+    };
+}
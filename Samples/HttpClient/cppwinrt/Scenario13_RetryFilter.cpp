@@ -33,7 +33,13 @@ namespace winrt::SDKTemplate::implementation
     {
         HttpBaseProtocolFilter baseProtocolFilter;
         HttpRetryFilter retryFilter(baseProtocolFilter);
-        httpClient = HttpClient(retryFilter);
+
+        // The resilience filter sits on top: it retries other server errors and network failures with a
+        // jittered backoff, sends a duplicate of a GET that takes unusually long, and stops sending
+        // requests to a server that keeps failing. A 503 with a Retry-After header is still handled by
+        // the retry filter underneath.
+        HttpResilienceFilter resilienceFilter(retryFilter);
+        httpClient = HttpClient(resilienceFilter);
         UpdateAddressField();
     }
 
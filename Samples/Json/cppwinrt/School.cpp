@@ -31,6 +31,13 @@ namespace winrt::SDKTemplate::implementation
         m_type = jsonObject.GetNamedString(typeKey);
     }
 
+    School::School(::SDKTemplate::SchoolRecord const& record) :
+        m_id(record.id),
+        m_name(record.name),
+        m_type(record.type)
+    {
+    }
+
     winrt::Windows::Data::Json::JsonObject School::ToJsonObject()
     {
         JsonObject schoolObject;        
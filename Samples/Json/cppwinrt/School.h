@@ -11,6 +11,7 @@
 
 #pragma once
 #include "School.g.h"
+#include "UserJson.h"
 
 namespace winrt::SDKTemplate::implementation
 {
@@ -18,6 +19,7 @@ namespace winrt::SDKTemplate::implementation
     {
         School() = default;
         School(winrt::Windows::Data::Json::JsonObject const& jsonObject);
+        School(::SDKTemplate::SchoolRecord const& record);
 
         winrt::Windows::Data::Json::JsonObject ToJsonObject();
 
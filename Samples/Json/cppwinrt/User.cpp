@@ -12,66 +12,72 @@
 #include "pch.h"
 #include "User.h"
 #include "User.g.cpp"
+#include "UserJson.h"
 
 using namespace winrt;
 using namespace winrt::Windows::Data::Json;
 
+namespace
+{
+    // Reports reader errors with the same HRESULTs as JsonObject, so that JsonError::GetJsonStatus
+    // and the schema check in the scenario page work unchanged.
+    hresult ToHResult(::SDKTemplate::UserJsonError error)
+    {
+        switch (error)
+        {
+        case ::SDKTemplate::UserJsonError::InvalidJsonString: return WEB_E_INVALID_JSON_STRING;
+        case ::SDKTemplate::UserJsonError::InvalidJsonNumber: return WEB_E_INVALID_JSON_NUMBER;
+        case ::SDKTemplate::UserJsonError::JsonValueNotFound: return WEB_E_JSON_VALUE_NOT_FOUND;
+        case ::SDKTemplate::UserJsonError::ImplementationLimit: return HRESULT_FROM_WIN32(ERROR_IMPLEMENTATION_LIMIT);
+        default: return E_ILLEGAL_METHOD_CALL;
+        }
+    }
+}
+
 namespace winrt::SDKTemplate::implementation
 {
     User::User(hstring const& jsonString)
     {
-        JsonObject jsonObject = JsonObject::Parse(jsonString);
-        m_id = jsonObject.GetNamedString(idKey, L"");
-
-        IJsonValue phoneJsonValue = jsonObject.GetNamedValue(phoneKey);
-        if (phoneJsonValue.ValueType() == JsonValueType::Null)
+        // The text is read straight into a record instead of a JsonObject. The record is reused so
+        // that its strings and education list keep their capacity from one parse to the next.
+        thread_local ::SDKTemplate::UserRecord record;
+        try
         {
-            m_phone = {};
+            ::SDKTemplate::ReadUser(std::wstring_view(jsonString), record);
         }
-        else
+        catch (::SDKTemplate::UserJsonException const& ex)
         {
-            m_phone = phoneJsonValue.GetString();
+            throw hresult_error(ToHResult(ex.Error()), to_hstring(ex.what()));
         }
 
-        m_name = jsonObject.GetNamedString(nameKey, L"");
-        m_timezone = jsonObject.GetNamedNumber(timezoneKey, 0.0);
-        m_verified = jsonObject.GetNamedBoolean(verifiedKey, false);
+        m_id = record.id;
+        m_phone = record.phone;
+        m_name = record.name;
+        m_timezone = record.timezone;
+        m_verified = record.verified;
 
-        for (IJsonValue jsonValue : jsonObject.GetNamedArray(educationKey, {}))
+        for (auto const& school : record.education)
         {
-            m_education.Append(SDKTemplate::School(jsonValue.GetObject()));
+            m_education.Append(make<School>(school));
         }
     }
 
     hstring User::Stringify()
     {
-        JsonObject jsonObject;
+        // Written straight to text instead of building a JsonObject for the user and each school.
+        thread_local std::wstring buffer;
+        buffer.clear();
 
-        jsonObject.SetNamedValue(idKey, JsonValue::CreateStringValue(m_id));
+        ::SDKTemplate::UserJsonWriter<wchar_t> writer(buffer);
 
-        // Treating a blank string as null
-        if (m_phone.empty())
-        {
-            jsonObject.SetNamedValue(phoneKey, JsonValue::CreateNullValue());
-        }
-        else
-        {
-            jsonObject.SetNamedValue(phoneKey, JsonValue::CreateStringValue(m_phone));
-        }
-
-        jsonObject.SetNamedValue(nameKey, JsonValue::CreateStringValue(m_name));
-        jsonObject.SetNamedValue(timezoneKey, JsonValue::CreateNumberValue(m_timezone));
-        jsonObject.SetNamedValue(verifiedKey, JsonValue::CreateBooleanValue(m_verified));
-
-        JsonArray jsonArray;
+        // Treating a blank phone as null
+        writer.BeginUser(m_id, m_phone, m_name, m_timezone, m_verified);
         for (SDKTemplate::School school : m_education)
         {
-            jsonArray.Append(school.ToJsonObject());
+            writer.AddSchool(school.Id(), school.Name(), school.Type());
         }
+        writer.EndUser();
 
-        // JsonObject can also be treated as an IMap.
-        jsonObject.Insert(educationKey, jsonArray);
-
-        return jsonObject.Stringify();
+        return hstring(buffer);
     }
 }
@@ -38,13 +38,6 @@ namespace winrt::SDKTemplate::implementation
         hstring Stringify();
 
     private:
-        static constexpr inline wchar_t idKey[] = L"id";
-        static constexpr inline wchar_t phoneKey[] = L"phone";
-        static constexpr inline wchar_t nameKey[] = L"name";
-        static constexpr inline wchar_t educationKey[] = L"education";
-        static constexpr inline wchar_t timezoneKey[] = L"timezone";
-        static constexpr inline wchar_t verifiedKey[] = L"verified";
-
         hstring m_id;
         hstring m_phone;
         hstring m_name;
@@ -0,0 +1,1038 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "UserJson.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+using namespace SDKTemplate;
+
+namespace
+{
+    // Deepest nesting accepted inside values that are skipped.
+    constexpr int MaxSkipDepth = 512;
+
+    // Longest key the models use; longer keys can't match and are skipped without being kept.
+    constexpr size_t MaxKeyLength = 9;
+
+    enum class Key
+    {
+        Unknown,
+        Id,
+        Phone,
+        Name,
+        Timezone,
+        Verified,
+        Education,
+        School,
+        Type,
+        Count
+    };
+
+    Key LookUpKey(wchar_t const* key, size_t length)
+    {
+        std::wstring_view view(key, length);
+        switch (length)
+        {
+        case 2: return (view == L"id") ? Key::Id : Key::Unknown;
+        case 4: return (view == L"name") ? Key::Name : (view == L"type") ? Key::Type : Key::Unknown;
+        case 5: return (view == L"phone") ? Key::Phone : Key::Unknown;
+        case 6: return (view == L"school") ? Key::School : Key::Unknown;
+        case 8: return (view == L"timezone") ? Key::Timezone : (view == L"verified") ? Key::Verified : Key::Unknown;
+        case 9: return (view == L"education") ? Key::Education : Key::Unknown;
+        default: return Key::Unknown;
+        }
+    }
+
+    // Receives the UTF-16 code units of a decoded string.
+    struct StringSink
+    {
+        std::wstring& out;
+
+        template <typename Char>
+        void AppendRun(Char const* begin, Char const* end) { out.append(begin, end); }
+        void Append(wchar_t unit) { out.push_back(unit); }
+    };
+
+    struct KeySink
+    {
+        wchar_t key[MaxKeyLength];
+        size_t length = 0;      // Exceeds MaxKeyLength once the key is too long to match.
+
+        template <typename Char>
+        void AppendRun(Char const* begin, Char const* end)
+        {
+            for (; begin != end; begin++)
+            {
+                Append(static_cast<wchar_t>(*begin));
+            }
+        }
+
+        void Append(wchar_t unit)
+        {
+            if (length < MaxKeyLength)
+            {
+                key[length] = unit;
+            }
+            length++;
+        }
+
+        Key GetKey() const { return (length <= MaxKeyLength) ? LookUpKey(key, length) : Key::Unknown; }
+    };
+
+    // A value of the wrong type or a missing required value. These are only reported once the whole
+    // text has been read, so that syntax errors take precedence as they do with JsonObject::Parse,
+    // and so that a later duplicate key can still replace the offending value.
+    struct SchemaProblem
+    {
+        UserJsonError error = UserJsonError::SchemaMismatch;
+        size_t offset = 0;
+        char const* message = nullptr;
+
+        explicit operator bool() const { return message != nullptr; }
+    };
+
+    // Problems found in one object, by key. The first is reported in the order in which the
+    // JsonObject path looks the keys up.
+    class ObjectProblems
+    {
+    public:
+        SchemaProblem& operator[](Key key) { return m_problems[static_cast<size_t>(key)]; }
+
+        SchemaProblem First() const
+        {
+            for (SchemaProblem const& problem : m_problems)
+            {
+                if (problem)
+                {
+                    return problem;
+                }
+            }
+            return {};
+        }
+
+    private:
+        SchemaProblem m_problems[static_cast<size_t>(Key::Count)];
+    };
+
+    template <typename Char>
+    class Reader
+    {
+    public:
+        Reader(Char const* text, size_t length) :
+            m_begin(text), m_position(text), m_end(text + length)
+        {
+            // Tolerate a byte order mark, which text read from a file often starts with.
+            if constexpr (sizeof(Char) == 1)
+            {
+                if (length >= 3 && memcmp(text, "\xEF\xBB\xBF", 3) == 0)
+                {
+                    m_position += 3;
+                }
+            }
+            else
+            {
+                if (length >= 1 && text[0] == 0xFEFF)
+                {
+                    m_position++;
+                }
+            }
+        }
+
+        // Reads one user object and returns its first schema problem, if any.
+        SchemaProblem ReadUser(UserRecord& user)
+        {
+            user.id.clear();
+            user.phone.clear();
+            user.name.clear();
+            user.timezone = 0.0;
+            user.verified = false;
+
+            if (Peek() != '{')
+            {
+                return SkipMismatchedValue();
+            }
+            m_position++;
+
+            ObjectProblems problems;
+            size_t schoolCount = 0;
+            bool hasPhone = false;
+
+            if (!TryConsume('}'))
+            {
+                do
+                {
+                    Key key = ReadKey();
+                    SchemaProblem& problem = problems[key];
+                    problem = {};
+
+                    switch (key)
+                    {
+                    case Key::Id:
+                        ReadString(user.id, problem);
+                        break;
+
+                    case Key::Phone:
+                        // Treating null as a blank string
+                        if (Peek() == 'n')
+                        {
+                            ReadLiteral("null");
+                            user.phone.clear();
+                        }
+                        else
+                        {
+                            ReadString(user.phone, problem);
+                        }
+                        hasPhone = true;
+                        break;
+
+                    case Key::Name:
+                        ReadString(user.name, problem);
+                        break;
+
+                    case Key::Timezone:
+                        ReadNumber(user.timezone, problem);
+                        break;
+
+                    case Key::Verified:
+                        ReadBoolean(user.verified, problem);
+                        break;
+
+                    case Key::Education:
+                        schoolCount = 0;
+                        if (Peek() != '[')
+                        {
+                            problem = SkipMismatchedValue();
+                            break;
+                        }
+                        m_position++;
+                        if (!TryConsume(']'))
+                        {
+                            do
+                            {
+                                if (schoolCount == user.education.size())
+                                {
+                                    user.education.emplace_back();
+                                }
+
+                                SchemaProblem schoolProblem = ReadSchool(user.education[schoolCount++]);
+                                if (schoolProblem && !problem)
+                                {
+                                    problem = schoolProblem;
+                                }
+                            } while (TryConsume(','));
+                            Expect(']');
+                        }
+                        break;
+
+                    default:
+                        SkipValue(0);
+                        break;
+                    }
+                } while (TryConsume(','));
+                Expect('}');
+            }
+
+            user.education.resize(schoolCount);
+
+            if (!hasPhone)
+            {
+                problems[Key::Phone] = { UserJsonError::JsonValueNotFound, Offset(), "User has no \"phone\" value" };
+            }
+
+            return problems.First();
+        }
+
+        // Reads a JSON array of users and returns the first schema problem, if any.
+        SchemaProblem ReadUsers(std::vector<UserRecord>& users)
+        {
+            if (Peek() != '[')
+            {
+                return SkipMismatchedValue();
+            }
+            m_position++;
+
+            SchemaProblem firstProblem;
+            size_t userCount = 0;
+            if (!TryConsume(']'))
+            {
+                do
+                {
+                    if (userCount == users.size())
+                    {
+                        users.emplace_back();
+                    }
+
+                    SchemaProblem problem = ReadUser(users[userCount++]);
+                    if (problem && !firstProblem)
+                    {
+                        firstProblem = problem;
+                    }
+                } while (TryConsume(','));
+                Expect(']');
+            }
+
+            users.resize(userCount);
+            return firstProblem;
+        }
+
+        // Checks that only whitespace follows the top level value, then reports the schema problem
+        // found while reading it, if any.
+        void Finish(SchemaProblem const& problem)
+        {
+            SkipWhitespace();
+            if (m_position != m_end)
+            {
+                Fail(UserJsonError::InvalidJsonString, "Unexpected text after the JSON value");
+            }
+
+            if (problem)
+            {
+                throw UserJsonException(problem.error, problem.offset, problem.message);
+            }
+        }
+
+    private:
+        [[noreturn]] void Fail(UserJsonError error, char const* message)
+        {
+            throw UserJsonException(error, Offset(), message);
+        }
+
+        size_t Offset() const
+        {
+            return static_cast<size_t>(m_position - m_begin);
+        }
+
+        // Skips a well formed value that has the wrong type for its key.
+        SchemaProblem SkipMismatchedValue()
+        {
+            SchemaProblem problem{ UserJsonError::SchemaMismatch, Offset(), "JSON value has an unexpected type" };
+            SkipValue(0);
+            return problem;
+        }
+
+        void SkipWhitespace()
+        {
+            while (m_position != m_end &&
+                (*m_position == ' ' || *m_position == '\n' || *m_position == '\r' || *m_position == '\t'))
+            {
+                m_position++;
+            }
+        }
+
+        // Returns the next significant character, or 0 at the end of the text.
+        Char Peek()
+        {
+            SkipWhitespace();
+            return (m_position != m_end) ? *m_position : 0;
+        }
+
+        bool TryConsume(char c)
+        {
+            if (Peek() == static_cast<Char>(c))
+            {
+                m_position++;
+                return true;
+            }
+            return false;
+        }
+
+        void Expect(char c)
+        {
+            if (!TryConsume(c))
+            {
+                Fail(UserJsonError::InvalidJsonString, (c == '}') ? "Expected ',' or '}'" : (c == ']') ? "Expected ',' or ']'" : "Expected ':'");
+            }
+        }
+
+        Key ReadKey()
+        {
+            if (Peek() != '"')
+            {
+                Fail(UserJsonError::InvalidJsonString, "Expected a key");
+            }
+
+            KeySink sink;
+            DecodeString(sink);
+            Expect(':');
+            Peek();
+            return sink.GetKey();
+        }
+
+        void ReadString(std::wstring& value, SchemaProblem& problem)
+        {
+            if (Peek() != '"')
+            {
+                problem = SkipMismatchedValue();
+                return;
+            }
+
+            value.clear();
+            StringSink sink{ value };
+            DecodeString(sink);
+        }
+
+        void ReadBoolean(bool& value, SchemaProblem& problem)
+        {
+            switch (Peek())
+            {
+            case 't':
+                ReadLiteral("true");
+                value = true;
+                break;
+            case 'f':
+                ReadLiteral("false");
+                value = false;
+                break;
+            default:
+                problem = SkipMismatchedValue();
+                break;
+            }
+        }
+
+        void ReadNumber(double& value, SchemaProblem& problem)
+        {
+            Char c = Peek();
+            if (c != '-' && (c < '0' || c > '9'))
+            {
+                problem = SkipMismatchedValue();
+                return;
+            }
+            value = ReadNumber();
+        }
+
+        // Reads one education entry and returns its first schema problem, if any.
+        SchemaProblem ReadSchool(SchoolRecord& school)
+        {
+            school.id.clear();
+            school.name.clear();
+            school.type.clear();
+
+            if (Peek() != '{')
+            {
+                return SkipMismatchedValue();
+            }
+            m_position++;
+
+            ObjectProblems problems;
+            bool hasType = false;
+
+            if (!TryConsume('}'))
+            {
+                do
+                {
+                    Key key = ReadKey();
+                    SchemaProblem& problem = problems[key];
+                    problem = {};
+
+                    switch (key)
+                    {
+                    case Key::School:
+                        // A later "school" replaces an earlier one entirely.
+                        school.id.clear();
+                        school.name.clear();
+                        if (Peek() != '{')
+                        {
+                            problem = SkipMismatchedValue();
+                            break;
+                        }
+                        m_position++;
+                        if (!TryConsume('}'))
+                        {
+                            ObjectProblems schoolProblems;
+                            do
+                            {
+                                Key schoolKey = ReadKey();
+                                SchemaProblem& schoolProblem = schoolProblems[schoolKey];
+                                schoolProblem = {};
+
+                                switch (schoolKey)
+                                {
+                                case Key::Id:
+                                    ReadString(school.id, schoolProblem);
+                                    break;
+                                case Key::Name:
+                                    ReadString(school.name, schoolProblem);
+                                    break;
+                                default:
+                                    SkipValue(0);
+                                    break;
+                                }
+                            } while (TryConsume(','));
+                            Expect('}');
+                            problem = schoolProblems.First();
+                        }
+                        break;
+
+                    case Key::Type:
+                        ReadString(school.type, problem);
+                        hasType = true;
+                        break;
+
+                    default:
+                        SkipValue(0);
+                        break;
+                    }
+                } while (TryConsume(','));
+                Expect('}');
+            }
+
+            if (!hasType)
+            {
+                problems[Key::Type] = { UserJsonError::JsonValueNotFound, Offset(), "School has no \"type\" value" };
+            }
+
+            return problems.First();
+        }
+
+        void ReadLiteral(char const* literal)
+        {
+            for (; *literal != '\0'; literal++, m_position++)
+            {
+                if (m_position == m_end || *m_position != static_cast<Char>(*literal))
+                {
+                    Fail(UserJsonError::InvalidJsonString, "Invalid literal");
+                }
+            }
+        }
+
+        // Reads a number, checking it against the JSON grammar, which is stricter than from_chars.
+        double ReadNumber()
+        {
+            Char const* start = m_position;
+
+            // The decimal exponent of the first significant digit, which tells an overflow from an
+            // underflow when from_chars reports that the number is out of range.
+            int64_t leadingExponent = -1;
+            int64_t exponent = 0;
+            bool negativeExponent = false;
+
+            auto isDigit = [this]() { return m_position != m_end && *m_position >= '0' && *m_position <= '9'; };
+            auto skipDigits = [&]()
+            {
+                if (!isDigit())
+                {
+                    Fail(UserJsonError::InvalidJsonNumber, "Expected a digit");
+                }
+                while (isDigit())
+                {
+                    m_position++;
+                }
+            };
+
+            if (*m_position == '-')
+            {
+                m_position++;
+            }
+
+            if (m_position != m_end && *m_position == '0')
+            {
+                m_position++;
+            }
+            else
+            {
+                Char const* digits = m_position;
+                skipDigits();
+                leadingExponent = (m_position - digits) - 1;
+            }
+
+            if (m_position != m_end && *m_position == '.')
+            {
+                m_position++;
+                Char const* digits = m_position;
+                skipDigits();
+                if (leadingExponent < 0)
+                {
+                    Char const* significant = digits;
+                    while (significant != m_position && *significant == '0')
+                    {
+                        significant++;
+                    }
+                    leadingExponent = -((significant - digits) + 1);
+                }
+            }
+
+            if (m_position != m_end && (*m_position == 'e' || *m_position == 'E'))
+            {
+                m_position++;
+                if (m_position != m_end && (*m_position == '+' || *m_position == '-'))
+                {
+                    negativeExponent = (*m_position == '-');
+                    m_position++;
+                }
+                Char const* digits = m_position;
+                skipDigits();
+
+                // Saturate, since anything this large is out of range either way.
+                for (; digits != m_position && exponent < 100000; digits++)
+                {
+                    exponent = exponent * 10 + (*digits - '0');
+                }
+                if (negativeExponent)
+                {
+                    exponent = -exponent;
+                }
+            }
+
+            // from_chars only takes chars. Numbers are short in practice, so the copy stays on the stack.
+            char buffer[64];
+            std::string longNumber;
+            size_t length = static_cast<size_t>(m_position - start);
+            char* digits = buffer;
+            if (length > sizeof(buffer))
+            {
+                longNumber.resize(length);
+                digits = longNumber.data();
+            }
+            for (size_t i = 0; i < length; i++)
+            {
+                digits[i] = static_cast<char>(start[i]);
+            }
+
+            double value = 0.0;
+            auto result = std::from_chars(digits, digits + length, value);
+            if (result.ec == std::errc::result_out_of_range)
+            {
+                // Values too small for a double read as zero; values too large are an error.
+                if (leadingExponent + exponent > 0)
+                {
+                    m_position = start;
+                    Fail(UserJsonError::InvalidJsonNumber, "Number is out of range");
+                }
+                value = (*start == '-') ? -0.0 : 0.0;
+            }
+            else if (result.ec != std::errc() || result.ptr != digits + length)
+            {
+                m_position = start;
+                Fail(UserJsonError::InvalidJsonNumber, "Invalid number");
+            }
+
+            return value;
+        }
+
+        // Decodes the string at the current position, which must be at the opening quote.
+        template <typename Sink>
+        void DecodeString(Sink& sink)
+        {
+            m_position++;
+            for (;;)
+            {
+                // Copy runs of characters that need no decoding in one go.
+                Char const* run = m_position;
+                while (m_position != m_end && IsPlain(*m_position))
+                {
+                    m_position++;
+                }
+                sink.AppendRun(run, m_position);
+
+                if (m_position == m_end)
+                {
+                    Fail(UserJsonError::InvalidJsonString, "Unterminated string");
+                }
+
+                Char c = *m_position;
+                if (c == '"')
+                {
+                    m_position++;
+                    return;
+                }
+                else if (c == '\\')
+                {
+                    DecodeEscape(sink);
+                }
+                else if (static_cast<uint32_t>(c) < 0x20)
+                {
+                    Fail(UserJsonError::InvalidJsonString, "Control character in string");
+                }
+                else
+                {
+                    DecodeMultibyte(sink);
+                }
+            }
+        }
+
+        static bool IsPlain(Char c)
+        {
+            auto unit = static_cast<uint32_t>(static_cast<std::make_unsigned_t<Char>>(c));
+            if constexpr (sizeof(Char) == 1)
+            {
+                return unit >= 0x20 && unit < 0x80 && unit != '"' && unit != '\\';
+            }
+            else
+            {
+                return unit >= 0x20 && unit <= 0xFFFF && unit != '"' && unit != '\\';
+            }
+        }
+
+        template <typename Sink>
+        void DecodeEscape(Sink& sink)
+        {
+            m_position++;
+            if (m_position == m_end)
+            {
+                Fail(UserJsonError::InvalidJsonString, "Unterminated string");
+            }
+
+            switch (*m_position++)
+            {
+            case '"': sink.Append(L'"'); break;
+            case '\\': sink.Append(L'\\'); break;
+            case '/': sink.Append(L'/'); break;
+            case 'b': sink.Append(L'\b'); break;
+            case 'f': sink.Append(L'\f'); break;
+            case 'n': sink.Append(L'\n'); break;
+            case 'r': sink.Append(L'\r'); break;
+            case 't': sink.Append(L'\t'); break;
+            case 'u':
+            {
+                // Surrogates are kept as separate code units, paired or not, as in a UTF-16 string.
+                uint32_t unit = 0;
+                for (int i = 0; i < 4; i++, m_position++)
+                {
+                    uint32_t c = (m_position != m_end) ? static_cast<uint32_t>(*m_position) : 0;
+                    uint32_t digit = (c >= '0' && c <= '9') ? c - '0' : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : 16;
+                    if (digit == 16)
+                    {
+                        Fail(UserJsonError::InvalidJsonString, "Invalid \\u escape");
+                    }
+                    unit = (unit << 4) | digit;
+                }
+                sink.Append(static_cast<wchar_t>(unit));
+                break;
+            }
+            default:
+                m_position--;
+                Fail(UserJsonError::InvalidJsonString, "Invalid escape");
+            }
+        }
+
+        // Decodes a UTF-8 sequence into UTF-16. UTF-16 text only gets here for code units that don't
+        // fit in 16 bits, which are not valid.
+        template <typename Sink>
+        void DecodeMultibyte(Sink& sink)
+        {
+            if constexpr (sizeof(Char) == 1)
+            {
+                auto byteAt = [this](size_t i) -> uint32_t
+                {
+                    return (static_cast<size_t>(m_end - m_position) > i) ? static_cast<uint8_t>(m_position[i]) : 0;
+                };
+
+                uint32_t lead = byteAt(0);
+                uint32_t codePoint;
+                size_t length;
+                uint32_t low = 0x80;        // Range of the second byte, narrower after some lead bytes
+                uint32_t high = 0xBF;       // to rule out overlong forms, surrogates and values past U+10FFFF.
+
+                if (lead >= 0xC2 && lead <= 0xDF) { length = 2; codePoint = lead & 0x1F; }
+                else if (lead >= 0xE0 && lead <= 0xEF) { length = 3; codePoint = lead & 0x0F; low = (lead == 0xE0) ? 0xA0 : 0x80; high = (lead == 0xED) ? 0x9F : 0xBF; }
+                else if (lead >= 0xF0 && lead <= 0xF4) { length = 4; codePoint = lead & 0x07; low = (lead == 0xF0) ? 0x90 : 0x80; high = (lead == 0xF4) ? 0x8F : 0xBF; }
+                else
+                {
+                    Fail(UserJsonError::InvalidJsonString, "Invalid UTF-8");
+                }
+
+                for (size_t i = 1; i < length; i++)
+                {
+                    uint32_t next = byteAt(i);
+                    if (next < ((i == 1) ? low : 0x80) || next > ((i == 1) ? high : 0xBF))
+                    {
+                        Fail(UserJsonError::InvalidJsonString, "Invalid UTF-8");
+                    }
+                    codePoint = (codePoint << 6) | (next & 0x3F);
+                }
+                m_position += length;
+
+                if (codePoint >= 0x10000)
+                {
+                    codePoint -= 0x10000;
+                    sink.Append(static_cast<wchar_t>(0xD800 + (codePoint >> 10)));
+                    sink.Append(static_cast<wchar_t>(0xDC00 + (codePoint & 0x3FF)));
+                }
+                else
+                {
+                    sink.Append(static_cast<wchar_t>(codePoint));
+                }
+            }
+            else
+            {
+                Fail(UserJsonError::InvalidJsonString, "Invalid UTF-16 code unit");
+            }
+        }
+
+        // Skips a value of any type after checking that it is well formed.
+        void SkipValue(int depth)
+        {
+            if (depth >= MaxSkipDepth)
+            {
+                Fail(UserJsonError::ImplementationLimit, "JSON is nested too deeply");
+            }
+
+            switch (Peek())
+            {
+            case '{':
+                m_position++;
+                if (!TryConsume('}'))
+                {
+                    do
+                    {
+                        ReadKey();
+                        SkipValue(depth + 1);
+                    } while (TryConsume(','));
+                    Expect('}');
+                }
+                break;
+
+            case '[':
+                m_position++;
+                if (!TryConsume(']'))
+                {
+                    do
+                    {
+                        SkipValue(depth + 1);
+                    } while (TryConsume(','));
+                    Expect(']');
+                }
+                break;
+
+            case '"':
+            {
+                KeySink sink;
+                DecodeString(sink);
+                break;
+            }
+
+            case 't': ReadLiteral("true"); break;
+            case 'f': ReadLiteral("false"); break;
+            case 'n': ReadLiteral("null"); break;
+
+            case '-': case '0': case '1': case '2': case '3': case '4': case '5': case '6': case '7': case '8': case '9':
+                ReadNumber();
+                break;
+
+            default:
+                Fail(UserJsonError::InvalidJsonString, "Expected a JSON value");
+            }
+        }
+
+        Char const* m_begin;
+        Char const* m_position;
+        Char const* m_end;
+    };
+}
+
+void SDKTemplate::ReadUser(std::string_view text, UserRecord& user)
+{
+    Reader<char> reader(text.data(), text.size());
+    reader.Finish(reader.ReadUser(user));
+}
+
+void SDKTemplate::ReadUser(std::wstring_view text, UserRecord& user)
+{
+    Reader<wchar_t> reader(text.data(), text.size());
+    reader.Finish(reader.ReadUser(user));
+}
+
+void SDKTemplate::ReadUsers(std::string_view text, std::vector<UserRecord>& users)
+{
+    Reader<char> reader(text.data(), text.size());
+    reader.Finish(reader.ReadUsers(users));
+}
+
+void SDKTemplate::ReadUsers(std::wstring_view text, std::vector<UserRecord>& users)
+{
+    Reader<wchar_t> reader(text.data(), text.size());
+    reader.Finish(reader.ReadUsers(users));
+}
+
+template <typename Char>
+void UserJsonWriter<Char>::BeginUsers()
+{
+    m_out.push_back('[');
+    m_firstUser = true;
+}
+
+template <typename Char>
+void UserJsonWriter<Char>::EndUsers()
+{
+    m_out.push_back(']');
+}
+
+template <typename Char>
+void UserJsonWriter<Char>::BeginUser(std::wstring_view id, std::wstring_view phone, std::wstring_view name, double timezone, bool verified)
+{
+    if (!std::isfinite(timezone))
+    {
+        throw std::invalid_argument("Timezone must be a finite number");
+    }
+
+    if (!m_firstUser)
+    {
+        m_out.push_back(',');
+    }
+    m_firstUser = false;
+    m_firstSchool = true;
+
+    WriteAscii("{\"id\":");
+    WriteString(id);
+
+    // Treating a blank string as null
+    WriteAscii(",\"phone\":");
+    if (phone.empty())
+    {
+        WriteAscii("null");
+    }
+    else
+    {
+        WriteString(phone);
+    }
+
+    WriteAscii(",\"name\":");
+    WriteString(name);
+
+    // Shortest form that reads back as the same double.
+    char number[32];
+    auto result = std::to_chars(number, number + sizeof(number) - 1, timezone);
+    *result.ptr = '\0';
+    WriteAscii(",\"timezone\":");
+    WriteAscii(number);
+
+    WriteAscii(",\"verified\":");
+    WriteAscii(verified ? "true" : "false");
+
+    WriteAscii(",\"education\":[");
+}
+
+template <typename Char>
+void UserJsonWriter<Char>::AddSchool(std::wstring_view id, std::wstring_view name, std::wstring_view type)
+{
+    if (!m_firstSchool)
+    {
+        m_out.push_back(',');
+    }
+    m_firstSchool = false;
+
+    WriteAscii("{\"school\":{\"id\":");
+    WriteString(id);
+    WriteAscii(",\"name\":");
+    WriteString(name);
+    WriteAscii("},\"type\":");
+    WriteString(type);
+    m_out.push_back('}');
+}
+
+template <typename Char>
+void UserJsonWriter<Char>::EndUser()
+{
+    WriteAscii("]}");
+}
+
+template <typename Char>
+void UserJsonWriter<Char>::WriteUser(UserRecord const& user)
+{
+    BeginUser(user.id, user.phone, user.name, user.timezone, user.verified);
+    for (SchoolRecord const& school : user.education)
+    {
+        AddSchool(school.id, school.name, school.type);
+    }
+    EndUser();
+}
+
+template <typename Char>
+void UserJsonWriter<Char>::WriteAscii(char const* text)
+{
+    m_out.append(text, text + strlen(text));
+}
+
+template <typename Char>
+void UserJsonWriter<Char>::WriteString(std::wstring_view value)
+{
+    static constexpr char hexDigits[] = "0123456789abcdef";
+
+    m_out.push_back('"');
+    size_t length = value.size();
+    for (size_t i = 0; i < length; i++)
+    {
+        uint32_t unit = static_cast<uint32_t>(value[i]) & 0xFFFF;
+
+        // Plain ASCII is by far the most common case.
+        if (unit >= 0x20 && unit < 0x80 && unit != '"' && unit != '\\')
+        {
+            m_out.push_back(static_cast<Char>(unit));
+            continue;
+        }
+
+        uint32_t trail = (i + 1 < length) ? (static_cast<uint32_t>(value[i + 1]) & 0xFFFF) : 0;
+        bool isPair = (unit >= 0xD800 && unit <= 0xDBFF && trail >= 0xDC00 && trail <= 0xDFFF);
+
+        switch (unit)
+        {
+        case '"': WriteAscii("\\\""); break;
+        case '\\': WriteAscii("\\\\"); break;
+        case '\b': WriteAscii("\\b"); break;
+        case '\f': WriteAscii("\\f"); break;
+        case '\n': WriteAscii("\\n"); break;
+        case '\r': WriteAscii("\\r"); break;
+        case '\t': WriteAscii("\\t"); break;
+        default:
+            if (unit < 0x20 || (unit >= 0xD800 && unit <= 0xDFFF && !isPair))
+            {
+                char escape[] = { '\\', 'u', hexDigits[unit >> 12], hexDigits[(unit >> 8) & 0xF], hexDigits[(unit >> 4) & 0xF], hexDigits[unit & 0xF], '\0' };
+                WriteAscii(escape);
+            }
+            else if constexpr (sizeof(Char) == 1)
+            {
+                uint32_t codePoint = unit;
+                if (isPair)
+                {
+                    codePoint = 0x10000 + ((unit - 0xD800) << 10) + (trail - 0xDC00);
+                    i++;
+                }
+
+                if (codePoint < 0x800)
+                {
+                    m_out.push_back(static_cast<Char>(0xC0 | (codePoint >> 6)));
+                }
+                else if (codePoint < 0x10000)
+                {
+                    m_out.push_back(static_cast<Char>(0xE0 | (codePoint >> 12)));
+                    m_out.push_back(static_cast<Char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                }
+                else
+                {
+                    m_out.push_back(static_cast<Char>(0xF0 | (codePoint >> 18)));
+                    m_out.push_back(static_cast<Char>(0x80 | ((codePoint >> 12) & 0x3F)));
+                    m_out.push_back(static_cast<Char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                }
+                m_out.push_back(static_cast<Char>(0x80 | (codePoint & 0x3F)));
+            }
+            else
+            {
+                m_out.push_back(static_cast<Char>(unit));
+                if (isPair)
+                {
+                    m_out.push_back(static_cast<Char>(trail));
+                    i++;
+                }
+            }
+            break;
+        }
+    }
+    m_out.push_back('"');
+}
+
+template class SDKTemplate::UserJsonWriter<char>;
+template class SDKTemplate::UserJsonWriter<wchar_t>;
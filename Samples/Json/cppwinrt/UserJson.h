@@ -0,0 +1,122 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+// Reads and writes the JSON form of User and School without building a JsonObject DOM. The reader
+// makes a single pass over UTF-8 or UTF-16 text and dispatches on each key as it is read; the writer
+// appends to a caller-owned buffer. Records and buffers keep their capacity between documents, so
+// once they have grown, reading and writing documents of a similar shape doesn't allocate. This file
+// only depends on the C++ standard library.
+//
+// The reader accepts the same documents as the JsonObject path in User.cpp and School.cpp: missing
+// optional keys take their default value, "phone" may be null but must be present, every education
+// entry needs a "type", unknown keys are skipped and the last of duplicate keys wins. Syntax errors
+// take precedence over values of the wrong type or missing values, which are only reported once the
+// whole text has been read.
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace SDKTemplate
+{
+    struct SchoolRecord
+    {
+        std::wstring id;
+        std::wstring name;
+        std::wstring type;
+    };
+
+    struct UserRecord
+    {
+        std::wstring id;
+        std::wstring phone;     // Empty when the JSON value is null.
+        std::wstring name;
+        double timezone = 0.0;
+        bool verified = false;
+        std::vector<SchoolRecord> education;
+    };
+
+    // Matches Windows::Data::Json::JsonErrorStatus, plus the type mismatches that the JsonObject
+    // path reports as E_ILLEGAL_METHOD_CALL.
+    enum class UserJsonError
+    {
+        InvalidJsonString,
+        InvalidJsonNumber,
+        JsonValueNotFound,
+        ImplementationLimit,
+        SchemaMismatch,
+    };
+
+    class UserJsonException : public std::runtime_error
+    {
+    public:
+        UserJsonException(UserJsonError error, size_t offset, char const* message) :
+            std::runtime_error(message), m_error(error), m_offset(offset)
+        {
+        }
+
+        UserJsonError Error() const { return m_error; }
+
+        // Position of the problem, in code units from the start of the text.
+        size_t Offset() const { return m_offset; }
+
+    private:
+        UserJsonError m_error;
+        size_t m_offset;
+    };
+
+    // Text is UTF-8 for std::string_view and UTF-16 for std::wstring_view. All errors throw
+    // UserJsonException, and the record is left partly filled in.
+    void ReadUser(std::string_view text, UserRecord& user);
+    void ReadUser(std::wstring_view text, UserRecord& user);
+
+    // Reads a JSON array of users.
+    void ReadUsers(std::string_view text, std::vector<UserRecord>& users);
+    void ReadUsers(std::wstring_view text, std::vector<UserRecord>& users);
+
+    // Appends JSON to out, as UTF-8 for std::string and UTF-16 for std::wstring. Strings are taken as
+    // views so that callers can write straight from their own storage. A user is written either with
+    // WriteUser, or with BeginUser, one AddSchool per education entry and EndUser. Lone surrogates
+    // are escaped, so the output is always well formed.
+    template <typename Char>
+    class UserJsonWriter
+    {
+    public:
+        explicit UserJsonWriter(std::basic_string<Char>& out) : m_out(out) {}
+
+        // Brackets a JSON array of users.
+        void BeginUsers();
+        void EndUsers();
+
+        // An empty phone is written as null. Throws std::invalid_argument if timezone is not finite,
+        // since JSON has no representation for it.
+        void BeginUser(std::wstring_view id, std::wstring_view phone, std::wstring_view name, double timezone, bool verified);
+        void AddSchool(std::wstring_view id, std::wstring_view name, std::wstring_view type);
+        void EndUser();
+
+        void WriteUser(UserRecord const& user);
+
+    private:
+        void WriteString(std::wstring_view value);
+        void WriteAscii(char const* text);
+
+        std::basic_string<Char>& m_out;
+        bool m_firstUser = true;
+        bool m_firstSchool = true;
+    };
+
+    extern template class UserJsonWriter<char>;
+    extern template class UserJsonWriter<wchar_t>;
+}
@@ -0,0 +1,102 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "LatencyHistogram.h"
+
+using namespace SDKTemplate;
+
+LatencyHistogram::LatencyHistogram()
+{
+    Reset();
+}
+
+void LatencyHistogram::Record(uint64_t microseconds)
+{
+    uint64_t bucket = microseconds / BucketWidthMicroseconds;
+    if (bucket < BucketCount)
+    {
+        buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        overflow.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Only the recording thread writes the maximum, so a plain compare is enough.
+    if (microseconds > maximum.load(std::memory_order_relaxed))
+    {
+        maximum.store(microseconds, std::memory_order_relaxed);
+    }
+
+    count.fetch_add(1, std::memory_order_release);
+}
+
+void LatencyHistogram::Reset()
+{
+    for (auto& bucket : buckets)
+    {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+
+    overflow.store(0, std::memory_order_relaxed);
+    maximum.store(0, std::memory_order_relaxed);
+    count.store(0, std::memory_order_release);
+}
+
+uint64_t LatencyHistogram::GetSampleCount() const
+{
+    return count.load(std::memory_order_acquire);
+}
+
+uint64_t LatencyHistogram::GetMaximum() const
+{
+    return maximum.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::GetOverflowCount() const
+{
+    return overflow.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::GetBucketCount(uint32_t bucket) const
+{
+    return (bucket < BucketCount) ? buckets[bucket].load(std::memory_order_relaxed) : 0;
+}
+
+uint64_t LatencyHistogram::GetPercentile(double percentile) const
+{
+    uint64_t total = GetSampleCount();
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    // Rank of the sample at the requested percentile, rounded up so that 100 selects the last one.
+    double clamped = (percentile < 0.0) ? 0.0 : (percentile > 100.0) ? 100.0 : percentile;
+    uint64_t rank = static_cast<uint64_t>(clamped / 100.0 * static_cast<double>(total) + 0.999999);
+    if (rank == 0)
+    {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < BucketCount; i++)
+    {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+        {
+            return static_cast<uint64_t>(i + 1) * BucketWidthMicroseconds;
+        }
+    }
+
+    return GetMaximum();
+}
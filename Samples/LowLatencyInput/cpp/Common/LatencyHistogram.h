@@ -0,0 +1,50 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace SDKTemplate
+{
+    // Fixed-size histogram of latencies in microseconds. Samples are recorded by a single thread
+    // (the render loop) and can be queried from any thread; queries taken while samples are being
+    // recorded may be off by the samples in flight.
+    class LatencyHistogram
+    {
+    public:
+        // Buckets are 250us wide and cover 0 to 100ms; larger samples go into an overflow bucket.
+        static const uint32_t BucketWidthMicroseconds = 250;
+        static const uint32_t BucketCount = 400;
+
+        LatencyHistogram();
+
+        void Record(uint64_t microseconds);
+        void Reset();
+
+        uint64_t GetSampleCount() const;
+        uint64_t GetMaximum() const;
+        uint64_t GetOverflowCount() const;
+        uint64_t GetBucketCount(uint32_t bucket) const;
+
+        // Returns the upper edge, in microseconds, of the bucket containing the given percentile
+        // (0 to 100), or 0 if no samples were recorded. Samples in the overflow bucket report the
+        // largest recorded value.
+        uint64_t GetPercentile(double percentile) const;
+
+    private:
+        std::atomic<uint64_t> buckets[BucketCount];
+        std::atomic<uint64_t> overflow;
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> maximum;
+    };
+}
@@ -0,0 +1,92 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace SDKTemplate
+{
+    // Latest-value channel between one writer thread and one reader thread.
+    //
+    // The writer fills GetWriteBuffer() and calls Publish(); the reader calls Update() and then
+    // reads GetReadBuffer(). Three buffers rotate through a single atomic index, so neither side
+    // ever waits for the other: the writer can publish any number of times between reads and the
+    // reader always sees the most recently published value. Publishing hands the write buffer to
+    // the reader, so the writer must write a complete value each time.
+    template <typename T>
+    class TripleBuffer
+    {
+    public:
+        TripleBuffer() :
+            writeIndex(0),
+            shared(1),
+            readIndex(2)
+        {
+        }
+
+        TripleBuffer(const TripleBuffer&) = delete;
+        TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+        // Writer side.
+        T& GetWriteBuffer()
+        {
+            return buffers[writeIndex];
+        }
+
+        // Makes the write buffer visible to the reader. Returns true if the previously published
+        // value was replaced before the reader picked it up.
+        bool Publish()
+        {
+            uint8_t previous = shared.exchange(writeIndex | dirtyFlag, std::memory_order_acq_rel);
+            writeIndex = previous & indexMask;
+            return (previous & dirtyFlag) != 0;
+        }
+
+        // Returns true if the last published value has not been picked up by the reader yet.
+        // Either side may call this, but the answer can change immediately afterwards.
+        bool HasUnreadValue() const
+        {
+            return (shared.load(std::memory_order_relaxed) & dirtyFlag) != 0;
+        }
+
+        // Reader side. Returns true if a new value was published since the last call.
+        bool Update()
+        {
+            if ((shared.load(std::memory_order_relaxed) & dirtyFlag) == 0)
+            {
+                return false;
+            }
+
+            uint8_t previous = shared.exchange(readIndex, std::memory_order_acq_rel);
+            readIndex = previous & indexMask;
+            return true;
+        }
+
+        const T& GetReadBuffer() const
+        {
+            return buffers[readIndex];
+        }
+
+    private:
+        static const uint8_t indexMask = 0x3;
+        static const uint8_t dirtyFlag = 0x4;
+
+        T buffers[3];
+
+        // Each index is only touched by its own thread; shared holds the index of the middle
+        // buffer plus a flag marking it as not yet read.
+        uint8_t writeIndex;
+        std::atomic<uint8_t> shared;
+        uint8_t readIndex;
+    };
+}
@@ -22,18 +22,27 @@ using namespace Windows::Foundation;
 using namespace Windows::Foundation::Collections;
 using namespace Windows::UI::Input;
 using namespace Microsoft::WRL;
+using namespace Concurrency;
 
 // Initialization.
 RectRenderer::RectRenderer(const std::shared_ptr<DX::DeviceResources>& deviceResources) :
     deviceResources(deviceResources),
     rect(),
-    rectTransform()
+    inputState(),
+    lastPresentedSequence(0)
 {
     CreateDeviceDependentResources();
 
-    //Initialize start position and rect size
-    rectTransform = D2D1::Matrix3x2F::Identity();
-    rectSize = bigRectSize;
+    //Initialize start position, rect size and color
+    inputState.transform = D2D1::Matrix3x2F::Identity();
+    inputState.size = bigRectSize;
+    inputState.color = D2D1::ColorF(D2D1::ColorF::LightSlateGray);
+    inputState.sequence = 0;
+    inputState.inputTime = std::chrono::steady_clock::now();
+
+    // Hand the initial state to the render loop. Sequence 0 is never counted as input.
+    stateChannel.GetWriteBuffer() = inputState;
+    stateChannel.Publish();
 }
 
 void RectRenderer::CreateDeviceDependentResources()
@@ -59,13 +68,19 @@ void RectRenderer::Render()
 {
     ComPtr<ID2D1DeviceContext1> deviceContext = deviceResources->GetD2DDeviceContext();
 
+    // Pick up the latest input snapshot, if any; otherwise redraw the previous one.
+    stateChannel.Update();
+    const RectState& state = stateChannel.GetReadBuffer();
+
+    brush->SetColor(state.color);
+
     deviceContext->BeginDraw();
 
     // Rotate the rendered scene based on the current orientation of the device and rotation of the rect
-    deviceContext->SetTransform(rectTransform * deviceResources->GetOrientationTransform2D());
+    deviceContext->SetTransform(state.transform * deviceResources->GetOrientationTransform2D());
 
     // Draw the rect at its current position.
-    rect = D2D1::RectF(0, 0, rectSize, rectSize);
+    rect = D2D1::RectF(0, 0, state.size, state.size);
     deviceContext->FillRectangle(rect, brush.Get());
 
     // Restore the transform to nothing.
@@ -90,12 +105,21 @@ void RectRenderer::UpdateRectTransform(Point newPosition, Windows::UI::Input::Ma
         D2D1::Matrix3x2F::Rotation(delta.Rotation, center) *
         D2D1::Matrix3x2F::Translation(delta.Translation.X, delta.Translation.Y);
 
-    rectTransform = rectTransform * deltaTransform;
+    critical_section::scoped_lock lock(inputLock);
+    inputState.transform = inputState.transform * deltaTransform;
+    PublishState();
 }
 
 bool RectRenderer::HitTest(Point position)
 {
-    D2D1::Matrix3x2F localInverseTransform = rectTransform;
+    D2D1::Matrix3x2F localInverseTransform;
+    float rectSize;
+    {
+        critical_section::scoped_lock lock(inputLock);
+        localInverseTransform = inputState.transform;
+        rectSize = inputState.size;
+    }
+
     if (D2D1InvertMatrix(&localInverseTransform))
     {
         // "Untransform" (x, y) from parent coordinate system to object's initial principal axes coordinate system.
@@ -112,15 +136,51 @@ bool RectRenderer::HitTest(Point position)
 
 void RectRenderer::SetRectSize(float newSize)
 {
-    rectSize = newSize;
+    critical_section::scoped_lock lock(inputLock);
+    inputState.size = newSize;
+    PublishState();
 }
 
 void RectRenderer::ResetRect()
 {
-    rectTransform = D2D1::Matrix3x2F::Identity() * D2D1::Matrix3x2F::Translation(0, 0);
+    critical_section::scoped_lock lock(inputLock);
+    inputState.transform = D2D1::Matrix3x2F::Identity() * D2D1::Matrix3x2F::Translation(0, 0);
+    PublishState();
 }
 
 void RectRenderer::SetBrushColor(D2D1::ColorF color)
 {
-    brush->SetColor(color);
+    critical_section::scoped_lock lock(inputLock);
+    inputState.color = color;
+    PublishState();
+}
+
+// Hands a copy of the input-side state to the render loop. Must be called with inputLock held,
+// which makes the input handlers a single writer as far as the triple buffer is concerned.
+void RectRenderer::PublishState()
+{
+    // If the render loop hasn't picked up the previous snapshot yet, this input will be presented
+    // together with it, so latency is measured from the older input. The render loop may take
+    // the snapshot right after this check, which can only make the measurement more conservative.
+    if (!stateChannel.HasUnreadValue())
+    {
+        inputState.inputTime = std::chrono::steady_clock::now();
+    }
+
+    inputState.sequence++;
+    stateChannel.GetWriteBuffer() = inputState;
+    stateChannel.Publish();
+}
+
+void RectRenderer::OnFramePresented()
+{
+    const RectState& state = stateChannel.GetReadBuffer();
+    if (state.sequence != lastPresentedSequence)
+    {
+        lastPresentedSequence = state.sequence;
+
+        auto latency = std::chrono::steady_clock::now() - state.inputTime;
+        latencyHistogram.Record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(latency).count()));
+    }
 }
\ No newline at end of file
@@ -13,10 +13,31 @@
 
 #include "..\Common\DeviceResources.h"
 #include "..\Common\Constants.h"
+#include "..\Common\LatencyHistogram.h"
+#include "..\Common\TripleBuffer.h"
 
 namespace SDKTemplate
 {
+    // Everything the render loop needs to draw the rect, published as one snapshot by the input threads.
+    struct RectState
+    {
+        D2D1::Matrix3x2F transform;
+        float size;
+        D2D1_COLOR_F color;
+
+        // Incremented on every publish so the render loop can tell new input from a repeated frame.
+        uint64_t sequence;
+
+        // When the oldest input that contributed to this snapshot was published.
+        std::chrono::steady_clock::time_point inputTime;
+    };
+
     // This sample renderer instantiates a basic rendering pipeline.
+    //
+    // Input handlers (UpdateRectTransform, HitTest, SetRectSize, ResetRect, SetBrushColor) run on the
+    // independent input thread and the UI thread. They update an input-side copy of the rect and publish
+    // a snapshot through a triple buffer; Render picks up the latest snapshot without waiting, so the
+    // render loop and the input threads never block each other.
     class RectRenderer
     {
 
@@ -31,7 +52,13 @@ namespace SDKTemplate
         void ResetRect();
         void SetBrushColor(D2D1::ColorF newColor);
 
+        // Called by the render loop after Present to record input-to-present latency.
+        void OnFramePresented();
+        const LatencyHistogram& GetLatencyHistogram() const { return latencyHistogram; }
+
     private:
+        void PublishState();
+
         // Cached pointer to device resources.
         std::shared_ptr<DX::DeviceResources> deviceResources;
 
@@ -41,11 +68,17 @@ namespace SDKTemplate
         // The rect to be drawn.
         D2D1_RECT_F rect;
 
-        //The rect's width/height
-        float rectSize;
+        // Input-side state of the rect. Only the input handlers touch these, serialized by inputLock,
+        // which is never taken by the render loop.
+        Concurrency::critical_section inputLock;
+        RectState inputState;
+
+        // Latest snapshot handed from the input handlers to the render loop.
+        TripleBuffer<RectState> stateChannel;
 
-        //Maintains the transform of the rect
-        D2D1::Matrix3x2F rectTransform;
+        // Render-loop-only latency bookkeeping.
+        LatencyHistogram latencyHistogram;
+        uint64_t lastPresentedSequence;
     };
 }
 
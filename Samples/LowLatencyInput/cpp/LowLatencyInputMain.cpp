@@ -57,6 +57,7 @@ void LowLatencyInputMain::StartRenderLoop()
             deviceResources->WaitOnSwapChain();
             Render();
             deviceResources->Present();
+            sceneRenderer->OnFramePresented();
         }
     });
 
@@ -102,6 +103,10 @@ void LowLatencyInputMain::OnDeviceRestored()
     sceneRenderer->CreateDeviceDependentResources();
 }
 
+// The input handlers below may be called from the input and UI threads while the render loop is running.
+// They don't take criticalSection; the renderer hands their updates to the render loop through a
+// triple buffer, so they never wait for a frame to finish.
+
 //Passes rect data to renderer class to transform rect
 void LowLatencyInputMain::UpdateRectTransform(Point newPosition, Windows::UI::Input::ManipulationDelta delta)
 {
@@ -35,6 +35,7 @@ namespace SDKTemplate
         void SetBrushColor(D2D1::ColorF color);
         void ResetRect();
         bool HitTest( Windows::Foundation::Point position);
+        const LatencyHistogram& GetLatencyHistogram() const { return sceneRenderer->GetLatencyHistogram(); }
 
     private:
         void Render();
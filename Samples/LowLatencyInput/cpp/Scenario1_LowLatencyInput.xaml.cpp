@@ -228,6 +228,19 @@ void Scenario1_LowLatencyInput::OnManipulationCompleted(GestureRecognizer^,  Man
 {
     //Handle logic you want to occur when the manipulation completes here
     main->SetBrushColor(D2D1::ColorF::LightSlateGray);
+
+    // Report the input-to-present latency measured by the render loop so far.
+    const LatencyHistogram& latency = main->GetLatencyHistogram();
+    if (latency.GetSampleCount() > 0)
+    {
+        std::wostringstream message;
+        message << L"Input-to-present latency over " << latency.GetSampleCount() << L" frames: "
+            << L"p50 " << latency.GetPercentile(50) / 1000.0 << L" ms, "
+            << L"p95 " << latency.GetPercentile(95) / 1000.0 << L" ms, "
+            << L"p99 " << latency.GetPercentile(99) / 1000.0 << L" ms, "
+            << L"max " << latency.GetMaximum() / 1000.0 << L" ms";
+        rootPage->NotifyUser(ref new String(message.str().c_str()), NotifyType::StatusMessage);
+    }
 }
 
 ManipulationProcessor::ManipulationProcessor(Windows::UI::Input::GestureRecognizer^ gestureRecognizer, Windows::UI::Xaml::Controls::Border^ target, Windows::UI::Xaml::UIElement^ referenceFrame)
@@ -29,7 +29,9 @@
 #include <wincodec.h>
 #include <DirectXColors.h>
 #include <DirectXMath.h>
+#include <chrono>
 #include <memory>
+#include <sstream>
 #include <agile.h>
 #include <concrt.h>
 
@@ -871,3 +871,75 @@ task<void> BasicLoader::LoadMeshAsync(
             );
     });
 }
+
+void BasicLoader::CreateTextureFromMemory(
+    _In_ Platform::String^ filename,
+    _In_reads_bytes_(dataSize) byte* data,
+    _In_ uint32 dataSize,
+    _Out_opt_ ID3D11Texture2D** texture,
+    _Out_opt_ ID3D11ShaderResourceView** textureView
+    )
+{
+    CreateTexture(
+        GetExtension(filename) == "dds",
+        data,
+        dataSize,
+        texture,
+        textureView,
+        filename
+        );
+}
+
+void BasicLoader::CreateShaderFromMemory(
+    _In_ Platform::String^ filename,
+    _In_reads_bytes_(bytecodeSize) byte* bytecode,
+    _In_ uint32 bytecodeSize,
+    _In_reads_opt_(layoutDescNumElements) D3D11_INPUT_ELEMENT_DESC layoutDesc[],
+    _In_ uint32 layoutDescNumElements,
+    _Out_ ID3D11VertexShader** shader,
+    _Out_opt_ ID3D11InputLayout** layout
+    )
+{
+    DX::ThrowIfFailed(
+        m_d3dDevice->CreateVertexShader(
+            bytecode,
+            bytecodeSize,
+            nullptr,
+            shader
+            )
+        );
+
+    SetDebugName(*shader, filename);
+
+    if (layout != nullptr)
+    {
+        CreateInputLayout(
+            bytecode,
+            bytecodeSize,
+            layoutDesc,
+            layoutDescNumElements,
+            layout
+            );
+
+        SetDebugName(*layout, filename);
+    }
+}
+
+void BasicLoader::CreateShaderFromMemory(
+    _In_ Platform::String^ filename,
+    _In_reads_bytes_(bytecodeSize) byte* bytecode,
+    _In_ uint32 bytecodeSize,
+    _Out_ ID3D11PixelShader** shader
+    )
+{
+    DX::ThrowIfFailed(
+        m_d3dDevice->CreatePixelShader(
+            bytecode,
+            bytecodeSize,
+            nullptr,
+            shader
+            )
+        );
+
+    SetDebugName(*shader, filename);
+}
@@ -133,6 +133,33 @@ internal:
         _Out_opt_ uint32* indexCount
         );
 
+    // Create resources from file contents that are already in memory, e.g. read by an
+    // AssetPipeline worker.  The filename selects the texture decoder and names the objects.
+    void CreateTextureFromMemory(
+        _In_ Platform::String^ filename,
+        _In_reads_bytes_(dataSize) byte* data,
+        _In_ uint32 dataSize,
+        _Out_opt_ ID3D11Texture2D** texture,
+        _Out_opt_ ID3D11ShaderResourceView** textureView
+        );
+
+    void CreateShaderFromMemory(
+        _In_ Platform::String^ filename,
+        _In_reads_bytes_(bytecodeSize) byte* bytecode,
+        _In_ uint32 bytecodeSize,
+        _In_reads_opt_(layoutDescNumElements) D3D11_INPUT_ELEMENT_DESC layoutDesc[],
+        _In_ uint32 layoutDescNumElements,
+        _Out_ ID3D11VertexShader** shader,
+        _Out_opt_ ID3D11InputLayout** layout
+        );
+
+    void CreateShaderFromMemory(
+        _In_ Platform::String^ filename,
+        _In_reads_bytes_(bytecodeSize) byte* bytecode,
+        _In_ uint32 bytecodeSize,
+        _Out_ ID3D11PixelShader** shader
+        );
+
 private:
     Microsoft::WRL::ComPtr<ID3D11Device> m_d3dDevice;
     Microsoft::WRL::ComPtr<IWICImagingFactory2> m_wicFactory;
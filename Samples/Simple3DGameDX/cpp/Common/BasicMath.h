@@ -172,7 +172,7 @@ T dot(Vector3<T> a, Vector3<T> b)
 template <class T>
 T dot(Vector4<T> a, Vector4<T> b)
 {
-    return a.x * b.x + a.y * b.y + a.z * b.z + a.w + b.w;
+    return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
 }
 
 template <class T>
@@ -357,7 +357,7 @@ Matrix4x4<T> transpose(Matrix4x4<T> m)
 {
     return Matrix4x4<T>(
         m._11, m._21, m._31, m._41,
-        m_.12, m._22, m._32, m._42,
+        m._12, m._22, m._32, m._42,
         m._13, m._23, m._33, m._43,
         m._14, m._24, m._34, m._44
         );
@@ -0,0 +1,908 @@
+//// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+//// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+//// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+//// PARTICULAR PURPOSE.
+////
+//// Copyright (c) Microsoft Corporation. All rights reserved
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "BasicMathBatch.h"
+
+#include <atomic>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define BASICMATH_BATCH_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define BASICMATH_TARGET_AVX2
+#else
+#define BASICMATH_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace
+{
+    const size_t PackSize = 8;
+
+    // Each path provides the pack operations and the array operations.  The
+    // array operations read and write the arrays directly so that the change
+    // between array and pack layout happens in registers.  translate selects
+    // between transforming points and directions.
+    struct BatchKernels
+    {
+        void (*transform3)(const float4x4& m, bool translate, const float3x8& in, float3x8& out);
+        void (*transform4)(const float4x4& m, const float4x8& in, float4x8& out);
+        void (*normalize3)(const float3x8& in, float3x8& out);
+        void (*dot3)(const float3x8& a, const float3x8& b, float* out);
+        void (*cross3)(const float3x8& a, const float3x8& b, float3x8& out);
+        void (*mul4x4)(const float4x4& a, const float4x4& b, float4x4& out);
+
+        void (*transformArray3)(const float4x4& m, bool translate, const float3* in, size_t inStride, float3* out, size_t outStride, size_t count);
+        void (*transformArray4)(const float4x4& m, const float4* in, float4* out, size_t count);
+        void (*normalizeArray3)(const float3* in, size_t inStride, float3* out, size_t outStride, size_t count);
+        void (*dotArray3)(const float3* a, const float3* b, float* out, size_t count);
+        void (*crossArray3)(const float3* a, const float3* b, float3* out, size_t count);
+    };
+
+    template <class T>
+    const T* Advance(const T* p, size_t bytes)
+    {
+        return reinterpret_cast<const T*>(reinterpret_cast<const char*>(p) + bytes);
+    }
+
+    template <class T>
+    T* Advance(T* p, size_t bytes)
+    {
+        return reinterpret_cast<T*>(reinterpret_cast<char*>(p) + bytes);
+    }
+
+    const float* Row(const float4x4& m, int row)
+    {
+        return &m._11 + row * 4;
+    }
+
+    // Scalar
+
+    void ScalarTransform3(const float4x4& m, bool translate, const float3x8& in, float3x8& out)
+    {
+        for (size_t i = 0; i < PackSize; i++)
+        {
+            float3 v(in.x[i], in.y[i], in.z[i]);
+            v = translate ? transformPoint(m, v) : transformNormal(m, v);
+            out.x[i] = v.x;
+            out.y[i] = v.y;
+            out.z[i] = v.z;
+        }
+    }
+
+    void ScalarTransform4(const float4x4& m, const float4x8& in, float4x8& out)
+    {
+        for (size_t i = 0; i < PackSize; i++)
+        {
+            float4 v = transform(m, float4(in.x[i], in.y[i], in.z[i], in.w[i]));
+            out.x[i] = v.x;
+            out.y[i] = v.y;
+            out.z[i] = v.z;
+            out.w[i] = v.w;
+        }
+    }
+
+    void ScalarNormalize3(const float3x8& in, float3x8& out)
+    {
+        for (size_t i = 0; i < PackSize; i++)
+        {
+            float3 v = normalize(float3(in.x[i], in.y[i], in.z[i]));
+            out.x[i] = v.x;
+            out.y[i] = v.y;
+            out.z[i] = v.z;
+        }
+    }
+
+    void ScalarDot3(const float3x8& a, const float3x8& b, float* out)
+    {
+        for (size_t i = 0; i < PackSize; i++)
+        {
+            out[i] = dot(float3(a.x[i], a.y[i], a.z[i]), float3(b.x[i], b.y[i], b.z[i]));
+        }
+    }
+
+    void ScalarCross3(const float3x8& a, const float3x8& b, float3x8& out)
+    {
+        for (size_t i = 0; i < PackSize; i++)
+        {
+            float3 v = cross(float3(a.x[i], a.y[i], a.z[i]), float3(b.x[i], b.y[i], b.z[i]));
+            out.x[i] = v.x;
+            out.y[i] = v.y;
+            out.z[i] = v.z;
+        }
+    }
+
+    void ScalarMul4x4(const float4x4& a, const float4x4& b, float4x4& out)
+    {
+        out = mul(a, b);
+    }
+
+    void ScalarTransformArray3(const float4x4& m, bool translate, const float3* in, size_t inStride, float3* out, size_t outStride, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            float3 v = *Advance(in, i * inStride);
+            *Advance(out, i * outStride) = translate ? transformPoint(m, v) : transformNormal(m, v);
+        }
+    }
+
+    void ScalarTransformArray4(const float4x4& m, const float4* in, float4* out, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            out[i] = transform(m, in[i]);
+        }
+    }
+
+    void ScalarNormalizeArray3(const float3* in, size_t inStride, float3* out, size_t outStride, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            *Advance(out, i * outStride) = normalize(*Advance(in, i * inStride));
+        }
+    }
+
+    void ScalarDotArray3(const float3* a, const float3* b, float* out, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            out[i] = dot(a[i], b[i]);
+        }
+    }
+
+    void ScalarCrossArray3(const float3* a, const float3* b, float3* out, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            out[i] = cross(a[i], b[i]);
+        }
+    }
+
+    const BatchKernels ScalarKernels =
+    {
+        ScalarTransform3,
+        ScalarTransform4,
+        ScalarNormalize3,
+        ScalarDot3,
+        ScalarCross3,
+        ScalarMul4x4,
+        ScalarTransformArray3,
+        ScalarTransformArray4,
+        ScalarNormalizeArray3,
+        ScalarDotArray3,
+        ScalarCrossArray3
+    };
+
+#ifdef BASICMATH_BATCH_X86
+
+    // SSE2, four lanes at a time.  The lane functions are shared by the pack
+    // and array operations.
+
+    inline void Sse2TransformLanes(const float4x4& m, bool translate, __m128& x, __m128& y, __m128& z)
+    {
+        __m128 result[3];
+        for (int row = 0; row < 3; row++)
+        {
+            const float* r = Row(m, row);
+            __m128 sum = _mm_mul_ps(_mm_set1_ps(r[0]), x);
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(r[1]), y));
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(r[2]), z));
+            if (translate)
+            {
+                sum = _mm_add_ps(sum, _mm_set1_ps(r[3]));
+            }
+            result[row] = sum;
+        }
+
+        x = result[0];
+        y = result[1];
+        z = result[2];
+    }
+
+    inline void Sse2TransformLanes(const float4x4& m, __m128& x, __m128& y, __m128& z, __m128& w)
+    {
+        __m128 result[4];
+        for (int row = 0; row < 4; row++)
+        {
+            const float* r = Row(m, row);
+            __m128 sum = _mm_mul_ps(_mm_set1_ps(r[0]), x);
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(r[1]), y));
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(r[2]), z));
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(r[3]), w));
+            result[row] = sum;
+        }
+
+        x = result[0];
+        y = result[1];
+        z = result[2];
+        w = result[3];
+    }
+
+    inline void Sse2NormalizeLanes(__m128& x, __m128& y, __m128& z)
+    {
+        __m128 len = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+        x = _mm_div_ps(x, len);
+        y = _mm_div_ps(y, len);
+        z = _mm_div_ps(z, len);
+    }
+
+    inline __m128 Sse2DotLanes(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz)
+    {
+        return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+    }
+
+    inline void Sse2CrossLanes(__m128& ax, __m128& ay, __m128& az, __m128 bx, __m128 by, __m128 bz)
+    {
+        __m128 x = _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by));
+        __m128 y = _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz));
+        __m128 z = _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx));
+        ax = x;
+        ay = y;
+        az = z;
+    }
+
+    // Moves four vectors of an array into lanes with a 4x4 transpose.  Each load
+    // reads the four bytes after the vector, so the last vector of an array must
+    // not be loaded this way.
+    inline void Sse2Load4x3(const float3* v, size_t stride, __m128& x, __m128& y, __m128& z)
+    {
+        __m128 r0 = _mm_loadu_ps(&v->x);
+        __m128 r1 = _mm_loadu_ps(&Advance(v, stride)->x);
+        __m128 r2 = _mm_loadu_ps(&Advance(v, stride * 2)->x);
+        __m128 r3 = _mm_loadu_ps(&Advance(v, stride * 3)->x);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        x = r0;
+        y = r1;
+        z = r2;
+    }
+
+    // Writes x, y and z of four vectors, leaving whatever follows each vector alone.
+    inline void Sse2Store4x3(__m128 x, __m128 y, __m128 z, float3* v, size_t stride)
+    {
+        __m128 w = _mm_setzero_ps();
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        __m128 rows[4] = { x, y, z, w };
+        for (size_t i = 0; i < 4; i++)
+        {
+            float3* p = Advance(v, i * stride);
+            _mm_storel_pi(reinterpret_cast<__m64*>(&p->x), rows[i]);
+            _mm_store_ss(&p->z, _mm_movehl_ps(rows[i], rows[i]));
+        }
+    }
+
+    void Sse2Transform3(const float4x4& m, bool translate, const float3x8& in, float3x8& out)
+    {
+        for (size_t i = 0; i < PackSize; i += 4)
+        {
+            __m128 x = _mm_loadu_ps(in.x + i);
+            __m128 y = _mm_loadu_ps(in.y + i);
+            __m128 z = _mm_loadu_ps(in.z + i);
+            Sse2TransformLanes(m, translate, x, y, z);
+            _mm_storeu_ps(out.x + i, x);
+            _mm_storeu_ps(out.y + i, y);
+            _mm_storeu_ps(out.z + i, z);
+        }
+    }
+
+    void Sse2Transform4(const float4x4& m, const float4x8& in, float4x8& out)
+    {
+        for (size_t i = 0; i < PackSize; i += 4)
+        {
+            __m128 x = _mm_loadu_ps(in.x + i);
+            __m128 y = _mm_loadu_ps(in.y + i);
+            __m128 z = _mm_loadu_ps(in.z + i);
+            __m128 w = _mm_loadu_ps(in.w + i);
+            Sse2TransformLanes(m, x, y, z, w);
+            _mm_storeu_ps(out.x + i, x);
+            _mm_storeu_ps(out.y + i, y);
+            _mm_storeu_ps(out.z + i, z);
+            _mm_storeu_ps(out.w + i, w);
+        }
+    }
+
+    void Sse2Normalize3(const float3x8& in, float3x8& out)
+    {
+        for (size_t i = 0; i < PackSize; i += 4)
+        {
+            __m128 x = _mm_loadu_ps(in.x + i);
+            __m128 y = _mm_loadu_ps(in.y + i);
+            __m128 z = _mm_loadu_ps(in.z + i);
+            Sse2NormalizeLanes(x, y, z);
+            _mm_storeu_ps(out.x + i, x);
+            _mm_storeu_ps(out.y + i, y);
+            _mm_storeu_ps(out.z + i, z);
+        }
+    }
+
+    void Sse2Dot3(const float3x8& a, const float3x8& b, float* out)
+    {
+        for (size_t i = 0; i < PackSize; i += 4)
+        {
+            _mm_storeu_ps(out + i, Sse2DotLanes(
+                _mm_loadu_ps(a.x + i), _mm_loadu_ps(a.y + i), _mm_loadu_ps(a.z + i),
+                _mm_loadu_ps(b.x + i), _mm_loadu_ps(b.y + i), _mm_loadu_ps(b.z + i)
+                ));
+        }
+    }
+
+    void Sse2Cross3(const float3x8& a, const float3x8& b, float3x8& out)
+    {
+        for (size_t i = 0; i < PackSize; i += 4)
+        {
+            __m128 x = _mm_loadu_ps(a.x + i);
+            __m128 y = _mm_loadu_ps(a.y + i);
+            __m128 z = _mm_loadu_ps(a.z + i);
+            Sse2CrossLanes(x, y, z, _mm_loadu_ps(b.x + i), _mm_loadu_ps(b.y + i), _mm_loadu_ps(b.z + i));
+            _mm_storeu_ps(out.x + i, x);
+            _mm_storeu_ps(out.y + i, y);
+            _mm_storeu_ps(out.z + i, z);
+        }
+    }
+
+    void Sse2Mul4x4(const float4x4& a, const float4x4& b, float4x4& out)
+    {
+        __m128 rows[4];
+        for (int k = 0; k < 4; k++)
+        {
+            rows[k] = _mm_loadu_ps(Row(b, k));
+        }
+
+        // Summed from zero in the same order as mul().
+        __m128 result[4];
+        for (int i = 0; i < 4; i++)
+        {
+            const float* r = Row(a, i);
+            __m128 sum = _mm_setzero_ps();
+            for (int k = 0; k < 4; k++)
+            {
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(r[k]), rows[k]));
+            }
+            result[i] = sum;
+        }
+
+        for (int i = 0; i < 4; i++)
+        {
+            _mm_storeu_ps(&out._11 + i * 4, result[i]);
+        }
+    }
+
+    // The array loops stop before the last vector so that Sse2Load4x3 never reads
+    // past the end of an array; the rest is done by the scalar loops.  Arrays of
+    // cross products stay scalar: the transposes cost more than the arithmetic.
+
+    void Sse2TransformArray3(const float4x4& m, bool translate, const float3* in, size_t inStride, float3* out, size_t outStride, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 4 < count; i += 4)
+        {
+            __m128 x, y, z;
+            Sse2Load4x3(Advance(in, i * inStride), inStride, x, y, z);
+            Sse2TransformLanes(m, translate, x, y, z);
+            Sse2Store4x3(x, y, z, Advance(out, i * outStride), outStride);
+        }
+
+        ScalarTransformArray3(m, translate, Advance(in, i * inStride), inStride, Advance(out, i * outStride), outStride, count - i);
+    }
+
+    void Sse2TransformArray4(const float4x4& m, const float4* in, float4* out, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 x = _mm_loadu_ps(&in[i].x);
+            __m128 y = _mm_loadu_ps(&in[i + 1].x);
+            __m128 z = _mm_loadu_ps(&in[i + 2].x);
+            __m128 w = _mm_loadu_ps(&in[i + 3].x);
+            _MM_TRANSPOSE4_PS(x, y, z, w);
+            Sse2TransformLanes(m, x, y, z, w);
+            _MM_TRANSPOSE4_PS(x, y, z, w);
+            _mm_storeu_ps(&out[i].x, x);
+            _mm_storeu_ps(&out[i + 1].x, y);
+            _mm_storeu_ps(&out[i + 2].x, z);
+            _mm_storeu_ps(&out[i + 3].x, w);
+        }
+
+        ScalarTransformArray4(m, in + i, out + i, count - i);
+    }
+
+    void Sse2NormalizeArray3(const float3* in, size_t inStride, float3* out, size_t outStride, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 4 < count; i += 4)
+        {
+            __m128 x, y, z;
+            Sse2Load4x3(Advance(in, i * inStride), inStride, x, y, z);
+            Sse2NormalizeLanes(x, y, z);
+            Sse2Store4x3(x, y, z, Advance(out, i * outStride), outStride);
+        }
+
+        ScalarNormalizeArray3(Advance(in, i * inStride), inStride, Advance(out, i * outStride), outStride, count - i);
+    }
+
+    void Sse2DotArray3(const float3* a, const float3* b, float* out, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 4 < count; i += 4)
+        {
+            __m128 ax, ay, az, bx, by, bz;
+            Sse2Load4x3(a + i, sizeof(float3), ax, ay, az);
+            Sse2Load4x3(b + i, sizeof(float3), bx, by, bz);
+            _mm_storeu_ps(out + i, Sse2DotLanes(ax, ay, az, bx, by, bz));
+        }
+
+        ScalarDotArray3(a + i, b + i, out + i, count - i);
+    }
+
+    const BatchKernels Sse2Kernels =
+    {
+        Sse2Transform3,
+        Sse2Transform4,
+        Sse2Normalize3,
+        Sse2Dot3,
+        Sse2Cross3,
+        Sse2Mul4x4,
+        Sse2TransformArray3,
+        Sse2TransformArray4,
+        Sse2NormalizeArray3,
+        Sse2DotArray3,
+        ScalarCrossArray3
+    };
+
+    // AVX2, eight lanes at a time.  The arrays are moved in and out of lanes four
+    // vectors at a time as for SSE2, and the remainder is left to the SSE2 loops.
+    // Arrays of float4 and of dot products are not wide enough to gain from the
+    // extra lanes, so they use the SSE2 loops throughout.
+
+    BASICMATH_TARGET_AVX2 inline __m256 Avx2Combine(__m128 low, __m128 high)
+    {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+    }
+
+    BASICMATH_TARGET_AVX2 inline void Avx2TransformLanes(const float4x4& m, bool translate, __m256& x, __m256& y, __m256& z)
+    {
+        __m256 result[3];
+        for (int row = 0; row < 3; row++)
+        {
+            const float* r = Row(m, row);
+            __m256 sum = _mm256_mul_ps(_mm256_set1_ps(r[0]), x);
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(r[1]), y));
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(r[2]), z));
+            if (translate)
+            {
+                sum = _mm256_add_ps(sum, _mm256_set1_ps(r[3]));
+            }
+            result[row] = sum;
+        }
+
+        x = result[0];
+        y = result[1];
+        z = result[2];
+    }
+
+    BASICMATH_TARGET_AVX2 inline void Avx2NormalizeLanes(__m256& x, __m256& y, __m256& z)
+    {
+        __m256 len = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z)));
+        x = _mm256_div_ps(x, len);
+        y = _mm256_div_ps(y, len);
+        z = _mm256_div_ps(z, len);
+    }
+
+    BASICMATH_TARGET_AVX2 inline __m256 Avx2DotLanes(__m256 ax, __m256 ay, __m256 az, __m256 bx, __m256 by, __m256 bz)
+    {
+        return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ax, bx), _mm256_mul_ps(ay, by)), _mm256_mul_ps(az, bz));
+    }
+
+    BASICMATH_TARGET_AVX2 inline void Avx2CrossLanes(__m256& ax, __m256& ay, __m256& az, __m256 bx, __m256 by, __m256 bz)
+    {
+        __m256 x = _mm256_sub_ps(_mm256_mul_ps(ay, bz), _mm256_mul_ps(az, by));
+        __m256 y = _mm256_sub_ps(_mm256_mul_ps(az, bx), _mm256_mul_ps(ax, bz));
+        __m256 z = _mm256_sub_ps(_mm256_mul_ps(ax, by), _mm256_mul_ps(ay, bx));
+        ax = x;
+        ay = y;
+        az = z;
+    }
+
+    BASICMATH_TARGET_AVX2 inline void Avx2Load8x3(const float3* v, size_t stride, __m256& x, __m256& y, __m256& z)
+    {
+        __m128 x0, y0, z0, x1, y1, z1;
+        Sse2Load4x3(v, stride, x0, y0, z0);
+        Sse2Load4x3(Advance(v, stride * 4), stride, x1, y1, z1);
+        x = Avx2Combine(x0, x1);
+        y = Avx2Combine(y0, y1);
+        z = Avx2Combine(z0, z1);
+    }
+
+    BASICMATH_TARGET_AVX2 inline void Avx2Store8x3(__m256 x, __m256 y, __m256 z, float3* v, size_t stride)
+    {
+        Sse2Store4x3(_mm256_castps256_ps128(x), _mm256_castps256_ps128(y), _mm256_castps256_ps128(z), v, stride);
+        Sse2Store4x3(_mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1), _mm256_extractf128_ps(z, 1), Advance(v, stride * 4), stride);
+    }
+
+    BASICMATH_TARGET_AVX2 void Avx2Transform3(const float4x4& m, bool translate, const float3x8& in, float3x8& out)
+    {
+        __m256 x = _mm256_loadu_ps(in.x);
+        __m256 y = _mm256_loadu_ps(in.y);
+        __m256 z = _mm256_loadu_ps(in.z);
+        Avx2TransformLanes(m, translate, x, y, z);
+        _mm256_storeu_ps(out.x, x);
+        _mm256_storeu_ps(out.y, y);
+        _mm256_storeu_ps(out.z, z);
+    }
+
+    BASICMATH_TARGET_AVX2 void Avx2Transform4(const float4x4& m, const float4x8& in, float4x8& out)
+    {
+        __m256 x = _mm256_loadu_ps(in.x);
+        __m256 y = _mm256_loadu_ps(in.y);
+        __m256 z = _mm256_loadu_ps(in.z);
+        __m256 w = _mm256_loadu_ps(in.w);
+        float* dest[4] = { out.x, out.y, out.z, out.w };
+        for (int row = 0; row < 4; row++)
+        {
+            const float* r = Row(m, row);
+            __m256 sum = _mm256_mul_ps(_mm256_set1_ps(r[0]), x);
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(r[1]), y));
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(r[2]), z));
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(r[3]), w));
+            _mm256_storeu_ps(dest[row], sum);
+        }
+    }
+
+    BASICMATH_TARGET_AVX2 void Avx2Normalize3(const float3x8& in, float3x8& out)
+    {
+        __m256 x = _mm256_loadu_ps(in.x);
+        __m256 y = _mm256_loadu_ps(in.y);
+        __m256 z = _mm256_loadu_ps(in.z);
+        Avx2NormalizeLanes(x, y, z);
+        _mm256_storeu_ps(out.x, x);
+        _mm256_storeu_ps(out.y, y);
+        _mm256_storeu_ps(out.z, z);
+    }
+
+    BASICMATH_TARGET_AVX2 void Avx2Dot3(const float3x8& a, const float3x8& b, float* out)
+    {
+        _mm256_storeu_ps(out, Avx2DotLanes(
+            _mm256_loadu_ps(a.x), _mm256_loadu_ps(a.y), _mm256_loadu_ps(a.z),
+            _mm256_loadu_ps(b.x), _mm256_loadu_ps(b.y), _mm256_loadu_ps(b.z)
+            ));
+    }
+
+    BASICMATH_TARGET_AVX2 void Avx2Cross3(const float3x8& a, const float3x8& b, float3x8& out)
+    {
+        __m256 x = _mm256_loadu_ps(a.x);
+        __m256 y = _mm256_loadu_ps(a.y);
+        __m256 z = _mm256_loadu_ps(a.z);
+        Avx2CrossLanes(x, y, z, _mm256_loadu_ps(b.x), _mm256_loadu_ps(b.y), _mm256_loadu_ps(b.z));
+        _mm256_storeu_ps(out.x, x);
+        _mm256_storeu_ps(out.y, y);
+        _mm256_storeu_ps(out.z, z);
+    }
+
+    BASICMATH_TARGET_AVX2 void Avx2Mul4x4(const float4x4& a, const float4x4& b, float4x4& out)
+    {
+        // Each row of b appears in both halves so that rows i and i + 1 of the
+        // result are computed together.
+        __m256 rows[4];
+        for (int k = 0; k < 4; k++)
+        {
+            __m128 row = _mm_loadu_ps(Row(b, k));
+            rows[k] = Avx2Combine(row, row);
+        }
+
+        __m256 result[2];
+        for (int i = 0; i < 4; i += 2)
+        {
+            const float* r0 = Row(a, i);
+            const float* r1 = Row(a, i + 1);
+            __m256 sum = _mm256_setzero_ps();
+            for (int k = 0; k < 4; k++)
+            {
+                __m256 scale = Avx2Combine(_mm_set1_ps(r0[k]), _mm_set1_ps(r1[k]));
+                sum = _mm256_add_ps(sum, _mm256_mul_ps(scale, rows[k]));
+            }
+            result[i / 2] = sum;
+        }
+
+        _mm256_storeu_ps(&out._11, result[0]);
+        _mm256_storeu_ps(&out._31, result[1]);
+    }
+
+    BASICMATH_TARGET_AVX2 void Avx2TransformArray3(const float4x4& m, bool translate, const float3* in, size_t inStride, float3* out, size_t outStride, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 8 < count; i += 8)
+        {
+            __m256 x, y, z;
+            Avx2Load8x3(Advance(in, i * inStride), inStride, x, y, z);
+            Avx2TransformLanes(m, translate, x, y, z);
+            Avx2Store8x3(x, y, z, Advance(out, i * outStride), outStride);
+        }
+
+        Sse2TransformArray3(m, translate, Advance(in, i * inStride), inStride, Advance(out, i * outStride), outStride, count - i);
+    }
+
+    BASICMATH_TARGET_AVX2 void Avx2NormalizeArray3(const float3* in, size_t inStride, float3* out, size_t outStride, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 8 < count; i += 8)
+        {
+            __m256 x, y, z;
+            Avx2Load8x3(Advance(in, i * inStride), inStride, x, y, z);
+            Avx2NormalizeLanes(x, y, z);
+            Avx2Store8x3(x, y, z, Advance(out, i * outStride), outStride);
+        }
+
+        Sse2NormalizeArray3(Advance(in, i * inStride), inStride, Advance(out, i * outStride), outStride, count - i);
+    }
+
+    const BatchKernels Avx2Kernels =
+    {
+        Avx2Transform3,
+        Avx2Transform4,
+        Avx2Normalize3,
+        Avx2Dot3,
+        Avx2Cross3,
+        Avx2Mul4x4,
+        Avx2TransformArray3,
+        Sse2TransformArray4,
+        Avx2NormalizeArray3,
+        Sse2DotArray3,
+        ScalarCrossArray3
+    };
+
+    bool ProcessorSupportsAvx2()
+    {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+        {
+            return false;
+        }
+
+        // AVX also needs the OS to save the YMM registers on context switches.
+        __cpuid(info, 1);
+        bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+        bool avx = (info[2] & (1 << 28)) != 0;
+
+        __cpuidex(info, 7, 0);
+        bool avx2 = (info[1] & (1 << 5)) != 0;
+        return osSavesYmm && avx && avx2;
+#else
+        return __builtin_cpu_supports("avx2") != 0;
+#endif
+    }
+
+#endif
+
+    const BatchKernels* KernelsFor(BatchMathPath path)
+    {
+#ifdef BASICMATH_BATCH_X86
+        switch (path)
+        {
+        case BatchMathPath::AVX2:
+            return &Avx2Kernels;
+        case BatchMathPath::SSE2:
+            return &Sse2Kernels;
+        default:
+            break;
+        }
+#endif
+        return &ScalarKernels;
+    }
+
+    std::atomic<BatchMathPath> s_path(BatchMathPath::Scalar);
+    std::atomic<const BatchKernels*> s_kernels(nullptr);
+
+    const BatchKernels& Kernels()
+    {
+        const BatchKernels* kernels = s_kernels.load(std::memory_order_acquire);
+        if (kernels == nullptr)
+        {
+            setBatchMathPath(supportedBatchMathPath());
+            kernels = s_kernels.load(std::memory_order_acquire);
+        }
+
+        return *kernels;
+    }
+}
+
+// Instruction Set Selection
+
+BatchMathPath supportedBatchMathPath()
+{
+#ifdef BASICMATH_BATCH_X86
+    static const BatchMathPath supported = ProcessorSupportsAvx2() ? BatchMathPath::AVX2 : BatchMathPath::SSE2;
+    return supported;
+#else
+    return BatchMathPath::Scalar;
+#endif
+}
+
+BatchMathPath batchMathPath()
+{
+    Kernels();
+    return s_path.load(std::memory_order_relaxed);
+}
+
+void setBatchMathPath(BatchMathPath path)
+{
+    BatchMathPath supported = supportedBatchMathPath();
+    if (static_cast<int>(path) > static_cast<int>(supported))
+    {
+        path = supported;
+    }
+
+    s_path.store(path, std::memory_order_relaxed);
+    s_kernels.store(KernelsFor(path), std::memory_order_release);
+}
+
+// Pack Conversions
+
+void load(float3x8& pack, const float3* v, size_t stride, size_t count)
+{
+    for (size_t i = 0; i < PackSize; i++)
+    {
+        if (i < count)
+        {
+            const float3* p = Advance(v, i * stride);
+            pack.x[i] = p->x;
+            pack.y[i] = p->y;
+            pack.z[i] = p->z;
+        }
+        else
+        {
+            pack.x[i] = pack.y[i] = pack.z[i] = 0.0f;
+        }
+    }
+}
+
+void store(const float3x8& pack, float3* v, size_t stride, size_t count)
+{
+    for (size_t i = 0; i < count && i < PackSize; i++)
+    {
+        float3* p = Advance(v, i * stride);
+        p->x = pack.x[i];
+        p->y = pack.y[i];
+        p->z = pack.z[i];
+    }
+}
+
+void load(float4x8& pack, const float4* v, size_t stride, size_t count)
+{
+    for (size_t i = 0; i < PackSize; i++)
+    {
+        if (i < count)
+        {
+            const float4* p = Advance(v, i * stride);
+            pack.x[i] = p->x;
+            pack.y[i] = p->y;
+            pack.z[i] = p->z;
+            pack.w[i] = p->w;
+        }
+        else
+        {
+            pack.x[i] = pack.y[i] = pack.z[i] = pack.w[i] = 0.0f;
+        }
+    }
+}
+
+void store(const float4x8& pack, float4* v, size_t stride, size_t count)
+{
+    for (size_t i = 0; i < count && i < PackSize; i++)
+    {
+        float4* p = Advance(v, i * stride);
+        p->x = pack.x[i];
+        p->y = pack.y[i];
+        p->z = pack.z[i];
+        p->w = pack.w[i];
+    }
+}
+
+// Pack Operations
+
+void dot(const float3x8& a, const float3x8& b, float out[8])
+{
+    Kernels().dot3(a, b, out);
+}
+
+float3x8 cross(const float3x8& a, const float3x8& b)
+{
+    float3x8 out;
+    Kernels().cross3(a, b, out);
+    return out;
+}
+
+float3x8 normalize(const float3x8& a)
+{
+    float3x8 out;
+    Kernels().normalize3(a, out);
+    return out;
+}
+
+float3x8 transformPoint(const float4x4& m, const float3x8& p)
+{
+    float3x8 out;
+    Kernels().transform3(m, true, p, out);
+    return out;
+}
+
+float3x8 transformNormal(const float4x4& m, const float3x8& n)
+{
+    float3x8 out;
+    Kernels().transform3(m, false, n, out);
+    return out;
+}
+
+float4x8 transform(const float4x4& m, const float4x8& v)
+{
+    float4x8 out;
+    Kernels().transform4(m, v, out);
+    return out;
+}
+
+// Array Operations
+
+void transformPoints(
+    const float4x4& m,
+    const float3* in,
+    size_t inStride,
+    float3* out,
+    size_t outStride,
+    size_t count
+    )
+{
+    Kernels().transformArray3(m, true, in, inStride, out, outStride, count);
+}
+
+void transformNormals(
+    const float4x4& m,
+    const float3* in,
+    size_t inStride,
+    float3* out,
+    size_t outStride,
+    size_t count
+    )
+{
+    Kernels().transformArray3(m, false, in, inStride, out, outStride, count);
+}
+
+void transformArray(const float4x4& m, const float4* in, float4* out, size_t count)
+{
+    Kernels().transformArray4(m, in, out, count);
+}
+
+void normalizeArray(
+    const float3* in,
+    size_t inStride,
+    float3* out,
+    size_t outStride,
+    size_t count
+    )
+{
+    Kernels().normalizeArray3(in, inStride, out, outStride, count);
+}
+
+void dotArray(const float3* a, const float3* b, float* out, size_t count)
+{
+    Kernels().dotArray3(a, b, out, count);
+}
+
+void crossArray(const float3* a, const float3* b, float3* out, size_t count)
+{
+    Kernels().crossArray3(a, b, out, count);
+}
+
+void mulArray(const float4x4& m, const float4x4* in, float4x4* out, size_t count)
+{
+    const BatchKernels& kernels = Kernels();
+    for (size_t i = 0; i < count; i++)
+    {
+        kernels.mul4x4(m, in[i], out[i]);
+    }
+}
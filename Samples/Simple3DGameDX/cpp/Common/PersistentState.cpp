@@ -78,6 +78,46 @@ void PersistentState::SaveString(Platform::String^ key, Platform::String^ string
     m_settingsValues->Insert(fullKey, PropertyValue::CreateString(string));
 }
 
+// The bytes are split into parts of at most BytesPerPart under numbered keys, and the key
+// itself holds the number of parts.
+void PersistentState::SaveBytes(Platform::String^ key, const Platform::Array<byte>^ bytes)
+{
+    Platform::String^ fullKey = Platform::String::Concat(m_keyName, key);
+    int oldPartCount = LoadPartCount(fullKey);
+    unsigned int partCount = (bytes->Length + BytesPerPart - 1) / BytesPerPart;
+
+    for (unsigned int part = 0; part < partCount; part++)
+    {
+        unsigned int offset = part * BytesPerPart;
+        unsigned int length = min(bytes->Length - offset, BytesPerPart);
+        Platform::String^ partKey = GetPartKey(fullKey, part);
+        if (m_settingsValues->HasKey(partKey))
+        {
+            m_settingsValues->Remove(partKey);
+        }
+        m_settingsValues->Insert(
+            partKey,
+            PropertyValue::CreateUInt8Array(ref new Platform::Array<byte>(bytes->Data + offset, length))
+            );
+    }
+
+    // Remove the parts of a longer value saved earlier.
+    for (int part = partCount; part < oldPartCount; part++)
+    {
+        Platform::String^ partKey = GetPartKey(fullKey, part);
+        if (m_settingsValues->HasKey(partKey))
+        {
+            m_settingsValues->Remove(partKey);
+        }
+    }
+
+    if (m_settingsValues->HasKey(fullKey))
+    {
+        m_settingsValues->Remove(fullKey);
+    }
+    m_settingsValues->Insert(fullKey, PropertyValue::CreateInt32(partCount));
+}
+
 bool PersistentState::LoadBool(Platform::String^ key, bool defaultValue)
 {
     Platform::String^ fullKey = Platform::String::Concat(m_keyName, key);
@@ -134,3 +174,82 @@ Platform::String^ PersistentState::LoadString(Platform::String^ key, Platform::S
     }
     return defaultValue;
 }
+
+// Returns nullptr if the key or any of its parts is not present.
+Platform::Array<byte>^ PersistentState::LoadBytes(Platform::String^ key)
+{
+    Platform::String^ fullKey = Platform::String::Concat(m_keyName, key);
+    int partCount = LoadPartCount(fullKey);
+    if (partCount < 0)
+    {
+        return nullptr;
+    }
+
+    std::vector<Platform::Array<byte>^> parts(partCount);
+    unsigned int length = 0;
+    for (int part = 0; part < partCount; part++)
+    {
+        Platform::String^ partKey = GetPartKey(fullKey, part);
+        if (!m_settingsValues->HasKey(partKey))
+        {
+            return nullptr;
+        }
+        safe_cast<IPropertyValue^>(m_settingsValues->Lookup(partKey))->GetUInt8Array(&parts[part]);
+        length += parts[part]->Length;
+    }
+
+    Platform::Array<byte>^ bytes = ref new Platform::Array<byte>(length);
+    unsigned int offset = 0;
+    for (Platform::Array<byte>^ part : parts)
+    {
+        memcpy(bytes->Data + offset, part->Data, part->Length);
+        offset += part->Length;
+    }
+    return bytes;
+}
+
+// Removes every value whose key starts with keyPrefix.
+void PersistentState::RemoveKeys(Platform::String^ keyPrefix)
+{
+    Platform::String^ fullPrefix = Platform::String::Concat(m_keyName, keyPrefix);
+    std::vector<Platform::String^> keys;
+
+    IIterator<IKeyValuePair<Platform::String^, Platform::Object^>^>^ iterator = m_settingsValues->First();
+    while (iterator->HasCurrent)
+    {
+        Platform::String^ candidate = iterator->Current->Key;
+        if ((candidate->Length() >= fullPrefix->Length()) &&
+            (wcsncmp(candidate->Data(), fullPrefix->Data(), fullPrefix->Length()) == 0))
+        {
+            keys.push_back(candidate);
+        }
+        iterator->MoveNext();
+    }
+
+    for (Platform::String^ candidate : keys)
+    {
+        m_settingsValues->Remove(candidate);
+    }
+}
+
+Platform::String^ PersistentState::GetPartKey(Platform::String^ fullKey, unsigned int part)
+{
+    const int bufferLength = 16;
+    char16 str[bufferLength];
+    int len = swprintf_s(str, bufferLength, L":%u", part);
+    return Platform::String::Concat(fullKey, ref new Platform::String(str, len));
+}
+
+// Returns -1 if the key is not present or wasn't written by SaveBytes.
+int PersistentState::LoadPartCount(Platform::String^ fullKey)
+{
+    if (m_settingsValues->HasKey(fullKey))
+    {
+        IPropertyValue^ value = safe_cast<IPropertyValue^>(m_settingsValues->Lookup(fullKey));
+        if (value->Type == PropertyType::Int32)
+        {
+            return value->GetInt32();
+        }
+    }
+    return -1;
+}
@@ -32,7 +32,8 @@ GameHud::GameHud(
     ) :
     m_deviceResources(deviceResources),
     m_titleHeader(titleHeader),
-    m_titleBody(titleBody)
+    m_titleBody(titleBody),
+    m_frameTimings(nullptr)
 {
     m_showTitle = true;
     m_titleBodyVerticalOffset = GameConstants::Margin;
@@ -355,6 +356,54 @@ void GameHud::Render(_In_ Simple3DGame^ game)
                 );
         }
     }
+
+    if (m_frameTimings != nullptr && m_frameTimings->FrameCount() > 0)
+    {
+        // Rolling percentiles over the recent frames, in milliseconds, above the move control.
+        static const FramePhase phases[] = {
+            FramePhase::Frame,
+            FramePhase::Update,
+            FramePhase::Dynamics,
+            FramePhase::Render,
+            FramePhase::Hud,
+            FramePhase::Present
+        };
+        static const int bufferLength = 512;
+        static char16 wsbuffer[bufferLength];
+        int length = swprintf_s(wsbuffer, bufferLength, L"ms\tp50\tp95\tp99\n");
+        for (auto phase : phases)
+        {
+            length += swprintf_s(
+                wsbuffer + length,
+                bufferLength - length,
+                L"%S\t%.2f\t%.2f\t%.2f\n",
+                FrameTimings::PhaseName(phase),
+                m_frameTimings->Percentile(phase, 50.0),
+                m_frameTimings->Percentile(phase, 95.0),
+                m_frameTimings->Percentile(phase, 99.0)
+                );
+        }
+        length += swprintf_s(
+            wsbuffer + length,
+            bufferLength - length,
+            L"Steps\t%.1f",
+            m_frameTimings->AveragePhysicsSteps()
+            );
+
+        float height = (GameConstants::HudBodyPointSize + GameConstants::Margin) * 8;
+        d2dContext->DrawText(
+            wsbuffer,
+            length,
+            m_textFormatBody.Get(),
+            D2D1::RectF(
+                GameConstants::Margin,
+                windowBounds.Height - GameConstants::TouchRectangleSize - height,
+                GameConstants::Margin + GameConstants::HudSafeWidth * 2.0f,
+                windowBounds.Height - GameConstants::TouchRectangleSize
+                ),
+            m_textBrush.Get()
+            );
+    }
 }
 
 //----------------------------------------------------------------------
@@ -19,6 +19,7 @@
 
 #include "Simple3DGame.h"
 #include "DirectXSample.h"
+#include "FrameTimings.h"
 
 ref class Simple3DGame;
 
@@ -36,6 +37,9 @@ internal:
     void ReleaseDeviceDependentResources();
     void Render(_In_ Simple3DGame^ game);
 
+    // Shows rolling percentiles of the frame timings in the lower left corner; nullptr hides them.
+    void ShowFrameTimings(_In_opt_ const FrameTimings* timings) { m_frameTimings = timings; };
+
 private:
     // Cached pointer to device resources.
     std::shared_ptr<DX::DeviceResources>                m_deviceResources;
@@ -57,4 +61,6 @@ private:
     float                                               m_titleBodyVerticalOffset;
     D2D1_SIZE_F                                         m_logoSize;
     D2D1_SIZE_F                                         m_maxTitleSize;
+
+    const FrameTimings*                                 m_frameTimings;
 };
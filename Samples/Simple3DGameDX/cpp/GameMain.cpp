@@ -13,6 +13,8 @@
 #include "MoveLookController.h"
 #include "GameMain.h"
 
+#include <fstream>
+
 using namespace GameControl;
 using namespace Simple3DGameDX;
 using namespace concurrency;
@@ -43,6 +45,15 @@ GameMain::GameMain(const std::shared_ptr<DX::DeviceResources>& deviceResources)
     m_renderer = ref new GameRenderer(m_deviceResources);
     m_game = ref new Simple3DGame();
 
+    // Frame timings are always recorded.  Debug builds also show them on the HUD and write them
+    // out when the game is suspended.
+#if defined(_DEBUG)
+    m_renderer->SetFrameTimings(&m_frameTimings, true);
+#else
+    m_renderer->SetFrameTimings(&m_frameTimings, false);
+#endif
+    m_game->SetFrameTimings(&m_frameTimings);
+
     m_uiControl = m_renderer->GameUIControl();
 
     m_controller = ref new MoveLookController(CoreWindow::GetForCurrentThread());
@@ -186,10 +197,20 @@ void GameMain::Run()
                 }
                 // otherwise fall through and do normal processing to get the rendering handled.
             default:
+                m_frameTimings.BeginFrame();
                 CoreWindow::GetForCurrentThread()->Dispatcher->ProcessEvents(CoreProcessEventsOption::ProcessAllIfPresent);
-                Update();
-                m_renderer->Render();
-                m_deviceResources->Present();
+                {
+                    ScopedFrameTimer timer(&m_frameTimings, FramePhase::Update);
+                    Update();
+                }
+                {
+                    ScopedFrameTimer timer(&m_frameTimings, FramePhase::Render);
+                    m_renderer->Render();
+                }
+                {
+                    ScopedFrameTimer timer(&m_frameTimings, FramePhase::Present);
+                    m_deviceResources->Present();
+                }
                 m_renderNeeded = false;
             }
         }
@@ -768,6 +789,25 @@ void GameMain::Suspend()
 
     m_controller->Active(false);
     m_game->OnSuspending();
+
+#if defined(_DEBUG)
+    ExportFrameTimings();
+#endif
+}
+
+//--------------------------------------------------------------------------------------
+
+void GameMain::ExportFrameTimings()
+{
+    // Write the recent frames to the app's local folder as CSV, and as a trace that can be
+    // loaded into chrome://tracing.
+    std::wstring folder(Windows::Storage::ApplicationData::Current->LocalFolder->Path->Data());
+
+    std::ofstream csv((folder + L"\\FrameTimings.csv").c_str());
+    m_frameTimings.WriteCsv(csv);
+
+    std::ofstream trace((folder + L"\\FrameTimings.json").c_str());
+    m_frameTimings.WriteTrace(trace);
 }
 
 //--------------------------------------------------------------------------------------
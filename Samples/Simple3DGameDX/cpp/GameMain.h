@@ -108,6 +108,7 @@ private:
     void UpdateLayoutState();
     void Update();
     void WaitingForResourceLoading();
+    void ExportFrameTimings();
 
 private:
     bool                                                m_windowClosed;
@@ -130,5 +131,7 @@ private:
     GameControl::GameInfoOverlayState                   m_gameInfoOverlayState;
     Simple3DGameDX::GameInfoOverlayCommand              m_gameInfoOverlayCommand;
     uint32                                              m_loadingCount;
+
+    FrameTimings                                        m_frameTimings;
 };
 
@@ -22,19 +22,47 @@
 #include "Sphere.h"
 #include "Cylinder.h"
 
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <string>
+
 using namespace concurrency;
 using namespace DirectX;
 using namespace Microsoft::WRL;
 using namespace Windows::UI::Core;
 using namespace Simple3DGameDX;
 
+namespace
+{
+    // Resources created by the asset pipeline.
+    struct VertexShaderAsset
+    {
+        ComPtr<ID3D11VertexShader>          shader;
+        ComPtr<ID3D11InputLayout>           layout;
+    };
+
+    struct PixelShaderAsset
+    {
+        ComPtr<ID3D11PixelShader>           shader;
+    };
+
+    struct TextureAsset
+    {
+        ComPtr<ID3D11ShaderResourceView>    view;
+    };
+}
+
 //----------------------------------------------------------------------
 
 GameRenderer::GameRenderer(const std::shared_ptr<DX::DeviceResources>& deviceResources) :
     m_deviceResources(deviceResources),
     m_initialized(false),
     m_gameResourcesLoaded(false),
-    m_levelResourcesLoaded(false)
+    m_levelResourcesLoaded(false),
+    m_instancingSupported(false),
+    m_instanceBufferCapacity(0),
+    m_frameTimings(nullptr)
 {
     m_gameHud = ref new GameHud(
         deviceResources,
@@ -49,6 +77,14 @@ GameRenderer::GameRenderer(const std::shared_ptr<DX::DeviceResources>& deviceRes
 
 //----------------------------------------------------------------------
 
+void GameRenderer::SetFrameTimings(_In_opt_ FrameTimings* timings, bool showOverlay)
+{
+    m_frameTimings = timings;
+    m_gameHud->ShowFrameTimings(showOverlay ? timings : nullptr);
+}
+
+//----------------------------------------------------------------------
+
 void GameRenderer::ReleaseDeviceDependentResources()
 {
     // On device lost all the device resources are invalid.
@@ -56,6 +92,10 @@ void GameRenderer::ReleaseDeviceDependentResources()
     // Simple3DGame object.  It will be reset as a part of the
     // game devices resources being recreated.
     m_game = nullptr;
+    m_gameAssets.clear();
+    m_assetPipeline = nullptr;
+    m_instanceBuffer = nullptr;
+    m_instanceBufferCapacity = 0;
     m_gameHud->ReleaseDeviceDependentResources();
     m_gameInfoOverlay->ReleaseDeviceDependentResources();
 }
@@ -202,16 +242,119 @@ task<void> GameRenderer::CreateGameDeviceResourcesAsync(_In_ Simple3DGame^ game)
         d3dDevice->CreateSamplerState(&sampDesc, &m_samplerLinear)
         );
 
-    // Start the async tasks to load the shaders and textures.
+    // Load the shaders and textures through the asset pipeline.  It reads the files on its own
+    // worker threads, most urgent first, and keeps the resources resident across levels.  Its
+    // resources belong to the device, so a new pipeline is created after the device is lost.
+    if (m_assetPipeline == nullptr)
+    {
+        BasicReaderWriter^ reader = ref new BasicReaderWriter();
+        m_assetPipeline.reset(new AssetPipeline(
+            [reader](const std::wstring& path, std::vector<uint8_t>& data)
+            {
+                // ReadData throws if the file cannot be read, which the pipeline treats as a failed read.
+                Platform::Array<byte>^ fileData = reader->ReadData(ref new Platform::String(path.c_str()));
+                data.assign(fileData->Data, fileData->Data + fileData->Length);
+                return true;
+            },
+            std::thread::hardware_concurrency()
+            ));
+    }
+
+    // Generate the meshes on background threads while the files load.  Meshes generated for an
+    // earlier device are still cached and are not generated again.
+    if (m_meshCache == nullptr)
+    {
+        m_meshCache.reset(new MeshCache());
+    }
+    m_meshCache->Request({
+        { MeshShape::Cylinder, GameConstants::MeshSegments },
+        { MeshShape::Sphere, GameConstants::MeshSegments },
+        { MeshShape::Face, 0 },
+        { MeshShape::WorldFloor, 0 },
+        { MeshShape::WorldCeiling, 0 },
+        { MeshShape::WorldWalls, 0 }
+        });
+
     BasicLoader^ loader = ref new BasicLoader(d3dDevice);
+    // The loads and the task below hold the pipeline, since a lost device releases
+    // m_assetPipeline while they may still be running.
+    std::shared_ptr<AssetPipeline> pipeline = m_assetPipeline;
+
+    auto loadVertexShader = [loader, pipeline](Platform::String^ filename, D3D11_INPUT_ELEMENT_DESC* layoutDesc, uint32 numElements)
+    {
+        AssetRequest request;
+        request.type = AssetType::VertexShader;
+        request.path = filename->Data();
+        request.variant = 0;
+        request.priority = AssetPriority::Critical;
+        request.create = [loader, filename, layoutDesc, numElements](std::vector<uint8_t>& data, const std::vector<AssetHandle>&)
+        {
+            auto shader = std::make_shared<VertexShaderAsset>();
+            loader->CreateShaderFromMemory(
+                filename,
+                data.data(),
+                static_cast<uint32>(data.size()),
+                layoutDesc,
+                numElements,
+                &shader->shader,
+                (layoutDesc == nullptr) ? nullptr : &shader->layout
+                );
+            return std::static_pointer_cast<void>(shader);
+        };
+        return pipeline->Load(request);
+    };
 
-    std::vector<task<void>> tasks;
+    auto loadPixelShader = [loader, pipeline](Platform::String^ filename)
+    {
+        AssetRequest request;
+        request.type = AssetType::PixelShader;
+        request.path = filename->Data();
+        request.variant = 0;
+        request.priority = AssetPriority::Critical;
+        request.create = [loader, filename](std::vector<uint8_t>& data, const std::vector<AssetHandle>&)
+        {
+            auto shader = std::make_shared<PixelShaderAsset>();
+            loader->CreateShaderFromMemory(filename, data.data(), static_cast<uint32>(data.size()), &shader->shader);
+            return std::static_pointer_cast<void>(shader);
+        };
+        return pipeline->Load(request);
+    };
+
+    auto loadTexture = [loader, pipeline](Platform::String^ filename)
+    {
+        AssetRequest request;
+        request.type = AssetType::Texture;
+        request.path = filename->Data();
+        request.variant = 0;
+        request.priority = AssetPriority::Critical;
+        request.create = [loader, filename](std::vector<uint8_t>& data, const std::vector<AssetHandle>&)
+        {
+            auto texture = std::make_shared<TextureAsset>();
+            loader->CreateTextureFromMemory(filename, data.data(), static_cast<uint32>(data.size()), nullptr, &texture->view);
+            return std::static_pointer_cast<void>(texture);
+        };
+        return pipeline->Load(request);
+    };
 
     uint32 numElements = ARRAYSIZE(PNTVertexLayout);
-    tasks.push_back(loader->LoadShaderAsync("VertexShader.cso", PNTVertexLayout, numElements, &m_vertexShader, &m_vertexLayout));
-    tasks.push_back(loader->LoadShaderAsync("VertexShaderFlat.cso", nullptr, numElements, &m_vertexShaderFlat, nullptr));
-    tasks.push_back(loader->LoadShaderAsync("PixelShader.cso", &m_pixelShader));
-    tasks.push_back(loader->LoadShaderAsync("PixelShaderFlat.cso", &m_pixelShaderFlat));
+    AssetHandle vertexShader = loadVertexShader("VertexShader.cso", PNTVertexLayout, numElements);
+    AssetHandle vertexShaderFlat = loadVertexShader("VertexShaderFlat.cso", nullptr, numElements);
+    AssetHandle pixelShader = loadPixelShader("PixelShader.cso");
+    AssetHandle pixelShaderFlat = loadPixelShader("PixelShaderFlat.cso");
+
+    // Instanced drawing needs feature level 9_3.  Below that every object is drawn on its own.
+    m_instancingSupported = m_deviceResources->GetDeviceFeatureLevel() >= D3D_FEATURE_LEVEL_9_3;
+    m_vertexShaderInstanced = nullptr;
+    m_vertexLayoutInstanced = nullptr;
+    AssetHandle vertexShaderInstanced;
+    if (m_instancingSupported)
+    {
+        vertexShaderInstanced = loadVertexShader(
+            "VertexShaderInstanced.cso",
+            PNTInstancedVertexLayout,
+            ARRAYSIZE(PNTInstancedVertexLayout)
+            );
+    }
 
     // Make sure the previous versions if any of the textures are released.
     m_sphereTexture = nullptr;
@@ -221,19 +364,65 @@ task<void> GameRenderer::CreateGameDeviceResourcesAsync(_In_ Simple3DGame^ game)
     m_wallsTexture = nullptr;
 
     // Load Game specific textures.
-    tasks.push_back(loader->LoadTextureAsync("Assets\\seafloor.dds", nullptr, &m_sphereTexture));
-    tasks.push_back(loader->LoadTextureAsync("Assets\\metal_texture.dds", nullptr, &m_cylinderTexture));
-    tasks.push_back(loader->LoadTextureAsync("Assets\\cellceiling.dds", nullptr, &m_ceilingTexture));
-    tasks.push_back(loader->LoadTextureAsync("Assets\\cellfloor.dds", nullptr, &m_floorTexture));
-    tasks.push_back(loader->LoadTextureAsync("Assets\\cellwall.dds", nullptr, &m_wallsTexture));
-    tasks.push_back(create_task([]()
+    AssetHandle sphereTexture = loadTexture("Assets\\seafloor.dds");
+    AssetHandle cylinderTexture = loadTexture("Assets\\metal_texture.dds");
+    AssetHandle ceilingTexture = loadTexture("Assets\\cellceiling.dds");
+    AssetHandle floorTexture = loadTexture("Assets\\cellfloor.dds");
+    AssetHandle wallsTexture = loadTexture("Assets\\cellwall.dds");
+
+    std::vector<AssetHandle> assets = {
+        vertexShader, vertexShaderFlat, pixelShader, pixelShaderFlat,
+        sphereTexture, cylinderTexture, ceilingTexture, floorTexture, wallsTexture
+    };
+    if (vertexShaderInstanced != nullptr)
     {
-        // Simulate loading additional resources by introducing a delay.
-        wait(GameConstants::InitialLoadingDelay);
-    }));
+        assets.push_back(vertexShaderInstanced);
+    }
+
+    // Holding the handles keeps the game assets resident when levels release theirs.
+    m_gameAssets = assets;
+
+    // Return a task that completes once every asset is ready.
+    return create_task([=]()
+    {
+        if (!pipeline->Wait(assets))
+        {
+            throw ref new Platform::FailureException();
+        }
 
-    // Return the task group of all the async tasks for loading the shader and texture assets.
-    return when_all(tasks.begin(), tasks.end());
+        m_vertexShader = vertexShader->Get<VertexShaderAsset>()->shader;
+        m_vertexLayout = vertexShader->Get<VertexShaderAsset>()->layout;
+        m_vertexShaderFlat = vertexShaderFlat->Get<VertexShaderAsset>()->shader;
+        m_pixelShader = pixelShader->Get<PixelShaderAsset>()->shader;
+        m_pixelShaderFlat = pixelShaderFlat->Get<PixelShaderAsset>()->shader;
+        if (vertexShaderInstanced != nullptr)
+        {
+            m_vertexShaderInstanced = vertexShaderInstanced->Get<VertexShaderAsset>()->shader;
+            m_vertexLayoutInstanced = vertexShaderInstanced->Get<VertexShaderAsset>()->layout;
+        }
+
+        m_sphereTexture = sphereTexture->Get<TextureAsset>()->view;
+        m_cylinderTexture = cylinderTexture->Get<TextureAsset>()->view;
+        m_ceilingTexture = ceilingTexture->Get<TextureAsset>()->view;
+        m_floorTexture = floorTexture->Get<TextureAsset>()->view;
+        m_wallsTexture = wallsTexture->Get<TextureAsset>()->view;
+
+#if defined(_DEBUG)
+        AssetPipelineStats stats = pipeline->GetStats();
+        wchar_t message[256];
+        swprintf_s(
+            message,
+            L"Game assets: %llu created, %llu shared, %llu bytes read; %.1f ms critical path, %.1f ms reading, %.1f ms creating\n",
+            stats.created,
+            stats.pathHits + stats.contentHits,
+            stats.bytesRead,
+            stats.criticalPath,
+            stats.readMilliseconds,
+            stats.createMilliseconds
+            );
+        OutputDebugStringW(message);
+#endif
+    });
 }
 
 //----------------------------------------------------------------------
@@ -279,9 +468,10 @@ void GameRenderer::FinalizeCreateGameDeviceResources()
         m_deviceResources->GetD2DDeviceContext()
         );
 
-    MeshObject^ cylinderMesh = ref new CylinderMesh(d3dDevice, 26);
-    MeshObject^ targetMesh = ref new FaceMesh(d3dDevice);
-    MeshObject^ sphereMesh = ref new SphereMesh(d3dDevice, 26);
+    MeshCache* meshes = m_meshCache.get();
+    MeshObject^ cylinderMesh = ref new CylinderMesh(d3dDevice, *meshes->Get(MeshShape::Cylinder, GameConstants::MeshSegments));
+    MeshObject^ targetMesh = ref new FaceMesh(d3dDevice, *meshes->Get(MeshShape::Face, 0));
+    MeshObject^ sphereMesh = ref new SphereMesh(d3dDevice, *meshes->Get(MeshShape::Sphere, GameConstants::MeshSegments));
 
     Material^ cylinderMaterial = ref new Material(
         XMFLOAT4(0.8f, 0.8f, 0.8f, .5f),
@@ -292,6 +482,7 @@ void GameRenderer::FinalizeCreateGameDeviceResources()
         m_vertexShader.Get(),
         m_pixelShader.Get()
         );
+    cylinderMaterial->SetInstancedVertexShader(m_vertexShaderInstanced.Get());
 
     Material^ sphereMaterial = ref new Material(
         XMFLOAT4(0.8f, 0.4f, 0.0f, 1.0f),
@@ -302,9 +493,51 @@ void GameRenderer::FinalizeCreateGameDeviceResources()
         m_vertexShader.Get(),
         m_pixelShader.Get()
         );
+    sphereMaterial->SetInstancedVertexShader(m_vertexShaderInstanced.Get());
 
     auto objects = m_game->RenderObjects();
 
+    // Draw all of the targets into one atlas shared by their materials, if it fits.  The
+    // atlas is saved in the local cache folder so that later launches can skip drawing it.
+    std::vector<std::wstring> targetNames;
+    for (auto object = objects.begin(); object != objects.end(); object++)
+    {
+        if (Face^ target = dynamic_cast<Face^>(*object))
+        {
+            std::wstring name = std::to_wstring(target->TargetId());
+            if (std::find(targetNames.begin(), targetNames.end(), name) == targetNames.end())
+            {
+                targetNames.push_back(name);
+            }
+        }
+    }
+
+    std::wstring atlasPath(Windows::Storage::ApplicationData::Current->LocalCacheFolder->Path->Data());
+    atlasPath += L"\\TargetAtlas.bin";
+
+    std::vector<uint8_t> cachedAtlas;
+    {
+        std::ifstream file(atlasPath.c_str(), std::ios::binary);
+        cachedAtlas.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    TargetAtlasLayout atlasLayout;
+    ComPtr<ID3D11ShaderResourceView> atlasTexture;
+    std::vector<uint8_t> atlasToCache;
+    bool useAtlas = !targetNames.empty() && textureGenerator->CreateAtlas(
+        targetNames,
+        m_deviceResources->GetDpi(),
+        cachedAtlas,
+        &atlasLayout,
+        &atlasTexture,
+        &atlasToCache
+        );
+    if (!atlasToCache.empty())
+    {
+        std::ofstream file(atlasPath.c_str(), std::ios::binary);
+        file.write(reinterpret_cast<const char*>(atlasToCache.data()), atlasToCache.size());
+    }
+
     // Attach the textures to the appropriate game objects.
     for (auto object = objects.begin(); object != objects.end(); object++)
     {
@@ -321,7 +554,7 @@ void GameRenderer::FinalizeCreateGameDeviceResources()
                     m_pixelShaderFlat.Get()
                     )
                 );
-            (*object)->Mesh(ref new WorldFloorMesh(d3dDevice));
+            (*object)->Mesh(ref new WorldFloorMesh(d3dDevice, *meshes->Get(MeshShape::WorldFloor, 0)));
         }
         else if ((*object)->TargetId() == GameConstants::WorldCeilingId)
         {
@@ -336,7 +569,7 @@ void GameRenderer::FinalizeCreateGameDeviceResources()
                     m_pixelShaderFlat.Get()
                     )
                 );
-            (*object)->Mesh(ref new WorldCeilingMesh(d3dDevice));
+            (*object)->Mesh(ref new WorldCeilingMesh(d3dDevice, *meshes->Get(MeshShape::WorldCeiling, 0)));
         }
         else if ((*object)->TargetId() == GameConstants::WorldWallsId)
         {
@@ -351,7 +584,7 @@ void GameRenderer::FinalizeCreateGameDeviceResources()
                     m_pixelShaderFlat.Get()
                     )
                 );
-            (*object)->Mesh(ref new WorldWallsMesh(d3dDevice));
+            (*object)->Mesh(ref new WorldWallsMesh(d3dDevice, *meshes->Get(MeshShape::WorldWalls, 0)));
         }
         else if (Cylinder^ cylinder = dynamic_cast<Cylinder^>(*object))
         {
@@ -365,8 +598,17 @@ void GameRenderer::FinalizeCreateGameDeviceResources()
             int len = swprintf_s(str, bufferLength, L"%d", target->TargetId());
             Platform::String^ string = ref new Platform::String(str, len);
 
+            size_t nameIndex = std::find(targetNames.begin(), targetNames.end(), std::wstring(str, len)) - targetNames.begin();
+
             ComPtr<ID3D11ShaderResourceView> texture;
-            textureGenerator->CreateTextureResourceView(string, &texture);
+            if (useAtlas)
+            {
+                texture = atlasTexture;
+            }
+            else
+            {
+                textureGenerator->CreateTextureResourceView(string, &texture);
+            }
             target->NormalMaterial(
                 ref new Material(
                     XMFLOAT4(0.8f, 0.8f, 0.8f, 0.5f),
@@ -378,8 +620,22 @@ void GameRenderer::FinalizeCreateGameDeviceResources()
                     m_pixelShader.Get()
                     )
                 );
+            if (useAtlas)
+            {
+                AtlasRegion region = atlasLayout.Region(atlasLayout.CellIndex(nameIndex, TargetVariant::Normal));
+                target->NormalMaterial()->SetTextureTransform(XMFLOAT4(region.scaleU, region.scaleV, region.offsetU, region.offsetV));
+            }
+
+            target->NormalMaterial()->SetInstancedVertexShader(m_vertexShaderInstanced.Get());
 
-            textureGenerator->CreateHitTextureResourceView(string, &texture);
+            if (useAtlas)
+            {
+                texture = atlasTexture;
+            }
+            else
+            {
+                textureGenerator->CreateHitTextureResourceView(string, &texture);
+            }
             target->HitMaterial(
                 ref new Material(
                     XMFLOAT4(0.8f, 0.8f, 0.8f, 0.5f),
@@ -391,6 +647,12 @@ void GameRenderer::FinalizeCreateGameDeviceResources()
                     m_pixelShader.Get()
                     )
                 );
+            if (useAtlas)
+            {
+                AtlasRegion region = atlasLayout.Region(atlasLayout.CellIndex(nameIndex, TargetVariant::Hit));
+                target->HitMaterial()->SetTextureTransform(XMFLOAT4(region.scaleU, region.scaleV, region.offsetU, region.offsetV));
+            }
+            target->HitMaterial()->SetInstancedVertexShader(m_vertexShaderInstanced.Get());
 
             target->Mesh(targetMesh);
         }
@@ -449,13 +711,15 @@ task<void> GameRenderer::LoadLevelResourcesAsync()
 {
     m_levelResourcesLoaded = false;
 
-    return create_task([this]()
+    // This is where level specific resources would be requested from m_assetPipeline with
+    // AssetPriority::Level, and the returned task would wait for them.  Assets the previous
+    // level used that nobody holds any more are released first; the game assets stay resident.
+    if (m_assetPipeline != nullptr)
     {
-        // This is where additional async loading of level specific resources
-        // would be done.  Since there aren't any to load, just simulate
-        // by delaying for some time.
-        wait(GameConstants::LevelLoadingDelay);
-    });
+        m_assetPipeline->ReleaseUnused();
+    }
+
+    return task_from_result();
 }
 
 //----------------------------------------------------------------------
@@ -484,6 +748,14 @@ void GameRenderer::Render()
         renderingPasses = 2;
     }
 
+    bool renderScene = m_game != nullptr && m_gameResourcesLoaded && m_levelResourcesLoaded;
+    if (renderScene)
+    {
+        // The visible set is the same for both eyes, so it is built and uploaded once per frame.
+        BuildRenderQueue(stereoEnabled);
+        UpdateInstanceBuffer();
+    }
+
     for (int i = 0; i < renderingPasses; i++)
     {
         // Iterate through the number of rendering passes to be completed.
@@ -506,7 +778,7 @@ void GameRenderer::Render()
             d2dContext->SetTarget(m_deviceResources->GetD2DTargetBitmap());
         }
 
-        if (m_game != nullptr && m_gameResourcesLoaded && m_levelResourcesLoaded)
+        if (renderScene)
         {
             // This section is only used after the game state has been initialized and all device
             // resources needed for the game have been created and associated with the game objects.
@@ -554,10 +826,10 @@ void GameRenderer::Render()
                 0
                 );
 
-            // Setup the graphics pipeline. This sample uses the same InputLayout and set of
-            // constant buffers for all shaders, so they only need to be set once per frame.
+            // Setup the graphics pipeline. This sample uses the same set of constant buffers
+            // for all shaders, so they only need to be set once per frame.  The input layout
+            // depends on whether a batch is instanced and is set by RenderQueuedObjects.
 
-            d3dContext->IASetInputLayout(m_vertexLayout.Get());
             d3dContext->VSSetConstantBuffers(0, 1, m_constantBufferNeverChanges.GetAddressOf());
             d3dContext->VSSetConstantBuffers(1, 1, m_constantBufferChangeOnResize.GetAddressOf());
             d3dContext->VSSetConstantBuffers(2, 1, m_constantBufferChangesEveryFrame.GetAddressOf());
@@ -567,11 +839,7 @@ void GameRenderer::Render()
             d3dContext->PSSetConstantBuffers(3, 1, m_constantBufferChangesEveryPrim.GetAddressOf());
             d3dContext->PSSetSamplers(0, 1, m_samplerLinear.GetAddressOf());
 
-            auto objects = m_game->RenderObjects();
-            for (auto object = objects.begin(); object != objects.end(); object++)
-            {
-                (*object)->Render(d3dContext, m_constantBufferChangesEveryPrim.Get());
-            }
+            RenderQueuedObjects(d3dContext);
         }
         else
         {
@@ -592,6 +860,8 @@ void GameRenderer::Render()
             }
         }
 
+        // The HUD phase covers the D2D drawing up to EndDraw, which flushes it to the GPU.
+        ScopedFrameTimer hudTimer(m_frameTimings, FramePhase::Hud);
         d3dContext->BeginEventInt(L"D2D BeginDraw", 1);
         d2dContext->BeginDraw();
 
@@ -625,6 +895,154 @@ void GameRenderer::Render()
 
 //----------------------------------------------------------------------
 
+void GameRenderer::BuildRenderQueue(bool stereoEnabled)
+{
+    auto objects = m_game->RenderObjects();
+
+    m_renderQueue.Clear();
+    m_renderQueue.Reserve(objects.size());
+
+    for (uint32 i = 0; i < objects.size(); i++)
+    {
+        GameObject^ object = objects[i];
+        MeshObject^ mesh = object->Mesh();
+
+        // Skip the same objects that GameObject::Render would skip.
+        if (!object->Active() || (mesh == nullptr) || (object->NormalMaterial() == nullptr))
+        {
+            continue;
+        }
+
+        Material^ material = object->CurrentMaterial();
+        bool instanced = m_instancingSupported && material->SupportsInstancing();
+
+        RenderQueueItem item;
+        item.sortKey = RenderQueue::MakeSortKey(instanced ? 1 : 0, material->SortId(), mesh->SortId());
+        item.objectIndex = i;
+        XMStoreFloat4x4(reinterpret_cast<XMFLOAT4X4*>(item.world), object->ModelMatrix());
+
+        XMFLOAT3 center = mesh->BoundingCenter();
+        RenderQueue::TransformBounds(
+            item.world,
+            &center.x,
+            mesh->BoundingRadius(),
+            item.boundsCenter,
+            &item.boundsRadius
+            );
+
+        m_renderQueue.Add(item);
+    }
+
+    // The shaders apply the view, then the orientation transform and then the projection,
+    // so the culling frusta are built from the same product.
+    auto camera = m_game->GameCamera();
+    auto orientation = m_deviceResources->GetOrientationTransform3D();
+    XMMATRIX viewOrientation = XMMatrixMultiply(camera->View(), XMLoadFloat4x4(&orientation));
+
+    RenderFrustum frusta[2];
+    size_t frustumCount = stereoEnabled ? 2 : 1;
+    for (size_t i = 0; i < frustumCount; i++)
+    {
+        XMMATRIX projection =
+            !stereoEnabled ? camera->Projection() :
+            (i == 0) ? camera->LeftEyeProjection() : camera->RightEyeProjection();
+
+        XMFLOAT4X4 viewProjection;
+        XMStoreFloat4x4(&viewProjection, XMMatrixMultiply(viewOrientation, projection));
+        RenderQueue::ExtractFrustum(&viewProjection._11, &frusta[i]);
+    }
+
+    m_renderQueue.Build(frusta, frustumCount);
+}
+
+//----------------------------------------------------------------------
+
+void GameRenderer::UpdateInstanceBuffer()
+{
+    uint32 instanceCount = m_renderQueue.InstanceCount();
+    if (!m_instancingSupported || instanceCount == 0)
+    {
+        return;
+    }
+
+    if (instanceCount > m_instanceBufferCapacity)
+    {
+        // Grow geometrically so the buffer is only recreated a few times as a level fills up.
+        m_instanceBufferCapacity = max(instanceCount, max(64u, m_instanceBufferCapacity * 2));
+
+        D3D11_BUFFER_DESC bd = {0};
+        bd.Usage = D3D11_USAGE_DYNAMIC;
+        bd.ByteWidth = RenderQueue::InstanceStride * m_instanceBufferCapacity;
+        bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+        bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+        m_instanceBuffer = nullptr;
+        DX::ThrowIfFailed(
+            m_deviceResources->GetD3DDevice()->CreateBuffer(&bd, nullptr, &m_instanceBuffer)
+            );
+    }
+
+    auto d3dContext = m_deviceResources->GetD3DDeviceContext();
+
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    DX::ThrowIfFailed(
+        d3dContext->Map(m_instanceBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)
+        );
+    memcpy(mapped.pData, m_renderQueue.InstanceData(), RenderQueue::InstanceStride * instanceCount);
+    d3dContext->Unmap(m_instanceBuffer.Get(), 0);
+}
+
+//----------------------------------------------------------------------
+
+void GameRenderer::RenderQueuedObjects(_In_ ID3D11DeviceContext* context)
+{
+    auto objects = m_game->RenderObjects();
+    const std::vector<uint32_t>& drawOrder = m_renderQueue.DrawOrder();
+
+    if (m_instanceBuffer != nullptr)
+    {
+        uint32 stride = RenderQueue::InstanceStride;
+        uint32 offset = 0;
+        context->IASetVertexBuffers(1, 1, m_instanceBuffer.GetAddressOf(), &stride, &offset);
+    }
+
+    ID3D11InputLayout* currentLayout = nullptr;
+    for (const RenderBatch& batch : m_renderQueue.Batches())
+    {
+        GameObject^ first = objects[drawOrder[batch.firstInstance]];
+        Material^ material = first->CurrentMaterial();
+
+        bool instanced = m_instancingSupported && material->SupportsInstancing();
+        ID3D11InputLayout* layout = instanced ? m_vertexLayoutInstanced.Get() : m_vertexLayout.Get();
+        if (layout != currentLayout)
+        {
+            context->IASetInputLayout(layout);
+            currentLayout = layout;
+        }
+
+        if (instanced)
+        {
+            // The instanced vertex shader ignores the world matrix in the constant buffer,
+            // so only the material properties need to be filled in.
+            ConstantBufferChangesEveryPrim constantBuffer = {};
+            XMStoreFloat4x4(&constantBuffer.worldMatrix, XMMatrixIdentity());
+            material->RenderSetupInstanced(context, &constantBuffer);
+            context->UpdateSubresource(m_constantBufferChangesEveryPrim.Get(), 0, nullptr, &constantBuffer, 0, 0);
+
+            first->Mesh()->RenderInstanced(context, batch.instanceCount, batch.firstInstance);
+        }
+        else
+        {
+            for (uint32 i = 0; i < batch.instanceCount; i++)
+            {
+                objects[drawOrder[batch.firstInstance + i]]->Render(context, m_constantBufferChangesEveryPrim.Get());
+            }
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+
 #if defined(_DEBUG)
 void GameRenderer::ReportLiveDeviceObjects()
 {
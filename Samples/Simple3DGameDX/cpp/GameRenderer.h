@@ -32,6 +32,13 @@
 //         transformation matrix as well as material properties like color and specular exponent for lighting
 //         calculations.
 //
+// Each frame the visible objects are collected into a RenderQueue, which culls them against
+// the view frustum (both eye frusta in stereo), sorts them by pipeline state and groups
+// objects that share a mesh and material into batches.  On feature level 9_3 and above
+// the batches of lit objects are drawn with one instanced draw each, taking their world
+// matrices from m_instanceBuffer instead of m_constantBufferChangesEveryPrim.  The queue
+// is built once per frame and replayed for each eye.
+//
 // The renderer also maintains a set of texture resources that will be associated with particular game objects.
 // It knows which textures are to be associated with which objects and will do that association once the
 // textures have been loaded.
@@ -39,7 +46,9 @@
 // The renderer provides a set of methods to allow for a "standard" sequence to be executed for loading general
 // game resources and for level specific resources.  Because D3D11 allows free threaded creation of objects,
 // textures will be loaded asynchronously and in parallel, however D3D11 does not allow for multiple threads to
-// be using the DeviceContext at the same time.
+// be using the DeviceContext at the same time.  Shaders and textures are loaded through an AssetPipeline,
+// which keeps them resident across levels and shares them between requests for the same file.  Meshes are
+// generated in parallel by a MeshCache; it only holds CPU data, so it survives the device being lost.
 //
 // The pattern is:
 //     create_task([this]()
@@ -55,6 +64,10 @@
 #include "GameInfoOverlay.h"
 #include "GameHud.h"
 #include "Simple3DGame.h"
+#include "RenderQueue.h"
+#include "AssetPipeline.h"
+#include "MeshGenerator.h"
+#include "FrameTimings.h"
 
 ref class Simple3DGame;
 ref class GameHud;
@@ -74,6 +87,9 @@ internal:
     concurrency::task<void> LoadLevelResourcesAsync();
     void FinalizeLoadLevelResources();
 
+    // Records the time spent drawing the HUD, and optionally shows the timings on it.
+    void SetFrameTimings(_In_opt_ FrameTimings* timings, bool showOverlay);
+
     Simple3DGameDX::IGameUIControl^ GameUIControl()  { return m_gameInfoOverlay; };
 
     DirectX::XMFLOAT2 GameInfoOverlayUpperLeft()
@@ -91,6 +107,10 @@ internal:
 #endif
 
 protected private:
+    void BuildRenderQueue(bool stereoEnabled);
+    void UpdateInstanceBuffer();
+    void RenderQueuedObjects(_In_ ID3D11DeviceContext* context);
+
     // Cached pointer to device resources.
     std::shared_ptr<DX::DeviceResources>                m_deviceResources;
 
@@ -120,4 +140,19 @@ protected private:
     Microsoft::WRL::ComPtr<ID3D11PixelShader>           m_pixelShader;
     Microsoft::WRL::ComPtr<ID3D11PixelShader>           m_pixelShaderFlat;
     Microsoft::WRL::ComPtr<ID3D11InputLayout>           m_vertexLayout;
+
+    // Instanced rendering
+    bool                                                m_instancingSupported;
+    Microsoft::WRL::ComPtr<ID3D11VertexShader>          m_vertexShaderInstanced;
+    Microsoft::WRL::ComPtr<ID3D11InputLayout>           m_vertexLayoutInstanced;
+    Microsoft::WRL::ComPtr<ID3D11Buffer>                m_instanceBuffer;
+    uint32                                              m_instanceBufferCapacity;
+    RenderQueue                                         m_renderQueue;
+
+    // Asset loading
+    std::shared_ptr<AssetPipeline>                      m_assetPipeline;
+    std::vector<AssetHandle>                            m_gameAssets;
+    std::unique_ptr<MeshCache>                          m_meshCache;
+
+    FrameTimings*                                       m_frameTimings;
 };
@@ -23,6 +23,7 @@
 #include "Cylinder.h"
 #include "Face.h"
 #include "MediaReader.h"
+#include "GameSnapshot.h"
 
 using namespace concurrency;
 using namespace DirectX;
@@ -42,7 +43,8 @@ Simple3DGame::Simple3DGame():
     m_levelBonusTime(0.0),
     m_levelTimeRemaining(0.0),
     m_levelCount(0),
-    m_currentLevel(0)
+    m_currentLevel(0),
+    m_frameTimings(nullptr)
 {
     m_topScore.totalHits = 0;
     m_topScore.totalShots = 0;
@@ -151,7 +153,18 @@ void Simple3DGame::Initialize(
     }
 
     MediaReader^ mediaReader = ref new MediaReader;
-    auto targetHitSound = mediaReader->LoadMedia("Assets\\hit.wav");
+    auto targetHitSound = mediaReader->LoadCachedMedia("Assets\\hit.wav");
+
+    // The impact sounds of all the objects share one pool of voices.  The mixer is created
+    // after the first sound is loaded, because loading sets the output format.
+    m_soundMixer = ref new SoundEffectMixer();
+    m_soundMixer->Initialize(
+        m_audioController->SoundEffectEngine(),
+        mediaReader->GetOutputWaveFormatEx(),
+        GameConstants::Sound::MaxVoices,
+        GameConstants::Sound::MaxDistance
+        );
+    uint32 targetHitSoundId = m_soundMixer->AddSound(targetHitSound);
 
     // Instantiate the targets for use in the game.
     // Each target has a different initial position, size and orientation,
@@ -200,11 +213,7 @@ void Simple3DGame::Initialize(
         target->TargetId(a);
         target->Active(true);
         target->HitSound(ref new SoundEffect());
-        target->HitSound()->Initialize(
-            m_audioController->SoundEffectEngine(),
-            mediaReader->GetOutputWaveFormatEx(),
-            targetHitSound
-            );
+        target->HitSound()->Initialize(m_soundMixer, targetHitSoundId);
 
         m_objects.push_back(target);
         m_renderObjects.push_back(target);
@@ -212,18 +221,15 @@ void Simple3DGame::Initialize(
 
     // Instantiate a set of spheres to be used as ammunition for the game
     // and set the material properties of the spheres.
-    auto ammoHitSound = mediaReader->LoadMedia("Assets\\bounce.wav");
+    auto ammoHitSound = mediaReader->LoadCachedMedia("Assets\\bounce.wav");
+    uint32 ammoHitSoundId = m_soundMixer->AddSound(ammoHitSound);
 
     for (int a = 0; a < GameConstants::MaxAmmo; a++)
     {
         m_ammo[a] = ref new Sphere;
         m_ammo[a]->Radius(GameConstants::AmmoRadius);
         m_ammo[a]->HitSound(ref new SoundEffect());
-        m_ammo[a]->HitSound()->Initialize(
-            m_audioController->SoundEffectEngine(),
-            mediaReader->GetOutputWaveFormatEx(),
-            ammoHitSound
-            );
+        m_ammo[a]->HitSound()->Initialize(m_soundMixer, ammoHitSoundId);
         m_ammo[a]->Active(false);
         m_renderObjects.push_back(m_ammo[a]);
     }
@@ -287,6 +293,7 @@ task<void> Simple3DGame::LoadLevelAsync()
 
     m_level[m_currentLevel]->Initialize(m_objects);
     m_levelDuration = m_level[m_currentLevel]->TimeLimit() + m_levelBonusTime;
+    BuildPathAnimations();
 
     return m_renderer->LoadLevelResourcesAsync();
 }
@@ -370,7 +377,13 @@ GameState Simple3DGame::RunGame()
         m_player->Velocity(m_controller->Velocity());
         m_camera->LookDirection(m_controller->LookDirection());
 
-        UpdateDynamics();
+        {
+            ScopedFrameTimer timer(m_frameTimings, FramePhase::Dynamics);
+            UpdateDynamics();
+        }
+
+        // The collisions queued their impact sounds; play them.
+        m_soundMixer->Submit(m_timer->DeltaTime());
 
         // Update the Camera with the player position updates from the dynamics calculations.
         m_camera->Eye(m_player->Position());
@@ -489,16 +502,41 @@ void Simple3DGame::UpdateDynamics()
     // Update the position of the object based on evaluating the animation object with the current time.
     // Once the current time (timeTotal) is past the end of the animation time remove
     // the animation object since it is no longer needed.
+    // The line list animations set up by the level are evaluated together in one pass first;
+    // any other animation, or one assigned after the level was loaded, is evaluated on its own.
+    m_pathAnimations.Evaluate(timeTotal);
+
     for (uint32 i = 0; i < m_objects.size(); i++)
     {
-        if (m_objects[i]->AnimatePosition())
+        Animate^ animation = m_objects[i]->AnimatePosition();
+        if (animation == nullptr)
         {
-            m_objects[i]->Position(m_objects[i]->AnimatePosition()->Evaluate(timeTotal));
-            if (m_objects[i]->AnimatePosition()->IsFinished(timeTotal))
+            continue;
+        }
+
+        int slot = (i < m_pathAnimationSlot.size()) ? m_pathAnimationSlot[i] : -1;
+        bool finished;
+        if (slot >= 0 && m_pathAnimationSources[slot] == animation)
+        {
+            XMFLOAT3 position;
+            m_pathAnimations.Position(slot, &position.x);
+            m_objects[i]->Position(position);
+            finished = m_pathAnimations.IsFinished(slot);
+            if (finished)
             {
-                m_objects[i]->AnimatePosition(nullptr);
+                m_pathAnimations.SetActive(slot, false);
             }
         }
+        else
+        {
+            m_objects[i]->Position(animation->Evaluate(timeTotal));
+            finished = animation->IsFinished(timeTotal);
+        }
+
+        if (finished)
+        {
+            m_objects[i]->AnimatePosition(nullptr);
+        }
     }
 #pragma endregion
 
@@ -506,10 +544,12 @@ void Simple3DGame::UpdateDynamics()
     // smaller time steps to avoid missing collisions.
     float timeLeft = timeFrame;
     float elapsedFrameTime;
+    uint32 physicsSteps = 0;
     while (timeLeft > 0.0f)
     {
         elapsedFrameTime = min(timeLeft, GameConstants::Physics::FrameLength);
         timeLeft -= elapsedFrameTime;
+        physicsSteps++;
 
         // Update the player position.
         m_player->Position(m_player->VectorPosition() + m_player->VectorVelocity() * elapsedFrameTime);
@@ -853,6 +893,41 @@ void Simple3DGame::UpdateDynamics()
         }
     }
 #pragma endregion
+
+    if (m_frameTimings != nullptr)
+    {
+        m_frameTimings->AddPhysicsSteps(physicsSteps);
+    }
+}
+
+//----------------------------------------------------------------------
+
+void Simple3DGame::BuildPathAnimations()
+{
+    // Collect the line list animations the level has assigned so UpdateDynamics can evaluate
+    // them in one pass instead of through a virtual call per object.  The timing is copied
+    // when the batch is built.
+    m_pathAnimations.Clear();
+    m_pathAnimationSources.clear();
+    m_pathAnimationSlot.assign(m_objects.size(), -1);
+
+    for (uint32 i = 0; i < m_objects.size(); i++)
+    {
+        AnimateLineListPosition^ animation = dynamic_cast<AnimateLineListPosition^>(m_objects[i]->AnimatePosition());
+        if (animation != nullptr)
+        {
+            m_pathAnimationSlot[i] = static_cast<int>(
+                m_pathAnimations.Add(
+                    animation->Path(),
+                    animation->Start(),
+                    animation->Duration(),
+                    animation->Continuous(),
+                    PathInterpolation::Linear
+                    )
+                );
+            m_pathAnimationSources.push_back(animation);
+        }
+    }
 }
 
 //----------------------------------------------------------------------
@@ -872,38 +947,39 @@ void Simple3DGame::SaveState()
     if (m_levelActive)
     {
         // The game is currently in the middle of a level, so save the extended state of
-        // the game.
-        m_savedState->SaveSingle(":LevelDuration", m_levelDuration);
-        m_savedState->SaveSingle(":LevelPlayingTime", m_timer->PlayingTime());
-
-        m_savedState->SaveInt32(":AmmoCount", m_ammoCount);
-        m_savedState->SaveInt32(":AmmoNext", m_ammoNext);
-
-        const int bufferLength = 16;
-        char16 str[bufferLength];
-
+        // the game.  The ammo and object state is written as one binary snapshot rather
+        // than a PersistentState entry per field, which keeps suspend fast as levels grow.
+        GameSnapshot snapshot;
+        snapshot.ammoNext = m_ammoNext;
+        snapshot.levelDuration = m_levelDuration;
+        snapshot.levelPlayingTime = m_timer->PlayingTime();
+
+        snapshot.ammo.Resize(m_ammoCount, true);
         for (uint32 i = 0; i < m_ammoCount; i++)
         {
-            int len = swprintf_s(str, bufferLength, L"%d", i);
-            Platform::String^ string = ref new Platform::String(str, len);
-
-            m_savedState->SaveBool(Platform::String::Concat(":AmmoActive", string), m_ammo[i]->Active());
-            m_savedState->SaveXMFLOAT3(Platform::String::Concat(":AmmoPosition", string), m_ammo[i]->Position());
-            m_savedState->SaveXMFLOAT3(Platform::String::Concat(":AmmoVelocity", string), m_ammo[i]->Velocity());
+            XMFLOAT3 position = m_ammo[i]->Position();
+            XMFLOAT3 velocity = m_ammo[i]->Velocity();
+            snapshot.ammo.Set(i, &position.x, &velocity.x, m_ammo[i]->Active() ? GameSnapshotFlags::Active : 0);
         }
 
-        m_savedState->SaveInt32(":ObjectCount", static_cast<int>(m_objects.size()));
-
+        snapshot.objects.Resize(m_objects.size(), false);
         for (uint32 i = 0; i < m_objects.size(); i++)
         {
-            int len = swprintf_s(str, bufferLength, L"%d", i);
-            Platform::String^ string = ref new Platform::String(str, len);
-
-            m_savedState->SaveBool(Platform::String::Concat(":ObjectActive", string), m_objects[i]->Active());
-            m_savedState->SaveBool(Platform::String::Concat(":ObjectTarget", string), m_objects[i]->Target());
-            m_savedState->SaveXMFLOAT3(Platform::String::Concat(":ObjectPosition", string), m_objects[i]->Position());
+            XMFLOAT3 position = m_objects[i]->Position();
+            uint8 flags = static_cast<uint8>(
+                (m_objects[i]->Active() ? GameSnapshotFlags::Active : 0) |
+                (m_objects[i]->Target() ? GameSnapshotFlags::Target : 0)
+                );
+            snapshot.objects.Set(i, &position.x, nullptr, flags);
         }
 
+        std::vector<uint8_t> blob;
+        GameSnapshotCodec::Encode(snapshot, true, blob);
+        m_savedState->SaveBytes(
+            ":LevelSnapshot",
+            ref new Platform::Array<byte>(blob.data(), static_cast<unsigned int>(blob.size()))
+            );
+
         m_level[m_currentLevel]->SaveState(m_savedState);
     }
 }
@@ -912,6 +988,13 @@ void Simple3DGame::SaveState()
 
 void Simple3DGame::LoadState()
 {
+    // Earlier versions saved the ammo and objects as one value per field. They are now part
+    // of the level snapshot, so remove the old values.
+    m_savedState->RemoveKeys(":LevelDuration");
+    m_savedState->RemoveKeys(":LevelPlayingTime");
+    m_savedState->RemoveKeys(":Ammo");
+    m_savedState->RemoveKeys(":Object");
+
     m_gameActive = m_savedState->LoadBool(":GameActive", m_gameActive);
     m_levelActive = m_savedState->LoadBool(":LevelActive", m_levelActive);
 
@@ -955,80 +1038,51 @@ void Simple3DGame::SetCurrentLevelToSavedState()
     {
         if (m_levelActive)
         {
-            // Middle of a level so restart where left off.
-            m_levelDuration = m_savedState->LoadSingle(":LevelDuration", 0.0f);
-
-            m_timer->Reset();
-            m_timer->PlayingTime(m_savedState->LoadSingle(":LevelPlayingTime", 0.0f));
+            // Middle of a level so restart where left off.  A missing or unreadable snapshot
+            // restarts the level with no ammo in flight and the objects where the level placed them.
+            GameSnapshot snapshot = {};
+            Platform::Array<byte>^ blob = m_savedState->LoadBytes(":LevelSnapshot");
+            if (blob == nullptr ||
+                GameSnapshotCodec::Decode(blob->Data, blob->Length, snapshot) != GameSnapshotResult::Success)
+            {
+                snapshot = GameSnapshot();
+            }
 
-            m_ammoCount = m_savedState->LoadInt32(":AmmoCount", 0);
+            m_levelDuration = snapshot.levelDuration;
 
-            m_ammoNext = m_savedState->LoadInt32(":AmmoNext", 0);
+            m_timer->Reset();
+            m_timer->PlayingTime(snapshot.levelPlayingTime);
 
-            const int bufferLength = 16;
-            char16 str[bufferLength];
+            m_ammoCount = min(static_cast<uint32>(snapshot.ammo.Count()), static_cast<uint32>(m_ammo.size()));
+            m_ammoNext = snapshot.ammoNext;
 
             for (uint32 i = 0; i < m_ammoCount; i++)
             {
-                int len = swprintf_s(str, bufferLength, L"%d", i);
-                Platform::String^ string = ref new Platform::String(str, len);
-
-                m_ammo[i]->Active(
-                    m_savedState->LoadBool(
-                        Platform::String::Concat(":AmmoActive", string),
-                        m_ammo[i]->Active()
-                        )
-                    );
+                m_ammo[i]->Active((snapshot.ammo.flags[i] & GameSnapshotFlags::Active) != 0);
                 if (m_ammo[i]->Active())
                 {
                     m_ammo[i]->OnGround(false);
                 }
 
-                m_ammo[i]->Position(
-                    m_savedState->LoadXMFLOAT3(
-                        Platform::String::Concat(":AmmoPosition", string),
-                        m_ammo[i]->Position()
-                        )
-                    );
-
-                m_ammo[i]->Velocity(
-                    m_savedState->LoadXMFLOAT3(
-                        Platform::String::Concat(":AmmoVelocity", string),
-                        m_ammo[i]->Velocity()
-                        )
-                    );
-            }
-
-            int storedObjectCount = 0;
-            storedObjectCount = m_savedState->LoadInt32(":ObjectCount", 0);
+                const float* position = snapshot.ammo.Position(i);
+                m_ammo[i]->Position(XMFLOAT3(position[0], position[1], position[2]));
 
-            storedObjectCount = min(storedObjectCount, static_cast<int>(m_objects.size()));
+                if (snapshot.ammo.HasVelocities())
+                {
+                    const float* velocity = snapshot.ammo.Velocity(i);
+                    m_ammo[i]->Velocity(XMFLOAT3(velocity[0], velocity[1], velocity[2]));
+                }
+            }
 
-            for (int i = 0; i < storedObjectCount; i++)
+            uint32 storedObjectCount = min(static_cast<uint32>(snapshot.objects.Count()), static_cast<uint32>(m_objects.size()));
+            for (uint32 i = 0; i < storedObjectCount; i++)
             {
-                int len = swprintf_s(str, bufferLength, L"%d", i);
-                Platform::String^ string = ref new Platform::String(str, len);
-
-                m_objects[i]->Active(
-                    m_savedState->LoadBool(
-                        Platform::String::Concat(":ObjectActive", string),
-                        m_objects[i]->Active()
-                        )
-                    );
-
-                m_objects[i]->Target(
-                    m_savedState->LoadBool(
-                        Platform::String::Concat(":ObjectTarget", string),
-                        m_objects[i]->Target()
-                        )
-                    );
-
-                m_objects[i]->Position(
-                    m_savedState->LoadXMFLOAT3(
-                        Platform::String::Concat(":ObjectPosition", string),
-                        m_objects[i]->Position()
-                        )
-                    );
+                uint8 flags = snapshot.objects.flags[i];
+                m_objects[i]->Active((flags & GameSnapshotFlags::Active) != 0);
+                m_objects[i]->Target((flags & GameSnapshotFlags::Target) != 0);
+
+                const float* position = snapshot.objects.Position(i);
+                m_objects[i]->Position(XMFLOAT3(position[0], position[1], position[2]));
             }
 
             m_level[m_currentLevel]->LoadState(m_savedState);
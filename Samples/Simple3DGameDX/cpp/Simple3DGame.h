@@ -31,6 +31,7 @@
 
 #include "GameConstants.h"
 #include "Audio.h"
+#include "SoundEffectMixer.h"
 #include "Camera.h"
 #include "Level.h"
 #include "GameObject.h"
@@ -39,6 +40,7 @@
 #include "PersistentState.h"
 #include "Sphere.h"
 #include "GameRenderer.h"
+#include "FrameTimings.h"
 
 //--------------------------------------------------------------------------------------
 
@@ -87,6 +89,9 @@ internal:
     void OnSuspending();
     void OnResuming();
 
+    // Optional; UpdateDynamics records its duration and physics sub-steps here.
+    void SetFrameTimings(_In_opt_ FrameTimings* timings) { m_frameTimings = timings; };
+
     bool IsActivePlay()                         { return m_timer->Active(); }
     int LevelCompleted()                        { return m_currentLevel; };
     int TotalShots()                            { return m_totalShots; };
@@ -107,12 +112,14 @@ private:
     void LoadHighScore();
     void InitializeAmmo();
     void UpdateDynamics();
+    void BuildPathAnimations();
 
     MoveLookController^                         m_controller;
     GameRenderer^                               m_renderer;
     Camera^                                     m_camera;
 
     Audio^                                      m_audioController;
+    SoundEffectMixer^                           m_soundMixer;
 
     std::vector<Sphere^>                        m_ammo;
     uint32                                      m_ammoCount;
@@ -137,7 +144,14 @@ private:
     std::vector<GameObject^>                    m_objects;           // List of all objects to be included in intersection calculations.
     std::vector<GameObject^>                    m_renderObjects;     // List of all objects to be rendered.
 
+    // Line list animations of m_objects, evaluated together in UpdateDynamics.
+    PathAnimationBatch                          m_pathAnimations;
+    std::vector<Animate^>                       m_pathAnimationSources;  // Animation behind each batch entry.
+    std::vector<int>                            m_pathAnimationSlot;     // Batch entry per object, or -1.
+
     DirectX::XMFLOAT3                           m_minBound;
     DirectX::XMFLOAT3                           m_maxBound;
+
+    FrameTimings*                               m_frameTimings;
 };
 
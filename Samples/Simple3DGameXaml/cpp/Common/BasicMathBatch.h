@@ -0,0 +1,158 @@
+//// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+//// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+//// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+//// PARTICULAR PURPOSE.
+////
+//// Copyright (c) Microsoft Corporation. All rights reserved
+
+#pragma once
+
+#include "BasicMath.h"
+#include <stddef.h>
+
+// This header defines batch versions of the BasicMath vector operations for
+// working on whole vertex arrays instead of one vertex at a time.
+//
+// The pack operations work on eight vectors held in structure-of-arrays packs.
+// The array operations read ordinary vertex arrays and change them to that
+// layout in registers, four or eight vectors at a time.  Each operation runs on
+// AVX2 or SSE2 when the processor supports it and falls back to plain C++
+// otherwise; the path is picked once, on first use.  All paths
+// perform the same operations in the same order without fused multiply-add, so
+// they produce the same results as each other and as the scalar operators in
+// BasicMath.h.
+//
+// Matrices follow the BasicMath convention: vectors are columns, so a point is
+// transformed as mul(m, p) and translation lives in _14, _24 and _34.
+
+// Structure of Arrays Vector Packs
+
+struct float3x8
+{
+    float x[8];
+    float y[8];
+    float z[8];
+};
+
+struct float4x8
+{
+    float x[8];
+    float y[8];
+    float z[8];
+    float w[8];
+};
+
+// Instruction Set Selection
+
+enum class BatchMathPath
+{
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+// Returns the path used by the batch operations.
+BatchMathPath batchMathPath();
+
+// Returns the fastest path the processor supports.
+BatchMathPath supportedBatchMathPath();
+
+// Selects a path, e.g. to compare results or timings between paths.  Requests
+// for a path the processor does not support select the best supported one.
+void setBatchMathPath(BatchMathPath path);
+
+// Single Vector Transforms
+
+// Transforms a point (w = 1) without dividing by the resulting w.
+inline float3 transformPoint(const float4x4& m, float3 p)
+{
+    return float3(
+        m._11 * p.x + m._12 * p.y + m._13 * p.z + m._14,
+        m._21 * p.x + m._22 * p.y + m._23 * p.z + m._24,
+        m._31 * p.x + m._32 * p.y + m._33 * p.z + m._34
+        );
+}
+
+// Transforms a direction (w = 0).  Normals need the inverse transpose of the
+// matrix when it contains a non-uniform scale.
+inline float3 transformNormal(const float4x4& m, float3 n)
+{
+    return float3(
+        m._11 * n.x + m._12 * n.y + m._13 * n.z,
+        m._21 * n.x + m._22 * n.y + m._23 * n.z,
+        m._31 * n.x + m._32 * n.y + m._33 * n.z
+        );
+}
+
+inline float4 transform(const float4x4& m, float4 v)
+{
+    return float4(
+        m._11 * v.x + m._12 * v.y + m._13 * v.z + m._14 * v.w,
+        m._21 * v.x + m._22 * v.y + m._23 * v.z + m._24 * v.w,
+        m._31 * v.x + m._32 * v.y + m._33 * v.z + m._34 * v.w,
+        m._41 * v.x + m._42 * v.y + m._43 * v.z + m._44 * v.w
+        );
+}
+
+// Pack Conversions
+//
+// The strides are in bytes so that a pack can be filled from one field of a
+// vertex structure, e.g. &vertices[0].pos with a stride of sizeof(BasicVertex).
+// count is at most 8; the lanes past count are set to zero on load and are not
+// written on store.
+
+void load(float3x8& pack, const float3* v, size_t stride, size_t count);
+void store(const float3x8& pack, float3* v, size_t stride, size_t count);
+void load(float4x8& pack, const float4* v, size_t stride, size_t count);
+void store(const float4x8& pack, float4* v, size_t stride, size_t count);
+
+// Pack Operations
+
+void dot(const float3x8& a, const float3x8& b, float out[8]);
+float3x8 cross(const float3x8& a, const float3x8& b);
+
+// Like normalize(), a zero length vector results in NaNs.
+float3x8 normalize(const float3x8& a);
+
+float3x8 transformPoint(const float4x4& m, const float3x8& p);
+float3x8 transformNormal(const float4x4& m, const float3x8& n);
+float4x8 transform(const float4x4& m, const float4x8& v);
+
+// Array Operations
+//
+// The output may be the same array as an input, as long as it uses the same
+// stride.
+
+void transformPoints(
+    const float4x4& m,
+    const float3* in,
+    size_t inStride,
+    float3* out,
+    size_t outStride,
+    size_t count
+    );
+
+void transformNormals(
+    const float4x4& m,
+    const float3* in,
+    size_t inStride,
+    float3* out,
+    size_t outStride,
+    size_t count
+    );
+
+void transformArray(const float4x4& m, const float4* in, float4* out, size_t count);
+
+void normalizeArray(
+    const float3* in,
+    size_t inStride,
+    float3* out,
+    size_t outStride,
+    size_t count
+    );
+
+void dotArray(const float3* a, const float3* b, float* out, size_t count);
+void crossArray(const float3* a, const float3* b, float3* out, size_t count);
+
+// out[i] = mul(m, in[i]), e.g. to append a parent transform to many children.
+void mulArray(const float4x4& m, const float4x4* in, float4x4* out, size_t count);
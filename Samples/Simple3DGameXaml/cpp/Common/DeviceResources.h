@@ -41,6 +41,7 @@ namespace DX
         Windows::Foundation::Size GetOutputSize() const                     { return m_outputSize; }
         Windows::Foundation::Size GetLogicalSize() const                    { return m_logicalSize; }
         Windows::Foundation::Size GetRenderTargetSize() const               { return m_d3dRenderTargetSize; }
+        float                   GetDpi() const                              { return m_dpi; }
         bool                    GetStereoState() const                      { return m_stereoEnabled; }
         Windows::UI::Xaml::Controls::SwapChainPanel^ GetSwapChainPanel() const { return m_swapChainPanel; }
 
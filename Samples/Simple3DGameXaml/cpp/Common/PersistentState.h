@@ -23,14 +23,24 @@ internal:
     void SaveSingle(Platform::String^ key, float value);
     void SaveXMFLOAT3(Platform::String^ key, DirectX::XMFLOAT3 value);
     void SaveString(Platform::String^ key, Platform::String^ string);
+    void SaveBytes(Platform::String^ key, const Platform::Array<byte>^ bytes);
 
     bool LoadBool(Platform::String^ key, bool defaultValue);
     int  LoadInt32(Platform::String^ key, int defaultValue);
     float LoadSingle(Platform::String^ key, float defaultValue);
     DirectX::XMFLOAT3 LoadXMFLOAT3(Platform::String^ key, DirectX::XMFLOAT3 defaultValue);
     Platform::String^ LoadString(Platform::String^ key, Platform::String^ defaultValue);
+    Platform::Array<byte>^ LoadBytes(Platform::String^ key);
+
+    void RemoveKeys(Platform::String^ keyPrefix);
 
 private:
+    // LocalSettings holds at most 8KB in each value, so byte arrays are stored in parts.
+    static const unsigned int BytesPerPart = 4096;
+
+    Platform::String^ GetPartKey(Platform::String^ fullKey, unsigned int part);
+    int LoadPartCount(Platform::String^ fullKey);
+
     Platform::String^ m_keyName;
     Windows::Foundation::Collections::IPropertySet^ m_settingsValues;
 };
@@ -23,12 +23,37 @@
 #include "Cylinder.h"
 #include "windows.ui.xaml.media.dxinterop.h"
 
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <string>
+
 using namespace concurrency;
 using namespace DirectX;
 using namespace Microsoft::WRL;
 using namespace Windows::UI::Core;
 using namespace Windows::UI::Xaml::Controls;
 
+namespace
+{
+    // Resources created by the asset pipeline.
+    struct VertexShaderAsset
+    {
+        ComPtr<ID3D11VertexShader>          shader;
+        ComPtr<ID3D11InputLayout>           layout;
+    };
+
+    struct PixelShaderAsset
+    {
+        ComPtr<ID3D11PixelShader>           shader;
+    };
+
+    struct TextureAsset
+    {
+        ComPtr<ID3D11ShaderResourceView>    view;
+    };
+}
+
 //----------------------------------------------------------------------
 
 GameRenderer::GameRenderer(const std::shared_ptr<DX::DeviceResources>& deviceResources) :
@@ -57,6 +82,8 @@ void GameRenderer::ReleaseDeviceDependentResources()
     // Simple3DGame object.  It will be reset as a part of the
     // game devices resources being recreated.
     m_game = nullptr;
+    m_gameAssets.clear();
+    m_assetPipeline = nullptr;
     m_gameHud->ReleaseDeviceDependentResources();
 }
 
@@ -165,16 +192,105 @@ task<void> GameRenderer::CreateGameDeviceResourcesAsync(_In_ Simple3DGame^ game)
         d3dDevice->CreateSamplerState(&sampDesc, &m_samplerLinear)
         );
 
-    // Start the async tasks to load the shaders and textures.
+    // Load the shaders and textures through the asset pipeline.  It reads the files on its own
+    // worker threads, most urgent first, and keeps the resources resident across levels.  Its
+    // resources belong to the device, so a new pipeline is created after the device is lost.
+    if (m_assetPipeline == nullptr)
+    {
+        BasicReaderWriter^ reader = ref new BasicReaderWriter();
+        m_assetPipeline.reset(new AssetPipeline(
+            [reader](const std::wstring& path, std::vector<uint8_t>& data)
+            {
+                // ReadData throws if the file cannot be read, which the pipeline treats as a failed read.
+                Platform::Array<byte>^ fileData = reader->ReadData(ref new Platform::String(path.c_str()));
+                data.assign(fileData->Data, fileData->Data + fileData->Length);
+                return true;
+            },
+            std::thread::hardware_concurrency()
+            ));
+    }
+
+    // Generate the meshes on background threads while the files load.  Meshes generated for an
+    // earlier device are still cached and are not generated again.
+    if (m_meshCache == nullptr)
+    {
+        m_meshCache.reset(new MeshCache());
+    }
+    m_meshCache->Request({
+        { MeshShape::Cylinder, GameConstants::MeshSegments },
+        { MeshShape::Sphere, GameConstants::MeshSegments },
+        { MeshShape::Face, 0 },
+        { MeshShape::WorldFloor, 0 },
+        { MeshShape::WorldCeiling, 0 },
+        { MeshShape::WorldWalls, 0 }
+        });
+
     BasicLoader^ loader = ref new BasicLoader(d3dDevice);
+    // The loads and the task below hold the pipeline, since a lost device releases
+    // m_assetPipeline while they may still be running.
+    std::shared_ptr<AssetPipeline> pipeline = m_assetPipeline;
+
+    auto loadVertexShader = [loader, pipeline](Platform::String^ filename, D3D11_INPUT_ELEMENT_DESC* layoutDesc, uint32 numElements)
+    {
+        AssetRequest request;
+        request.type = AssetType::VertexShader;
+        request.path = filename->Data();
+        request.variant = 0;
+        request.priority = AssetPriority::Critical;
+        request.create = [loader, filename, layoutDesc, numElements](std::vector<uint8_t>& data, const std::vector<AssetHandle>&)
+        {
+            auto shader = std::make_shared<VertexShaderAsset>();
+            loader->CreateShaderFromMemory(
+                filename,
+                data.data(),
+                static_cast<uint32>(data.size()),
+                layoutDesc,
+                numElements,
+                &shader->shader,
+                (layoutDesc == nullptr) ? nullptr : &shader->layout
+                );
+            return std::static_pointer_cast<void>(shader);
+        };
+        return pipeline->Load(request);
+    };
 
-    std::vector<task<void>> tasks;
+    auto loadPixelShader = [loader, pipeline](Platform::String^ filename)
+    {
+        AssetRequest request;
+        request.type = AssetType::PixelShader;
+        request.path = filename->Data();
+        request.variant = 0;
+        request.priority = AssetPriority::Critical;
+        request.create = [loader, filename](std::vector<uint8_t>& data, const std::vector<AssetHandle>&)
+        {
+            auto shader = std::make_shared<PixelShaderAsset>();
+            loader->CreateShaderFromMemory(filename, data.data(), static_cast<uint32>(data.size()), &shader->shader);
+            return std::static_pointer_cast<void>(shader);
+        };
+        return pipeline->Load(request);
+    };
+
+    auto loadTexture = [loader, pipeline](Platform::String^ filename)
+    {
+        AssetRequest request;
+        request.type = AssetType::Texture;
+        request.path = filename->Data();
+        request.variant = 0;
+        request.priority = AssetPriority::Critical;
+        request.create = [loader, filename](std::vector<uint8_t>& data, const std::vector<AssetHandle>&)
+        {
+            auto texture = std::make_shared<TextureAsset>();
+            loader->CreateTextureFromMemory(filename, data.data(), static_cast<uint32>(data.size()), nullptr, &texture->view);
+            return std::static_pointer_cast<void>(texture);
+        };
+        return pipeline->Load(request);
+    };
 
     uint32 numElements = ARRAYSIZE(PNTVertexLayout);
-    tasks.push_back(loader->LoadShaderAsync("VertexShader.cso", PNTVertexLayout, numElements, &m_vertexShader, &m_vertexLayout));
-    tasks.push_back(loader->LoadShaderAsync("VertexShaderFlat.cso", nullptr, numElements, &m_vertexShaderFlat, nullptr));
-    tasks.push_back(loader->LoadShaderAsync("PixelShader.cso", &m_pixelShader));
-    tasks.push_back(loader->LoadShaderAsync("PixelShaderFlat.cso", &m_pixelShaderFlat));
+    AssetHandle vertexShader = loadVertexShader("VertexShader.cso", PNTVertexLayout, numElements);
+    AssetHandle vertexShaderFlat = loadVertexShader("VertexShaderFlat.cso", nullptr, numElements);
+    AssetHandle pixelShader = loadPixelShader("PixelShader.cso");
+    AssetHandle pixelShaderFlat = loadPixelShader("PixelShaderFlat.cso");
 
     // Make sure the previous versions if any of the textures are released.
     m_sphereTexture = nullptr;
@@ -186,26 +302,73 @@ task<void> GameRenderer::CreateGameDeviceResourcesAsync(_In_ Simple3DGame^ game)
         m_wallsTexture[i] = nullptr;
     }
 
-    // Load Game specific textures.
-    tasks.push_back(loader->LoadTextureAsync("Assets\\seafloor.dds", nullptr, &m_sphereTexture));
-    tasks.push_back(loader->LoadTextureAsync("Assets\\metal_texture.dds", nullptr, &m_cylinderTexture));
-    tasks.push_back(loader->LoadTextureAsync("Assets\\cellceiling.dds", nullptr, &m_ceilingTexture[0]));
-    tasks.push_back(loader->LoadTextureAsync("Assets\\cellfloor.dds", nullptr, &m_floorTexture[0]));
-    tasks.push_back(loader->LoadTextureAsync("Assets\\cellwall.dds", nullptr, &m_wallsTexture[0]));
-    tasks.push_back(loader->LoadTextureAsync("Assets\\nightwall.dds", nullptr, &m_ceilingTexture[1]));
-    tasks.push_back(loader->LoadTextureAsync("Assets\\nightfloor.dds", nullptr, &m_floorTexture[1]));
-    tasks.push_back(loader->LoadTextureAsync("Assets\\nightwall.dds", nullptr, &m_wallsTexture[1]));
-    tasks.push_back(loader->LoadTextureAsync("Assets\\daywall.dds", nullptr, &m_ceilingTexture[2]));
-    tasks.push_back(loader->LoadTextureAsync("Assets\\dayfloor.dds", nullptr, &m_floorTexture[2]));
-    tasks.push_back(loader->LoadTextureAsync("Assets\\daywall.dds", nullptr, &m_wallsTexture[2]));
-    tasks.push_back(create_task([]()
+    // Load Game specific textures.  The night and day walls are also used for the ceiling;
+    // the pipeline loads each file once.
+    AssetHandle sphereTexture = loadTexture("Assets\\seafloor.dds");
+    AssetHandle cylinderTexture = loadTexture("Assets\\metal_texture.dds");
+    AssetHandle ceilingTexture[GameConstants::MaxBackgroundTextures] = {
+        loadTexture("Assets\\cellceiling.dds"),
+        loadTexture("Assets\\nightwall.dds"),
+        loadTexture("Assets\\daywall.dds")
+    };
+    AssetHandle floorTexture[GameConstants::MaxBackgroundTextures] = {
+        loadTexture("Assets\\cellfloor.dds"),
+        loadTexture("Assets\\nightfloor.dds"),
+        loadTexture("Assets\\dayfloor.dds")
+    };
+    AssetHandle wallsTexture[GameConstants::MaxBackgroundTextures] = {
+        loadTexture("Assets\\cellwall.dds"),
+        loadTexture("Assets\\nightwall.dds"),
+        loadTexture("Assets\\daywall.dds")
+    };
+
+    std::vector<AssetHandle> assets = { vertexShader, vertexShaderFlat, pixelShader, pixelShaderFlat, sphereTexture, cylinderTexture };
+    assets.insert(assets.end(), ceilingTexture, ceilingTexture + GameConstants::MaxBackgroundTextures);
+    assets.insert(assets.end(), floorTexture, floorTexture + GameConstants::MaxBackgroundTextures);
+    assets.insert(assets.end(), wallsTexture, wallsTexture + GameConstants::MaxBackgroundTextures);
+
+    // Holding the handles keeps the game assets resident when levels release theirs.
+    m_gameAssets = assets;
+
+    // Return a task that completes once every asset is ready.
+    return create_task([=]()
     {
-        // Simulate loading additional resources by introducing a delay.
-        wait(GameConstants::InitialLoadingDelay);
-    }));
+        if (!pipeline->Wait(assets))
+        {
+            throw ref new Platform::FailureException();
+        }
 
-    // Return the task group of all the async tasks for loading the shader and texture assets.
-    return when_all(tasks.begin(), tasks.end());
+        m_vertexShader = vertexShader->Get<VertexShaderAsset>()->shader;
+        m_vertexLayout = vertexShader->Get<VertexShaderAsset>()->layout;
+        m_vertexShaderFlat = vertexShaderFlat->Get<VertexShaderAsset>()->shader;
+        m_pixelShader = pixelShader->Get<PixelShaderAsset>()->shader;
+        m_pixelShaderFlat = pixelShaderFlat->Get<PixelShaderAsset>()->shader;
+
+        m_sphereTexture = sphereTexture->Get<TextureAsset>()->view;
+        m_cylinderTexture = cylinderTexture->Get<TextureAsset>()->view;
+        for (uint32 i = 0; i < GameConstants::MaxBackgroundTextures; i++)
+        {
+            m_ceilingTexture[i] = ceilingTexture[i]->Get<TextureAsset>()->view;
+            m_floorTexture[i] = floorTexture[i]->Get<TextureAsset>()->view;
+            m_wallsTexture[i] = wallsTexture[i]->Get<TextureAsset>()->view;
+        }
+
+#if defined(_DEBUG)
+        AssetPipelineStats stats = pipeline->GetStats();
+        wchar_t message[256];
+        swprintf_s(
+            message,
+            L"Game assets: %llu created, %llu shared, %llu bytes read; %.1f ms critical path, %.1f ms reading, %.1f ms creating\n",
+            stats.created,
+            stats.pathHits + stats.contentHits,
+            stats.bytesRead,
+            stats.criticalPath,
+            stats.readMilliseconds,
+            stats.createMilliseconds
+            );
+        OutputDebugStringW(message);
+#endif
+    });
 }
 
 //----------------------------------------------------------------------
@@ -251,9 +414,10 @@ void GameRenderer::FinalizeCreateGameDeviceResources()
         m_deviceResources->GetD2DDeviceContext()
         );
 
-    MeshObject^ cylinderMesh = ref new CylinderMesh(d3dDevice, 26);
-    MeshObject^ targetMesh = ref new FaceMesh(d3dDevice);
-    MeshObject^ sphereMesh = ref new SphereMesh(d3dDevice, 26);
+    MeshCache* meshes = m_meshCache.get();
+    MeshObject^ cylinderMesh = ref new CylinderMesh(d3dDevice, *meshes->Get(MeshShape::Cylinder, GameConstants::MeshSegments));
+    MeshObject^ targetMesh = ref new FaceMesh(d3dDevice, *meshes->Get(MeshShape::Face, 0));
+    MeshObject^ sphereMesh = ref new SphereMesh(d3dDevice, *meshes->Get(MeshShape::Sphere, GameConstants::MeshSegments));
 
     Material^ cylinderMaterial = ref new Material(
         XMFLOAT4(0.8f, 0.8f, 0.8f, .5f),
@@ -277,6 +441,47 @@ void GameRenderer::FinalizeCreateGameDeviceResources()
 
     auto objects = m_game->RenderObjects();
 
+    // Draw all of the targets into one atlas shared by their materials, if it fits.  The
+    // atlas is saved in the local cache folder so that later launches can skip drawing it.
+    std::vector<std::wstring> targetNames;
+    for (auto object = objects.begin(); object != objects.end(); object++)
+    {
+        if (Face^ target = dynamic_cast<Face^>(*object))
+        {
+            std::wstring name = std::to_wstring(target->TargetId());
+            if (std::find(targetNames.begin(), targetNames.end(), name) == targetNames.end())
+            {
+                targetNames.push_back(name);
+            }
+        }
+    }
+
+    std::wstring atlasPath(Windows::Storage::ApplicationData::Current->LocalCacheFolder->Path->Data());
+    atlasPath += L"\\TargetAtlas.bin";
+
+    std::vector<uint8_t> cachedAtlas;
+    {
+        std::ifstream file(atlasPath.c_str(), std::ios::binary);
+        cachedAtlas.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    TargetAtlasLayout atlasLayout;
+    ComPtr<ID3D11ShaderResourceView> atlasTexture;
+    std::vector<uint8_t> atlasToCache;
+    bool useAtlas = !targetNames.empty() && textureGenerator->CreateAtlas(
+        targetNames,
+        m_deviceResources->GetDpi(),
+        cachedAtlas,
+        &atlasLayout,
+        &atlasTexture,
+        &atlasToCache
+        );
+    if (!atlasToCache.empty())
+    {
+        std::ofstream file(atlasPath.c_str(), std::ios::binary);
+        file.write(reinterpret_cast<const char*>(atlasToCache.data()), atlasToCache.size());
+    }
+
     // Attach the textures to the appropriate game objects.
     for (auto object = objects.begin(); object != objects.end(); object++)
     {
@@ -293,7 +498,7 @@ void GameRenderer::FinalizeCreateGameDeviceResources()
                     m_pixelShaderFlat.Get()
                     )
                 );
-            (*object)->Mesh(ref new WorldFloorMesh(d3dDevice));
+            (*object)->Mesh(ref new WorldFloorMesh(d3dDevice, *meshes->Get(MeshShape::WorldFloor, 0)));
         }
         else if ((*object)->TargetId() == GameConstants::WorldCeilingId)
         {
@@ -308,7 +513,7 @@ void GameRenderer::FinalizeCreateGameDeviceResources()
                     m_pixelShaderFlat.Get()
                     )
                 );
-            (*object)->Mesh(ref new WorldCeilingMesh(d3dDevice));
+            (*object)->Mesh(ref new WorldCeilingMesh(d3dDevice, *meshes->Get(MeshShape::WorldCeiling, 0)));
         }
         else if ((*object)->TargetId() == GameConstants::WorldWallsId)
         {
@@ -323,7 +528,7 @@ void GameRenderer::FinalizeCreateGameDeviceResources()
                     m_pixelShaderFlat.Get()
                     )
                 );
-            (*object)->Mesh(ref new WorldWallsMesh(d3dDevice));
+            (*object)->Mesh(ref new WorldWallsMesh(d3dDevice, *meshes->Get(MeshShape::WorldWalls, 0)));
         }
         else if (Cylinder^ cylinder = dynamic_cast<Cylinder^>(*object))
         {
@@ -337,8 +542,17 @@ void GameRenderer::FinalizeCreateGameDeviceResources()
             int len = swprintf_s(str, bufferLength, L"%d", target->TargetId());
             Platform::String^ string = ref new Platform::String(str, len);
 
+            size_t nameIndex = std::find(targetNames.begin(), targetNames.end(), std::wstring(str, len)) - targetNames.begin();
+
             ComPtr<ID3D11ShaderResourceView> texture;
-            textureGenerator->CreateTextureResourceView(string, &texture);
+            if (useAtlas)
+            {
+                texture = atlasTexture;
+            }
+            else
+            {
+                textureGenerator->CreateTextureResourceView(string, &texture);
+            }
             target->NormalMaterial(
                 ref new Material(
                     XMFLOAT4(0.8f, 0.8f, 0.8f, 0.5f),
@@ -350,8 +564,20 @@ void GameRenderer::FinalizeCreateGameDeviceResources()
                     m_pixelShader.Get()
                     )
                 );
+            if (useAtlas)
+            {
+                AtlasRegion region = atlasLayout.Region(atlasLayout.CellIndex(nameIndex, TargetVariant::Normal));
+                target->NormalMaterial()->SetTextureTransform(XMFLOAT4(region.scaleU, region.scaleV, region.offsetU, region.offsetV));
+            }
 
-            textureGenerator->CreateHitTextureResourceView(string, &texture);
+            if (useAtlas)
+            {
+                texture = atlasTexture;
+            }
+            else
+            {
+                textureGenerator->CreateHitTextureResourceView(string, &texture);
+            }
             target->HitMaterial(
                 ref new Material(
                     XMFLOAT4(0.8f, 0.8f, 0.8f, 0.5f),
@@ -363,6 +589,11 @@ void GameRenderer::FinalizeCreateGameDeviceResources()
                     m_pixelShader.Get()
                     )
                 );
+            if (useAtlas)
+            {
+                AtlasRegion region = atlasLayout.Region(atlasLayout.CellIndex(nameIndex, TargetVariant::Hit));
+                target->HitMaterial()->SetTextureTransform(XMFLOAT4(region.scaleU, region.scaleV, region.offsetU, region.offsetV));
+            }
 
             target->Mesh(targetMesh);
         }
@@ -421,13 +652,15 @@ task<void> GameRenderer::LoadLevelResourcesAsync()
 {
     m_levelResourcesLoaded = false;
 
-    return create_task([this]()
+    // This is where level specific resources would be requested from m_assetPipeline with
+    // AssetPriority::Level, and the returned task would wait for them.  Assets the previous
+    // level used that nobody holds any more are released first; the game assets stay resident.
+    if (m_assetPipeline != nullptr)
     {
-        // This is where additional async loading of level specific resources
-        // would be done.  Since there aren't any to load, just simulate
-        // by delaying for some time.
-        wait(GameConstants::LevelLoadingDelay);
-    });
+        m_assetPipeline->ReleaseUnused();
+    }
+
+    return task_from_result();
 }
 
 //----------------------------------------------------------------------
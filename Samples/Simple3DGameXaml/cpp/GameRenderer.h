@@ -39,7 +39,9 @@
 // The renderer provides a set of methods to allow for a "standard" sequence to be executed for loading general
 // game resources and for level specific resources.  Because D3D11 allows free threaded creation of objects,
 // textures will be loaded asynchronously and in parallel, however D3D11 does not allow for multiple threads to
-// be using the DeviceContext at the same time.
+// be using the DeviceContext at the same time.  Shaders and textures are loaded through an AssetPipeline,
+// which keeps them resident across levels and shares them between requests for the same file.  Meshes are
+// generated in parallel by a MeshCache; it only holds CPU data, so it survives the device being lost.
 //
 // The pattern is:
 //     create_task([this]()
@@ -53,6 +55,8 @@
 #include "DeviceResources.h"
 #include "GameHud.h"
 #include "Simple3DGame.h"
+#include "AssetPipeline.h"
+#include "MeshGenerator.h"
 
 ref class Simple3DGame;
 ref class GameHud;
@@ -107,4 +111,9 @@ protected private:
     Microsoft::WRL::ComPtr<ID3D11PixelShader>           m_pixelShader;
     Microsoft::WRL::ComPtr<ID3D11PixelShader>           m_pixelShaderFlat;
     Microsoft::WRL::ComPtr<ID3D11InputLayout>           m_vertexLayout;
+
+    // Asset loading
+    std::shared_ptr<AssetPipeline>                      m_assetPipeline;
+    std::vector<AssetHandle>                            m_gameAssets;
+    std::unique_ptr<MeshCache>                          m_meshCache;
 };
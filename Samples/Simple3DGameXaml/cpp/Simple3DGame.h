@@ -32,6 +32,7 @@
 #include "GameConstants.h"
 #include "GameUIConstants.h"
 #include "Audio.h"
+#include "SoundEffectMixer.h"
 #include "Camera.h"
 #include "Level.h"
 #include "GameObject.h"
@@ -121,6 +122,7 @@ private:
     void LoadHighScore();
     void InitializeAmmo();
     void UpdateDynamics();
+    void BuildPathAnimations();
     void InitializeGameConfig();
 
     MoveLookController^                         m_controller;
@@ -128,6 +130,7 @@ private:
     Camera^                                     m_camera;
 
     Audio^                                      m_audioController;
+    SoundEffectMixer^                           m_soundMixer;
 
     std::vector<Sphere^>                        m_ammo;
     uint32                                      m_ammoCount;
@@ -155,6 +158,11 @@ private:
     std::vector<GameObject^>                    m_objects;           // List of all objects to be included in intersection calculations.
     std::vector<GameObject^>                    m_renderObjects;     // List of all objects to be rendered.
 
+    // Line list animations of m_objects, evaluated together in UpdateDynamics.
+    PathAnimationBatch                          m_pathAnimations;
+    std::vector<Animate^>                       m_pathAnimationSources;  // Animation behind each batch entry.
+    std::vector<int>                            m_pathAnimationSlot;     // Batch entry per object, or -1.
+
     DirectX::XMFLOAT3                           m_minBound;
     DirectX::XMFLOAT3                           m_maxBound;
 };
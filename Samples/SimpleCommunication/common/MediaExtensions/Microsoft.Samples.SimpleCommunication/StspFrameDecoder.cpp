@@ -0,0 +1,103 @@
+//// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+//// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+//// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+//// PARTICULAR PURPOSE.
+////
+//// Copyright (c) Microsoft Corporation. All rights reserved
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "StspFrameDecoder.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace Microsoft::Samples::SimpleCommunication;
+
+CStspFrameDecoder::CStspFrameDecoder(uint32_t cbMaxPayload, uint32_t operationLimit)
+: _cbMaxPayload(cbMaxPayload)
+, _operationLimit(operationLimit)
+{
+    Reset();
+}
+
+bool CStspFrameDecoder::Feed(const uint8_t *pData, size_t cbData, IStspFrameHandler &handler)
+{
+    while (_state != State_Failed && cbData > 0)
+    {
+        if (_state == State_Header)
+        {
+            size_t cbCopy = std::min<size_t>(c_cbStspFrameHeaderSize - _cbHeader, cbData);
+            memcpy(_headerBytes + _cbHeader, pData, cbCopy);
+            _cbHeader += static_cast<uint32_t>(cbCopy);
+            pData += cbCopy;
+            cbData -= cbCopy;
+
+            if (_cbHeader < c_cbStspFrameHeaderSize)
+            {
+                break;
+            }
+
+            _cbHeader = 0;
+            memcpy(&_header, _headerBytes, sizeof(_header));
+            if (_header.cbDataSize > _cbMaxPayload || _header.operation >= _operationLimit)
+            {
+                _state = State_Failed;
+                break;
+            }
+
+            if (_header.cbDataSize == 0)
+            {
+                CompleteFrame(handler);
+                continue;
+            }
+
+            _pPayload = handler.OnFrameHeader(_header);
+            if (_pPayload == nullptr)
+            {
+                _heldPayload.resize(_header.cbDataSize);
+                _pPayload = _heldPayload.data();
+            }
+
+            _cbPayload = 0;
+            _state = State_Payload;
+        }
+        else
+        {
+            size_t cbCopy = std::min<size_t>(_header.cbDataSize - _cbPayload, cbData);
+            memcpy(_pPayload + _cbPayload, pData, cbCopy);
+            _cbPayload += static_cast<uint32_t>(cbCopy);
+            pData += cbCopy;
+            cbData -= cbCopy;
+
+            if (_cbPayload == _header.cbDataSize)
+            {
+                CompleteFrame(handler);
+            }
+        }
+    }
+
+    return _state != State_Failed;
+}
+
+void CStspFrameDecoder::Reset()
+{
+    _state = State_Header;
+    _cbHeader = 0;
+    _header.cbDataSize = 0;
+    _header.operation = 0;
+    _pPayload = nullptr;
+    _cbPayload = 0;
+    _cFrames = 0;
+}
+
+void CStspFrameDecoder::CompleteFrame(IStspFrameHandler &handler)
+{
+    // Get ready for the next header first, so a handler that throws leaves the decoder usable.
+    StspFrameHeader header = _header;
+    const uint8_t *pPayload = _pPayload;
+    _state = State_Header;
+    _pPayload = nullptr;
+    _cFrames++;
+
+    handler.OnFrame(header, pPayload);
+}
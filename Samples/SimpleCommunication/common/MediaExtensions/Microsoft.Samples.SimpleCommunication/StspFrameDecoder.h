@@ -0,0 +1,85 @@
+//// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+//// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+//// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+//// PARTICULAR PURPOSE.
+////
+//// Copyright (c) Microsoft Corporation. All rights reserved
+
+#pragma once
+
+// Incremental decoder for the STSP stream the server sends to the media source. This file only
+// depends on the C++ standard library.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Microsoft { namespace Samples { namespace SimpleCommunication {
+
+// Same layout as StspOperationHeader, which leads every operation on the wire.
+struct StspFrameHeader
+{
+    uint32_t cbDataSize;
+    uint32_t operation;
+};
+
+const uint32_t c_cbStspFrameHeaderSize = sizeof(StspFrameHeader);
+
+// Receives the frames found by CStspFrameDecoder.
+class IStspFrameHandler
+{
+public:
+    // Called once the header of a frame with a payload has been read. Returns where the payload
+    // should be written (header.cbDataSize bytes), or nullptr to have the decoder keep it.
+    virtual uint8_t *OnFrameHeader(const StspFrameHeader &header) = 0;
+
+    // Called once the whole payload has arrived. pPayload is the buffer returned from
+    // OnFrameHeader, the decoder's copy, or nullptr if the frame has no payload.
+    virtual void OnFrame(const StspFrameHeader &header, const uint8_t *pPayload) = 0;
+
+protected:
+    ~IStspFrameHandler() {}
+};
+
+// Splits a byte stream into STSP frames. Data can be fed in pieces of any size, split anywhere;
+// each call works through every frame the new data completes, one after another. A header with
+// an unknown operation or an oversized payload puts the decoder in a failed state, and it rejects
+// everything after that until Reset.
+class CStspFrameDecoder
+{
+public:
+    CStspFrameDecoder(uint32_t cbMaxPayload, uint32_t operationLimit);
+
+    // Returns false if the stream is malformed. Exceptions thrown by the handler propagate, and
+    // the decoder is left waiting for the next frame header.
+    bool Feed(const uint8_t *pData, size_t cbData, IStspFrameHandler &handler);
+
+    void Reset();
+
+    bool IsFailed() const { return _state == State_Failed; }
+    uint64_t GetFrameCount() const { return _cFrames; }
+
+private:
+    enum State
+    {
+        State_Header,
+        State_Payload,
+        State_Failed,
+    };
+
+    void CompleteFrame(IStspFrameHandler &handler);
+
+    uint32_t                _cbMaxPayload;
+    uint32_t                _operationLimit;
+
+    State                   _state;
+    uint8_t                 _headerBytes[c_cbStspFrameHeaderSize];
+    uint32_t                _cbHeader;                  // Header bytes received so far
+    StspFrameHeader         _header;
+    uint8_t                 *_pPayload;                 // Where the payload is being written
+    uint32_t                _cbPayload;                 // Payload bytes received so far
+    std::vector<uint8_t>    _heldPayload;               // Used when the handler has no buffer to offer
+    uint64_t                _cFrames;
+};
+
+}}} // namespace Microsoft::Samples::SimpleCommunication
@@ -15,10 +15,12 @@ using namespace Microsoft::Samples::SimpleCommunication::Network;
 
 namespace
 {
-    const DWORD c_cbReceiveBufferSize = 2 * 1024;
+    const DWORD c_cbReceiveBufferSize = 64 * 1024;
     const DWORD c_cbMaxPacketSize = 1024 * 1024;
 };
 
+static_assert(sizeof(StspOperationHeader) == c_cbStspFrameHeaderSize, "The frame decoder reads operation headers as StspFrameHeader");
+
 CSourceOperation::CSourceOperation(CSourceOperation::Type opType)
 : _cRef(1)
 , _opType(opType)
@@ -83,9 +85,11 @@ CMediaSource::CMediaSource(void)
 , _cRef(1)
 , _eSourceState(SourceState_Invalid)
 , _serverPort(0)
+, _nNextReceiveBuffer(0)
+, _fReceivePending(false)
+, _frameDecoder(c_cbMaxPacketSize, StspOperation_Last)
 , _flRate(1.0f)
 {
-    ZeroMemory(&_CurrentReceivedOperationHeader, sizeof(_CurrentReceivedOperationHeader));
 }
 
 CMediaSource::~CMediaSource(void)
@@ -348,6 +352,11 @@ IFACEMETHODIMP CMediaSource::Shutdown()
 
         _spEventQueue.Reset();
         _networkSender = nullptr;
+
+        // A read still in progress holds on to its own buffer.
+        _spReceiveBuffers[0].Reset();
+        _spReceiveBuffers[1].Reset();
+        _spFramePayload.Reset();
     }
 
     TRACEHR_RET(hr);
@@ -736,7 +745,7 @@ concurrency::task<void> CMediaSource::SendRequestAsync(StspOperation eOperation)
 // Sending request for media description to the server
 void CMediaSource::SendDescribeRequest()
 {
-    _CurrentReceivedOperationHeader.eOperation = StspOperation_Unknown;
+    _frameDecoder.Reset();
     ComPtr<CMediaSource> spThis = this;
     SendRequestAsync(StspOperation_ClientRequestDescription).then([this, spThis](concurrency::task<void>& task)
     {
@@ -763,7 +772,6 @@ void CMediaSource::SendDescribeRequest()
 
 void CMediaSource::SendStartRequest()
 {
-    _CurrentReceivedOperationHeader.eOperation = StspOperation_Unknown;
     ComPtr<CMediaSource> spThis = this;
     SendRequestAsync(StspOperation_ClientRequestStart).then([this, spThis](concurrency::task<void>& task)
     {
@@ -789,28 +797,42 @@ void CMediaSource::SendStartRequest()
 void CMediaSource::Receive()
 {
     // We already during receive operation
-    if (_spCurrentReceiveBuffer)
+    if (_fReceivePending)
     {
         Throw(MF_E_INVALIDREQUEST);
     }
 
-    ComPtr<IMediaBufferWrapper> spBuffer;
-    ThrowIfError(CreateMediaBufferWrapper(c_cbReceiveBufferSize, &spBuffer));
+    // The receive buffers are used in turn. The one picked here was parsed completely before
+    // this read could be started, so it can be reused as is.
+    ComPtr<IMediaBufferWrapper> &spNextBuffer = _spReceiveBuffers[_nNextReceiveBuffer];
+    if (spNextBuffer == nullptr)
+    {
+        ThrowIfError(CreateMediaBufferWrapper(c_cbReceiveBufferSize, &spNextBuffer));
+    }
+    else
+    {
+        ThrowIfError(spNextBuffer->Reset());
+    }
+
+    ComPtr<IMediaBufferWrapper> spBuffer = spNextBuffer;
+    _nNextReceiveBuffer = (_nNextReceiveBuffer + 1) % _countof(_spReceiveBuffers);
 
     ComPtr<CMediaSource> spThis = this;
-    concurrency::create_task(_networkSender->ReceiveAsync(spBuffer.Get())).then([this, spThis](concurrency::task<void>& task)
+    concurrency::create_task(_networkSender->ReceiveAsync(spBuffer.Get())).then([this, spThis, spBuffer](concurrency::task<void>& task)
     {
         AutoLock lock(_critSec);
         try
         {
+            _fReceivePending = false;
             task.get();
 
             ThrowIfError(CheckShutdown());
 
-            ParseCurrentBuffer();
-
-            // Continue receiving
+            // Start reading into the other buffer before parsing this one, so the socket is
+            // not left idle while operations are processed.
             Receive();
+
+            ParseReceivedBuffer(spBuffer.Get());
         }
         catch(Exception ^exc)
         {
@@ -818,79 +840,54 @@ void CMediaSource::Receive()
         }
      });
 
-    _spCurrentReceiveBuffer = spBuffer;
+    _fReceivePending = true;
 }
 
-// Parse data stored in current receive buffer
-void CMediaSource::ParseCurrentBuffer()
+// Parse data stored in a receive buffer
+void CMediaSource::ParseReceivedBuffer(IMediaBufferWrapper *pBuffer)
 {
-    bool fCompletePackage = false;
-    DWORD cbTotalLength = 0;
-    // Remember the buffer
-    ComPtr<IMediaBufferWrapper> spLastBuffer = _spCurrentReceiveBuffer;
+    DWORD cbCurrentLength = 0;
+    ThrowIfError(pBuffer->GetCurrentLength(&cbCurrentLength));
 
-    if (_spCurrentReceivePacket == nullptr)
+    // Every operation completed by this data is dispatched from inside Feed.
+    if (!_frameDecoder.Feed(pBuffer->GetBuffer(), cbCurrentLength, *this))
     {
-        // If packet object storing current operation data is not created yet - create it.
-        ThrowIfError(CreateBufferPacket(&_spCurrentReceivePacket));
+        // Packet size is too large or operation is not recognized
+        Throw(MF_E_UNSUPPORTED_FORMAT);
     }
+}
 
-    // Add current receive buffer to the packet.
-    ThrowIfError(_spCurrentReceivePacket->AddBuffer(_spCurrentReceiveBuffer.Get()));
-    _spCurrentReceiveBuffer.Reset();
-
-    // Parsing new package, we have't read operation just yet
-    if (_CurrentReceivedOperationHeader.eOperation == StspOperation_Unknown)
-    {
-        DWORD cbCurrentLength;
-        ThrowIfError(_spCurrentReceivePacket->GetTotalLength(&cbCurrentLength));
+// Operation payloads are received into a buffer of their own rather than into the receive
+// buffers, because the samples created from them keep referencing that memory.
+uint8_t *CMediaSource::OnFrameHeader(const StspFrameHeader &header)
+{
+    _spFramePayload.Reset();
+    ThrowIfError(CreateMediaBufferWrapper(header.cbDataSize, &_spFramePayload));
 
-        // Check if we have enough data to retrieve operation header
-        if(cbCurrentLength >= sizeof(StspOperationHeader))
-        {
-            ThrowIfError(_spCurrentReceivePacket->MoveLeft(sizeof(_CurrentReceivedOperationHeader), &_CurrentReceivedOperationHeader));
-        }
-        else
-        {
-            // We don't have enough data just yet so set data size to maximum packet size (then we will pass validation performed later on)
-            _CurrentReceivedOperationHeader.cbDataSize = c_cbMaxPacketSize;
-        }
-    }
+    return _spFramePayload->GetBuffer();
+}
 
-    // Get length of the packet (without operation header which was removed from the packet).
-    ThrowIfError(_spCurrentReceivePacket->GetTotalLength(&cbTotalLength)); 
+void CMediaSource::OnFrame(const StspFrameHeader &header, const uint8_t *pPayload)
+{
+    ComPtr<IBufferPacket> spPacket;
+    ThrowIfError(CreateBufferPacket(&spPacket));
 
-    if (// packet size is too large
-        (c_cbMaxPacketSize < _CurrentReceivedOperationHeader.cbDataSize ||
-        // Unrecognized operation
-        _CurrentReceivedOperationHeader.eOperation >= StspOperation_Last))
+    if (header.cbDataSize > 0)
     {
-        Throw(MF_E_UNSUPPORTED_FORMAT);
-    }
+        ComPtr<IMediaBufferWrapper> spPayload;
+        spPayload.Swap(_spFramePayload);
+        assert(spPayload != nullptr && spPayload->GetBuffer() == pPayload);
 
-    if (// Size of the package already exceeded value described in operation header
-        cbTotalLength > _CurrentReceivedOperationHeader.cbDataSize)
-    {
-        // Trim the right edge of the packet and get buffer representing trimmed data
-        ThrowIfError(spLastBuffer->TrimRight(cbTotalLength - _CurrentReceivedOperationHeader.cbDataSize, &_spCurrentReceiveBuffer));
-        // Fix total length
-        cbTotalLength = _CurrentReceivedOperationHeader.cbDataSize;
+        ThrowIfError(spPayload->SetCurrentLength(header.cbDataSize));
+        ThrowIfError(spPacket->AddBuffer(spPayload.Get()));
     }
 
-    // We've got a whole packet
-    if (cbTotalLength == _CurrentReceivedOperationHeader.cbDataSize)
-    {
-        // Process packet payload
-        ProcessPacket(&_CurrentReceivedOperationHeader, _spCurrentReceivePacket.Get());
-        _spCurrentReceivePacket.Reset();
-        _CurrentReceivedOperationHeader.eOperation =  StspOperation_Unknown;
-    }
+    StspOperationHeader opHeader;
+    opHeader.cbDataSize = header.cbDataSize;
+    opHeader.eOperation = static_cast<StspOperation>(header.operation);
 
-    if (_spCurrentReceiveBuffer)
-    {
-        // We've got a buffer which was left from TrimRight operation above, we can keep parsing.
-        ParseCurrentBuffer();
-    }
+    // Process packet payload
+    ProcessPacket(&opHeader, spPacket.Get());
 }
 
 void CMediaSource::ProcessPacket(StspOperationHeader *pOpHeader, IBufferPacket *pPacket)
@@ -12,6 +12,7 @@
 #include <BaseAttributes.h>
 #include <StspNetwork.h>
 #include <StspDefs.h>
+#include <StspFrameDecoder.h>
 
 namespace Microsoft { namespace Samples { namespace SimpleCommunication {
 
@@ -82,7 +83,8 @@ class CMediaSource :
     public IMFMediaSource,
     public IMFGetService,
     public IMFRateControl,
-    public Microsoft::Samples::Common::CBaseAttributes<>
+    public Microsoft::Samples::Common::CBaseAttributes<>,
+    public IStspFrameHandler
 {
 public:
     static HRESULT CreateInstance(CMediaSource **ppNetSource);
@@ -117,6 +119,10 @@ public:
     IFACEMETHOD (SetRate) (BOOL fThin, float flRate);        
     IFACEMETHOD (GetRate) (_Inout_opt_ BOOL *pfThin, _Inout_opt_ float *pflRate);
 
+    // IStspFrameHandler
+    __override uint8_t *OnFrameHeader(const StspFrameHeader &header);
+    __override void OnFrame(const StspFrameHeader &header, const uint8_t *pPayload);
+
     // OpQueue
     __override HRESULT DispatchOperation(_In_ CSourceOperation *pOp);
     __override HRESULT ValidateOperation(_In_ CSourceOperation *pOp);
@@ -148,7 +154,7 @@ private:
     void SendDescribeRequest();
     void SendStartRequest();
     void Receive();
-    void ParseCurrentBuffer();
+    void ParseReceivedBuffer(Network::IMediaBufferWrapper *pBuffer);
     void ProcessPacket(StspOperationHeader *pOpHeader, Network::IBufferPacket *pPacket);
     void ProcessServerDescription(Network::IBufferPacket *pPacket);
     void ProcessServerSample(Network::IBufferPacket *pPacket);
@@ -185,9 +191,11 @@ private:
     String^                     _serverAddress;             // Address of a server
     WORD                        _serverPort;                // Port of a server
     
-    ComPtr<Network::IBufferPacket> _spCurrentReceivePacket;    // Receive packet
-    ComPtr<Network::IMediaBufferWrapper> _spCurrentReceiveBuffer;    // Current buffer 
-    StspOperationHeader         _CurrentReceivedOperationHeader; // Header of the operation currently being received from the server.
+    ComPtr<Network::IMediaBufferWrapper> _spReceiveBuffers[2];  // Receive buffers, filled in turn and reused
+    DWORD                       _nNextReceiveBuffer;        // Index of the buffer the next read goes into
+    bool                        _fReceivePending;           // A read is outstanding on the channel
+    CStspFrameDecoder           _frameDecoder;              // Splits received data into operations
+    ComPtr<Network::IMediaBufferWrapper> _spFramePayload;  // Payload of the operation currently being received from the server.
 
     ComPtr<IMFPresentationDescriptor> _spPresentationDescriptor;
 
@@ -18,6 +18,16 @@ using namespace Microsoft::Samples::SimpleCommunication::Network;
     ThrowIfError(pSample->SetUINT32(MFSampleExtension_##flagName, (StspSampleFlag_##flagName & flag) == StspSampleFlag_##flagName)); \
 }
 
+namespace
+{
+    // Samples are held back by 10ms to 500ms depending on network jitter. A sample that ends up
+    // more than 150ms past its playout time is dropped, along with the rest of its group of
+    // pictures.
+    const LONGLONG c_hnsMinPlayoutDelay = 100000;
+    const LONGLONG c_hnsMaxPlayoutDelay = 5000000;
+    const LONGLONG c_hnsMaxPlayoutLateness = 1500000;
+};
+
 // RAII object locking the the source on initialization and unlocks it on deletion
 class CMediaStream::CSourceLock
 {
@@ -87,6 +97,10 @@ CMediaStream::CMediaStream(CMediaSource *pSource)
     , _fWaitingForCleanPoint(true)
     , _hnsStartDroppingAt(0)
     , _hnsAmountToDrop(0)
+    , _playoutBuffer(c_hnsMinPlayoutDelay, c_hnsMaxPlayoutDelay, c_hnsMaxPlayoutLateness)
+    , _playoutTimerCB(this, &CMediaStream::OnPlayoutTimer)
+    , _playoutTimerKey(0)
+    , _fPlayoutTimerPending(false)
 {
 }
 
@@ -535,6 +549,8 @@ HRESULT CMediaStream::Stop()
             _eSourceState = SourceState_Stopped;
             _tokens.Clear();
             _samples.Clear();
+            _playoutBuffer.Reset();
+            CancelPlayoutTimer();
             // Inform the client that we've stopped.
             hr = QueueEvent(MEStreamStopped, GUID_NULL, S_OK, nullptr);
         }
@@ -581,6 +597,8 @@ HRESULT CMediaStream::Flush()
 
     _tokens.Clear();
     _samples.Clear();
+    _playoutBuffer.Reset();
+    CancelPlayoutTimer();
 
     _fDiscontinuity = false;
     _eDropMode = MF_DROP_MODE_NONE;
@@ -626,8 +644,10 @@ void CMediaStream::ProcessSample(StspSampleHeader *pSampleHeader, IMFSample *pSa
         // Check if we are in propper state if so deliver the sample otherwise just skip it and don't treat it as an error.
         if (_eSourceState == SourceState_Started)
         {
-            // Put sample on the list
-            ThrowIfError(_samples.InsertBack(pSample));
+            // Hold the sample back until its playout time. Audio samples can always be decoded on their own.
+            bool fCleanPoint = !_fVideo || (pSampleHeader->dwFlags & StspSampleFlag_CleanPoint) != 0;
+            _playoutBuffer.Insert(pSampleHeader->ullTimestamp, fCleanPoint, MFGetSystemTime(), pSample);
+            ReleaseDueSamples();
             // Deliver samples
             DeliverSamples();
         }
@@ -653,6 +673,8 @@ void CMediaStream::ProcessFormatChange(IMFMediaType *pMediaType)
         // Check if we are in proper state if so deliver the sample otherwise just skip it and don't treat it as an error.
         if (_eSourceState == SourceState_Started)
         {
+            // Samples still held back were sent before the format change.
+            FlushPlayoutBuffer();
             // Put sample on the list
             ThrowIfError(_samples.InsertBack(pMediaType));
             // Deliver samples
@@ -812,6 +834,97 @@ void CMediaStream::DeliverSamples()
     }
 }
 
+// Move samples whose playout time has come to the delivery queue
+void CMediaStream::ReleaseDueSamples()
+{
+    if (_flRate != 1.0f)
+    {
+        // Samples are only paced during normal playback.
+        FlushPlayoutBuffer();
+        return;
+    }
+
+    ComPtr<IMFSample> spSample;
+    uint32_t cDropped = 0;
+    while (_playoutBuffer.Pop(MFGetSystemTime(), &spSample, &cDropped))
+    {
+        ThrowIfError(_samples.InsertBack(spSample.Get()));
+    }
+
+    if (cDropped > 0)
+    {
+        TRACE(TRACE_LEVEL_LOW, L"Dropped %d samples that were too late for playout (target delay %I64d jitter %I64d)\n",
+            cDropped, _playoutBuffer.GetClock().GetTargetDelay(), _playoutBuffer.GetClock().GetJitter());
+        _fDiscontinuity = true;
+    }
+
+    SchedulePlayoutTimer();
+}
+
+// Move all samples held back for playout to the delivery queue
+void CMediaStream::FlushPlayoutBuffer()
+{
+    ComPtr<IMFSample> spSample;
+    while (_playoutBuffer.PopNext(&spSample))
+    {
+        ThrowIfError(_samples.InsertBack(spSample.Get()));
+    }
+}
+
+void CMediaStream::SchedulePlayoutTimer()
+{
+    LONGLONG hnsPlayoutTime = 0;
+    if (_fPlayoutTimerPending || !_playoutBuffer.GetNextPlayoutTime(&hnsPlayoutTime))
+    {
+        return;
+    }
+
+    // The timeout is given in milliseconds as a negative number; round up so the sample is due
+    // when the timer fires.
+    LONGLONG msTimeout = (hnsPlayoutTime - MFGetSystemTime() + 9999) / 10000;
+    if (msTimeout < 1)
+    {
+        msTimeout = 1;
+    }
+
+    ThrowIfError(MFScheduleWorkItem(&_playoutTimerCB, nullptr, -msTimeout, &_playoutTimerKey));
+    _fPlayoutTimerPending = true;
+}
+
+void CMediaStream::CancelPlayoutTimer()
+{
+    if (_fPlayoutTimerPending)
+    {
+        // The timer may already be running, in which case it finds nothing to release.
+        MFCancelWorkItem(_playoutTimerKey);
+        _fPlayoutTimerPending = false;
+    }
+}
+
+HRESULT CMediaStream::OnPlayoutTimer(IMFAsyncResult *pAsyncResult)
+{
+    CSourceLock lock(_spSource.Get());
+
+    _fPlayoutTimerPending = false;
+
+    try
+    {
+        ThrowIfError(CheckShutdown());
+
+        if (_eSourceState == SourceState_Started)
+        {
+            ReleaseDueSamples();
+            DeliverSamples();
+        }
+    }
+    catch(Exception ^exc)
+    {
+        HandleError(exc->HResult);
+    }
+
+    return S_OK;
+}
+
 void CMediaStream::HandleError(HRESULT hErrorCode)
 {
     if (hErrorCode != MF_E_SHUTDOWN)
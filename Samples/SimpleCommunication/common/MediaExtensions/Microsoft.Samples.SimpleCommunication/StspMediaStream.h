@@ -7,8 +7,10 @@
 
 #pragma once
 #include <CritSec.h>
+#include <AsyncCB.h>
 #include <linklist.h>
 #include <StspDefs.h>
+#include <StspPlayoutBuffer.h>
 
 namespace Microsoft { namespace Samples { namespace SimpleCommunication {
     class CMediaSource;
@@ -80,6 +82,11 @@ namespace Microsoft { namespace Samples { namespace SimpleCommunication {
     private:
         void Initialize(StspStreamDescription *pStreamDescription, Network::IBufferPacket *pAttributesBuffer);
         void DeliverSamples();
+        void ReleaseDueSamples();
+        void FlushPlayoutBuffer();
+        void SchedulePlayoutTimer();
+        void CancelPlayoutTimer();
+        HRESULT OnPlayoutTimer(IMFAsyncResult *pAsyncResult);
         void SetSampleAttributes(StspSampleHeader *pSampleHeader, IMFSample *pSample);
         void HandleError(HRESULT hErrorCode);
 
@@ -109,6 +116,11 @@ namespace Microsoft { namespace Samples { namespace SimpleCommunication {
         ComPtrList<IUnknown>        _samples;
         ComPtrList<IUnknown, true>  _tokens;
 
+        CPlayoutBuffer<ComPtr<IMFSample>> _playoutBuffer;     // Received samples waiting for their playout time
+        AsyncCallback<CMediaStream> _playoutTimerCB;            // Releases samples when the next one is due
+        MFWORKITEM_KEY              _playoutTimerKey;
+        bool                        _fPlayoutTimerPending;
+
         DWORD                       _dwId;
         bool                        _fActive;
         bool                        _fVideo;
@@ -0,0 +1,178 @@
+//// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+//// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+//// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+//// PARTICULAR PURPOSE.
+////
+//// Copyright (c) Microsoft Corporation. All rights reserved
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "StspPlayoutBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace Microsoft::Samples::SimpleCommunication;
+
+namespace
+{
+    const int64_t c_hnsPerSecond = 10000000;
+
+    // The loop looks at one second of media at a time. After locking it only corrects the offset
+    // for a few updates, so the error of the first arrivals is not mistaken for drift.
+    const int64_t c_hnsLoopPeriod = c_hnsPerSecond;
+    const int c_cAcquireWindows = 3;
+    const double c_phaseGain = 0.5;
+    const double c_frequencyGain = 0.05;
+    const double c_maxDrift = 0.001;
+
+    // A window whose fastest arrival is off by more than this is either a stall, which is
+    // ignored, or a change of route, which is accepted once it has lasted a few windows. Either
+    // way it says nothing about drift.
+    const int64_t c_hnsMaxLoopError = 100000;
+    const int c_cSlowWindowsToAccept = 5;
+
+    // Delays this far off the prediction mean the sender restarted its clock.
+    const int64_t c_hnsRelockThreshold = 5 * c_hnsPerSecond;
+
+    // The playout delay covers the 98th percentile of the delay above the fastest arrivals, plus
+    // 5ms. The percentile is tracked in steps of 1ms per sample, which bounds how far a single
+    // stall can push it.
+    const double c_delayPercentile = 0.98;
+    const double c_hnsPercentileStep = 10000.0;
+    const int64_t c_hnsSafetyMargin = 50000;
+};
+
+CPlayoutClock::CPlayoutClock(int64_t hnsMinDelay, int64_t hnsMaxDelay)
+: _hnsMinDelay(hnsMinDelay)
+, _hnsMaxDelay(std::max(hnsMinDelay, hnsMaxDelay))
+{
+    Reset();
+}
+
+void CPlayoutClock::Update(int64_t hnsTimestamp, int64_t hnsArrival)
+{
+    int64_t hnsDelay = hnsArrival - hnsTimestamp;
+    if (!_fLocked)
+    {
+        Lock(hnsTimestamp, hnsDelay);
+        return;
+    }
+
+    int64_t hnsError = hnsDelay - GetOffset(hnsTimestamp);
+    if (hnsError > c_hnsRelockThreshold || hnsError < -c_hnsRelockThreshold)
+    {
+        Lock(hnsTimestamp, hnsDelay);
+        return;
+    }
+
+    int64_t hnsTransit = std::abs(hnsDelay - _hnsLastDelay);
+    _hnsJitter += (hnsTransit - _hnsJitter) / 16;
+    _hnsLastDelay = hnsDelay;
+
+    UpdateTargetDelay(hnsError);
+
+    _hnsWindowMinError = std::min(_hnsWindowMinError, hnsError);
+    if (hnsTimestamp - _hnsWindowStart >= c_hnsLoopPeriod)
+    {
+        UpdateLoop(hnsTimestamp);
+    }
+}
+
+void CPlayoutClock::Reset()
+{
+    _fLocked = false;
+    _hnsReference = 0;
+    _offset = 0.0;
+    _drift = 0.0;
+    _cWindows = 0;
+    _cSlowWindows = 0;
+    _hnsWindowStart = 0;
+    _hnsWindowMinError = std::numeric_limits<int64_t>::max();
+    _hnsLastDelay = 0;
+    _hnsJitter = 0;
+    _excessPercentile = 0.0;
+    _hnsTargetDelay = _hnsMinDelay;
+}
+
+int64_t CPlayoutClock::GetPlayoutTime(int64_t hnsTimestamp) const
+{
+    return hnsTimestamp + GetOffset(hnsTimestamp) + _hnsTargetDelay;
+}
+
+void CPlayoutClock::UpdateTargetDelay(int64_t hnsError)
+{
+    // No playout delay could cover these, so they are left to the late sample handling.
+    if (hnsError > _hnsMaxDelay)
+    {
+        return;
+    }
+
+    if (static_cast<double>(hnsError) > _excessPercentile)
+    {
+        _excessPercentile += c_hnsPercentileStep * c_delayPercentile;
+    }
+    else
+    {
+        _excessPercentile -= c_hnsPercentileStep * (1.0 - c_delayPercentile);
+    }
+
+    int64_t hnsDelay = static_cast<int64_t>(_excessPercentile) + c_hnsSafetyMargin;
+    _hnsTargetDelay = std::min(std::max(hnsDelay, _hnsMinDelay), _hnsMaxDelay);
+}
+
+void CPlayoutClock::UpdateLoop(int64_t hnsTimestamp)
+{
+    double elapsed = static_cast<double>(hnsTimestamp - _hnsReference);
+    int64_t hnsError = _hnsWindowMinError;
+
+    _offset += _drift * elapsed;
+    _hnsReference = hnsTimestamp;
+    _hnsWindowStart = hnsTimestamp;
+    _hnsWindowMinError = std::numeric_limits<int64_t>::max();
+
+    if (hnsError > c_hnsMaxLoopError && ++_cSlowWindows < c_cSlowWindowsToAccept)
+    {
+        return;
+    }
+
+    _cSlowWindows = 0;
+    if (hnsError > c_hnsMaxLoopError || hnsError < -c_hnsMaxLoopError)
+    {
+        // Start acquiring again.
+        _cWindows = 0;
+    }
+
+    // While acquiring, the offset jumps straight to the fastest arrival and drift is left alone.
+    double correction = static_cast<double>(hnsError);
+    if (_cWindows >= c_cAcquireWindows)
+    {
+        correction *= c_phaseGain;
+        _drift = std::min(std::max(_drift + c_frequencyGain * static_cast<double>(hnsError) / elapsed, -c_maxDrift), c_maxDrift);
+    }
+
+    _offset += correction;
+    _cWindows++;
+
+    // The percentile was measured against the old offset.
+    _excessPercentile -= correction;
+}
+
+int64_t CPlayoutClock::GetOffset(int64_t hnsTimestamp) const
+{
+    return static_cast<int64_t>(std::llround(_offset + _drift * static_cast<double>(hnsTimestamp - _hnsReference)));
+}
+
+// Starts over from a single arrival. The drift and delay estimates are kept, since a sender
+// that restarts its timestamps still runs on the same clock.
+void CPlayoutClock::Lock(int64_t hnsTimestamp, int64_t hnsDelay)
+{
+    _fLocked = true;
+    _hnsReference = hnsTimestamp;
+    _offset = static_cast<double>(hnsDelay);
+    _cWindows = 0;
+    _cSlowWindows = 0;
+    _hnsWindowStart = hnsTimestamp;
+    _hnsWindowMinError = std::numeric_limits<int64_t>::max();
+    _hnsLastDelay = hnsDelay;
+}
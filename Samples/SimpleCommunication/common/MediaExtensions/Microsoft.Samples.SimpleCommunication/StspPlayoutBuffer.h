@@ -0,0 +1,197 @@
+//// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+//// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+//// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+//// PARTICULAR PURPOSE.
+////
+//// Copyright (c) Microsoft Corporation. All rights reserved
+
+#pragma once
+
+// Playout buffering for the samples a media stream receives from the network. Times are in 100ns
+// units: sample timestamps are in the sender's clock and everything else in the local clock. This
+// file only depends on the C++ standard library.
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+namespace Microsoft { namespace Samples { namespace SimpleCommunication {
+
+// Maps sender timestamps to local playout times.
+//
+// The offset between the two clocks is taken from the fastest arrivals: once per second of media
+// the smallest delay seen is compared with the prediction, and a phase-locked loop corrects both
+// the offset and the drift between the clocks. Delay above that floor is network jitter, and the
+// playout delay is set to cover nearly all of it.
+class CPlayoutClock
+{
+public:
+    CPlayoutClock(int64_t hnsMinDelay, int64_t hnsMaxDelay);
+
+    // Records that the sample stamped hnsTimestamp arrived at hnsArrival.
+    void Update(int64_t hnsTimestamp, int64_t hnsArrival);
+    void Reset();
+
+    bool IsLocked() const { return _fLocked; }
+
+    // Local time at which the sample stamped hnsTimestamp should be played. Only valid once locked.
+    int64_t GetPlayoutTime(int64_t hnsTimestamp) const;
+
+    int64_t GetTargetDelay() const { return _hnsTargetDelay; }
+    int64_t GetJitter() const { return _hnsJitter; }
+
+    // How much faster the local clock runs than the sender's, in parts per million.
+    double GetDriftPpm() const { return _drift * 1e6; }
+
+private:
+    int64_t GetOffset(int64_t hnsTimestamp) const;
+    void Lock(int64_t hnsTimestamp, int64_t hnsDelay);
+    void UpdateTargetDelay(int64_t hnsError);
+    void UpdateLoop(int64_t hnsTimestamp);
+
+    int64_t     _hnsMinDelay;
+    int64_t     _hnsMaxDelay;
+
+    bool        _fLocked;
+    int64_t     _hnsReference;          // Sender time the offset below was measured at
+    double      _offset;                // Arrival time minus timestamp for the fastest arrivals
+    double      _drift;                 // Change of that offset per unit of sender time
+    int         _cWindows;              // Loop updates since locking
+    int         _cSlowWindows;          // Windows in a row that only saw slow arrivals
+
+    int64_t     _hnsWindowStart;
+    int64_t     _hnsWindowMinError;     // Smallest delay above the prediction in this window
+
+    int64_t     _hnsLastDelay;
+    int64_t     _hnsJitter;             // Interarrival jitter, as in RFC 3550
+    double      _excessPercentile;      // Estimated high percentile of the delay above the fastest arrivals
+    int64_t     _hnsTargetDelay;
+};
+
+struct PlayoutBufferStats
+{
+    uint64_t cReleased;     // Samples handed on for playback
+    uint64_t cLate;         // Released samples that arrived after their playout time
+    uint64_t cDropped;      // Samples thrown away for being too late, or while waiting for a clean point
+};
+
+// First-in first-out queue that holds each sample until its playout time.
+//
+// Samples leave in the order they were inserted, so decode order is kept even when timestamps
+// are not monotonic. A sample that is more than hnsMaxLateness past its playout time is dropped,
+// and so is everything after it up to the next clean point, since those samples cannot be
+// decoded without it.
+template <class TSample>
+class CPlayoutBuffer
+{
+public:
+    CPlayoutBuffer(int64_t hnsMinDelay, int64_t hnsMaxDelay, int64_t hnsMaxLateness)
+    : _clock(hnsMinDelay, hnsMaxDelay)
+    , _hnsMaxLateness(hnsMaxLateness)
+    , _fWaitingForCleanPoint(false)
+    , _stats()
+    {
+    }
+
+    void Insert(int64_t hnsTimestamp, bool fCleanPoint, int64_t hnsArrival, const TSample &sample)
+    {
+        _clock.Update(hnsTimestamp, hnsArrival);
+
+        Entry entry = { hnsTimestamp, hnsArrival, fCleanPoint, sample };
+        _entries.push_back(entry);
+    }
+
+    // Removes the first sample if it is due at hnsNow. Samples dropped on the way are added to
+    // *pcDropped.
+    bool Pop(int64_t hnsNow, TSample *pSample, uint32_t *pcDropped)
+    {
+        while (!_entries.empty())
+        {
+            Entry &front = _entries.front();
+            int64_t hnsLateness = hnsNow - _clock.GetPlayoutTime(front.hnsTimestamp);
+
+            if (hnsLateness > _hnsMaxLateness || (_fWaitingForCleanPoint && !front.fCleanPoint))
+            {
+                _fWaitingForCleanPoint = true;
+                _entries.pop_front();
+                _stats.cDropped++;
+                (*pcDropped)++;
+                continue;
+            }
+
+            if (hnsLateness < 0)
+            {
+                return false;
+            }
+
+            if (front.hnsArrival > hnsNow - hnsLateness)
+            {
+                _stats.cLate++;
+            }
+
+            _fWaitingForCleanPoint = false;
+            *pSample = front.sample;
+            _entries.pop_front();
+            _stats.cReleased++;
+            return true;
+        }
+
+        return false;
+    }
+
+    // Removes the first sample whatever its playout time.
+    bool PopNext(TSample *pSample)
+    {
+        if (_entries.empty())
+        {
+            return false;
+        }
+
+        *pSample = _entries.front().sample;
+        _entries.pop_front();
+        _stats.cReleased++;
+        return true;
+    }
+
+    // Returns false if the buffer is empty.
+    bool GetNextPlayoutTime(int64_t *phnsPlayoutTime) const
+    {
+        if (_entries.empty())
+        {
+            return false;
+        }
+
+        *phnsPlayoutTime = _clock.GetPlayoutTime(_entries.front().hnsTimestamp);
+        return true;
+    }
+
+    // Empties the buffer and starts clock recovery over.
+    void Reset()
+    {
+        _entries.clear();
+        _clock.Reset();
+        _fWaitingForCleanPoint = false;
+    }
+
+    bool IsEmpty() const { return _entries.empty(); }
+    size_t GetCount() const { return _entries.size(); }
+    const CPlayoutClock &GetClock() const { return _clock; }
+    const PlayoutBufferStats &GetStats() const { return _stats; }
+
+private:
+    struct Entry
+    {
+        int64_t     hnsTimestamp;
+        int64_t     hnsArrival;
+        bool        fCleanPoint;
+        TSample     sample;
+    };
+
+    std::deque<Entry>       _entries;
+    CPlayoutClock           _clock;
+    int64_t                 _hnsMaxLateness;
+    bool                    _fWaitingForCleanPoint;
+    PlayoutBufferStats      _stats;
+};
+
+}}} // namespace Microsoft::Samples::SimpleCommunication
@@ -10,18 +10,22 @@
 //*********************************************************
 #include "pch.h"
 
-_Use_decl_annotations_
-HRESULT AudioFileReader::Initialize(LPCWSTR filename)
-{
-    BOOL mfStarted = FALSE;
-    auto hr = MFStartup(MF_VERSION);
-    mfStarted = SUCCEEDED(hr);
+size_t AudioFileReader::s_streamingThreshold = AudioFileReader::DefaultStreamingThreshold;
 
-    ComPtr<IMFSourceReader> reader;
-    if (SUCCEEDED(hr))
+AudioFileReader::~AudioFileReader()
+{
+    if (_mfStarted)
     {
-        hr = MFCreateSourceReaderFromURL(filename, nullptr, &reader);
+        _reader.Reset();
+        MFShutdown();
     }
+}
+
+_Use_decl_annotations_
+HRESULT AudioFileReader::CreateReader(LPCWSTR filename, IMFSourceReader** sourceReader)
+{
+    ComPtr<IMFSourceReader> reader;
+    auto hr = MFCreateSourceReaderFromURL(filename, nullptr, &reader);
     
     // Select the first audio stream, and deselect all other streams.
     if (SUCCEEDED(hr))
@@ -94,9 +98,100 @@ HRESULT AudioFileReader::Initialize(LPCWSTR filename)
         }
     }
 
+    if (SUCCEEDED(hr))
+    {
+        *sourceReader = reader.Detach();
+    }
+
+    return hr;
+}
+
+DecodedAudioCache& AudioFileReader::GetCache()
+{
+    static DecodedAudioCache cache(DefaultCacheBudget);
+    return cache;
+}
+
+void AudioFileReader::SetStreamingThreshold(size_t bytes)
+{
+    s_streamingThreshold = bytes;
+}
+
+_Use_decl_annotations_
+HRESULT AudioFileReader::Initialize(LPCWSTR filename)
+{
+    _reader.Reset();
+    _audio.reset();
+
+    // Decoded files are shared with every other reader of the same file through the cache.
+    auto hr = S_OK;
+    auto tooLarge = false;
+    _audio = GetCache().Acquire(filename, [&](DecodedAudio& audio)
+    {
+        hr = Decode(filename, &audio, &tooLarge);
+        return SUCCEEDED(hr) && !tooLarge;
+    });
+
+    if (tooLarge)
+    {
+        return InitializeStreaming(filename);
+    }
+
+    if (SUCCEEDED(hr) && (!_audio || _audio->format.size() < sizeof(WAVEFORMATEX)))
+    {
+        hr = E_FAIL;
+    }
+
+    if (SUCCEEDED(hr))
+    {
+        CopyMemory(&_format, _audio->format.data(), sizeof WAVEFORMATEX);
+    }
+
+    return hr;
+}
+
+_Use_decl_annotations_
+HRESULT AudioFileReader::Decode(LPCWSTR filename, DecodedAudio* audio, bool* tooLarge)
+{
+    *tooLarge = false;
+
+    BOOL mfStarted = FALSE;
+    auto hr = MFStartup(MF_VERSION);
+    mfStarted = SUCCEEDED(hr);
+
+    ComPtr<IMFSourceReader> reader;
+    if (SUCCEEDED(hr))
+    {
+        hr = CreateReader(filename, &reader);
+    }
+
+    if (SUCCEEDED(hr))
+    {
+        auto format = reinterpret_cast<const uint8_t*>(&_format);
+        audio->format.assign(format, format + sizeof WAVEFORMATEX);
+    }
+
+    // Files that would decode to more than the streaming threshold are not decoded here.
+    // The estimate is only used to size the buffer; the loop below reads whatever the file contains.
+    if (SUCCEEDED(hr))
+    {
+        PROPVARIANT duration;
+        PropVariantInit(&duration);
+        if (SUCCEEDED(reader->GetPresentationAttribute(static_cast<DWORD>(MF_SOURCE_READER_MEDIASOURCE), MF_PD_DURATION, &duration)))
+        {
+            // Duration is in 100ns units.
+            auto estimatedSize = static_cast<size_t>(duration.uhVal.QuadPart * _format.nAvgBytesPerSec / 10000000);
+            *tooLarge = estimatedSize > s_streamingThreshold;
+            if (!*tooLarge)
+            {
+                audio->data.reserve(estimatedSize + _format.nBlockAlign);
+            }
+        }
+        PropVariantClear(&duration);
+    }
+
     // Get audio samples from the source reader.
-    _audioData.resize(0);
-    while (SUCCEEDED(hr))
+    while (!*tooLarge &&  (SUCCEEDED(hr))
     {
         DWORD dwFlags = 0;
 
@@ -129,15 +224,15 @@ HRESULT AudioFileReader::Initialize(LPCWSTR filename)
             BYTE* data;
             hr = buffer->Lock(&data, nullptr, &bufferSize);
 
-            auto currentDataSize = _audioData.size();
+            auto currentDataSize = audio->data.size();
             if (SUCCEEDED(hr))
             {
-                _audioData.resize(currentDataSize + bufferSize);
+                audio->data.resize(currentDataSize + bufferSize);
             }
 
             if (SUCCEEDED(hr))
             {
-                CopyMemory(_audioData.data() + currentDataSize, data, bufferSize);
+                CopyMemory(audio->data.data() + currentDataSize, data, bufferSize);
                 // Unlock the buffer
                 hr = buffer->Unlock();
             }
@@ -150,4 +245,124 @@ HRESULT AudioFileReader::Initialize(LPCWSTR filename)
     }
 
     return hr;
-}
\ No newline at end of file
+}
+
+_Use_decl_annotations_
+HRESULT AudioFileReader::InitializeStreaming(LPCWSTR filename)
+{
+    // Media Foundation stays started for as long as the reader is in use; the destructor shuts it down.
+    auto hr = S_OK;
+    if (!_mfStarted)
+    {
+        hr = MFStartup(MF_VERSION);
+        _mfStarted = SUCCEEDED(hr);
+    }
+
+    if (SUCCEEDED(hr))
+    {
+        _reader.Reset();
+        _audio.reset();
+        _pending.clear();
+        _pendingOffset = 0;
+        hr = CreateReader(filename, &_reader);
+    }
+
+    return hr;
+}
+
+_Use_decl_annotations_
+HRESULT AudioFileReader::ReadStream(BYTE* buffer, size_t size, bool loop, size_t* bytesRead)
+{
+    *bytesRead = 0;
+    if (!_reader)
+    {
+        return E_NOT_VALID_STATE;
+    }
+
+    auto hr = S_OK;
+    bool restarted = false;
+    while (SUCCEEDED(hr) && *bytesRead < size)
+    {
+        if (_pendingOffset == _pending.size())
+        {
+            bool endOfStream = false;
+            hr = ReadNextSample(&endOfStream);
+            if (SUCCEEDED(hr) && endOfStream)
+            {
+                // Stop after one restart without data so that an empty file cannot spin forever.
+                if (!loop || restarted)
+                {
+                    hr = S_FALSE;
+                    break;
+                }
+
+                hr = Rewind();
+                restarted = true;
+            }
+            continue;
+        }
+
+        restarted = false;
+        auto count = (std::min)(size - *bytesRead, _pending.size() - _pendingOffset);
+        CopyMemory(buffer + *bytesRead, _pending.data() + _pendingOffset, count);
+        *bytesRead += count;
+        _pendingOffset += count;
+    }
+
+    return hr;
+}
+
+_Use_decl_annotations_
+HRESULT AudioFileReader::ReadNextSample(bool* endOfStream)
+{
+    *endOfStream = false;
+    _pending.clear();
+    _pendingOffset = 0;
+
+    DWORD dwFlags = 0;
+    ComPtr<IMFSample> sample;
+    auto hr = _reader->ReadSample(static_cast<DWORD>(MF_SOURCE_READER_FIRST_AUDIO_STREAM), 0, nullptr, &dwFlags, nullptr, &sample);
+
+    if (SUCCEEDED(hr) && (dwFlags & MF_SOURCE_READERF_ENDOFSTREAM) != 0)
+    {
+        *endOfStream = true;
+        return hr;
+    }
+
+    if (SUCCEEDED(hr) && sample == nullptr)
+    {
+        // No sample, the caller will ask again.
+        return hr;
+    }
+
+    ComPtr<IMFMediaBuffer> mediaBuffer;
+    if (SUCCEEDED(hr))
+    {
+        hr = sample->ConvertToContiguousBuffer(&mediaBuffer);
+    }
+
+    if (SUCCEEDED(hr))
+    {
+        BYTE* data;
+        DWORD bufferSize = 0;
+        hr = mediaBuffer->Lock(&data, nullptr, &bufferSize);
+        if (SUCCEEDED(hr))
+        {
+            _pending.assign(data, data + bufferSize);
+            hr = mediaBuffer->Unlock();
+        }
+    }
+
+    return hr;
+}
+
+HRESULT AudioFileReader::Rewind()
+{
+    PROPVARIANT position;
+    PropVariantInit(&position);
+    position.vt = VT_I8;
+    position.hVal.QuadPart = 0;
+    auto hr = _reader->SetCurrentPosition(GUID_NULL, position);
+    PropVariantClear(&position);
+    return hr;
+}
@@ -17,9 +17,34 @@
 class AudioFileReader
 {
 public:
-    virtual ~AudioFileReader() {}
+    // Decoded files larger than this are streamed rather than cached.
+    static const size_t DefaultStreamingThreshold = 4 * 1024 * 1024;
+
+    // Memory kept for decoded files, including files no reader currently uses.
+    static const size_t DefaultCacheBudget = 16 * 1024 * 1024;
+
+    virtual ~AudioFileReader();
+
+    // Decodes the whole file into memory, shared through GetCache() with every other reader of the same file.
+    // Files larger than the streaming threshold are opened as with InitializeStreaming instead.
     HRESULT Initialize(_In_ LPCWSTR filename);
 
+    // Opens the file for decoding on demand with ReadStream; GetSize and GetData stay empty.
+    // Only the most recently decoded media sample is held in memory.
+    HRESULT InitializeStreaming(_In_ LPCWSTR filename);
+
+    bool IsStreaming() const
+    {
+        return _reader != nullptr;
+    }
+
+    static DecodedAudioCache& GetCache();
+    static void SetStreamingThreshold(_In_ size_t bytes);
+
+    // Decodes up to size bytes of PCM into buffer. At the end of the stream it starts over from the
+    // beginning if loop is set, otherwise it returns S_FALSE with fewer bytes than requested.
+    HRESULT ReadStream(_Out_writes_bytes_to_(size, *bytesRead) BYTE* buffer, _In_ size_t size, _In_ bool loop, _Out_ size_t* bytesRead);
+
     const WAVEFORMATEX* GetFormat() const
     {
         return &_format;
@@ -27,15 +52,29 @@ public:
 
     size_t GetSize() const
     {
-        return _audioData.size();
+        return _audio ? _audio->data.size() : 0;
     }
 
     const BYTE* GetData() const
     {
-        return _audioData.data();
+        return _audio ? _audio->data.data() : nullptr;
     }
 
 private:
-    WAVEFORMATEX        _format;
-    std::vector<BYTE>   _audioData;
+    HRESULT CreateReader(_In_ LPCWSTR filename, _COM_Outptr_ IMFSourceReader** reader);
+    HRESULT Decode(_In_ LPCWSTR filename, _Inout_ DecodedAudio* audio, _Out_ bool* tooLarge);
+    HRESULT ReadNextSample(_Out_ bool* endOfStream);
+    HRESULT Rewind();
+
+private:
+    static size_t                           s_streamingThreshold;
+
+    WAVEFORMATEX                            _format;
+    std::shared_ptr<const DecodedAudio>     _audio;
+
+    // Streaming state
+    ComPtr<IMFSourceReader>                 _reader;
+    bool                                    _mfStarted = false;
+    std::vector<BYTE>                       _pending;           // Decoded bytes not yet returned by ReadStream.
+    size_t                                  _pendingOffset = 0;
 };
\ No newline at end of file
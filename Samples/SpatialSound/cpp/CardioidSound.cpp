@@ -29,6 +29,8 @@ HRESULT CardioidSound::Initialize(LPCWSTR filename)
 
 CardioidSound::~CardioidSound()
 {
+    _streamer.Detach();
+
     if (_sourceVoice)
     {
         _sourceVoice->DestroyVoice();
@@ -42,6 +44,7 @@ HRESULT CardioidSound::ConfigureApo(float scaling, float order)
     // To change directivity, we'll need to stop audio processing and reinitialize another APO instance with the new directivity.
     if (_xaudio2)
     {
+        _streamer.Detach();
         _xaudio2->StopEngine();
         _xaudio2.Reset();
     }
@@ -82,17 +85,13 @@ HRESULT CardioidSound::ConfigureApo(float scaling, float order)
     // The source voice is used to submit audio data and control playback.
     if (SUCCEEDED(hr))
     {
-        hr = SetupXAudio2(_audioFile.GetFormat(), xapo.Get(), &_xaudio2, &_sourceVoice);
+        hr = SetupXAudio2(_audioFile.GetFormat(), xapo.Get(), &_xaudio2, &_sourceVoice, _audioFile.IsStreaming() ? &_streamer : nullptr);
     }
 
     // Submit audio data to the source voice
     if (SUCCEEDED(hr))
     {
-        XAUDIO2_BUFFER buffer{};
-        buffer.AudioBytes = static_cast<UINT32>(_audioFile.GetSize());
-        buffer.pAudioData = _audioFile.GetData();
-        buffer.LoopCount = XAUDIO2_LOOP_INFINITE;
-        hr = _sourceVoice->SubmitSourceBuffer(&buffer);
+        hr = SubmitAudioFile(&_audioFile, _sourceVoice, &_streamer);
     }
 
     return hr;
@@ -32,6 +32,7 @@ private:
 
 private:
     AudioFileReader                 _audioFile;
+    ChunkedVoiceStreamer            _streamer;
     ComPtr<IXAudio2>                _xaudio2;
     IXAudio2SourceVoice*            _sourceVoice = nullptr;
     ComPtr<IXAPOHrtfParameters>     _hrtfParams;
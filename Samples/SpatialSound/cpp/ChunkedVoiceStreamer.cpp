@@ -0,0 +1,110 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+ChunkedVoiceStreamer::~ChunkedVoiceStreamer()
+{
+    Detach();
+
+    if (_bufferEndEvent)
+    {
+        CloseHandle(_bufferEndEvent);
+    }
+}
+
+_Use_decl_annotations_
+HRESULT ChunkedVoiceStreamer::Initialize(size_t chunkBytes, UINT32 chunkCount, FillFunction fill)
+{
+    if (chunkBytes == 0 || chunkCount < 2 || !fill)
+    {
+        return E_INVALIDARG;
+    }
+
+    _chunkBytes = chunkBytes;
+    _chunkCount = chunkCount;
+    _fill = fill;
+
+    // One more chunk than are queued holds the next one, filled ahead of time.
+    _chunks.assign(chunkBytes * (chunkCount + 1), 0);
+
+    if (!_bufferEndEvent)
+    {
+        _bufferEndEvent = CreateEventEx(nullptr, nullptr, 0, EVENT_MODIFY_STATE | SYNCHRONIZE);
+    }
+    return _bufferEndEvent ? S_OK : HRESULT_FROM_WIN32(GetLastError());
+}
+
+_Use_decl_annotations_
+HRESULT ChunkedVoiceStreamer::Attach(IXAudio2SourceVoice* sourceVoice)
+{
+    Detach();
+
+    _sourceVoice = sourceVoice;
+    _nextChunk = 0;
+    _nextChunkBytes = _fill(_chunks.data(), _chunkBytes);
+
+    auto hr = SubmitChunks();
+    if (SUCCEEDED(hr))
+    {
+        _running = true;
+        _thread = std::thread(&ChunkedVoiceStreamer::WorkerThread, this);
+    }
+    return hr;
+}
+
+void ChunkedVoiceStreamer::Detach()
+{
+    if (_thread.joinable())
+    {
+        _running = false;
+        SetEvent(_bufferEndEvent);
+        _thread.join();
+    }
+}
+
+HRESULT ChunkedVoiceStreamer::SubmitChunks()
+{
+    XAUDIO2_VOICE_STATE state{};
+    _sourceVoice->GetState(&state, XAUDIO2_VOICE_NOSAMPLESPLAYED);
+
+    // The chunk after the one being submitted is filled first, so that the last chunk of the stream
+    // is known when it is submitted and can be flagged as the end of the stream. Chunks complete in
+    // submission order, so the slot after the next chunk in the ring is always free here.
+    auto hr = S_OK;
+    for (auto queued = state.BuffersQueued; SUCCEEDED(hr) && _nextChunkBytes > 0 && queued < _chunkCount; queued++)
+    {
+        BYTE* chunk = _chunks.data() + _nextChunk * _chunkBytes;
+        auto size = _nextChunkBytes;
+
+        _nextChunk = (_nextChunk + 1) % (_chunkCount + 1);
+        _nextChunkBytes = _fill(_chunks.data() + _nextChunk * _chunkBytes, _chunkBytes);
+
+        XAUDIO2_BUFFER buffer{};
+        buffer.AudioBytes = static_cast<UINT32>(size);
+        buffer.pAudioData = chunk;
+        buffer.Flags = (_nextChunkBytes == 0) ? XAUDIO2_END_OF_STREAM : 0;
+        hr = _sourceVoice->SubmitSourceBuffer(&buffer);
+    }
+    return hr;
+}
+
+void ChunkedVoiceStreamer::WorkerThread()
+{
+    while (_running)
+    {
+        WaitForSingleObjectEx(_bufferEndEvent, INFINITE, FALSE);
+        if (_running && FAILED(SubmitChunks()))
+        {
+            break;
+        }
+    }
+}
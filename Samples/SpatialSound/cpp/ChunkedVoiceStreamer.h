@@ -0,0 +1,69 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+//
+// Keeps a source voice fed from a fill function, a fixed-size chunk at a time.
+// A worker thread fills chunks ahead of the voice and queues them, and refills each one as soon as XAudio2
+// has finished playing it, so decoding or rendering never happens on the XAudio2 processing thread.
+// The last chunk of a stream is submitted with XAUDIO2_END_OF_STREAM.
+// Pass the streamer as the voice callback when creating the source voice.
+//
+class ChunkedVoiceStreamer : public IXAudio2VoiceCallback
+{
+public:
+    // Fills up to size bytes of audio and returns how many were written. Called on the worker thread,
+    // and from Attach on the calling thread. A short chunk is still submitted; a chunk of zero bytes
+    // ends the stream.
+    typedef std::function<size_t(BYTE* buffer, size_t size)> FillFunction;
+
+    virtual ~ChunkedVoiceStreamer();
+
+    // Chunks should be a whole number of audio frames.
+    HRESULT Initialize(_In_ size_t chunkBytes, _In_ UINT32 chunkCount, _In_ FillFunction fill);
+
+    // Queues the first chunks on the voice and starts the worker. Playback is still controlled with the
+    // voice's own Start and Stop; while the voice is stopped the queued chunks simply wait.
+    HRESULT Attach(_In_ IXAudio2SourceVoice* sourceVoice);
+
+    // Stops the worker. Must be called before the voice is destroyed.
+    void Detach();
+
+    // IXAudio2VoiceCallback
+    STDMETHOD_(void, OnBufferEnd)(void*) override
+    {
+        SetEvent(_bufferEndEvent);
+    }
+
+    STDMETHOD_(void, OnVoiceProcessingPassStart)(UINT32) override {}
+    STDMETHOD_(void, OnVoiceProcessingPassEnd)() override {}
+    STDMETHOD_(void, OnStreamEnd)() override {}
+    STDMETHOD_(void, OnBufferStart)(void*) override {}
+    STDMETHOD_(void, OnLoopEnd)(void*) override {}
+    STDMETHOD_(void, OnVoiceError)(void*, HRESULT) override {}
+
+private:
+    HRESULT SubmitChunks();
+    void WorkerThread();
+
+private:
+    IXAudio2SourceVoice*            _sourceVoice = nullptr;
+    FillFunction                    _fill;
+    size_t                          _chunkBytes = 0;
+    UINT32                          _chunkCount = 0;
+    std::vector<BYTE>               _chunks;
+    UINT32                          _nextChunk = 0;
+    size_t                          _nextChunkBytes = 0;    // Filled but not yet submitted; zero at the end of the stream.
+    HANDLE                          _bufferEndEvent = nullptr;
+    std::thread                     _thread;
+    std::atomic<bool>               _running{ false };
+};
@@ -51,23 +51,21 @@ HRESULT CustomDecaySound::Initialize(LPCWSTR filename)
     // The source voice is used to submit audio data and control playback.
     if (SUCCEEDED(hr))
     {
-        hr = SetupXAudio2(_audioFile.GetFormat(), xapo.Get(), &_xaudio2, &_sourceVoice);
+        hr = SetupXAudio2(_audioFile.GetFormat(), xapo.Get(), &_xaudio2, &_sourceVoice, _audioFile.IsStreaming() ? &_streamer : nullptr);
     }
 
     // Submit audio data to the source voice
     if (SUCCEEDED(hr))
     {
-        XAUDIO2_BUFFER buffer{};
-        buffer.AudioBytes = static_cast<UINT32>(_audioFile.GetSize());
-        buffer.pAudioData = _audioFile.GetData();
-        buffer.LoopCount = XAUDIO2_LOOP_INFINITE;
-        hr = _sourceVoice->SubmitSourceBuffer(&buffer);
+        hr = SubmitAudioFile(&_audioFile, _sourceVoice, &_streamer);
     }
     return hr;
 }
 
 CustomDecaySound::~CustomDecaySound()
 {
+    _streamer.Detach();
+
     if (_sourceVoice)
     {
         _sourceVoice->DestroyVoice();
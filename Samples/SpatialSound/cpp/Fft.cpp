@@ -0,0 +1,109 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "Fft.h"
+
+#include <cmath>
+#include <utility>
+
+Fft::Fft(size_t size) :
+    _size(NextPowerOfTwo(size < 2 ? 2 : size))
+{
+    const double pi = 3.14159265358979323846;
+
+    _twiddles.resize(_size / 2);
+    for (size_t i = 0; i < _twiddles.size(); i++)
+    {
+        double angle = -2.0 * pi * static_cast<double>(i) / static_cast<double>(_size);
+        _twiddles[i] = std::complex<float>(static_cast<float>(cos(angle)), static_cast<float>(sin(angle)));
+    }
+
+    size_t bits = 0;
+    while ((static_cast<size_t>(1) << bits) < _size)
+    {
+        bits++;
+    }
+
+    _bitReverse.resize(_size);
+    for (size_t i = 0; i < _size; i++)
+    {
+        uint32_t reversed = 0;
+        for (size_t bit = 0; bit < bits; bit++)
+        {
+            if (i & (static_cast<size_t>(1) << bit))
+            {
+                reversed |= 1u << (bits - 1 - bit);
+            }
+        }
+        _bitReverse[i] = reversed;
+    }
+}
+
+size_t Fft::NextPowerOfTwo(size_t value)
+{
+    size_t result = 1;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+
+void Fft::Forward(std::complex<float>* data) const
+{
+    Transform(data, false);
+}
+
+void Fft::Inverse(std::complex<float>* data) const
+{
+    Transform(data, true);
+
+    float scale = 1.0f / static_cast<float>(_size);
+    for (size_t i = 0; i < _size; i++)
+    {
+        data[i] *= scale;
+    }
+}
+
+void Fft::Transform(std::complex<float>* data, bool inverse) const
+{
+    for (size_t i = 0; i < _size; i++)
+    {
+        size_t j = _bitReverse[i];
+        if (i < j)
+        {
+            std::swap(data[i], data[j]);
+        }
+    }
+
+    for (size_t length = 2; length <= _size; length <<= 1)
+    {
+        size_t half = length / 2;
+        size_t step = _size / length;
+        for (size_t start = 0; start < _size; start += length)
+        {
+            for (size_t k = 0; k < half; k++)
+            {
+                std::complex<float> w = _twiddles[k * step];
+                if (inverse)
+                {
+                    w = std::conj(w);
+                }
+
+                std::complex<float> value = data[start + k + half];
+                std::complex<float> odd(value.real() * w.real() - value.imag() * w.imag(), value.real() * w.imag() + value.imag() * w.real());
+                data[start + k + half] = data[start + k] - odd;
+                data[start + k] += odd;
+            }
+        }
+    }
+}
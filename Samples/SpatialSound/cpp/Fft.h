@@ -0,0 +1,47 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+//
+// In-place radix-2 complex FFT of a fixed power-of-two size.
+// Twiddle factors and the bit reversal table are computed once, so a single instance can be shared
+// by every convolver that uses the same size. Transforms are const and safe to run concurrently.
+//
+class Fft
+{
+public:
+    explicit Fft(size_t size);
+
+    size_t GetSize() const
+    {
+        return _size;
+    }
+
+    void Forward(std::complex<float>* data) const;
+
+    // Inverse transform, scaled by 1/N so that Inverse(Forward(x)) == x.
+    void Inverse(std::complex<float>* data) const;
+
+    static size_t NextPowerOfTwo(size_t value);
+
+private:
+    void Transform(std::complex<float>* data, bool inverse) const;
+
+private:
+    size_t                              _size;
+    std::vector<std::complex<float>>    _twiddles;
+    std::vector<uint32_t>               _bitReverse;
+};
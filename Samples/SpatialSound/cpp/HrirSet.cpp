@@ -0,0 +1,185 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "HrirSet.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const float Pi = 3.14159265358979323846f;
+
+    // Unit vector for a direction given in the HRTF xAPO coordinate system.
+    void DirectionToVector(float azimuth, float elevation, float& x, float& y, float& z)
+    {
+        x = cosf(elevation) * sinf(azimuth);
+        y = sinf(elevation);
+        z = -cosf(elevation) * cosf(azimuth);
+    }
+
+    // Impulse response of one ear of a rigid sphere for a source at the given angle of incidence
+    // (0 when the source faces the ear, pi when it is on the opposite side).
+    void SphericalHeadEar(float incidence, float sampleRate, float* response, size_t length)
+    {
+        const float headRadius = 0.0875f;           // Meters
+        const float speedOfSound = 343.0f;          // Meters per second
+        const float minimumAlpha = 0.1f;
+        const float minimumAngle = 150.0f * Pi / 180.0f;
+
+        // Head shadow: H(s) = (alpha * s + 2 * w0) / (s + 2 * w0), discretized with the bilinear transform.
+        float w0 = speedOfSound / headRadius;
+        float alpha = (1.0f + minimumAlpha / 2) + (1.0f - minimumAlpha / 2) * cosf(incidence / minimumAngle * Pi);
+        float k = 2.0f * sampleRate;
+        float b0 = (2 * w0 + alpha * k) / (2 * w0 + k);
+        float b1 = (2 * w0 - alpha * k) / (2 * w0 + k);
+        float a1 = (2 * w0 - k) / (2 * w0 + k);
+
+        // Path length difference around the sphere, offset so that the earliest arrival is at a/c.
+        float delaySeconds = (incidence < Pi / 2) ?
+            (headRadius / speedOfSound) * (1.0f - cosf(incidence)) :
+            (headRadius / speedOfSound) * (1.0f + incidence - Pi / 2);
+        float delay = delaySeconds * sampleRate;
+        size_t whole = static_cast<size_t>(delay);
+        float fraction = delay - static_cast<float>(whole);
+
+        // Fractionally delayed impulse (linear interpolation) through the shadow filter.
+        float previousInput = 0;
+        float previousOutput = 0;
+        for (size_t i = 0; i < length; i++)
+        {
+            float input = (i == whole) ? (1.0f - fraction) : (i == whole + 1) ? fraction : 0.0f;
+            float output = b0 * input + b1 * previousInput - a1 * previousOutput;
+            response[i] = output;
+            previousInput = input;
+            previousOutput = output;
+        }
+    }
+}
+
+HrirSet::HrirSet() :
+    _length(0),
+    _blockSize(0),
+    _partitionCount(0)
+{
+}
+
+bool HrirSet::Add(float azimuth, float elevation, const float* left, const float* right, size_t length)
+{
+    if (_fft || length == 0 || (_length != 0 && length != _length))
+    {
+        return false;
+    }
+
+    _length = length;
+
+    Direction direction;
+    DirectionToVector(azimuth, elevation, direction.x, direction.y, direction.z);
+    _directions.push_back(direction);
+
+    for (size_t i = 0; i < length; i++)
+    {
+        _responses.push_back(left[i]);
+        _responses.push_back(right[i]);
+    }
+    return true;
+}
+
+std::unique_ptr<HrirSet> HrirSet::CreateSphericalHeadModel(float sampleRate, float azimuthStepDegrees, float elevationStepDegrees)
+{
+    // Long enough for the largest interaural delay (about 0.7ms) plus the decay of the shadow filter.
+    const size_t length = static_cast<size_t>(sampleRate * 0.0025f);
+
+    auto set = std::make_unique<HrirSet>();
+    std::vector<float> left(length);
+    std::vector<float> right(length);
+
+    int azimuthSteps = std::max(1, static_cast<int>(360.0f / azimuthStepDegrees + 0.5f));
+    int elevationSteps = std::max(0, static_cast<int>(90.0f / elevationStepDegrees + 0.5f));
+    for (int e = -elevationSteps; e <= elevationSteps; e++)
+    {
+        float elevation = e * 90.0f / std::max(1, elevationSteps) * Pi / 180.0f;
+
+        // Straight up and down only need one direction.
+        int count = (e == elevationSteps || e == -elevationSteps) && elevationSteps > 0 ? 1 : azimuthSteps;
+        for (int a = 0; a < count; a++)
+        {
+            float azimuth = a * 2.0f * Pi / azimuthSteps;
+
+            float x, y, z;
+            DirectionToVector(azimuth, elevation, x, y, z);
+
+            // The ears sit on the x axis, so the angle of incidence follows from the x component alone.
+            float rightIncidence = acosf(std::max(-1.0f, std::min(1.0f, x)));
+            float leftIncidence = Pi - rightIncidence;
+            SphericalHeadEar(leftIncidence, sampleRate, left.data(), length);
+            SphericalHeadEar(rightIncidence, sampleRate, right.data(), length);
+            set->Add(azimuth, elevation, left.data(), right.data(), length);
+        }
+    }
+
+    return set;
+}
+
+bool HrirSet::Prepare(size_t blockSize)
+{
+    if (_fft || _directions.empty() || blockSize == 0)
+    {
+        return false;
+    }
+
+    // Overlap-save with partitions as long as a block needs at least 2 * blockSize - 1 points.
+    _fft = std::make_unique<Fft>(2 * blockSize);
+    _blockSize = blockSize;
+    _partitionCount = (_length + blockSize - 1) / blockSize;
+
+    size_t fftSize = _fft->GetSize();
+    _spectra.assign(_directions.size() * _partitionCount * fftSize, std::complex<float>());
+
+    for (size_t index = 0; index < _directions.size(); index++)
+    {
+        const float* response = _responses.data() + index * _length * 2;
+        for (size_t partition = 0; partition < _partitionCount; partition++)
+        {
+            std::complex<float>* spectrum = _spectra.data() + (index * _partitionCount + partition) * fftSize;
+            size_t first = partition * blockSize;
+            size_t count = std::min(blockSize, _length - first);
+            for (size_t i = 0; i < count; i++)
+            {
+                spectrum[i] = std::complex<float>(response[(first + i) * 2], response[(first + i) * 2 + 1]);
+            }
+            _fft->Forward(spectrum);
+        }
+    }
+
+    // The time domain copies are not needed for rendering.
+    _responses.clear();
+    _responses.shrink_to_fit();
+    return true;
+}
+
+size_t HrirSet::FindNearest(float x, float y, float z) const
+{
+    size_t nearest = 0;
+    float best = -2.0f;
+    for (size_t i = 0; i < _directions.size(); i++)
+    {
+        // The largest dot product is the smallest angle; no need to normalize the query.
+        float dot = _directions[i].x * x + _directions[i].y * y + _directions[i].z * z;
+        if (dot > best)
+        {
+            best = dot;
+            nearest = i;
+        }
+    }
+    return nearest;
+}
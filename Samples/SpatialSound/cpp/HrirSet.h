@@ -0,0 +1,89 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include "Fft.h"
+
+#include <memory>
+
+//
+// Set of head-related impulse responses (one left/right pair per direction), pre-transformed for
+// uniformly partitioned convolution.
+//
+// Coordinates follow the HRTF xAPO: right-handed, +x to the right, +y up and -z forward, in meters.
+// Azimuth is measured clockwise from the front (positive to the right) and elevation upwards, both in radians.
+//
+class HrirSet
+{
+public:
+    HrirSet();
+
+    // Adds a measured pair. Every pair must have the same length; call before Prepare.
+    bool Add(float azimuth, float elevation, const float* left, const float* right, size_t length);
+
+    // Builds an approximate set from a rigid spherical head model (Brown and Duda): per-ear delay plus a
+    // one-pole/one-zero head shadow filter. It gives convincing left/right and front/back level cues but
+    // no pinna (elevation) cues, so a measured set should be added instead where one is available.
+    static std::unique_ptr<HrirSet> CreateSphericalHeadModel(float sampleRate, float azimuthStepDegrees, float elevationStepDegrees);
+
+    // Splits every response into partitions of blockSize samples and transforms them.
+    // Must be called once, after all pairs were added and before the set is used for rendering;
+    // SoftwareSpatializer does this when it takes ownership of the set.
+    bool Prepare(size_t blockSize);
+
+    size_t GetCount() const
+    {
+        return _directions.size();
+    }
+
+    size_t GetBlockSize() const
+    {
+        return _blockSize;
+    }
+
+    size_t GetPartitionCount() const
+    {
+        return _partitionCount;
+    }
+
+    const Fft& GetFft() const
+    {
+        return *_fft;
+    }
+
+    // Returns the index of the direction closest to the given position (any distance).
+    size_t FindNearest(float x, float y, float z) const;
+
+    // Spectrum of one partition, packed as H_left + j * H_right so that a single complex multiply
+    // and a single inverse transform produce both ears (left in the real part, right in the imaginary part).
+    const std::complex<float>* GetPartition(size_t index, size_t partition) const
+    {
+        return _spectra.data() + (index * _partitionCount + partition) * _fft->GetSize();
+    }
+
+private:
+    struct Direction
+    {
+        float x;
+        float y;
+        float z;
+    };
+
+    std::vector<Direction>              _directions;
+    std::vector<float>                  _responses;     // Interleaved left/right, _length frames per direction.
+    size_t                              _length;
+
+    std::unique_ptr<Fft>                _fft;
+    std::vector<std::complex<float>>    _spectra;
+    size_t                              _blockSize;
+    size_t                              _partitionCount;
+};
@@ -14,15 +14,19 @@
 _Use_decl_annotations_
 HRESULT OmnidirectionalSound::Initialize(LPCWSTR filename)
 {
-    auto hr = _audioFile.Initialize(filename);
-
+    // Passing in nullptr as the first arg for HrtfApoInit initializes the APO with defaults of
+    // omnidirectional sound with natural distance decay behavior.
+    // CreateHrtfApo will fail with E_NOTIMPL on unsupported platforms, where the sound is spatialized in software instead.
     ComPtr<IXAPO> xapo;
+    auto hr = CreateHrtfApo(nullptr, &xapo);
+    if (hr == E_NOTIMPL)
+    {
+        return InitializeSoftwareRenderer(filename);
+    }
+
     if (SUCCEEDED(hr))
     {
-        // Passing in nullptr as the first arg for HrtfApoInit initializes the APO with defaults of
-        // omnidirectional sound with natural distance decay behavior.
-        // CreateHrtfApo will fail with E_NOTIMPL on unsupported platforms.
-        hr = CreateHrtfApo(nullptr, &xapo);
+        hr = _audioFile.Initialize(filename);
     }
 
     if (SUCCEEDED(hr))
@@ -40,24 +44,75 @@ HRESULT OmnidirectionalSound::Initialize(LPCWSTR filename)
     // The source voice is used to submit audio data and control playback.
     if (SUCCEEDED(hr))
     {
-        hr = SetupXAudio2(_audioFile.GetFormat(), xapo.Get(), &_xaudio2, &_sourceVoice);
+        hr = SetupXAudio2(_audioFile.GetFormat(), xapo.Get(), &_xaudio2, &_sourceVoice, _audioFile.IsStreaming() ? &_streamer : nullptr);
     }
 
     // Submit audio data to the source voice.
     if (SUCCEEDED(hr))
     {
-        XAUDIO2_BUFFER buffer{};
-        buffer.AudioBytes = static_cast<UINT32>(_audioFile.GetSize());
-        buffer.pAudioData = _audioFile.GetData();
-        buffer.LoopCount = XAUDIO2_LOOP_INFINITE;
-        hr = _sourceVoice->SubmitSourceBuffer(&buffer);
+        hr = SubmitAudioFile(&_audioFile, _sourceVoice, &_streamer);
+    }
+
+    return hr;
+}
+
+_Use_decl_annotations_
+HRESULT OmnidirectionalSound::InitializeSoftwareRenderer(LPCWSTR filename)
+{
+    // The file is decoded as it plays rather than loaded up front.
+    auto hr = _audioFile.InitializeStreaming(filename);
+
+    // The spatializer mixes at 48kHz and does not resample.
+    if (SUCCEEDED(hr))
+    {
+        auto format = _audioFile.GetFormat();
+        if (format->nChannels != 1 || format->wBitsPerSample != 16 || format->nSamplesPerSec != 48000)
+        {
+            hr = E_INVALIDARG;
+        }
+    }
+
+    // Render in 10ms blocks against a 15 degree spherical head model.
+    if (SUCCEEDED(hr))
+    {
+        _spatializer = std::make_unique<SoftwareSpatializer>(HrirSet::CreateSphericalHeadModel(48000.0f, 15.0f, 15.0f), 480);
+        _streamBuffer.resize(_spatializer->GetBlockSize());
+        _spatialSource = _spatializer->AddSource([this](float* buffer, size_t frames)
+        {
+            return ReadStream(buffer, frames);
+        });
+        hr = _spatialSource ? S_OK : E_FAIL;
+    }
+
+    if (SUCCEEDED(hr))
+    {
+        hr = _renderVoice.Initialize(_spatializer.get());
     }
 
     return hr;
 }
 
+// Called on the render thread for every block.
+_Use_decl_annotations_
+size_t OmnidirectionalSound::ReadStream(float* buffer, size_t frames)
+{
+    frames = (std::min)(frames, _streamBuffer.size());
+
+    size_t bytesRead = 0;
+    _audioFile.ReadStream(reinterpret_cast<BYTE*>(_streamBuffer.data()), frames * sizeof(int16_t), true, &bytesRead);
+
+    auto framesRead = bytesRead / sizeof(int16_t);
+    for (size_t i = 0; i < framesRead; i++)
+    {
+        buffer[i] = _streamBuffer[i] / 32768.0f;
+    }
+    return framesRead;
+}
+
 OmnidirectionalSound::~OmnidirectionalSound()
 {
+    _streamer.Detach();
+
     if (_sourceVoice)
     {
         _sourceVoice->DestroyVoice();
@@ -67,17 +122,23 @@ OmnidirectionalSound::~OmnidirectionalSound()
 HRESULT OmnidirectionalSound::Start()
 {
     _lastTick = GetTickCount64();
-    return _sourceVoice->Start();
+    return _spatializer ? _renderVoice.Start() : _sourceVoice->Start();
 }
 
 HRESULT OmnidirectionalSound::Stop()
 {
-    return _sourceVoice->Stop();
+    return _spatializer ? _renderVoice.Stop() : _sourceVoice->Stop();
 }
 
 _Use_decl_annotations_
 HRESULT OmnidirectionalSound::SetEnvironment(HrtfEnvironment environment)
 {
+    // The software renderer only models the direct path, so the environment has no effect there.
+    if (_spatializer)
+    {
+        return S_OK;
+    }
+
     // Environment can be changed at any time.
     return _hrtfParams->SetEnvironment(environment);
 }
@@ -95,6 +156,12 @@ HRESULT OmnidirectionalSound::OnUpdate(float angularVelocity, float height, floa
     _angle += elapsedTime * angularVelocity;
     _angle = _angle > HRTF_2PI ? (_angle - HRTF_2PI) : _angle;
     auto position = ComputePositionInOrbit(height, radius, _angle);
+    if (_spatialSource)
+    {
+        // The renderer crossfades to the new position over its next block.
+        _spatialSource->SetPosition(position.x, position.y, position.z);
+        return S_OK;
+    }
     return _hrtfParams->SetSourcePosition(&position);
 }
 
@@ -26,15 +26,27 @@ public:
     HRESULT SetEnvironment(_In_ HrtfEnvironment environment);
     HrtfEnvironment GetEnvironment() { return _environment; }
 
+    // True when the HRTF xAPO is not available and the sound is rendered by SoftwareSpatializer instead.
+    bool IsSoftwareRendered() const { return _spatializer != nullptr; }
+
 private:
     HrtfPosition ComputePositionInOrbit(_In_ float height, _In_ float radius, _In_ float angle);
+    HRESULT InitializeSoftwareRenderer(_In_ LPCWSTR filename);
+    size_t ReadStream(_Out_writes_(frames) float* buffer, _In_ size_t frames);
 
 private:
     AudioFileReader                 _audioFile;
+    ChunkedVoiceStreamer            _streamer;
     ComPtr<IXAudio2>                _xaudio2;
     IXAudio2SourceVoice*            _sourceVoice = nullptr;
     ComPtr<IXAPOHrtfParameters>     _hrtfParams;
     HrtfEnvironment                 _environment = HrtfEnvironment::Outdoors;
     ULONGLONG                       _lastTick = 0;
     float                           _angle = 0;
+
+    // Software rendering path. The render voice is declared last so that its thread stops first.
+    std::unique_ptr<SoftwareSpatializer>    _spatializer;
+    std::shared_ptr<SpatialSource>          _spatialSource;
+    std::vector<int16_t>                    _streamBuffer;
+    SpatialRenderVoice                      _renderVoice;
 };
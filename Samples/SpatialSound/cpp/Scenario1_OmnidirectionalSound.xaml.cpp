@@ -38,7 +38,14 @@ Scenario1_OmnidirectionalSound::Scenario1_OmnidirectionalSound() : _rootPage(Mai
         timespan.Duration = 10000 / 30;
         _timer->Interval = timespan;
         EnvironmentComboBox->SelectedIndex = static_cast<int>(_omnidirectionalSound.GetEnvironment());
-        _rootPage->NotifyUser("Stopped", NotifyType::StatusMessage);
+        if (_omnidirectionalSound.IsSoftwareRendered())
+        {
+            _rootPage->NotifyUser("HRTF API is not supported on this platform, using the software renderer. Environment settings have no effect. Stopped", NotifyType::StatusMessage);
+        }
+        else
+        {
+            _rootPage->NotifyUser("Stopped", NotifyType::StatusMessage);
+        }
     }
     else
     {
@@ -0,0 +1,207 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "SoftwareSpatializer.h"
+
+#include <algorithm>
+#include <cmath>
+
+const float SoftwareSpatializer::UnityGainDistance = 1.0f;
+
+namespace
+{
+    float DistanceGain(const float position[3])
+    {
+        float distance = sqrtf(position[0] * position[0] + position[1] * position[1] + position[2] * position[2]);
+        return (distance <= SoftwareSpatializer::UnityGainDistance) ? 1.0f : SoftwareSpatializer::UnityGainDistance / distance;
+    }
+}
+
+SpatialSource::SpatialSource(const HrirSet& hrirs, ReadFunction read) :
+    _read(read),
+    _positionChanged(true),
+    _historyHead(0),
+    _hrirIndex(0),
+    _gain(0),
+    _started(false)
+{
+    // Default to one meter in front of the listener.
+    _position[0] = 0;
+    _position[1] = 0;
+    _position[2] = -1.0f;
+
+    size_t fftSize = hrirs.GetFft().GetSize();
+    _input.assign(fftSize, 0.0f);
+    _history.assign(hrirs.GetPartitionCount() * fftSize, std::complex<float>());
+}
+
+void SpatialSource::SetPosition(float x, float y, float z)
+{
+    std::lock_guard<std::mutex> lock(_positionLock);
+    _position[0] = x;
+    _position[1] = y;
+    _position[2] = z;
+    _positionChanged = true;
+}
+
+void SpatialSource::Accumulate(const HrirSet& hrirs, size_t index, std::complex<float>* result) const
+{
+    size_t fftSize = hrirs.GetFft().GetSize();
+    size_t partitions = hrirs.GetPartitionCount();
+
+    std::fill(result, result + fftSize, std::complex<float>());
+
+    // Partition p of the response meets the input window from p blocks ago.
+    for (size_t p = 0; p < partitions; p++)
+    {
+        size_t slot = (_historyHead + partitions - p) % partitions;
+        // Spelled out on the float pairs; std::complex multiplication adds NaN/infinity handling
+        // that keeps the compiler from vectorizing this loop.
+        const float* input = reinterpret_cast<const float*>(_history.data() + slot * fftSize);
+        const float* response = reinterpret_cast<const float*>(hrirs.GetPartition(index, p));
+        float* sum = reinterpret_cast<float*>(result);
+        for (size_t i = 0; i < fftSize * 2; i += 2)
+        {
+            sum[i] += input[i] * response[i] - input[i + 1] * response[i + 1];
+            sum[i + 1] += input[i] * response[i + 1] + input[i + 1] * response[i];
+        }
+    }
+
+    hrirs.GetFft().Inverse(result);
+}
+
+void SpatialSource::RenderBlock(const HrirSet& hrirs, float* output, std::complex<float>* scratch, std::complex<float>* crossfadeScratch)
+{
+    size_t blockSize = hrirs.GetBlockSize();
+    size_t fftSize = hrirs.GetFft().GetSize();
+    size_t partitions = hrirs.GetPartitionCount();
+
+    float position[3];
+    bool positionChanged;
+    {
+        std::lock_guard<std::mutex> lock(_positionLock);
+        position[0] = _position[0];
+        position[1] = _position[1];
+        position[2] = _position[2];
+        positionChanged = _positionChanged;
+        _positionChanged = false;
+    }
+
+    size_t previousIndex = _hrirIndex;
+    float previousGain = _gain;
+    if (positionChanged)
+    {
+        _hrirIndex = hrirs.FindNearest(position[0], position[1], position[2]);
+        _gain = DistanceGain(position);
+    }
+
+    if (!_started)
+    {
+        // Nothing was rendered with the old values, so there is nothing to fade from.
+        previousIndex = _hrirIndex;
+        previousGain = _gain;
+        _started = true;
+    }
+
+    // Slide the input window by one block and append the new samples.
+    std::copy(_input.begin() + blockSize, _input.end(), _input.begin());
+    float* incoming = _input.data() + fftSize - blockSize;
+    size_t read = _read ? _read(incoming, blockSize) : 0;
+    std::fill(incoming + std::min(read, blockSize), incoming + blockSize, 0.0f);
+
+    _historyHead = (_historyHead + 1) % partitions;
+    std::complex<float>* spectrum = _history.data() + _historyHead * fftSize;
+    for (size_t i = 0; i < fftSize; i++)
+    {
+        spectrum[i] = std::complex<float>(_input[i], 0.0f);
+    }
+    hrirs.GetFft().Forward(spectrum);
+
+    // Overlap-save: only the last blockSize points of the inverse transform are free of wrap-around.
+    Accumulate(hrirs, _hrirIndex, scratch);
+    const std::complex<float>* current = scratch + fftSize - blockSize;
+
+    if (previousIndex != _hrirIndex)
+    {
+        // Both responses see the same input history, so fading between their outputs is click free.
+        Accumulate(hrirs, previousIndex, crossfadeScratch);
+        const std::complex<float>* previous = crossfadeScratch + fftSize - blockSize;
+        for (size_t i = 0; i < blockSize; i++)
+        {
+            float t = static_cast<float>(i + 1) / static_cast<float>(blockSize);
+            float currentGain = t * _gain;
+            float fadingGain = (1.0f - t) * previousGain;
+            output[i * 2] += current[i].real() * currentGain + previous[i].real() * fadingGain;
+            output[i * 2 + 1] += current[i].imag() * currentGain + previous[i].imag() * fadingGain;
+        }
+    }
+    else
+    {
+        // Same response; ramp the gain so that distance changes do not step.
+        for (size_t i = 0; i < blockSize; i++)
+        {
+            float t = static_cast<float>(i + 1) / static_cast<float>(blockSize);
+            float gain = previousGain + (_gain - previousGain) * t;
+            output[i * 2] += current[i].real() * gain;
+            output[i * 2 + 1] += current[i].imag() * gain;
+        }
+    }
+}
+
+SoftwareSpatializer::SoftwareSpatializer(std::unique_ptr<HrirSet> hrirs, size_t blockSize) :
+    _hrirs(std::move(hrirs))
+{
+    if (_hrirs->GetBlockSize() != blockSize && !_hrirs->Prepare(blockSize))
+    {
+        return;
+    }
+
+    _scratch.resize(_hrirs->GetFft().GetSize());
+    _crossfadeScratch.resize(_hrirs->GetFft().GetSize());
+}
+
+std::shared_ptr<SpatialSource> SoftwareSpatializer::AddSource(SpatialSource::ReadFunction read)
+{
+    if (!IsValid())
+    {
+        return nullptr;
+    }
+
+    auto source = std::make_shared<SpatialSource>(*_hrirs, read);
+
+    std::lock_guard<std::mutex> lock(_sourcesLock);
+    _sources.push_back(source);
+    return source;
+}
+
+void SoftwareSpatializer::RemoveSource(const std::shared_ptr<SpatialSource>& source)
+{
+    std::lock_guard<std::mutex> lock(_sourcesLock);
+    _sources.erase(std::remove(_sources.begin(), _sources.end(), source), _sources.end());
+}
+
+size_t SoftwareSpatializer::GetSourceCount() const
+{
+    std::lock_guard<std::mutex> lock(_sourcesLock);
+    return _sources.size();
+}
+
+void SoftwareSpatializer::RenderBlock(float* output)
+{
+    std::fill(output, output + GetBlockSize() * 2, 0.0f);
+
+    std::lock_guard<std::mutex> lock(_sourcesLock);
+    for (auto& source : _sources)
+    {
+        source->RenderBlock(*_hrirs, output, _scratch.data(), _crossfadeScratch.data());
+    }
+}
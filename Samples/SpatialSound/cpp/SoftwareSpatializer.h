@@ -0,0 +1,108 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include "HrirSet.h"
+
+#include <functional>
+#include <mutex>
+
+//
+// One positional source rendered by SoftwareSpatializer.
+// SetPosition may be called from any thread; the renderer picks the new position up at the start of
+// its next block and crossfades from the previous response over that block.
+//
+class SpatialSource
+{
+public:
+    // Fills buffer with up to frames mono samples and returns how many were written; the rest are
+    // treated as silence. Called on the render thread.
+    typedef std::function<size_t(float* buffer, size_t frames)> ReadFunction;
+
+    SpatialSource(const HrirSet& hrirs, ReadFunction read);
+
+    SpatialSource(const SpatialSource&) = delete;
+    SpatialSource& operator=(const SpatialSource&) = delete;
+
+    void SetPosition(float x, float y, float z);
+
+private:
+    friend class SoftwareSpatializer;
+
+    void RenderBlock(const HrirSet& hrirs, float* output, std::complex<float>* scratch, std::complex<float>* crossfadeScratch);
+    void Accumulate(const HrirSet& hrirs, size_t index, std::complex<float>* result) const;
+
+private:
+    ReadFunction                        _read;
+
+    std::mutex                          _positionLock;
+    float                               _position[3];
+    bool                                _positionChanged;
+
+    // Render thread state.
+    std::vector<float>                  _input;             // Last FFT size input samples.
+    std::vector<std::complex<float>>    _history;           // Spectra of the last partition count input windows.
+    size_t                              _historyHead;
+    size_t                              _hrirIndex;
+    float                               _gain;
+    bool                                _started;
+};
+
+//
+// Software HRTF renderer for many sources. Each source is convolved with the HRIR pair closest to its
+// direction using uniformly partitioned overlap-save convolution in the frequency domain, attenuated by
+// natural distance decay, and mixed into a stereo output.
+//
+// Rendering happens in fixed blocks of the size given at construction. Work per block and source is one forward
+// transform, one inverse transform and one complex multiply-add per partition; a block in which the
+// response changes costs one extra inverse transform for the crossfade.
+//
+class SoftwareSpatializer
+{
+public:
+    // Distance at which sources are rendered at unity gain, in meters; matches HRTF_DEFAULT_UNITY_GAIN_DISTANCE.
+    static const float UnityGainDistance;
+
+    // Prepares hrirs for blocks of blockSize frames, e.g. 480 for 10ms at 48kHz.
+    SoftwareSpatializer(std::unique_ptr<HrirSet> hrirs, size_t blockSize);
+
+    // False if the HRIR set was empty or already prepared for a different block size.
+    bool IsValid() const
+    {
+        return _hrirs->GetBlockSize() != 0;
+    }
+
+    SoftwareSpatializer(const SoftwareSpatializer&) = delete;
+    SoftwareSpatializer& operator=(const SoftwareSpatializer&) = delete;
+
+    size_t GetBlockSize() const
+    {
+        return _hrirs->GetBlockSize();
+    }
+
+    std::shared_ptr<SpatialSource> AddSource(SpatialSource::ReadFunction read);
+    void RemoveSource(const std::shared_ptr<SpatialSource>& source);
+    size_t GetSourceCount() const;
+
+    // Renders one block of GetBlockSize() interleaved stereo frames, replacing the contents of output.
+    void RenderBlock(float* output);
+
+private:
+    std::unique_ptr<HrirSet>                        _hrirs;
+
+    mutable std::mutex                              _sourcesLock;
+    std::vector<std::shared_ptr<SpatialSource>>     _sources;
+
+    // Render thread scratch, sized once for the FFT.
+    std::vector<std::complex<float>>                _scratch;
+    std::vector<std::complex<float>>                _crossfadeScratch;
+};
@@ -0,0 +1,74 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "pch.h"
+
+SpatialRenderVoice::~SpatialRenderVoice()
+{
+    _streamer.Detach();
+
+    if (_sourceVoice)
+    {
+        _sourceVoice->DestroyVoice();
+    }
+}
+
+_Use_decl_annotations_
+HRESULT SpatialRenderVoice::Initialize(SoftwareSpatializer* spatializer)
+{
+    auto blockSize = spatializer->GetBlockSize();
+    auto hr = _streamer.Initialize(blockSize * 2 * sizeof(float), BlockCount, [spatializer, blockSize](BYTE* buffer, size_t)
+    {
+        spatializer->RenderBlock(reinterpret_cast<float*>(buffer));
+        return blockSize * 2 * sizeof(float);
+    });
+
+    if (SUCCEEDED(hr))
+    {
+        hr = XAudio2Create(&_xaudio2);
+    }
+
+    // The spatializer already produces binaural stereo at 48kHz, so no effect chain is needed.
+    IXAudio2MasteringVoice* masteringVoice = nullptr;
+    if (SUCCEEDED(hr))
+    {
+        hr = _xaudio2->CreateMasteringVoice(&masteringVoice, 2, 48000);
+    }
+
+    if (SUCCEEDED(hr))
+    {
+        WAVEFORMATEX format{};
+        format.wFormatTag = WAVE_FORMAT_IEEE_FLOAT;
+        format.nChannels = 2;
+        format.nSamplesPerSec = 48000;
+        format.wBitsPerSample = 32;
+        format.nBlockAlign = format.nChannels * format.wBitsPerSample / 8;
+        format.nAvgBytesPerSec = format.nSamplesPerSec * format.nBlockAlign;
+        hr = _xaudio2->CreateSourceVoice(&_sourceVoice, &format, 0, XAUDIO2_DEFAULT_FREQ_RATIO, &_streamer);
+    }
+
+    if (SUCCEEDED(hr))
+    {
+        hr = _streamer.Attach(_sourceVoice);
+    }
+
+    return hr;
+}
+
+HRESULT SpatialRenderVoice::Start()
+{
+    return _sourceVoice->Start();
+}
+
+HRESULT SpatialRenderVoice::Stop()
+{
+    return _sourceVoice->Stop();
+}
@@ -0,0 +1,35 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+//
+// Plays the output of a SoftwareSpatializer through XAudio2.
+// The spatializer renders one block per chunk of a ChunkedVoiceStreamer, so it runs on the streamer's
+// worker thread a few blocks ahead of playback and never on the XAudio2 processing thread.
+//
+class SpatialRenderVoice
+{
+public:
+    virtual ~SpatialRenderVoice();
+    HRESULT Initialize(_In_ SoftwareSpatializer* spatializer);
+
+    HRESULT Start();
+    HRESULT Stop();
+
+private:
+    // Three blocks of 10ms keep enough audio queued to ride out scheduling hiccups.
+    static const UINT32             BlockCount = 3;
+
+    ComPtr<IXAudio2>                _xaudio2;
+    IXAudio2SourceVoice*            _sourceVoice = nullptr;
+    ChunkedVoiceStreamer            _streamer;
+};
@@ -13,7 +13,7 @@
 
 
 // Sets up XAudio2 for HRTF processing
-static HRESULT SetupXAudio2(_In_ const WAVEFORMATEX* format, _In_ IXAPO* xApo, _Outptr_ IXAudio2** xAudio2, _Outptr_ IXAudio2SourceVoice** sourceVoice)
+static HRESULT SetupXAudio2(_In_ const WAVEFORMATEX* format, _In_ IXAPO* xApo, _Outptr_ IXAudio2** xAudio2, _Outptr_ IXAudio2SourceVoice** sourceVoice, _In_opt_ IXAudio2VoiceCallback* callback = nullptr)
 {
     // Initialize XAudio2 for HRTF processing with "XAUDIO2_1024_QUANTUM" flag which specifies processing frame size of 1024 samples.
     ComPtr<IXAudio2> xAudio2Instance;
@@ -32,7 +32,7 @@ static HRESULT SetupXAudio2(_In_ const WAVEFORMATEX* format, _In_ IXAPO* xApo, _
     IXAudio2SourceVoice* sourceVoiceInstance = nullptr;
     if (SUCCEEDED(hr))
     {
-        hr = xAudio2Instance->CreateSourceVoice(&sourceVoiceInstance, format);
+        hr = xAudio2Instance->CreateSourceVoice(&sourceVoiceInstance, format, 0, XAUDIO2_DEFAULT_FREQ_RATIO, callback);
     }
 
     // Create a submix voice that will host the xAPO.
@@ -83,3 +83,33 @@ static HRESULT SetupXAudio2(_In_ const WAVEFORMATEX* format, _In_ IXAPO* xApo, _
     return hr;
 }
 
+// Queues the audio file on the source voice. A cached file is submitted once and looped by XAudio2;
+// a streamed file is decoded in chunks ahead of the voice by the streamer, which must be the voice's callback.
+static HRESULT SubmitAudioFile(_In_ AudioFileReader* audioFile, _In_ IXAudio2SourceVoice* sourceVoice, _In_ ChunkedVoiceStreamer* streamer)
+{
+    if (audioFile->IsStreaming())
+    {
+        // Four chunks of 100ms each are decoded ahead of playback.
+        auto format = audioFile->GetFormat();
+        size_t chunkBytes = (format->nAvgBytesPerSec / 10 / format->nBlockAlign) * format->nBlockAlign;
+        auto hr = streamer->Initialize(chunkBytes, 4, [audioFile](BYTE* buffer, size_t size)
+        {
+            size_t bytesRead = 0;
+            audioFile->ReadStream(buffer, size, true, &bytesRead);
+            return bytesRead;
+        });
+
+        if (SUCCEEDED(hr))
+        {
+            hr = streamer->Attach(sourceVoice);
+        }
+        return hr;
+    }
+
+    XAUDIO2_BUFFER buffer{};
+    buffer.AudioBytes = static_cast<UINT32>(audioFile->GetSize());
+    buffer.pAudioData = audioFile->GetData();
+    buffer.LoopCount = XAUDIO2_LOOP_INFINITE;
+    return sourceVoice->SubmitSourceBuffer(&buffer);
+}
+
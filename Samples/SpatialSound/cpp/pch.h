@@ -28,13 +28,19 @@
 #include <mfidl.h>
 #include <mfreadwrite.h>
 #include <strsafe.h>
+#include <atomic>
+#include <thread>
 
 using namespace Microsoft::WRL;
 using namespace Windows::UI::Xaml;
 using namespace Windows::Foundation;
 
+#include "GameContent\DecodedAudioCache.h"
 #include "AudioFileReader.h"
+#include "ChunkedVoiceStreamer.h"
 #include "XAudio2Helpers.h"
+#include "SoftwareSpatializer.h"
+#include "SpatialRenderVoice.h"
 #include "App.xaml.h"
 #include "OmnidirectionalSound.h"
 #include "CardioidSound.h"
@@ -0,0 +1,370 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "MessageReassembler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace SDKTemplate
+{
+    bool Utf8Validator::Feed(uint8_t const* data, size_t size)
+    {
+        if (m_failed)
+        {
+            return false;
+        }
+
+        size_t i = 0;
+
+        // Finish a code point that started in an earlier piece.
+        while ((m_needed > 0) && (i < size))
+        {
+            uint8_t byte = data[i++];
+            if ((byte < m_lower) || (byte > m_upper))
+            {
+                m_failed = true;
+                return false;
+            }
+            m_lower = 0x80;
+            m_upper = 0xBF;
+            m_pending = (--m_needed == 0) ? 0 : m_pending + 1;
+        }
+
+        while (i < size)
+        {
+            // Text is mostly ASCII, so skip it a word at a time.
+            while (size - i >= sizeof(uint64_t))
+            {
+                uint64_t word;
+                std::memcpy(&word, data + i, sizeof(word));
+                if ((word & 0x8080808080808080) != 0)
+                {
+                    break;
+                }
+                i += sizeof(word);
+            }
+            while ((i < size) && (data[i] < 0x80))
+            {
+                i++;
+            }
+            if (i == size)
+            {
+                break;
+            }
+
+            // The ranges of the first continuation byte exclude overlong forms (E0, F0),
+            // surrogates (ED) and code points above U+10FFFF (F4).
+            uint8_t byte = data[i];
+            uint8_t needed;
+            uint8_t lower = 0x80;
+            uint8_t upper = 0xBF;
+            if (byte < 0xC2)
+            {
+                m_failed = true;
+                return false;
+            }
+            else if (byte < 0xE0)
+            {
+                needed = 1;
+            }
+            else if (byte < 0xF0)
+            {
+                needed = 2;
+                lower = (byte == 0xE0) ? 0xA0 : 0x80;
+                upper = (byte == 0xED) ? 0x9F : 0xBF;
+            }
+            else if (byte < 0xF5)
+            {
+                needed = 3;
+                lower = (byte == 0xF0) ? 0x90 : 0x80;
+                upper = (byte == 0xF4) ? 0x8F : 0xBF;
+            }
+            else
+            {
+                m_failed = true;
+                return false;
+            }
+
+            // Check as much of the code point as this piece holds, and keep the state for the rest.
+            size_t available = std::min<size_t>(needed, size - i - 1);
+            for (size_t k = 1; k <= available; k++)
+            {
+                uint8_t next = data[i + k];
+                if ((next < lower) || (next > upper))
+                {
+                    m_failed = true;
+                    return false;
+                }
+                lower = 0x80;
+                upper = 0xBF;
+            }
+            i += available + 1;
+            if (available < needed)
+            {
+                m_needed = static_cast<uint8_t>(needed - available);
+                m_pending = static_cast<uint8_t>(available + 1);
+                m_lower = lower;
+                m_upper = upper;
+            }
+        }
+        return true;
+    }
+
+    template <typename Char>
+    void MessagePart::AppendUtf16(std::basic_string<Char>& text) const
+    {
+        // A part holds whole, valid code points, and never needs more code units than bytes.
+        size_t start = text.size();
+        text.resize(start + m_size);
+        Char* output = &text[0] + start;
+
+        uint32_t codePoint = 0;
+        int needed = 0;
+        for (std::string_view span : m_spans)
+        {
+            uint8_t const* input = reinterpret_cast<uint8_t const*>(span.data());
+            uint8_t const* end = input + span.size();
+            while (input < end)
+            {
+                uint8_t byte = *input++;
+                if (needed == 0)
+                {
+                    if (byte < 0x80)
+                    {
+                        // Copy the rest of an ASCII run without going through the decoder, a word at
+                        // a time where possible.
+                        *output++ = static_cast<Char>(byte);
+                        while (end - input >= 8)
+                        {
+                            uint8_t bytes[8];
+                            uint64_t word;
+                            std::memcpy(bytes, input, sizeof(bytes));
+                            std::memcpy(&word, bytes, sizeof(word));
+                            if ((word & 0x8080808080808080) != 0)
+                            {
+                                break;
+                            }
+                            for (size_t k = 0; k < sizeof(bytes); k++)
+                            {
+                                output[k] = static_cast<Char>(bytes[k]);
+                            }
+                            input += sizeof(bytes);
+                            output += sizeof(bytes);
+                        }
+                        while ((input < end) && (*input < 0x80))
+                        {
+                            *output++ = static_cast<Char>(*input++);
+                        }
+                        continue;
+                    }
+                    else if (byte < 0xE0)
+                    {
+                        codePoint = byte & 0x1F;
+                        needed = 1;
+                    }
+                    else if (byte < 0xF0)
+                    {
+                        codePoint = byte & 0x0F;
+                        needed = 2;
+                    }
+                    else
+                    {
+                        codePoint = byte & 0x07;
+                        needed = 3;
+                    }
+                }
+                else
+                {
+                    codePoint = (codePoint << 6) | (byte & 0x3F);
+                    if (--needed == 0)
+                    {
+                        if (codePoint < 0x10000)
+                        {
+                            *output++ = static_cast<Char>(codePoint);
+                        }
+                        else
+                        {
+                            codePoint -= 0x10000;
+                            *output++ = static_cast<Char>(0xD800 + (codePoint >> 10));
+                            *output++ = static_cast<Char>(0xDC00 + (codePoint & 0x3FF));
+                        }
+                    }
+                }
+            }
+        }
+        text.resize(output - text.data());
+    }
+
+    MessageReassembler::MessageReassembler(size_t maxBufferedBytes, size_t segmentSize, PartFunction onPart) :
+        m_maxBufferedBytes(maxBufferedBytes), m_segmentSize(segmentSize), m_onPart(std::move(onPart))
+    {
+        if ((maxBufferedBytes < 4) || (segmentSize < 4))
+        {
+            throw std::invalid_argument("The buffer limit and segment size must be at least 4 bytes.");
+        }
+    }
+
+    bool MessageReassembler::AddFragment(MessageKind kind, void const* data, size_t size, bool isLastFragment)
+    {
+        uint8_t const* source = static_cast<uint8_t const*>(data);
+        return AddFragment(kind, size, isLastFragment, [&source](uint8_t* destination, size_t count)
+        {
+            std::memcpy(destination, source, count);
+            source += count;
+        });
+    }
+
+    void MessageReassembler::Reset()
+    {
+        Recycle();
+        m_inMessage = false;
+        m_dropping = false;
+    }
+
+    void MessageReassembler::StartFragment(MessageKind kind)
+    {
+        if (!m_inMessage)
+        {
+            m_inMessage = true;
+            m_part.m_kind = kind;
+            m_part.m_offset = 0;
+            m_validator.Reset();
+        }
+    }
+
+    std::pair<uint8_t*, size_t> MessageReassembler::Reserve(size_t size)
+    {
+        if (m_segments.empty() || (m_used == m_segmentSize))
+        {
+            if (m_freeSegments.empty())
+            {
+                m_segments.emplace_back(new uint8_t[m_segmentSize]);
+                m_segmentCount++;
+            }
+            else
+            {
+                m_segments.push_back(std::move(m_freeSegments.back()));
+                m_freeSegments.pop_back();
+            }
+            m_used = 0;
+        }
+
+        // Commit delivers a part as soon as the limit is reached, so there is always room here.
+        size_t count = std::min({ size, m_segmentSize - m_used, m_maxBufferedBytes - m_bufferedBytes });
+        return { m_segments.back().get() + m_used, count };
+    }
+
+    void MessageReassembler::Commit(size_t count)
+    {
+        // Validate the bytes while they are still in the cache.
+        if ((m_part.m_kind == MessageKind::Text) && !m_validator.Feed(m_segments.back().get() + m_used, count))
+        {
+            Recycle();
+            m_dropping = true;
+            return;
+        }
+
+        m_used += count;
+        m_bufferedBytes += count;
+        if (m_bufferedBytes == m_maxBufferedBytes)
+        {
+            Deliver(false);
+        }
+    }
+
+    bool MessageReassembler::EndFragment(bool isLastFragment)
+    {
+        bool valid = !m_dropping;
+        if (isLastFragment)
+        {
+            // A text message can't end in the middle of a code point.
+            if (valid && (m_validator.GetPendingByteCount() > 0))
+            {
+                valid = false;
+            }
+
+            if (valid)
+            {
+                Deliver(true);
+                m_messageCount++;
+            }
+            Reset();
+        }
+        return valid;
+    }
+
+    void MessageReassembler::Deliver(bool isLast)
+    {
+        // The bytes of an incomplete code point at the end stay behind for the next part.
+        size_t pending = isLast ? 0 : m_validator.GetPendingByteCount();
+        size_t size = m_bufferedBytes - pending;
+
+        m_part.m_isLast = isLast;
+        m_part.m_size = size;
+        m_part.m_spans.clear();
+        for (size_t remaining = size, i = 0; remaining > 0; i++)
+        {
+            size_t length = std::min(remaining, m_segmentSize);
+            m_part.m_spans.emplace_back(reinterpret_cast<char const*>(m_segments[i].get()), length);
+            remaining -= length;
+        }
+
+        try
+        {
+            m_onPart(m_part);
+        }
+        catch (...)
+        {
+            Reset();
+            throw;
+        }
+
+        m_part.m_offset += size;
+        m_partCount++;
+        m_byteCount += size;
+
+        uint8_t carry[4];
+        for (size_t i = 0, segment = m_segments.size() - 1, used = m_used; i < pending; i++)
+        {
+            if (used == 0)
+            {
+                segment--;
+                used = m_segmentSize;
+            }
+            carry[pending - 1 - i] = m_segments[segment][--used];
+        }
+        Recycle();
+        if (pending > 0)
+        {
+            std::pair<uint8_t*, size_t> space = Reserve(pending);
+            std::memcpy(space.first, carry, pending);
+            m_used = pending;
+            m_bufferedBytes = pending;
+        }
+    }
+
+    void MessageReassembler::Recycle()
+    {
+        for (std::unique_ptr<uint8_t[]>& segment : m_segments)
+        {
+            m_freeSegments.push_back(std::move(segment));
+        }
+        m_segments.clear();
+        m_used = 0;
+        m_bufferedBytes = 0;
+    }
+
+    template void MessagePart::AppendUtf16(std::basic_string<wchar_t>& text) const;
+    template void MessagePart::AppendUtf16(std::basic_string<char16_t>& text) const;
+}
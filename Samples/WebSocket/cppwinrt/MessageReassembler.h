@@ -0,0 +1,172 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+// Puts WebSocket messages back together from the fragments that MessageWebSocket raises in
+// MessageWebSocketReceiveMode::PartialMessage. Fragments are copied once, straight from the reader
+// into fixed-size segments that are recycled between messages, and text messages are checked for
+// valid UTF-8 as they arrive, so a code point may be split across fragments. This file only depends
+// on the C++ standard library.
+//
+// Memory is bounded: a message that fits in the buffer limit is delivered whole once its last
+// fragment arrives, and a longer one is delivered in parts of at most the limit. Parts of a text
+// message always end on a code point boundary, so each part is valid UTF-8 by itself.
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace SDKTemplate
+{
+    enum class MessageKind
+    {
+        Text,       // Validated as UTF-8.
+        Binary,
+    };
+
+    // Checks UTF-8 text that arrives in pieces. Overlong forms, surrogates and code points above
+    // U+10FFFF are rejected, as RFC 6455 requires for text messages.
+    class Utf8Validator
+    {
+    public:
+        // Returns false once the text seen so far can't be the start of valid UTF-8; the validator
+        // stays in that state until Reset.
+        bool Feed(uint8_t const* data, size_t size);
+
+        bool IsValid() const { return !m_failed; }
+
+        // Bytes at the end of the text seen so far that begin a code point whose remaining bytes
+        // haven't been fed yet. Zero when the text ends on a code point boundary.
+        size_t GetPendingByteCount() const { return m_pending; }
+
+        void Reset() { *this = Utf8Validator(); }
+
+    private:
+        uint8_t m_needed = 0;       // Continuation bytes still to come.
+        uint8_t m_pending = 0;
+        uint8_t m_lower = 0x80;     // Range of the next continuation byte.
+        uint8_t m_upper = 0xBF;
+        bool m_failed = false;
+    };
+
+    // Part of a message, made of spans that point into the reassembler's segments and stay valid
+    // until the callback returns. A part that is both first and last is a whole message.
+    class MessagePart
+    {
+    public:
+        MessageKind GetKind() const { return m_kind; }
+        bool IsFirst() const { return m_offset == 0; }
+        bool IsLast() const { return m_isLast; }
+
+        // Offset of the part from the start of the message, and its size in bytes.
+        uint64_t GetOffset() const { return m_offset; }
+        size_t GetSize() const { return m_size; }
+
+        size_t GetSpanCount() const { return m_spans.size(); }
+        std::string_view GetSpan(size_t index) const { return m_spans[index]; }
+
+        // Appends the part as UTF-16 code units. Only valid for text parts.
+        template <typename Char>
+        void AppendUtf16(std::basic_string<Char>& text) const;
+
+    private:
+        friend class MessageReassembler;
+
+        MessageKind m_kind = MessageKind::Text;
+        bool m_isLast = false;
+        uint64_t m_offset = 0;
+        size_t m_size = 0;
+        std::vector<std::string_view> m_spans;
+    };
+
+    class MessageReassembler
+    {
+    public:
+        typedef std::function<void(MessagePart const& part)> PartFunction;
+
+        // Buffers up to maxBufferedBytes of a message in segments of segmentSize bytes. Both need
+        // to be at least 4, so that a part of a text message always holds a whole code point;
+        // throws std::invalid_argument otherwise.
+        MessageReassembler(size_t maxBufferedBytes, size_t segmentSize, PartFunction onPart);
+
+        MessageReassembler(const MessageReassembler&) = delete;
+        MessageReassembler& operator=(const MessageReassembler&) = delete;
+
+        // Adds the next fragment of the current message; the kind is taken from the first fragment.
+        // Parts that become ready are delivered before this returns. Returns false if the message
+        // is text that isn't valid UTF-8, in which case the rest of it is dropped and the
+        // connection should be closed with status 1007.
+        bool AddFragment(MessageKind kind, void const* data, size_t size, bool isLastFragment);
+
+        // Same as above, but has read(destination, count) copy the fragment into the segments in
+        // pieces, so it needn't be contiguous anywhere else. Nothing is read from a fragment of a
+        // message that is being dropped.
+        template <typename ReadFunction>
+        bool AddFragment(MessageKind kind, size_t size, bool isLastFragment, ReadFunction&& read)
+        {
+            StartFragment(kind);
+            while ((size > 0) && !m_dropping)
+            {
+                std::pair<uint8_t*, size_t> space = Reserve(size);
+                read(space.first, space.second);
+                Commit(space.second);
+                size -= space.second;
+            }
+            return EndFragment(isLastFragment);
+        }
+
+        // Drops the message in progress, for example when the connection closes.
+        void Reset();
+
+        uint64_t GetMessageCount() const { return m_messageCount; }
+        uint64_t GetPartCount() const { return m_partCount; }
+        uint64_t GetByteCount() const { return m_byteCount; }
+        size_t GetSegmentCount() const { return m_segmentCount; }
+
+    private:
+        void StartFragment(MessageKind kind);
+        std::pair<uint8_t*, size_t> Reserve(size_t size);
+        void Commit(size_t count);
+        bool EndFragment(bool isLastFragment);
+        void Deliver(bool isLast);
+        void Recycle();
+
+        size_t m_maxBufferedBytes;
+        size_t m_segmentSize;
+        PartFunction m_onPart;
+
+        // Segments holding the buffered bytes, the last one filled up to m_used, and segments
+        // waiting to be reused. Every segment ever allocated is in one of the two lists.
+        std::vector<std::unique_ptr<uint8_t[]>> m_segments;
+        std::vector<std::unique_ptr<uint8_t[]>> m_freeSegments;
+        size_t m_used = 0;
+        size_t m_bufferedBytes = 0;
+        size_t m_segmentCount = 0;
+
+        bool m_inMessage = false;
+        bool m_dropping = false;
+        Utf8Validator m_validator;
+        MessagePart m_part;
+
+        uint64_t m_messageCount = 0;
+        uint64_t m_partCount = 0;
+        uint64_t m_byteCount = 0;
+    };
+
+    extern template void MessagePart::AppendUtf16(std::basic_string<wchar_t>& text) const;
+    extern template void MessagePart::AppendUtf16(std::basic_string<char16_t>& text) const;
+}
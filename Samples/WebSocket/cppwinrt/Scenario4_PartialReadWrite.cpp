@@ -22,6 +22,14 @@ using namespace winrt::Windows::Storage::Streams;
 using namespace winrt::Windows::UI::Xaml;
 using namespace winrt::Windows::UI::Xaml::Navigation;
 
+namespace
+{
+    // Messages up to this size are shown once they are complete. Longer ones are shown in parts of
+    // this size as they arrive, so a large message never needs more than this much memory.
+    constexpr size_t MaxBufferedMessageBytes = 64 * 1024;
+    constexpr size_t MessageSegmentBytes = 4096;
+}
+
 namespace winrt::SDKTemplate::implementation
 {
     Scenario4_PartialReadWrite::Scenario4_PartialReadWrite()
@@ -97,7 +105,24 @@ namespace winrt::SDKTemplate::implementation
         // as opposed to waiting until the EndOfMessage to process the entire data.
         m_messageWebSocket.Control().ReceiveMode(MessageWebSocketReceiveMode::PartialMessage);
 
-        m_messageWebSocket.MessageReceived({ get_weak(), &Scenario4_PartialReadWrite::MessageReceived });
+        // Fragments are put back together on the thread that raises MessageReceived, so the UI thread
+        // is only involved once per message. Each socket has its own reassembler, which lives as long
+        // as the handler.
+        auto reassembler = std::make_shared<::SDKTemplate::MessageReassembler>(MaxBufferedMessageBytes, MessageSegmentBytes,
+            [weak = get_weak()](::SDKTemplate::MessagePart const& part)
+        {
+            if (auto self = weak.get())
+            {
+                self->MessagePartReceived(part);
+            }
+        });
+        m_messageWebSocket.MessageReceived([weak = get_weak(), reassembler](MessageWebSocket const& sender, MessageWebSocketMessageReceivedEventArgs const& e)
+        {
+            if (auto self = weak.get())
+            {
+                self->MessageReceived(sender, e, *reassembler);
+            }
+        });
         m_messageWebSocket.Closed({ get_weak(), &Scenario4_PartialReadWrite::OnClosed });
 
         if (server.SchemeName() == L"wss")
@@ -178,36 +203,64 @@ namespace winrt::SDKTemplate::implementation
         m_rootPage.NotifyUser(L"Send Complete", NotifyType::StatusMessage);
     }
 
-    IAsyncAction Scenario4_PartialReadWrite::MessageReceived(MessageWebSocket sender, MessageWebSocketMessageReceivedEventArgs e)
+    // Raised on a worker thread, one fragment at a time.
+    void Scenario4_PartialReadWrite::MessageReceived(MessageWebSocket const& sender, MessageWebSocketMessageReceivedEventArgs const& e, ::SDKTemplate::MessageReassembler& reassembler)
     {
-        auto lifetime = get_strong();
+        ::SDKTemplate::MessageKind kind = (e.MessageType() == SocketMessageType::Utf8) ? ::SDKTemplate::MessageKind::Text : ::SDKTemplate::MessageKind::Binary;
 
-        co_await m_rootPage.Dispatcher();
-
-        hstring partialOrCompleted = L"Partial";
+        try
+        {
+            // The fragment is read straight into the reassembler's buffers. A partial UTF8 message may be
+            // split in the middle of a multi-byte character; the reassembler only hands out whole characters.
+            DataReader reader = e.GetDataReader();
+            bool isValid = reassembler.AddFragment(kind, reader.UnconsumedBufferLength(), e.IsMessageComplete(), [&reader](uint8_t* data, size_t count)
+            {
+                reader.ReadBytes(array_view<uint8_t>(data, data + count));
+            });
 
-        if (e.IsMessageComplete())
+            if (!isValid)
+            {
+                // RFC 6455 requires the connection to be closed when a text message is not valid UTF8.
+                sender.Close(1007, L"Invalid UTF8 data in a text message.");
+            }
+        }
+        catch (winrt::hresult_error const& ex)
         {
-            partialOrCompleted = L"Complete";
+            reassembler.Reset();
+            AppendOutputLinesAsync(BuildWebSocketError(ex), ex.message());
         }
-        
-        AppendOutputLine(partialOrCompleted + L" message Received; Type: " + to_hstring(e.MessageType()));
-        DataReader reader = e.GetDataReader();
+    }
+
+    // Called from MessageReceived with a complete message, or with part of a message that is too long
+    // to buffer.
+    void Scenario4_PartialReadWrite::MessagePartReceived(::SDKTemplate::MessagePart const& part)
+    {
+        bool isText = (part.GetKind() == ::SDKTemplate::MessageKind::Text);
 
-        reader.UnicodeEncoding(UnicodeEncoding::Utf8);
+        hstring header = (part.IsFirst() && part.IsLast()) ? hstring(L"Complete message received") : L"Partial message received at offset " + to_hstring(part.GetOffset());
+        header = header + L"; Type: " + to_hstring(isText ? SocketMessageType::Utf8 : SocketMessageType::Binary) + L", " + to_hstring(part.GetSize()) + L" bytes";
 
-        try
+        // Convert the text before switching threads, so the UI thread only has to display it.
+        std::wstring text;
+        if (isText)
         {
-            // Note that it may be possible for partial UTF8 messages to be split between a character if it
-            // extends multiple bytes. We avoid this by using only ASCII characters in this example. 
-            // Should your application use multi-byte characters, you will need to do checks for broken characters.
-            hstring read = reader.ReadString(reader.UnconsumedBufferLength());
-            AppendOutputLine(read);
+            part.AppendUtf16(text);
         }
-        catch (winrt::hresult_error const& ex)
+        AppendOutputLinesAsync(header, hstring(text));
+    }
+
+    fire_and_forget Scenario4_PartialReadWrite::AppendOutputLinesAsync(hstring header, hstring text)
+    {
+        auto lifetime = get_strong();
+
+        // Continue on the UI thread so we can update UI. Dispatched work runs in the order it was
+        // queued, so messages are shown in the order they were received.
+        co_await resume_foreground(Dispatcher());
+
+        AppendOutputLine(header);
+        if (!text.empty())
         {
-            AppendOutputLine(BuildWebSocketError(ex));
-            AppendOutputLine(ex.message());
+            AppendOutputLine(text);
         }
     }
 
@@ -12,6 +12,7 @@
 #pragma once
 
 #include "Scenario4_PartialReadWrite.g.h"
+#include "MessageReassembler.h"
 
 namespace winrt::SDKTemplate::implementation
 {
@@ -27,7 +28,9 @@ namespace winrt::SDKTemplate::implementation
     private:
         Windows::Foundation::IAsyncAction ConnectAsync();
         Windows::Foundation::IAsyncAction SendAsync();
-        Windows::Foundation::IAsyncAction MessageReceived(Windows::Networking::Sockets::MessageWebSocket sender, Windows::Networking::Sockets::MessageWebSocketMessageReceivedEventArgs e);
+        void MessageReceived(Windows::Networking::Sockets::MessageWebSocket const& sender, Windows::Networking::Sockets::MessageWebSocketMessageReceivedEventArgs const& e, ::SDKTemplate::MessageReassembler& reassembler);
+        void MessagePartReceived(::SDKTemplate::MessagePart const& part);
+        winrt::fire_and_forget AppendOutputLinesAsync(hstring header, hstring text);
         Windows::Foundation::IAsyncAction OnClosed(Windows::Networking::Sockets::IWebSocket sender, Windows::Networking::Sockets::WebSocketClosedEventArgs e);
         void CloseSocket();
         void AppendOutputLine(hstring const& value);
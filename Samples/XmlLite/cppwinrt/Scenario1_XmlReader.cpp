@@ -13,6 +13,7 @@
 #include "Scenario1_XmlReader.h"
 #include "Scenario1_XmlReader.g.cpp"
 #include "SampleConfiguration.h"
+#include "XmlRecordExtractor.h"
 
 using namespace winrt;
 using namespace winrt::Windows::ApplicationModel;
@@ -33,13 +34,21 @@ namespace winrt::SDKTemplate::implementation
         auto lifetime = get_strong();
 
         std::wostringstream result;
+        bool extractRecords = ExtractRecordsCheckBox().IsChecked().Value();
         try
         {
             StorageFolder installFolder = Package::Current().InstalledLocation();
             StorageFile file = co_await installFolder.GetFileAsync(L"Stocks.xml");
             IRandomAccessStream randomAccessReadStream = co_await file.OpenAsync(FileAccessMode::Read);
             com_ptr<IStream> readStream = capture<IStream>(::CreateStreamOverRandomAccessStream, winrt::get_unknown(randomAccessReadStream));
-            ReadXml(result, readStream);
+            if (extractRecords)
+            {
+                ExtractStocks(result, readStream);
+            }
+            else
+            {
+                ReadXml(result, readStream);
+            }
         }
         catch (hresult_error const& e)
         {
@@ -171,4 +180,96 @@ namespace winrt::SDKTemplate::implementation
             }
         } while (check_enumerator(reader->MoveToNextAttribute()));
     }
+
+    // Reads only the stock fields. The extractor tells the loop which attributes and text it needs,
+    // so the values of every other node are never fetched, let alone formatted.
+    void Scenario1_XmlReader::ExtractStocks(std::wostream& result, com_ptr<IStream> const& readStream)
+    {
+        ::SDKTemplate::XmlRecordSchema schema("portfolio/stock");
+        uint32_t exchangeField = schema.AddField("@exchange", ::SDKTemplate::XmlFieldType::String);
+        uint32_t nameField = schema.AddField("name", ::SDKTemplate::XmlFieldType::String);
+        uint32_t symbolField = schema.AddField("symbol", ::SDKTemplate::XmlFieldType::String);
+        uint32_t priceField = schema.AddField("price", ::SDKTemplate::XmlFieldType::Number);
+
+        ::SDKTemplate::XmlRecordExtractor<wchar_t> extractor(schema, 256, [&](::SDKTemplate::XmlRecordBatch<wchar_t> const& batch)
+        {
+            for (size_t i = 0; i < batch.GetRecordCount(); i++)
+            {
+                result << batch.GetString(i, symbolField) << L" (" << batch.GetString(i, nameField) << L", " <<
+                    batch.GetString(i, exchangeField) << L"): ";
+                if (batch.GetState(i, priceField) == ::SDKTemplate::XmlFieldState::Present)
+                {
+                    result << batch.GetNumber(i, priceField) << L"\n";
+                }
+                else
+                {
+                    result << L"no price\n";
+                }
+            }
+        });
+
+        com_ptr<IXmlReader> reader;
+        check_hresult(::CreateXmlReader(IID_PPV_ARGS(&reader), nullptr));
+        check_hresult(reader->SetProperty(XmlReaderProperty_DtdProcessing, DtdProcessing_Prohibit));
+        check_hresult(reader->SetInput(readStream.get()));
+
+        XmlNodeType nodeType;
+        while (check_enumerator(reader->Read(&nodeType)))
+        {
+            PCWSTR localName = nullptr;
+            PCWSTR value = nullptr;
+
+            UINT localNameSize = 0;
+            UINT valueSize = 0;
+
+            switch (nodeType)
+            {
+            case XmlNodeType_Element:
+                check_hresult(reader->GetLocalName(&localName, &localNameSize));
+                extractor.StartElement({ localName, localNameSize });
+
+                if (extractor.WantsAttributes() && check_enumerator(reader->MoveToFirstAttribute()))
+                {
+                    do
+                    {
+                        check_hresult(reader->GetLocalName(&localName, &localNameSize));
+                        uint32_t field = extractor.FindAttribute({ localName, localNameSize });
+                        if (field != ::SDKTemplate::XmlRecordExtractor<wchar_t>::NoField)
+                        {
+                            check_hresult(reader->GetValue(&value, &valueSize));
+                            extractor.Attribute(field, { value, valueSize });
+                        }
+                    } while (check_enumerator(reader->MoveToNextAttribute()));
+                    check_hresult(reader->MoveToElement());
+                }
+
+                // Empty elements have no EndElement node.
+                if (reader->IsEmptyElement())
+                {
+                    extractor.EndElement();
+                }
+                break;
+
+            case XmlNodeType_EndElement:
+                extractor.EndElement();
+                break;
+
+            case XmlNodeType_Text:
+            case XmlNodeType_CDATA:
+            case XmlNodeType_Whitespace:
+                if (extractor.WantsText())
+                {
+                    check_hresult(reader->GetValue(&value, &valueSize));
+                    extractor.Text({ value, valueSize });
+                }
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        extractor.Finish();
+        result << extractor.GetRecordCount() << L" stocks, " << extractor.GetSkippedElementCount() << L" elements skipped\n";
+    }
 }
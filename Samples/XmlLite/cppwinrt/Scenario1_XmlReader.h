@@ -24,6 +24,7 @@ namespace winrt::SDKTemplate::implementation
     private:
         static void ReadXml(std::wostream& result, com_ptr<IStream> const& readStream);
         static void ReadAttributes(std::wostream& result, com_ptr<IXmlReader> const& reader);
+        static void ExtractStocks(std::wostream& result, com_ptr<IStream> const& readStream);
     };
 }
 
@@ -0,0 +1,704 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "XmlPullTokenizer.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace SDKTemplate;
+
+namespace
+{
+    bool IsSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    bool IsNameEnd(char c)
+    {
+        return IsSpace(c) || c == '/' || c == '>' || c == '=' || c == '<' || c == '"' || c == '\'';
+    }
+
+    bool IsXmlChar(uint32_t c)
+    {
+        return c == 0x9 || c == 0xA || c == 0xD || (c >= 0x20 && c <= 0xD7FF) || (c >= 0xE000 && c <= 0xFFFD) || (c >= 0x10000 && c <= 0x10FFFF);
+    }
+
+    // Writes the UTF-8 form of a character and returns its length.
+    size_t EncodeUtf8(uint32_t c, char* out)
+    {
+        if (c < 0x80)
+        {
+            out[0] = static_cast<char>(c);
+            return 1;
+        }
+        if (c < 0x800)
+        {
+            out[0] = static_cast<char>(0xC0 | (c >> 6));
+            out[1] = static_cast<char>(0x80 | (c & 0x3F));
+            return 2;
+        }
+        if (c < 0x10000)
+        {
+            out[0] = static_cast<char>(0xE0 | (c >> 12));
+            out[1] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out[2] = static_cast<char>(0x80 | (c & 0x3F));
+            return 3;
+        }
+        out[0] = static_cast<char>(0xF0 | (c >> 18));
+        out[1] = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+        out[2] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+        out[3] = static_cast<char>(0x80 | (c & 0x3F));
+        return 4;
+    }
+
+    bool EqualsIgnoreCase(std::string_view a, std::string_view b)
+    {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y)
+        {
+            return ((x >= 'A' && x <= 'Z') ? x - 'A' + 'a' : x) == ((y >= 'A' && y <= 'Z') ? y - 'A' + 'a' : y);
+        });
+    }
+
+    // Returns 1 if the literal is at the position, 0 if it isn't, and -1 if the data ends before
+    // that can be decided.
+    int MatchAt(std::string_view data, size_t position, std::string_view literal)
+    {
+        size_t available = std::min(literal.size(), data.size() - position);
+        if (data.compare(position, available, literal, 0, available) != 0)
+        {
+            return 0;
+        }
+        return (available == literal.size()) ? 1 : -1;
+    }
+}
+
+XmlPullTokenizer::XmlPullTokenizer(ReadFunction read, size_t bufferSize) :
+    m_read(std::move(read)),
+    m_buffer(std::max<size_t>(bufferSize, 16))
+{
+    m_openNameLengths.reserve(32);
+}
+
+XmlTokenType XmlPullTokenizer::Read()
+{
+    for (;;)
+    {
+        m_tokenStart = m_position;
+        m_attributes.clear();
+        m_isEmptyElement = false;
+        m_valueDecoded = false;
+
+        if (m_startOfInput)
+        {
+            while (m_end - m_position < 3 && Fill())
+            {
+            }
+
+            std::string_view start(m_buffer.data() + m_position, m_end - m_position);
+            if (MatchAt(start, 0, "\xFE\xFF") == 1 || MatchAt(start, 0, "\xFF\xFE") == 1)
+            {
+                Fail("Only UTF-8 documents are supported");
+            }
+            if (MatchAt(start, 0, "\xEF\xBB\xBF") == 1)
+            {
+                m_position += 3;
+                m_tokenStart = m_position;
+            }
+            m_startOfInput = false;
+        }
+
+        if (m_position == m_end && !Fill())
+        {
+            if (!m_openNameLengths.empty())
+            {
+                Fail("The document ended inside an element");
+            }
+            if (!m_rootClosed)
+            {
+                Fail("The document has no root element");
+            }
+            return XmlTokenType::EndOfDocument;
+        }
+
+        // A token that is skipped comes back as EndOfDocument.
+        XmlTokenType type = XmlTokenType::EndOfDocument;
+        bool markup = (m_buffer[m_position] == '<');
+        if (!(markup ? ParseMarkup(type) : ParseText(type)))
+        {
+            // Read more and start the token again. Text simply ends with the input.
+            if (!Fill() && markup)
+            {
+                Fail("The document ended inside markup");
+            }
+            continue;
+        }
+
+        if (type != XmlTokenType::EndOfDocument)
+        {
+            return type;
+        }
+    }
+}
+
+std::string_view XmlPullTokenizer::GetAttributeValue(size_t index)
+{
+    Attribute& attribute = m_attributes[index];
+    if (!attribute.decoded)
+    {
+        attribute.value.length = Decode(attribute.value, ValueKind::Attribute);
+        attribute.decoded = true;
+    }
+    return View(attribute.value);
+}
+
+std::string_view XmlPullTokenizer::GetValue()
+{
+    if (!m_valueDecoded)
+    {
+        m_value.length = Decode(m_value, m_valueKind);
+        m_valueDecoded = true;
+    }
+    return View(m_value);
+}
+
+// Moves the current token to the front of the buffer, growing it if the token already fills it,
+// and reads more input after it. Returns false at the end of the input.
+bool XmlPullTokenizer::Fill()
+{
+    if (m_endOfInput)
+    {
+        return false;
+    }
+
+    if (m_tokenStart != 0)
+    {
+        std::memmove(m_buffer.data(), m_buffer.data() + m_tokenStart, m_end - m_tokenStart);
+        m_consumed += m_tokenStart;
+        m_end -= m_tokenStart;
+        m_position -= m_tokenStart;
+        m_tokenStart = 0;
+    }
+
+    if (m_end == m_buffer.size())
+    {
+        m_buffer.resize(m_buffer.size() * 2);
+    }
+
+    size_t bytesRead = m_read(m_buffer.data() + m_end, m_buffer.size() - m_end);
+    if (bytesRead == 0)
+    {
+        m_endOfInput = true;
+        return false;
+    }
+
+    m_end += bytesRead;
+    return true;
+}
+
+void XmlPullTokenizer::Fail(char const* message) const
+{
+    throw XmlParseException(GetPosition(), message);
+}
+
+bool XmlPullTokenizer::ParseMarkup(XmlTokenType& type)
+{
+    std::string_view data(m_buffer.data(), m_end);
+    if (m_position + 1 == m_end)
+    {
+        return false;
+    }
+
+    switch (data[m_position + 1])
+    {
+    case '/':
+        type = XmlTokenType::EndElement;
+        return ParseEndTag();
+
+    case '?':
+    {
+        size_t start = m_position;
+        if (!SkipPast(start + 2, "?>"))
+        {
+            return false;
+        }
+
+        // The declaration can only be the first thing in the document.
+        std::string_view instruction = data.substr(start + 2, m_position - start - 4);
+        if (m_consumed + start <= 3 && instruction.size() >= 4 && instruction.compare(0, 3, "xml") == 0 && IsSpace(instruction[3]))
+        {
+            CheckDeclaration(instruction);
+        }
+        return true;
+    }
+
+    case '!':
+        switch (MatchAt(data, m_position, "<!--"))
+        {
+        case -1: return false;
+        case 1: return SkipPast(m_position + 4, "-->");
+        }
+
+        switch (MatchAt(data, m_position, "<![CDATA["))
+        {
+        case -1: return false;
+        case 1:
+        {
+            if (m_openNameLengths.empty())
+            {
+                Fail("CDATA sections must be inside the root element");
+            }
+
+            size_t start = m_position + 9;
+            size_t end = data.find("]]>", start);
+            if (end == std::string_view::npos)
+            {
+                return false;
+            }
+
+            m_value = { start, end - start };
+            m_valueKind = ValueKind::CData;
+            m_position = end + 3;
+            type = XmlTokenType::Text;
+            return true;
+        }
+        }
+
+        switch (MatchAt(data, m_position, "<!DOCTYPE"))
+        {
+        case -1: return false;
+        case 1: Fail("DTDs are not supported");
+        }
+
+        Fail("Unexpected markup");
+
+    default:
+        type = XmlTokenType::StartElement;
+        return ParseStartTag();
+    }
+}
+
+bool XmlPullTokenizer::ParseStartTag()
+{
+    char const* data = m_buffer.data();
+    size_t position = m_position + 1;
+    Span prefix;
+    Span localName;
+    if (!ParseName(position, prefix, localName))
+    {
+        return false;
+    }
+
+    bool isEmpty = false;
+    for (;;)
+    {
+        size_t separator = position;
+        while (position < m_end && IsSpace(data[position]))
+        {
+            position++;
+        }
+        if (position == m_end)
+        {
+            return false;
+        }
+
+        if (data[position] == '>')
+        {
+            position++;
+            break;
+        }
+
+        if (data[position] == '/')
+        {
+            if (position + 1 == m_end)
+            {
+                return false;
+            }
+            if (data[position + 1] != '>')
+            {
+                Fail("Expected '>' after '/'");
+            }
+            isEmpty = true;
+            position += 2;
+            break;
+        }
+
+        if (position == separator)
+        {
+            Fail("Attributes must be separated by whitespace");
+        }
+
+        Attribute attribute{};
+        if (!ParseName(position, attribute.prefix, attribute.localName))
+        {
+            return false;
+        }
+
+        while (position < m_end && IsSpace(data[position]))
+        {
+            position++;
+        }
+        if (position == m_end)
+        {
+            return false;
+        }
+        if (data[position] != '=')
+        {
+            Fail("Expected '=' after an attribute name");
+        }
+        position++;
+
+        while (position < m_end && IsSpace(data[position]))
+        {
+            position++;
+        }
+        if (position == m_end)
+        {
+            return false;
+        }
+
+        char quote = data[position];
+        if (quote != '"' && quote != '\'')
+        {
+            Fail("Attribute values must be quoted");
+        }
+        position++;
+
+        auto close = static_cast<char const*>(std::memchr(data + position, quote, m_end - position));
+        if (close == nullptr)
+        {
+            return false;
+        }
+        if (std::memchr(data + position, '<', close - (data + position)) != nullptr)
+        {
+            Fail("Attribute values can't contain '<'");
+        }
+
+        attribute.value = { position, static_cast<size_t>(close - (data + position)) };
+        position = (close - data) + 1;
+
+        for (auto const& other : m_attributes)
+        {
+            if (View(other.prefix) == View(attribute.prefix) && View(other.localName) == View(attribute.localName))
+            {
+                Fail("Attributes can't be repeated");
+            }
+        }
+        m_attributes.push_back(attribute);
+    }
+
+    if (m_rootClosed)
+    {
+        Fail("The document has more than one root element");
+    }
+
+    m_prefix = prefix;
+    m_localName = localName;
+    m_isEmptyElement = isEmpty;
+    if (!isEmpty)
+    {
+        m_openNames.append(data + m_position + 1, localName.offset + localName.length - (m_position + 1));
+        m_openNameLengths.push_back(localName.offset + localName.length - (m_position + 1));
+    }
+    else if (m_openNameLengths.empty())
+    {
+        m_rootClosed = true;
+    }
+
+    m_position = position;
+    return true;
+}
+
+bool XmlPullTokenizer::ParseEndTag()
+{
+    char const* data = m_buffer.data();
+    size_t position = m_position + 2;
+    Span prefix;
+    Span localName;
+    if (!ParseName(position, prefix, localName))
+    {
+        return false;
+    }
+
+    size_t nameLength = position - (m_position + 2);
+    while (position < m_end && IsSpace(data[position]))
+    {
+        position++;
+    }
+    if (position == m_end)
+    {
+        return false;
+    }
+    if (data[position] != '>')
+    {
+        Fail("Expected '>' after an end tag name");
+    }
+
+    if (m_openNameLengths.empty())
+    {
+        Fail("The end tag has no start tag");
+    }
+
+    size_t openLength = m_openNameLengths.back();
+    if (std::string_view(m_openNames).substr(m_openNames.size() - openLength) != std::string_view(data + m_position + 2, nameLength))
+    {
+        Fail("The end tag doesn't match the start tag");
+    }
+
+    m_openNames.resize(m_openNames.size() - openLength);
+    m_openNameLengths.pop_back();
+    m_rootClosed = m_openNameLengths.empty();
+
+    m_prefix = prefix;
+    m_localName = localName;
+    m_position = position + 1;
+    return true;
+}
+
+bool XmlPullTokenizer::ParseText(XmlTokenType& type)
+{
+    char const* data = m_buffer.data();
+    auto markup = static_cast<char const*>(std::memchr(data + m_position, '<', m_end - m_position));
+    if (markup == nullptr && !m_endOfInput)
+    {
+        return false;
+    }
+
+    size_t end = (markup != nullptr) ? static_cast<size_t>(markup - data) : m_end;
+    m_value = { m_position, end - m_position };
+    m_valueKind = ValueKind::Text;
+    m_position = end;
+
+    if (m_openNameLengths.empty())
+    {
+        if (!std::all_of(data + m_value.offset, data + end, IsSpace))
+        {
+            Fail("Text must be inside the root element");
+        }
+        return true;
+    }
+
+    type = XmlTokenType::Text;
+    return true;
+}
+
+bool XmlPullTokenizer::SkipPast(size_t start, std::string_view terminator)
+{
+    size_t found = std::string_view(m_buffer.data(), m_end).find(terminator, start);
+    if (found == std::string_view::npos)
+    {
+        return false;
+    }
+
+    m_position = found + terminator.size();
+    return true;
+}
+
+bool XmlPullTokenizer::ParseName(size_t& position, Span& prefix, Span& localName)
+{
+    char const* data = m_buffer.data();
+    size_t start = position;
+    size_t colon = SIZE_MAX;
+    while (position < m_end && !IsNameEnd(data[position]))
+    {
+        if (data[position] == ':' && colon == SIZE_MAX)
+        {
+            colon = position;
+        }
+        position++;
+    }
+
+    if (position == m_end)
+    {
+        return false;
+    }
+    if (position == start)
+    {
+        Fail("Expected a name");
+    }
+
+    if (colon == SIZE_MAX)
+    {
+        prefix = { start, 0 };
+        localName = { start, position - start };
+    }
+    else
+    {
+        prefix = { start, colon - start };
+        localName = { colon + 1, position - colon - 1 };
+        if (prefix.length == 0 || localName.length == 0)
+        {
+            Fail("Names can't start or end with ':'");
+        }
+    }
+    return true;
+}
+
+void XmlPullTokenizer::CheckDeclaration(std::string_view declaration) const
+{
+    size_t found = declaration.find("encoding");
+    if (found == std::string_view::npos)
+    {
+        return;
+    }
+
+    size_t position = found + 8;
+    while (position < declaration.size() && (IsSpace(declaration[position]) || declaration[position] == '='))
+    {
+        position++;
+    }
+
+    if (position < declaration.size() && (declaration[position] == '"' || declaration[position] == '\''))
+    {
+        size_t close = declaration.find(declaration[position], position + 1);
+        if (close != std::string_view::npos)
+        {
+            std::string_view encoding = declaration.substr(position + 1, close - position - 1);
+            if (EqualsIgnoreCase(encoding, "utf-8") || EqualsIgnoreCase(encoding, "us-ascii"))
+            {
+                return;
+            }
+        }
+    }
+
+    Fail("Only UTF-8 documents are supported");
+}
+
+// Expands references and normalizes line ends in place, which never makes the text longer, and
+// returns the new length.
+size_t XmlPullTokenizer::Decode(Span span, ValueKind kind)
+{
+    char* data = m_buffer.data() + span.offset;
+    size_t length = span.length;
+    bool references = (kind != ValueKind::CData);
+    bool attribute = (kind == ValueKind::Attribute);
+
+    auto needsWork = [references, attribute](char c)
+    {
+        return (references && c == '&') || c == '\r' || (attribute && (c == '\t' || c == '\n'));
+    };
+
+    size_t in = std::find_if(data, data + length, needsWork) - data;
+    size_t out = in;
+    while (in < length)
+    {
+        char c = data[in];
+        if (references && c == '&')
+        {
+            auto semicolon = static_cast<char const*>(std::memchr(data + in, ';', length - in));
+            if (semicolon == nullptr)
+            {
+                Fail("Unterminated reference");
+            }
+
+            std::string_view name(data + in + 1, semicolon - (data + in + 1));
+            in = (semicolon - data) + 1;
+
+            if (name == "lt") { data[out++] = '<'; }
+            else if (name == "gt") { data[out++] = '>'; }
+            else if (name == "amp") { data[out++] = '&'; }
+            else if (name == "quot") { data[out++] = '"'; }
+            else if (name == "apos") { data[out++] = '\''; }
+            else if (name.size() >= 2 && name[0] == '#')
+            {
+                bool hex = (name[1] == 'x');
+                std::string_view digits = name.substr(hex ? 2 : 1);
+                uint32_t codePoint = 0;
+                for (char digit : digits)
+                {
+                    uint32_t value;
+                    if (digit >= '0' && digit <= '9') value = digit - '0';
+                    else if (hex && digit >= 'a' && digit <= 'f') value = digit - 'a' + 10;
+                    else if (hex && digit >= 'A' && digit <= 'F') value = digit - 'A' + 10;
+                    else Fail("Invalid character reference");
+
+                    codePoint = codePoint * (hex ? 16 : 10) + value;
+                    if (codePoint > 0x10FFFF)
+                    {
+                        Fail("Invalid character reference");
+                    }
+                }
+
+                if (digits.empty() || !IsXmlChar(codePoint))
+                {
+                    Fail("Invalid character reference");
+                }
+                out += EncodeUtf8(codePoint, data + out);
+            }
+            else
+            {
+                Fail("Unknown entity reference");
+            }
+        }
+        else if (c == '\r')
+        {
+            data[out++] = attribute ? ' ' : '\n';
+            in++;
+            if (in < length && data[in] == '\n')
+            {
+                in++;
+            }
+        }
+        else
+        {
+            data[out++] = (attribute && (c == '\t' || c == '\n')) ? ' ' : c;
+            in++;
+        }
+    }
+
+    return out;
+}
+
+void SDKTemplate::ExtractRecords(XmlPullTokenizer& tokenizer, XmlRecordExtractor<char>& extractor)
+{
+    for (;;)
+    {
+        switch (tokenizer.Read())
+        {
+        case XmlTokenType::StartElement:
+            extractor.StartElement(tokenizer.GetLocalName());
+            if (extractor.WantsAttributes())
+            {
+                for (size_t i = 0; i < tokenizer.GetAttributeCount(); i++)
+                {
+                    uint32_t field = extractor.FindAttribute(tokenizer.GetAttributeLocalName(i));
+                    if (field != XmlRecordExtractor<char>::NoField)
+                    {
+                        extractor.Attribute(field, tokenizer.GetAttributeValue(i));
+                    }
+                }
+            }
+
+            if (tokenizer.IsEmptyElement())
+            {
+                extractor.EndElement();
+            }
+            break;
+
+        case XmlTokenType::EndElement:
+            extractor.EndElement();
+            break;
+
+        case XmlTokenType::Text:
+            if (extractor.WantsText())
+            {
+                extractor.Text(tokenizer.GetValue());
+            }
+            break;
+
+        case XmlTokenType::EndOfDocument:
+            extractor.Finish();
+            return;
+        }
+    }
+}
@@ -0,0 +1,162 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+// A small pull tokenizer for UTF-8 XML, for running XmlRecordExtractor where XmlLite isn't
+// available. It reads the input in chunks through a callback, so documents of any size stream
+// through a buffer that only grows to the size of the largest token. Names, attribute values and
+// text are returned as views into that buffer; entities are only expanded when a value is asked
+// for, so nodes the caller doesn't look at cost a scan and nothing more. This file only depends on
+// the C++ standard library.
+//
+// The tokenizer checks that tags are balanced and, for the values it expands, that references are
+// valid. It doesn't validate UTF-8 or name characters. Like the sample's IXmlReader, which is created
+// with DtdProcessing_Prohibit, it rejects documents with a DOCTYPE.
+
+#include "XmlRecordExtractor.h"
+
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace SDKTemplate
+{
+    enum class XmlTokenType
+    {
+        EndOfDocument,
+        StartElement,   // Followed by an EndElement unless IsEmptyElement() is true.
+        EndElement,
+        Text,           // Character data or a CDATA section inside the root element.
+    };
+
+    class XmlParseException : public std::runtime_error
+    {
+    public:
+        XmlParseException(uint64_t offset, char const* message) :
+            std::runtime_error(message), m_offset(offset)
+        {
+        }
+
+        // Byte offset of the token that could not be read.
+        uint64_t Offset() const { return m_offset; }
+
+    private:
+        uint64_t m_offset;
+    };
+
+    class XmlPullTokenizer
+    {
+    public:
+        // Fills the buffer with up to size bytes and returns how many were written, or 0 at the end
+        // of the input.
+        typedef std::function<size_t(char* buffer, size_t size)> ReadFunction;
+
+        explicit XmlPullTokenizer(ReadFunction read, size_t bufferSize = 64 * 1024);
+
+        XmlPullTokenizer(const XmlPullTokenizer&) = delete;
+        XmlPullTokenizer& operator=(const XmlPullTokenizer&) = delete;
+
+        // Moves to the next token. Declarations, processing instructions, comments and whitespace
+        // outside the root element are skipped. Throws XmlParseException if the document is not
+        // well formed. Views returned for the previous token are invalidated.
+        XmlTokenType Read();
+
+        // Name of the current element, for StartElement and EndElement.
+        std::string_view GetPrefix() const { return View(m_prefix); }
+        std::string_view GetLocalName() const { return View(m_localName); }
+        bool IsEmptyElement() const { return m_isEmptyElement; }
+
+        // Attributes of the current StartElement, in document order, including namespace
+        // declarations. Values are expanded when they are first read, which throws
+        // XmlParseException if they contain an invalid reference.
+        size_t GetAttributeCount() const { return m_attributes.size(); }
+        std::string_view GetAttributePrefix(size_t index) const { return View(m_attributes[index].prefix); }
+        std::string_view GetAttributeLocalName(size_t index) const { return View(m_attributes[index].localName); }
+        std::string_view GetAttributeValue(size_t index);
+
+        // Text of the current Text token, expanded like attribute values.
+        std::string_view GetValue();
+
+        // Byte offset of the current token from the start of the input.
+        uint64_t GetPosition() const { return m_consumed + m_tokenStart; }
+
+    private:
+        // How a value is expanded: references are only recognized outside CDATA sections, and only
+        // attribute values have their whitespace characters turned into spaces.
+        enum class ValueKind
+        {
+            Text,
+            CData,
+            Attribute,
+        };
+
+        // Offsets into the buffer, which only move between tokens.
+        struct Span
+        {
+            size_t offset = 0;
+            size_t length = 0;
+        };
+
+        struct Attribute
+        {
+            Span prefix;
+            Span localName;
+            Span value;
+            bool decoded;
+        };
+
+        std::string_view View(Span span) const { return std::string_view(m_buffer.data() + span.offset, span.length); }
+
+        bool Fill();
+        [[noreturn]] void Fail(char const* message) const;
+
+        // Each returns false if the token isn't complete in the buffer yet, leaving no state behind.
+        bool ParseMarkup(XmlTokenType& type);
+        bool ParseStartTag();
+        bool ParseEndTag();
+        bool ParseText(XmlTokenType& type);
+        bool SkipPast(size_t start, std::string_view terminator);
+        bool ParseName(size_t& position, Span& prefix, Span& localName);
+        void CheckDeclaration(std::string_view declaration) const;
+
+        size_t Decode(Span span, ValueKind kind);
+
+        ReadFunction m_read;
+        std::vector<char> m_buffer;
+        size_t m_tokenStart = 0;        // Start of the current token.
+        size_t m_position = 0;          // End of the current token.
+        size_t m_end = 0;               // End of the data read so far.
+        uint64_t m_consumed = 0;        // Bytes dropped from the front of the buffer.
+        bool m_endOfInput = false;
+        bool m_startOfInput = true;
+
+        Span m_prefix;
+        Span m_localName;
+        bool m_isEmptyElement = false;
+        std::vector<Attribute> m_attributes;
+        Span m_value;
+        ValueKind m_valueKind = ValueKind::Text;
+        bool m_valueDecoded = false;
+
+        // Names of the open elements, one after the other, and their lengths.
+        std::string m_openNames;
+        std::vector<size_t> m_openNameLengths;
+        bool m_rootClosed = false;
+    };
+
+    // Feeds every token of the document to the extractor and finishes it. Attribute values and text
+    // are only decoded where the extractor binds them.
+    void ExtractRecords(XmlPullTokenizer& tokenizer, XmlRecordExtractor<char>& extractor);
+}
@@ -0,0 +1,526 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "XmlRecordExtractor.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+using namespace SDKTemplate;
+
+namespace
+{
+    const uint32_t NoName = UINT32_MAX;
+    const uint32_t NoNode = UINT32_MAX;
+
+    // Longest number text that is converted; xs:double needs at most 17 significant digits, so
+    // anything longer is padding or not a number.
+    const size_t MaxNumberLength = 64;
+
+    std::vector<std::string> SplitPath(std::string_view path)
+    {
+        std::vector<std::string> segments;
+        for (;;)
+        {
+            size_t separator = path.find('/');
+            std::string_view segment = path.substr(0, separator);
+            if (segment.empty())
+            {
+                throw std::invalid_argument("Paths can't have empty segments");
+            }
+
+            segments.emplace_back(segment);
+            if (separator == std::string_view::npos)
+            {
+                return segments;
+            }
+
+            path.remove_prefix(separator + 1);
+        }
+    }
+
+    bool IsPrefix(std::vector<std::string> const& prefix, std::vector<std::string> const& path)
+    {
+        return prefix.size() <= path.size() && std::equal(prefix.begin(), prefix.end(), path.begin());
+    }
+
+    // Schema names are UTF-8; wchar_t events are UTF-16.
+    template <typename Char>
+    std::basic_string<Char> ToEventString(std::string_view name)
+    {
+        if constexpr (std::is_same_v<Char, char>)
+        {
+            return std::string(name);
+        }
+        else
+        {
+            std::wstring result;
+            for (size_t i = 0; i < name.size();)
+            {
+                auto lead = static_cast<unsigned char>(name[i]);
+                size_t length = (lead < 0x80) ? 1 : (lead >= 0xF0) ? 4 : (lead >= 0xE0) ? 3 : (lead >= 0xC0) ? 2 : 0;
+                if (length == 0 || i + length > name.size())
+                {
+                    throw std::invalid_argument("Names must be UTF-8");
+                }
+
+                char32_t codePoint = (length == 1) ? lead : (lead & (0x7F >> length));
+                for (size_t j = 1; j < length; j++)
+                {
+                    auto trail = static_cast<unsigned char>(name[i + j]);
+                    if ((trail & 0xC0) != 0x80)
+                    {
+                        throw std::invalid_argument("Names must be UTF-8");
+                    }
+                    codePoint = (codePoint << 6) | (trail & 0x3F);
+                }
+
+                if (codePoint >= 0x10000)
+                {
+                    codePoint -= 0x10000;
+                    result.push_back(static_cast<wchar_t>(0xD800 + (codePoint >> 10)));
+                    result.push_back(static_cast<wchar_t>(0xDC00 + (codePoint & 0x3FF)));
+                }
+                else
+                {
+                    result.push_back(static_cast<wchar_t>(codePoint));
+                }
+                i += length;
+            }
+            return result;
+        }
+    }
+
+    template <typename Char>
+    bool IsXmlSpace(Char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    // Converts xs:long or xs:double text. Returns false if the text isn't a valid value of the type.
+    template <typename Char>
+    bool ParseNumber(std::basic_string_view<Char> text, XmlFieldType type, int64_t& integer, double& number)
+    {
+        while (!text.empty() && IsXmlSpace(text.front()))
+        {
+            text.remove_prefix(1);
+        }
+        while (!text.empty() && IsXmlSpace(text.back()))
+        {
+            text.remove_suffix(1);
+        }
+
+        if (text.empty() || text.size() > MaxNumberLength)
+        {
+            return false;
+        }
+
+        // from_chars only reads char, and accepts forms like "inf" and "0x1" that XML Schema
+        // doesn't, so copy the text and check the characters on the way.
+        char digits[MaxNumberLength];
+        size_t length = text.size();
+        for (size_t i = 0; i < length; i++)
+        {
+            Char c = text[i];
+            bool allowed = (c >= '0' && c <= '9') || c == '-' || c == '+' ||
+                (type == XmlFieldType::Number && (c == '.' || c == 'e' || c == 'E' || c == 'I' || c == 'N' || c == 'F' || c == 'a'));
+            if (!allowed)
+            {
+                return false;
+            }
+            digits[i] = static_cast<char>(c);
+        }
+
+        // from_chars rejects a leading '+', which XML Schema allows.
+        char const* begin = digits;
+        char const* end = digits + length;
+        if (*begin == '+')
+        {
+            begin++;
+            if (begin == end || *begin == '-' || *begin == '+')
+            {
+                return false;
+            }
+        }
+
+        if (type == XmlFieldType::Integer)
+        {
+            auto result = std::from_chars(begin, end, integer);
+            return result.ec == std::errc() && result.ptr == end;
+        }
+
+        std::string_view view(begin, end - begin);
+        if (view == "INF" || view == "-INF")
+        {
+            number = (view[0] == '-') ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+            return begin == digits || view[0] != '-';
+        }
+        if (view == "NaN")
+        {
+            number = std::numeric_limits<double>::quiet_NaN();
+            return begin == digits;
+        }
+
+        // The letters allowed above only form INF and NaN; from_chars would also take "infinity".
+        if (view.find_first_of("INFa") != std::string_view::npos)
+        {
+            return false;
+        }
+
+        auto result = std::from_chars(begin, end, number);
+        return result.ec == std::errc() && result.ptr == end;
+    }
+}
+
+XmlRecordSchema::XmlRecordSchema(std::string_view recordPath) :
+    m_recordPath(SplitPath(recordPath))
+{
+    for (auto const& segment : m_recordPath)
+    {
+        if (segment[0] == '@')
+        {
+            throw std::invalid_argument("The record path can't name an attribute");
+        }
+    }
+}
+
+uint32_t XmlRecordSchema::AddField(std::string_view fieldPath, XmlFieldType type)
+{
+    Field field;
+    field.elements = SplitPath(fieldPath);
+    field.type = type;
+
+    if (field.elements.back()[0] == '@')
+    {
+        field.attribute = field.elements.back().substr(1);
+        field.elements.pop_back();
+        if (field.attribute.empty())
+        {
+            throw std::invalid_argument("Attribute fields need a name");
+        }
+    }
+
+    for (auto const& element : field.elements)
+    {
+        if (element[0] == '@')
+        {
+            throw std::invalid_argument("Only the last segment of a field path can be an attribute");
+        }
+    }
+
+    for (auto const& other : m_fields)
+    {
+        if (other.elements == field.elements && other.attribute == field.attribute)
+        {
+            throw std::invalid_argument("The field is already defined");
+        }
+
+        if (field.attribute.empty() && other.attribute.empty() &&
+            (IsPrefix(other.elements, field.elements) || IsPrefix(field.elements, other.elements)))
+        {
+            throw std::invalid_argument("Element fields can't contain other element fields");
+        }
+    }
+
+    m_fields.push_back(std::move(field));
+    return static_cast<uint32_t>(m_fields.size() - 1);
+}
+
+template <typename Char>
+XmlRecordExtractor<Char>::XmlRecordExtractor(XmlRecordSchema const& schema, size_t batchSize, BatchFunction onBatch) :
+    m_batchSize(std::max<size_t>(batchSize, 1)),
+    m_onBatch(std::move(onBatch))
+{
+    m_nodes.emplace_back();
+
+    uint32_t record = 0;
+    for (auto const& element : schema.m_recordPath)
+    {
+        record = AddChild(record, element);
+    }
+    m_nodes[record].isRecord = true;
+
+    for (auto const& field : schema.m_fields)
+    {
+        auto index = static_cast<uint32_t>(m_fieldTypes.size());
+        m_fieldTypes.push_back(field.type);
+
+        uint32_t node = record;
+        for (auto const& element : field.elements)
+        {
+            node = AddChild(node, element);
+        }
+
+        if (field.attribute.empty())
+        {
+            m_nodes[node].textField = index;
+        }
+        else
+        {
+            uint32_t id = Intern(field.attribute);
+            m_nodes[node].attributes.emplace_back(id, index);
+            m_nodes[node].attributeLengths |= LengthBit(m_names[id].size());
+        }
+    }
+
+    // Build the lookup table with at most half of the slots in use, so probe sequences stay short.
+    size_t slotCount = 8;
+    while (slotCount < m_names.size() * 2)
+    {
+        slotCount *= 2;
+    }
+
+    m_nameSlots.assign(slotCount, 0);
+    std::hash<std::basic_string_view<Char>> hash;
+    for (uint32_t id = 0; id < m_names.size(); id++)
+    {
+        size_t slot = hash(m_names[id]) & (slotCount - 1);
+        while (m_nameSlots[slot] != 0)
+        {
+            slot = (slot + 1) & (slotCount - 1);
+        }
+        m_nameSlots[slot] = id + 1;
+    }
+
+    m_batch.m_fieldCount = m_fieldTypes.size();
+    m_path.reserve(16);
+    m_path.push_back(0);
+}
+
+template <typename Char>
+uint32_t XmlRecordExtractor<Char>::Intern(std::string_view name)
+{
+    std::basic_string<Char> converted = ToEventString<Char>(name);
+    auto existing = std::find(m_names.begin(), m_names.end(), converted);
+    if (existing != m_names.end())
+    {
+        return static_cast<uint32_t>(existing - m_names.begin());
+    }
+
+    m_names.push_back(std::move(converted));
+    return static_cast<uint32_t>(m_names.size() - 1);
+}
+
+template <typename Char>
+uint32_t XmlRecordExtractor<Char>::LookUpName(std::basic_string_view<Char> name) const
+{
+    size_t mask = m_nameSlots.size() - 1;
+    size_t slot = std::hash<std::basic_string_view<Char>>()(name) & mask;
+    while (m_nameSlots[slot] != 0)
+    {
+        uint32_t id = m_nameSlots[slot] - 1;
+        if (m_names[id] == name)
+        {
+            return id;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return NoName;
+}
+
+template <typename Char>
+uint32_t XmlRecordExtractor<Char>::AddChild(uint32_t node, std::string_view name)
+{
+    uint32_t id = Intern(name);
+    for (auto const& child : m_nodes[node].children)
+    {
+        if (child.first == id)
+        {
+            return child.second;
+        }
+    }
+
+    // Adding a node can move the others, so don't hold a reference across it.
+    auto child = static_cast<uint32_t>(m_nodes.size());
+    m_nodes.emplace_back();
+    m_nodes[node].children.emplace_back(id, child);
+    m_nodes[node].childLengths |= LengthBit(m_names[id].size());
+    return child;
+}
+
+template <typename Char>
+void XmlRecordExtractor<Char>::StartElement(std::basic_string_view<Char> localName)
+{
+    if (m_skipDepth != 0)
+    {
+        m_skipDepth++;
+        m_skippedElementCount++;
+        return;
+    }
+
+    // Most names that don't match are ruled out by their length, without hashing them.
+    uint32_t child = NoNode;
+    Node const& parent = m_nodes[m_path.back()];
+    if ((parent.childLengths & LengthBit(localName.size())) != 0)
+    {
+        uint32_t id = LookUpName(localName);
+        for (auto const& entry : parent.children)
+        {
+            if (entry.first == id)
+            {
+                child = entry.second;
+                break;
+            }
+        }
+    }
+
+    if (child == NoNode)
+    {
+        m_skipDepth = 1;
+        m_skippedElementCount++;
+        return;
+    }
+
+    m_path.push_back(child);
+    Node const& node = m_nodes[child];
+    if (node.isRecord)
+    {
+        m_batch.m_values.resize(m_batch.m_values.size() + m_fieldTypes.size(), typename XmlRecordBatch<Char>::FieldValue());
+    }
+
+    if (node.textField != NoField)
+    {
+        m_scratch.clear();
+    }
+}
+
+template <typename Char>
+bool XmlRecordExtractor<Char>::WantsAttributes() const
+{
+    return m_skipDepth == 0 && !m_nodes[m_path.back()].attributes.empty();
+}
+
+template <typename Char>
+uint32_t XmlRecordExtractor<Char>::FindAttribute(std::basic_string_view<Char> localName) const
+{
+    if ((m_nodes[m_path.back()].attributeLengths & LengthBit(localName.size())) == 0)
+    {
+        return NoField;
+    }
+
+    uint32_t id = LookUpName(localName);
+    for (auto const& entry : m_nodes[m_path.back()].attributes)
+    {
+        if (entry.first == id)
+        {
+            return entry.second;
+        }
+    }
+    return NoField;
+}
+
+template <typename Char>
+void XmlRecordExtractor<Char>::Attribute(uint32_t field, std::basic_string_view<Char> value)
+{
+    SetValue(field, value);
+}
+
+// Only the text directly inside an element field is collected; element fields can't nest, so there
+// is never more than one being read.
+template <typename Char>
+bool XmlRecordExtractor<Char>::WantsText() const
+{
+    return m_skipDepth == 0 && m_nodes[m_path.back()].textField != NoField;
+}
+
+template <typename Char>
+void XmlRecordExtractor<Char>::Text(std::basic_string_view<Char> value)
+{
+    if (WantsText())
+    {
+        m_scratch.append(value);
+    }
+}
+
+template <typename Char>
+void XmlRecordExtractor<Char>::EndElement()
+{
+    if (m_skipDepth != 0)
+    {
+        m_skipDepth--;
+        return;
+    }
+
+    if (m_path.size() == 1)
+    {
+        throw std::logic_error("EndElement has no matching StartElement");
+    }
+
+    Node const& node = m_nodes[m_path.back()];
+    if (node.textField != NoField)
+    {
+        SetValue(node.textField, m_scratch);
+    }
+
+    if (node.isRecord)
+    {
+        m_batch.m_recordCount++;
+        m_recordCount++;
+        if (m_batch.m_recordCount >= m_batchSize)
+        {
+            Flush();
+        }
+    }
+
+    m_path.pop_back();
+}
+
+// Stores the value of a field of the record being read.
+template <typename Char>
+void XmlRecordExtractor<Char>::SetValue(uint32_t field, std::basic_string_view<Char> text)
+{
+    auto& value = m_batch.At(m_batch.m_recordCount, field);
+    if (m_fieldTypes[field] == XmlFieldType::String)
+    {
+        value.state = XmlFieldState::Present;
+        value.offset = m_batch.m_text.size();
+        value.length = text.size();
+        m_batch.m_text.append(text);
+    }
+    else if (ParseNumber(text, m_fieldTypes[field], value.integer, value.number))
+    {
+        value.state = XmlFieldState::Present;
+    }
+    else
+    {
+        value.state = XmlFieldState::Invalid;
+        m_invalidValueCount++;
+    }
+}
+
+template <typename Char>
+void XmlRecordExtractor<Char>::Flush()
+{
+    if (m_batch.m_recordCount != 0)
+    {
+        m_onBatch(m_batch);
+        m_batch.Clear();
+    }
+}
+
+template <typename Char>
+void XmlRecordExtractor<Char>::Finish()
+{
+    if (m_path.size() != 1 || m_skipDepth != 0)
+    {
+        throw std::logic_error("Finish was called with elements still open");
+    }
+
+    Flush();
+}
+
+template class SDKTemplate::XmlRecordExtractor<char>;
+template class SDKTemplate::XmlRecordExtractor<wchar_t>;
@@ -0,0 +1,223 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+// Pulls typed records out of a stream of XML parse events without keeping the document or the text
+// of nodes it doesn't need. A schema names a repeating record element by its path from the root and
+// binds fields to elements and attributes beneath it. The schema is compiled into a table of interned
+// names, so each element costs one hash lookup, and a subtree that matches nothing is skipped by
+// counting its depth. Completed records are handed to a callback in batches whose storage is reused,
+// so once a batch has grown, extraction doesn't allocate. This file only depends on the C++ standard
+// library.
+//
+// Events come from any pull parser: IXmlReader in the sample, or XmlPullTokenizer elsewhere. Names
+// are matched on their local part; prefixes and namespace URIs are ignored.
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace SDKTemplate
+{
+    enum class XmlFieldType
+    {
+        String,     // Text as it appears in the document, after entities are expanded.
+        Integer,    // xs:long; surrounding whitespace is ignored.
+        Number,     // xs:double, including INF, -INF and NaN; surrounding whitespace is ignored.
+    };
+
+    enum class XmlFieldState : uint8_t
+    {
+        Missing,    // The record had no such element or attribute.
+        Present,
+        Invalid,    // The text could not be converted to the field type.
+    };
+
+    class XmlRecordSchema
+    {
+    public:
+        // The record path lists element names from the document root, separated by '/', for
+        // example "portfolio/stock". Throws std::invalid_argument if a segment is empty or names an
+        // attribute.
+        explicit XmlRecordSchema(std::string_view recordPath);
+
+        // Binds a field to a path relative to the record element and returns its index. Elements are
+        // separated by '/' and an attribute is named last with '@', so "price", "quote/last",
+        // "@exchange" and "quote/@time" are all fields. An element field collects the text directly
+        // inside the element, so it can't contain another element field. When a record has the field
+        // more than once, the last value wins. Throws std::invalid_argument for malformed paths,
+        // duplicates and nested element fields.
+        uint32_t AddField(std::string_view fieldPath, XmlFieldType type);
+
+        size_t GetFieldCount() const { return m_fields.size(); }
+
+    private:
+        template <typename Char>
+        friend class XmlRecordExtractor;
+
+        struct Field
+        {
+            std::vector<std::string> elements;
+            std::string attribute;      // Empty for element fields.
+            XmlFieldType type;
+        };
+
+        std::vector<std::string> m_recordPath;
+        std::vector<Field> m_fields;
+    };
+
+    // Records extracted since the last batch was delivered. Values are addressed by record and
+    // field index; strings point into the batch and stay valid until the callback returns.
+    template <typename Char>
+    class XmlRecordBatch
+    {
+    public:
+        size_t GetRecordCount() const { return m_recordCount; }
+
+        XmlFieldState GetState(size_t record, uint32_t field) const { return At(record, field).state; }
+
+        // Return an empty string or zero unless the field is present.
+        std::basic_string_view<Char> GetString(size_t record, uint32_t field) const
+        {
+            FieldValue const& value = At(record, field);
+            return (value.state == XmlFieldState::Present) ? std::basic_string_view<Char>(m_text).substr(value.offset, value.length) : std::basic_string_view<Char>();
+        }
+
+        int64_t GetInteger(size_t record, uint32_t field) const
+        {
+            FieldValue const& value = At(record, field);
+            return (value.state == XmlFieldState::Present) ? value.integer : 0;
+        }
+
+        double GetNumber(size_t record, uint32_t field) const
+        {
+            FieldValue const& value = At(record, field);
+            return (value.state == XmlFieldState::Present) ? value.number : 0.0;
+        }
+
+    private:
+        template <typename>
+        friend class XmlRecordExtractor;
+
+        struct FieldValue
+        {
+            XmlFieldState state;
+            size_t offset;      // String fields, into m_text.
+            size_t length;
+            union
+            {
+                int64_t integer;
+                double number;
+            };
+        };
+
+        FieldValue const& At(size_t record, uint32_t field) const { return m_values[record * m_fieldCount + field]; }
+        FieldValue& At(size_t record, uint32_t field) { return m_values[record * m_fieldCount + field]; }
+
+        // Clearing keeps the capacity of both vectors.
+        void Clear()
+        {
+            m_recordCount = 0;
+            m_values.clear();
+            m_text.clear();
+        }
+
+        size_t m_fieldCount = 0;
+        size_t m_recordCount = 0;
+        std::vector<FieldValue> m_values;
+        std::basic_string<Char> m_text;
+    };
+
+    // Char is char for UTF-8 events and wchar_t for UTF-16 events. Schema names are UTF-8.
+    template <typename Char>
+    class XmlRecordExtractor
+    {
+    public:
+        typedef std::function<void(XmlRecordBatch<Char> const& batch)> BatchFunction;
+
+        static const uint32_t NoField = UINT32_MAX;
+
+        // Delivers a batch whenever batchSize records have been completed, and the rest from Finish.
+        XmlRecordExtractor(XmlRecordSchema const& schema, size_t batchSize, BatchFunction onBatch);
+
+        XmlRecordExtractor(const XmlRecordExtractor&) = delete;
+        XmlRecordExtractor& operator=(const XmlRecordExtractor&) = delete;
+
+        // Parse events. Every StartElement needs a matching EndElement, including for empty elements.
+        // Attributes of an element are reported after its StartElement, and only when
+        // WantsAttributes() returns true: FindAttribute maps a name to its field, and the value only
+        // needs to be read for names that map to one. Text only needs to be reported when WantsText()
+        // returns true, and may be split across calls.
+        void StartElement(std::basic_string_view<Char> localName);
+        bool WantsAttributes() const;
+        uint32_t FindAttribute(std::basic_string_view<Char> localName) const;
+        void Attribute(uint32_t field, std::basic_string_view<Char> value);
+        bool WantsText() const;
+        void Text(std::basic_string_view<Char> value);
+        void EndElement();
+
+        // Delivers the remaining records. Throws std::logic_error if elements are still open.
+        void Finish();
+
+        uint64_t GetRecordCount() const { return m_recordCount; }
+        uint64_t GetSkippedElementCount() const { return m_skippedElementCount; }
+        uint64_t GetInvalidValueCount() const { return m_invalidValueCount; }
+
+    private:
+        struct Node
+        {
+            std::vector<std::pair<uint32_t, uint32_t>> children;     // Name id and node.
+            std::vector<std::pair<uint32_t, uint32_t>> attributes;   // Name id and field.
+            uint64_t childLengths = 0;      // Bit n is set if a child name is n long, or 63 and longer.
+            uint64_t attributeLengths = 0;
+            uint32_t textField = NoField;
+            bool isRecord = false;
+        };
+
+        static uint64_t LengthBit(size_t length) { return uint64_t(1) << std::min<size_t>(length, 63); }
+
+        uint32_t Intern(std::string_view name);
+        uint32_t LookUpName(std::basic_string_view<Char> name) const;
+        uint32_t AddChild(uint32_t node, std::string_view name);
+        void SetValue(uint32_t field, std::basic_string_view<Char> text);
+        void Flush();
+
+        std::vector<XmlFieldType> m_fieldTypes;
+        std::vector<Node> m_nodes;                  // Node 0 stands for the document.
+
+        // Interned names, found through an open-addressed table of ids plus one.
+        std::vector<std::basic_string<Char>> m_names;
+        std::vector<uint32_t> m_nameSlots;
+
+        // Matched nodes from the document down to the current element. Elements below a node that
+        // matches nothing are only counted.
+        std::vector<uint32_t> m_path;
+        uint64_t m_skipDepth = 0;
+
+        // Text of the element field being read, stored or converted when the element ends.
+        std::basic_string<Char> m_scratch;
+
+        size_t m_batchSize;
+        BatchFunction m_onBatch;
+        XmlRecordBatch<Char> m_batch;
+
+        uint64_t m_recordCount = 0;
+        uint64_t m_skippedElementCount = 0;
+        uint64_t m_invalidValueCount = 0;
+    };
+
+    extern template class XmlRecordExtractor<char>;
+    extern template class XmlRecordExtractor<wchar_t>;
+}
@@ -124,48 +124,28 @@ AnimateLineListPosition::AnimateLineListPosition(
 {
     m_duration = duration;
     m_continuous = continuous;
-    m_count = count;
+    m_cursor = 0;
 
-    std::vector<LineSegment> segment(m_count);
-    m_segment = segment;
-    m_totalLength = 0.0f;
-
-    m_segment[0].position = position[0];
-    for (unsigned int i = 1; i < count; i++)
-    {
-        m_segment[i].position = position[i];
-        m_segment[i - 1].length = XMVectorGetX(
-            XMVector3Length(
-                XMLoadFloat3(&m_segment[i].position) -
-                XMLoadFloat3(&m_segment[i - 1].position)
-                )
-            );
-        m_totalLength += m_segment[i - 1].length;
-    }
-
-    // Parameterize the segments to ensure uniform evaluation along the path.
-    float u = 0.0f;
-    for (unsigned int i = 0; i < (count - 1); i++)
-    {
-        m_segment[i].uStart = u;
-        m_segment[i].uLength = (m_segment[i].length / m_totalLength);
-        u += m_segment[i].uLength;
-    }
-    m_segment[count-1].uStart = 1.0f;
+    static_assert(sizeof(XMFLOAT3) == 3 * sizeof(float), "XMFLOAT3 must be three packed floats");
+    m_path = std::make_shared<AnimationPath>(&position[0].x, count);
 }
 
 //----------------------------------------------------------------------
 
 XMFLOAT3 AnimateLineListPosition::Evaluate(_In_ float t)
 {
+    XMFLOAT3 currentPosition;
+
     if (t <= m_startTime)
     {
-        return m_segment[0].position;
+        m_path->Point(0, &currentPosition.x);
+        return currentPosition;
     }
 
     if ((t >= (m_startTime + m_duration)) && !m_continuous)
     {
-        return m_segment[m_count-1].position;
+        m_path->Point(m_path->PointCount() - 1, &currentPosition.x);
+        return currentPosition;
     }
 
     float startTime = m_startTime;
@@ -177,20 +157,7 @@ XMFLOAT3 AnimateLineListPosition::Evaluate(_In_ float t)
     }
 
     float u = (t - startTime) / m_duration;
-    // Find the right segment.
-    unsigned int i = 0;
-    while (u > m_segment[i + 1].uStart)
-    {
-        i++;
-    }
-
-    u -= m_segment[i].uStart;
-    u /= m_segment[i].uLength;
-
-    XMFLOAT3 currentPosition;
-    currentPosition.x = m_segment[i].position.x + (m_segment[i + 1].position.x - m_segment[i].position.x)*u;
-    currentPosition.y = m_segment[i].position.y + (m_segment[i + 1].position.y - m_segment[i].position.y)*u;
-    currentPosition.z = m_segment[i].position.z + (m_segment[i + 1].position.z - m_segment[i].position.z)*u;
+    m_path->Evaluate(u, PathInterpolation::Linear, &m_cursor, &currentPosition.x);
 
     return currentPosition;
 }
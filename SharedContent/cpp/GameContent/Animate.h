@@ -25,6 +25,8 @@
 // It is expected that each derived class will provide an Evaluate method for the
 // specific kind of animation.
 
+#include "AnimationPath.h"
+
 ref class Animate abstract
 {
 internal:
@@ -72,20 +74,15 @@ private:
 
 //----------------------------------------------------------------------
 
-struct LineSegment
-{
-    DirectX::XMFLOAT3 position;
-    float             length;
-    float             uStart;
-    float             uLength;
-};
-
 // AnimateLineListPosition:
 // This class is a specialization of Animate that defines an animation of a position vector
 // along a set of line segments defined by a set of points.  The animation along the path is
 // such that the evaluation of the position along the path will be uniform independent of
 // the length of each of the line segments.  A continuous loop can be achieved by having the
 // first and last points of the list be the same.
+// The points are held in an AnimationPath, which can also be handed to a PathAnimationBatch
+// to evaluate many animations in one pass.  The segment found by the last Evaluate is kept
+// so that the next one usually does not need to search.
 
 ref class AnimateLineListPosition: public Animate
 {
@@ -98,10 +95,11 @@ internal:
         );
     virtual DirectX::XMFLOAT3 Evaluate(_In_ float t) override;
 
+    std::shared_ptr<const AnimationPath> Path() { return m_path; }
+
 private:
-    unsigned int             m_count;
-    float                    m_totalLength;
-    std::vector<LineSegment> m_segment;
+    std::shared_ptr<const AnimationPath> m_path;
+    uint32_t                             m_cursor;
 };
 
 //----------------------------------------------------------------------
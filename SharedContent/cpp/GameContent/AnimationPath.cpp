@@ -0,0 +1,234 @@
+//********************************************************* 
+// 
+// Copyright (c) Microsoft. All rights reserved. 
+// This code is licensed under the MIT License (MIT). 
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF 
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY 
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR 
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT. 
+// 
+//*********************************************************
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "AnimationPath.h"
+
+#include <algorithm>
+#include <cmath>
+
+//--------------------------------------------------------------------------------
+
+AnimationPath::AnimationPath(const float* points, size_t count) :
+    m_x(count),
+    m_y(count),
+    m_z(count),
+    m_uStart(count),
+    m_uLength(count),
+    m_closed(false)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        m_x[i] = points[i * 3];
+        m_y[i] = points[i * 3 + 1];
+        m_z[i] = points[i * 3 + 2];
+    }
+
+    std::vector<float> length(count, 0.0f);
+    float totalLength = 0.0f;
+    for (size_t i = 1; i < count; i++)
+    {
+        float dx = m_x[i] - m_x[i - 1];
+        float dy = m_y[i] - m_y[i - 1];
+        float dz = m_z[i] - m_z[i - 1];
+        length[i - 1] = std::sqrt(dx * dx + dy * dy + dz * dz);
+        totalLength += length[i - 1];
+    }
+
+    // Parameterize the segments to ensure uniform evaluation along the path.
+    float u = 0.0f;
+    for (size_t i = 0; i + 1 < count; i++)
+    {
+        m_uStart[i] = u;
+        m_uLength[i] = (totalLength > 0.0f) ? (length[i] / totalLength) : 0.0f;
+        u += m_uLength[i];
+    }
+    m_uStart[count - 1] = 1.0f;
+
+    m_closed = (count > 2) && (m_x[0] == m_x[count - 1]) && (m_y[0] == m_y[count - 1]) && (m_z[0] == m_z[count - 1]);
+}
+
+//--------------------------------------------------------------------------------
+
+void AnimationPath::Point(size_t index, float position[3]) const
+{
+    position[0] = m_x[index];
+    position[1] = m_y[index];
+    position[2] = m_z[index];
+}
+
+//--------------------------------------------------------------------------------
+
+uint32_t AnimationPath::FindSegment(float u, uint32_t hint) const
+{
+    uint32_t segmentCount = static_cast<uint32_t>(m_uStart.size() - 1);
+    if (segmentCount == 0)
+    {
+        return 0;
+    }
+
+    for (uint32_t i = hint; i < hint + 2 && i < segmentCount; i++)
+    {
+        if ((i == 0 || u > m_uStart[i]) && u <= m_uStart[i + 1])
+        {
+            return i;
+        }
+    }
+
+    // The first segment whose end is at or past u.
+    auto end = std::lower_bound(m_uStart.begin() + 1, m_uStart.end(), u);
+    uint32_t segment = static_cast<uint32_t>(end - (m_uStart.begin() + 1));
+    return (std::min)(segment, segmentCount - 1);
+}
+
+//--------------------------------------------------------------------------------
+
+void AnimationPath::Evaluate(float u, PathInterpolation interpolation, uint32_t* cursor, float position[3]) const
+{
+    size_t count = m_x.size();
+    if (count < 2)
+    {
+        Point(0, position);
+        return;
+    }
+
+    uint32_t i = FindSegment(u, *cursor);
+    *cursor = i;
+
+    float s = (m_uLength[i] > 0.0f) ? ((u - m_uStart[i]) / m_uLength[i]) : 0.0f;
+
+    if (interpolation == PathInterpolation::Linear)
+    {
+        position[0] = m_x[i] + (m_x[i + 1] - m_x[i]) * s;
+        position[1] = m_y[i] + (m_y[i + 1] - m_y[i]) * s;
+        position[2] = m_z[i] + (m_z[i + 1] - m_z[i]) * s;
+        return;
+    }
+
+    // Neighbouring points for the spline.  Closed paths wrap around, skipping the duplicated
+    // end point; open paths repeat their end points.
+    size_t p1 = i;
+    size_t p2 = i + 1;
+    size_t p0 = (i > 0) ? (i - 1) : (m_closed ? count - 2 : 0);
+    size_t p3 = (i + 2 < count) ? (i + 2) : (m_closed ? 1 : count - 1);
+
+    float s2 = s * s;
+    float s3 = s2 * s;
+    float w0 = 0.5f * (-s3 + 2.0f * s2 - s);
+    float w1 = 0.5f * (3.0f * s3 - 5.0f * s2 + 2.0f);
+    float w2 = 0.5f * (-3.0f * s3 + 4.0f * s2 + s);
+    float w3 = 0.5f * (s3 - s2);
+
+    position[0] = w0 * m_x[p0] + w1 * m_x[p1] + w2 * m_x[p2] + w3 * m_x[p3];
+    position[1] = w0 * m_y[p0] + w1 * m_y[p1] + w2 * m_y[p2] + w3 * m_y[p3];
+    position[2] = w0 * m_z[p0] + w1 * m_z[p1] + w2 * m_z[p2] + w3 * m_z[p3];
+}
+
+//--------------------------------------------------------------------------------
+
+void PathAnimationBatch::Clear()
+{
+    m_paths.clear();
+    m_startTime.clear();
+    m_duration.clear();
+    m_continuous.clear();
+    m_interpolation.clear();
+    m_active.clear();
+    m_cursor.clear();
+    m_x.clear();
+    m_y.clear();
+    m_z.clear();
+    m_finished.clear();
+}
+
+//--------------------------------------------------------------------------------
+
+uint32_t PathAnimationBatch::Add(
+    std::shared_ptr<const AnimationPath> path,
+    float startTime,
+    float duration,
+    bool continuous,
+    PathInterpolation interpolation
+    )
+{
+    float start[3];
+    path->Point(0, start);
+
+    m_paths.push_back(std::move(path));
+    m_startTime.push_back(startTime);
+    m_duration.push_back(duration);
+    m_continuous.push_back(continuous ? 1 : 0);
+    m_interpolation.push_back(interpolation);
+    m_active.push_back(1);
+    m_cursor.push_back(0);
+    m_x.push_back(start[0]);
+    m_y.push_back(start[1]);
+    m_z.push_back(start[2]);
+    m_finished.push_back(0);
+
+    return static_cast<uint32_t>(m_paths.size() - 1);
+}
+
+//--------------------------------------------------------------------------------
+
+void PathAnimationBatch::Evaluate(float t)
+{
+    size_t count = m_paths.size();
+    for (size_t k = 0; k < count; k++)
+    {
+        if (!m_active[k])
+        {
+            continue;
+        }
+
+        const AnimationPath& path = *m_paths[k];
+        float startTime = m_startTime[k];
+        float duration = m_duration[k];
+        bool continuous = m_continuous[k] != 0;
+        float position[3];
+
+        m_finished[k] = (!continuous && (t >= (startTime + duration))) ? 1 : 0;
+
+        if (t <= startTime)
+        {
+            path.Point(0, position);
+        }
+        else if (m_finished[k])
+        {
+            path.Point(path.PointCount() - 1, position);
+        }
+        else
+        {
+            if (continuous)
+            {
+                // For continuous operation move the start time forward to
+                // eliminate previous iterations.
+                startTime += ((int)((t - startTime) / duration)) * duration;
+            }
+
+            float u = (t - startTime) / duration;
+            path.Evaluate(u, m_interpolation[k], &m_cursor[k], position);
+        }
+
+        m_x[k] = position[0];
+        m_y[k] = position[1];
+        m_z[k] = position[2];
+    }
+}
+
+//--------------------------------------------------------------------------------
+
+void PathAnimationBatch::Position(uint32_t index, float position[3]) const
+{
+    position[0] = m_x[index];
+    position[1] = m_y[index];
+    position[2] = m_z[index];
+}
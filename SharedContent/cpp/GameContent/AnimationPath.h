@@ -0,0 +1,106 @@
+//********************************************************* 
+// 
+// Copyright (c) Microsoft. All rights reserved. 
+// This code is licensed under the MIT License (MIT). 
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF 
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY 
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR 
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT. 
+// 
+//*********************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+enum class PathInterpolation
+{
+    Linear,         // Straight lines between the points, as AnimateLineListPosition.
+    CatmullRom      // A Catmull-Rom spline through the points.
+};
+
+// AnimationPath:
+// A list of points parameterized by arc length, so that evaluating it with a
+// uniformly increasing u in [0, 1] moves along it at a constant speed.  Paths are
+// immutable once built and can be shared by any number of animations.
+//
+// Evaluate takes a segment cursor owned by the caller.  Animations move forward in
+// small steps, so the cursor's segment or the next one almost always contains u;
+// otherwise the segment is found with a binary search.  A path whose first and last
+// points are equal is treated as a closed loop by the spline interpolation.
+// This file only depends on the C++ standard library.
+
+class AnimationPath
+{
+public:
+    // points holds x, y, z for each of the count points.  count must be at least 1.
+    AnimationPath(const float* points, size_t count);
+
+    size_t PointCount() const { return m_x.size(); }
+    void Point(size_t index, float position[3]) const;
+
+    // Returns the segment i with uStart[i] < u <= uStart[i + 1], or 0 when u is at or
+    // before the start, trying hint and hint + 1 before searching.
+    uint32_t FindSegment(float u, uint32_t hint) const;
+
+    void Evaluate(float u, PathInterpolation interpolation, uint32_t* cursor, float position[3]) const;
+
+private:
+    std::vector<float>  m_x;
+    std::vector<float>  m_y;
+    std::vector<float>  m_z;
+    std::vector<float>  m_uStart;   // Path parameter at each point; the last one is 1.
+    std::vector<float>  m_uLength;  // Path parameter covered by each segment.
+    bool                m_closed;
+};
+
+// PathAnimationBatch:
+// Evaluates many path animations at once.  The timing, cursors and results of the
+// animations are kept in parallel arrays and advanced in one pass by Evaluate, with
+// the same timing rules as Animate: before the start an animation sits at its first
+// point; a continuous animation loops every duration; any other animation stops at
+// its last point and is finished from then on.
+
+class PathAnimationBatch
+{
+public:
+    void Clear();
+
+    // Returns the index of the new animation.
+    uint32_t Add(
+        std::shared_ptr<const AnimationPath> path,
+        float startTime,
+        float duration,
+        bool continuous,
+        PathInterpolation interpolation
+        );
+
+    size_t Count() const { return m_paths.size(); }
+
+    // Inactive animations are skipped by Evaluate and keep their last results.
+    void SetActive(uint32_t index, bool active) { m_active[index] = active ? 1 : 0; }
+    bool IsActive(uint32_t index) const { return m_active[index] != 0; }
+
+    void Evaluate(float t);
+
+    void Position(uint32_t index, float position[3]) const;
+    bool IsFinished(uint32_t index) const { return m_finished[index] != 0; }
+
+private:
+    std::vector<std::shared_ptr<const AnimationPath>>   m_paths;
+    std::vector<float>                                  m_startTime;
+    std::vector<float>                                  m_duration;
+    std::vector<uint8_t>                                m_continuous;
+    std::vector<PathInterpolation>                      m_interpolation;
+    std::vector<uint8_t>                                m_active;
+    std::vector<uint32_t>                               m_cursor;
+
+    // Results of the last Evaluate.
+    std::vector<float>                                  m_x;
+    std::vector<float>                                  m_y;
+    std::vector<float>                                  m_z;
+    std::vector<uint8_t>                                m_finished;
+};
@@ -0,0 +1,489 @@
+//********************************************************* 
+// 
+// Copyright (c) Microsoft. All rights reserved. 
+// This code is licensed under the MIT License (MIT). 
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF 
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY 
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR 
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT. 
+// 
+//*********************************************************
+
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "AssetPipeline.h"
+
+namespace
+{
+    const uint64_t FnvOffsetBasis = 14695981039346656037ull;
+    const uint64_t FnvPrime = 1099511628211ull;
+
+    double Milliseconds(std::chrono::steady_clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    bool IsComplete(AssetState state)
+    {
+        return state == AssetState::Ready || state == AssetState::Failed;
+    }
+}
+
+//----------------------------------------------------------------------
+
+Asset::Asset(const AssetRequest& request) :
+    m_type(request.type),
+    m_path(request.path),
+    m_variant(request.variant),
+    m_create(request.create),
+    m_dependencies(request.dependencies),
+    m_state(AssetState::Queued),
+    m_priority(request.priority),
+    m_read(false),
+    m_dependencyFailed(false),
+    m_pendingDependencies(0),
+    m_contentHash(0),
+    m_size(0),
+    m_requestTime(std::chrono::steady_clock::now()),
+    m_timings()
+{
+}
+
+//----------------------------------------------------------------------
+
+AssetPipeline::AssetPipeline(ReadFunction read, unsigned int workerCount) :
+    m_read(read),
+    m_sequence(0),
+    m_stopping(false),
+    m_waiters(0),
+    m_stats(),
+    m_timing(false)
+{
+    if (workerCount == 0)
+    {
+        workerCount = 1;
+    }
+
+    for (unsigned int i = 0; i < workerCount; i++)
+    {
+        m_workers.emplace_back(&AssetPipeline::WorkerThread, this);
+    }
+}
+
+//----------------------------------------------------------------------
+
+AssetPipeline::~AssetPipeline()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_stopping = true;
+    }
+
+    m_workAvailable.notify_all();
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+
+    // Assets that never completed hold their dependents, which hold them in turn; break those cycles.
+    std::unique_lock<std::mutex> lock(m_lock);
+    for (auto& entry : m_assets)
+    {
+        entry.second->m_dependents.clear();
+        if (!IsComplete(entry.second->m_state))
+        {
+            entry.second->m_state = AssetState::Failed;
+        }
+    }
+
+    // Every asset has completed now, so callers blocked in Wait return; the lock must outlive them.
+    m_completed.notify_all();
+    m_completed.wait(lock, [this]() { return m_waiters == 0; });
+}
+
+//----------------------------------------------------------------------
+
+AssetHandle AssetPipeline::Load(const AssetRequest& request)
+{
+    AssetHandle asset(new Asset(request));
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (!m_timing)
+        {
+            m_timing = true;
+            m_firstRequest = asset->m_requestTime;
+        }
+
+        m_stats.requested++;
+
+        std::wstring key = MakeKey(*asset);
+        auto existing = m_assets.find(key);
+        if (existing != m_assets.end() && existing->second->m_state != AssetState::Failed)
+        {
+            m_stats.pathHits++;
+            asset = existing->second;
+            Promote(asset, request.priority);
+        }
+        else
+        {
+            for (const auto& dependency : asset->m_dependencies)
+            {
+                AssetState state = dependency->m_state;
+                if (state == AssetState::Failed)
+                {
+                    asset->m_dependencyFailed = true;
+                }
+                else if (state != AssetState::Ready)
+                {
+                    dependency->m_dependents.push_back(asset);
+                    asset->m_pendingDependencies++;
+                    Promote(dependency, request.priority);
+                }
+            }
+
+            // The file is read straight away; only creating the resource waits for the dependencies.
+            m_assets[key] = asset;
+            Enqueue(asset);
+        }
+    }
+
+    m_workAvailable.notify_all();
+    return asset;
+}
+
+//----------------------------------------------------------------------
+
+bool AssetPipeline::Wait(const std::vector<AssetHandle>& assets)
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_waiters++;
+    m_completed.wait(lock, [&assets]()
+    {
+        for (const auto& asset : assets)
+        {
+            if (!IsComplete(asset->m_state))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    });
+
+    if (--m_waiters == 0 && m_stopping)
+    {
+        m_completed.notify_all();
+    }
+
+    for (const auto& asset : assets)
+    {
+        if (asset->m_state != AssetState::Ready)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//----------------------------------------------------------------------
+
+size_t AssetPipeline::ReleaseUnused()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    // Dropping an asset can release the last handle to one of its dependencies, so repeat until
+    // nothing else is dropped.
+    size_t released = 0;
+    bool releasedAny = true;
+    while (releasedAny)
+    {
+        releasedAny = false;
+        for (auto it = m_assets.begin(); it != m_assets.end();)
+        {
+            if (IsComplete(it->second->m_state) && it->second.use_count() == 1)
+            {
+                it = m_assets.erase(it);
+                released++;
+                releasedAny = true;
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    for (auto it = m_byContent.begin(); it != m_byContent.end();)
+    {
+        if (it->second.expired())
+        {
+            it = m_byContent.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    m_stats.evicted += released;
+    return released;
+}
+
+//----------------------------------------------------------------------
+
+size_t AssetPipeline::ResidentCount() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    size_t count = 0;
+    for (const auto& entry : m_assets)
+    {
+        if (entry.second->m_state == AssetState::Ready)
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+//----------------------------------------------------------------------
+
+AssetPipelineStats AssetPipeline::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_stats;
+}
+
+//----------------------------------------------------------------------
+
+void AssetPipeline::ResetStats()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_stats = AssetPipelineStats();
+    m_timing = false;
+}
+
+//----------------------------------------------------------------------
+
+uint64_t AssetPipeline::HashContent(const uint8_t* data, size_t size)
+{
+    // 64-bit FNV-1a.
+    uint64_t hash = FnvOffsetBasis;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ data[i]) * FnvPrime;
+    }
+
+    return hash;
+}
+
+//----------------------------------------------------------------------
+
+std::wstring AssetPipeline::MakeKey(const Asset& asset)
+{
+    return std::to_wstring(static_cast<int>(asset.m_type)) + L':' + std::to_wstring(asset.m_variant) + L':' + asset.m_path;
+}
+
+//----------------------------------------------------------------------
+
+uint64_t AssetPipeline::MakeContentKey(const Asset& asset)
+{
+    uint64_t key = asset.m_contentHash;
+    key = (key ^ static_cast<uint64_t>(asset.m_size)) * FnvPrime;
+    key = (key ^ static_cast<uint64_t>(asset.m_type)) * FnvPrime;
+    key = (key ^ static_cast<uint64_t>(asset.m_variant)) * FnvPrime;
+    return key;
+}
+
+//----------------------------------------------------------------------
+
+bool AssetPipeline::IsSameContent(const Asset& asset, const Asset& other)
+{
+    return asset.m_type == other.m_type &&
+        asset.m_variant == other.m_variant &&
+        asset.m_contentHash == other.m_contentHash &&
+        asset.m_size == other.m_size &&
+        asset.m_dependencies == other.m_dependencies;
+}
+
+//----------------------------------------------------------------------
+
+void AssetPipeline::Enqueue(const AssetHandle& asset)
+{
+    m_queue.push({ asset->m_priority, m_sequence++, asset });
+}
+
+//----------------------------------------------------------------------
+
+void AssetPipeline::Promote(const AssetHandle& asset, AssetPriority priority)
+{
+    if (IsComplete(asset->m_state) || priority >= asset->m_priority)
+    {
+        return;
+    }
+
+    // The queue can hold stale entries for an asset; only the one matching m_priority is used.
+    asset->m_priority = priority;
+    if (asset->m_state == AssetState::Queued)
+    {
+        Enqueue(asset);
+    }
+
+    for (const auto& dependency : asset->m_dependencies)
+    {
+        Promote(dependency, priority);
+    }
+}
+
+//----------------------------------------------------------------------
+
+void AssetPipeline::Complete(const AssetHandle& asset, bool succeeded)
+{
+    auto now = std::chrono::steady_clock::now();
+    std::vector<uint8_t>().swap(asset->m_data);
+    asset->m_timings.total = Milliseconds(now - asset->m_requestTime);
+    asset->m_state = succeeded ? AssetState::Ready : AssetState::Failed;
+    if (!succeeded)
+    {
+        m_stats.failed++;
+    }
+
+    if (m_timing)
+    {
+        m_stats.criticalPath = Milliseconds(now - m_firstRequest);
+    }
+
+    for (const auto& dependent : asset->m_dependents)
+    {
+        if (!succeeded)
+        {
+            dependent->m_dependencyFailed = true;
+        }
+
+        if (--dependent->m_pendingDependencies == 0 && dependent->m_state == AssetState::Waiting)
+        {
+            dependent->m_state = AssetState::Queued;
+            Enqueue(dependent);
+            m_workAvailable.notify_one();
+        }
+    }
+
+    asset->m_dependents.clear();
+    m_completed.notify_all();
+}
+
+//----------------------------------------------------------------------
+
+void AssetPipeline::WorkerThread()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    while (true)
+    {
+        m_workAvailable.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+        if (m_stopping)
+        {
+            return;
+        }
+
+        Job job = m_queue.top();
+        m_queue.pop();
+
+        AssetHandle asset = job.asset;
+        if (asset->m_state != AssetState::Queued || asset->m_priority != job.priority)
+        {
+            // Already taken from another entry, or superseded by a more urgent one.
+            continue;
+        }
+
+        asset->m_state = AssetState::Loading;
+
+        if (!asset->m_read)
+        {
+            lock.unlock();
+
+            auto start = std::chrono::steady_clock::now();
+            std::vector<uint8_t> data;
+            bool read = false;
+            try
+            {
+                read = m_read(asset->m_path, data);
+            }
+            catch (...)
+            {
+            }
+
+            uint64_t hash = read ? HashContent(data.data(), data.size()) : 0;
+            double readTime = Milliseconds(std::chrono::steady_clock::now() - start);
+
+            lock.lock();
+            asset->m_read = true;
+            asset->m_timings.read = readTime;
+            m_stats.readMilliseconds += readTime;
+            if (!read)
+            {
+                Complete(asset, false);
+                continue;
+            }
+
+            m_stats.bytesRead += data.size();
+            asset->m_contentHash = hash;
+            asset->m_size = data.size();
+
+            auto match = m_byContent.find(MakeContentKey(*asset));
+            if (match != m_byContent.end())
+            {
+                AssetHandle original = match->second.lock();
+                if (original != nullptr && original->m_state == AssetState::Ready && IsSameContent(*asset, *original))
+                {
+                    asset->m_resource = original->m_resource;
+                    m_stats.contentHits++;
+                    Complete(asset, true);
+                    continue;
+                }
+            }
+
+            asset->m_data.swap(data);
+            if (asset->m_pendingDependencies > 0)
+            {
+                // Complete requeues the asset once the last dependency is done.
+                asset->m_state = AssetState::Waiting;
+                continue;
+            }
+        }
+
+        if (asset->m_dependencyFailed)
+        {
+            Complete(asset, false);
+            continue;
+        }
+
+        // Only this worker touches the asset's data while it is Loading.
+        lock.unlock();
+
+        auto start = std::chrono::steady_clock::now();
+        std::shared_ptr<void> resource;
+        try
+        {
+            resource = asset->m_create(asset->m_data, asset->m_dependencies);
+        }
+        catch (...)
+        {
+            resource = nullptr;
+        }
+
+        double createTime = Milliseconds(std::chrono::steady_clock::now() - start);
+
+        lock.lock();
+        asset->m_timings.create = createTime;
+        m_stats.createMilliseconds += createTime;
+        asset->m_resource = resource;
+        if (resource != nullptr)
+        {
+            m_stats.created++;
+            m_byContent[MakeContentKey(*asset)] = asset;
+        }
+
+        Complete(asset, resource != nullptr);
+    }
+}
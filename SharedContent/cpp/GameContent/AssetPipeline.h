@@ -0,0 +1,235 @@
+//********************************************************* 
+// 
+// Copyright (c) Microsoft. All rights reserved. 
+// This code is licensed under the MIT License (MIT). 
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF 
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY 
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR 
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT. 
+// 
+//*********************************************************
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Kind of resource an asset produces.  Assets of different types never share a cache entry,
+// even when they are created from the same file.
+enum class AssetType
+{
+    VertexShader,
+    PixelShader,
+    Texture,
+    Mesh,
+    Other
+};
+
+// Lower values are loaded first.
+enum class AssetPriority
+{
+    Critical = 0,   // Needed before anything can be drawn.
+    Level = 1,      // Needed before the next level can start.
+    Prefetch = 2    // Wanted soon, but nothing waits for it yet.
+};
+
+enum class AssetState
+{
+    Queued,         // Waiting for a worker.
+    Loading,        // A worker is reading or creating it.
+    Waiting,        // Read, but some dependencies are not ready yet.
+    Ready,
+    Failed
+};
+
+class Asset;
+typedef std::shared_ptr<Asset> AssetHandle;
+
+// Creates the resource from the file contents.  Every dependency is Ready when this is called.
+// Called on worker threads, so it must be safe to call concurrently.  data may be modified and is
+// released once the function returns.  Returning nullptr or throwing marks the asset as Failed.
+typedef std::function<std::shared_ptr<void>(std::vector<uint8_t>& data, const std::vector<AssetHandle>& dependencies)> AssetCreateFunction;
+
+struct AssetRequest
+{
+    AssetType                   type;
+    std::wstring                path;
+    uint32_t                    variant;        // Tells apart assets made from the same file by different create
+                                                // functions, e.g. one vertex shader with two input layouts.
+    AssetPriority               priority;
+    std::vector<AssetHandle>    dependencies;
+    AssetCreateFunction         create;
+};
+
+// Times in milliseconds.
+struct AssetTimings
+{
+    double      read;       // Reading the file.
+    double      create;     // Running the create function; 0 when the resource was shared.
+    double      total;      // From the request to Ready or Failed, including time spent queued.
+};
+
+struct AssetPipelineStats
+{
+    uint64_t    requested;          // Calls to Load.
+    uint64_t    pathHits;           // Requests answered by an asset already resident or in flight.
+    uint64_t    contentHits;        // Loads whose file matched a resident asset, so its resource was shared.
+    uint64_t    created;            // Resources created.
+    uint64_t    failed;
+    uint64_t    evicted;            // Assets dropped by ReleaseUnused.
+    uint64_t    bytesRead;
+    double      readMilliseconds;   // Summed over all workers.
+    double      createMilliseconds; // Summed over all workers.
+    double      criticalPath;       // Milliseconds from the first request to the last completion.
+};
+
+// Asset:
+// One resource managed by an AssetPipeline.  Handles are reference counted; an asset stays resident
+// while anyone, including an asset that depends on it, holds its handle.
+// Only Type, Path and State may be used before the asset has completed.
+
+class Asset
+{
+public:
+    AssetType Type() const { return m_type; }
+    const std::wstring& Path() const { return m_path; }
+    uint32_t Variant() const { return m_variant; }
+    AssetState State() const { return m_state; }
+    bool IsReady() const { return m_state == AssetState::Ready; }
+
+    uint64_t ContentHash() const { return m_contentHash; }
+    size_t Size() const { return m_size; }
+    AssetTimings Timings() const { return m_timings; }
+
+    // The caller must know the type the create function returned.
+    template <typename T>
+    std::shared_ptr<T> Get() const
+    {
+        return std::static_pointer_cast<T>(m_resource);
+    }
+
+private:
+    friend class AssetPipeline;
+
+    Asset(const AssetRequest& request);
+
+    AssetType                                   m_type;
+    std::wstring                                m_path;
+    uint32_t                                    m_variant;
+    AssetCreateFunction                         m_create;
+    std::vector<AssetHandle>                    m_dependencies;
+
+    // Everything below is guarded by the pipeline's lock until the asset completes.
+    std::atomic<AssetState>                     m_state;
+    AssetPriority                               m_priority;
+    bool                                        m_read;
+    bool                                        m_dependencyFailed;
+    size_t                                      m_pendingDependencies;
+    std::vector<AssetHandle>                    m_dependents;
+    std::vector<uint8_t>                        m_data;
+    std::shared_ptr<void>                       m_resource;
+    uint64_t                                    m_contentHash;
+    size_t                                      m_size;
+    std::chrono::steady_clock::time_point       m_requestTime;
+    AssetTimings                                m_timings;
+};
+
+// AssetPipeline:
+// Loads assets on a pool of worker threads, most urgent first, and keeps them resident across levels.
+// A request for a path that is already resident or in flight returns the existing handle.  Files
+// are read as soon as a worker is free, but an asset is only created once all its dependencies
+// are Ready; requesting an urgent asset also promotes the dependencies it is waiting for.
+// After a file is read its contents are hashed, and if a resident asset of the same type and variant,
+// with the same dependencies, was made from identical data its resource is shared instead of created
+// again.  Contents are compared by 64-bit hash and size only.
+
+class AssetPipeline
+{
+public:
+    // Reads the whole file into data.  Called on worker threads.  Returns false if it could not be read.
+    typedef std::function<bool(const std::wstring& path, std::vector<uint8_t>& data)> ReadFunction;
+
+    AssetPipeline(ReadFunction read, unsigned int workerCount);
+    ~AssetPipeline();
+
+    AssetPipeline(const AssetPipeline&) = delete;
+    AssetPipeline& operator=(const AssetPipeline&) = delete;
+
+    // Returns the asset for the request's type, path and variant, queuing it if it is not already resident
+    // or in flight.  When it is, the request's create function and dependencies are ignored and
+    // the existing asset is only promoted to the request's priority.  An asset that failed is retried.
+    AssetHandle Load(const AssetRequest& request);
+
+    // Blocks until every asset has completed.  Returns true if they are all Ready.  Destroying the
+    // pipeline fails the assets that have not completed, which wakes the callers blocked here, and
+    // waits for them to return.
+    bool Wait(const std::vector<AssetHandle>& assets);
+
+    // Drops completed assets that nobody holds a handle to, e.g. when changing level.
+    // Returns the number of assets dropped.
+    size_t ReleaseUnused();
+
+    size_t ResidentCount() const;
+
+    AssetPipelineStats GetStats() const;
+    void ResetStats();
+
+    static uint64_t HashContent(const uint8_t* data, size_t size);
+
+private:
+    struct Job
+    {
+        AssetPriority   priority;
+        uint64_t        sequence;
+        AssetHandle     asset;
+
+        bool operator<(const Job& other) const
+        {
+            // std::priority_queue pops the largest element, so invert the ordering.
+            if (priority != other.priority)
+            {
+                return priority > other.priority;
+            }
+
+            return sequence > other.sequence;
+        }
+    };
+
+    static std::wstring MakeKey(const Asset& asset);
+    static uint64_t MakeContentKey(const Asset& asset);
+    static bool IsSameContent(const Asset& asset, const Asset& other);
+
+    void Enqueue(const AssetHandle& asset);
+    void Promote(const AssetHandle& asset, AssetPriority priority);
+    void Complete(const AssetHandle& asset, bool succeeded);
+    void WorkerThread();
+
+    ReadFunction                                        m_read;
+
+    mutable std::mutex                                  m_lock;
+    std::condition_variable                             m_workAvailable;
+    std::condition_variable                             m_completed;
+    std::priority_queue<Job>                            m_queue;
+    std::unordered_map<std::wstring, AssetHandle>       m_assets;
+    std::unordered_map<uint64_t, std::weak_ptr<Asset>>  m_byContent;
+    uint64_t                                            m_sequence;
+    bool                                                m_stopping;
+    size_t                                              m_waiters;
+    AssetPipelineStats                                  m_stats;
+    bool                                                m_timing;
+    std::chrono::steady_clock::time_point               m_firstRequest;
+
+    std::vector<std::thread>                            m_workers;
+};
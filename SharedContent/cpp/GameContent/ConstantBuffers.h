@@ -25,6 +25,18 @@ static D3D11_INPUT_ELEMENT_DESC PNTVertexLayout[] =
     {"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT,    0, 24, D3D11_INPUT_PER_VERTEX_DATA, 0},
 };
 
+// PNTVertex in slot 0 plus one row major object to world matrix per instance in slot 1.
+static D3D11_INPUT_ELEMENT_DESC PNTInstancedVertexLayout[] =
+{
+    {"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT,    0,  0, D3D11_INPUT_PER_VERTEX_DATA,   0},
+    {"NORMAL",   0, DXGI_FORMAT_R32G32B32_FLOAT,    0, 12, D3D11_INPUT_PER_VERTEX_DATA,   0},
+    {"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT,       0, 24, D3D11_INPUT_PER_VERTEX_DATA,   0},
+    {"WORLD",    0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1,  0, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+    {"WORLD",    1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 16, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+    {"WORLD",    2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 32, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+    {"WORLD",    3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 48, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+};
+
 struct ConstantBufferNeverChanges
 {
     DirectX::XMFLOAT4 lightPosition[4];
@@ -47,6 +59,7 @@ struct ConstantBufferChangesEveryPrim
     DirectX::XMFLOAT4 meshColor;
     DirectX::XMFLOAT4 diffuseColor;
     DirectX::XMFLOAT4 specularColor;
+    DirectX::XMFLOAT4 textureTransform;     // uv * xy + zw, see Material::SetTextureTransform.
     float specularPower;
 };
 
@@ -34,6 +34,7 @@ cbuffer ConstantBufferChangesEveryPrim : register (b3)
     float4 meshColor;
     float4 diffuseColor;
     float4 specularColor;
+    float4 textureTransform;
     float  specularExponent;
 };
 
@@ -44,6 +45,17 @@ struct VertextShaderInput
     float2 textureUV : TEXCOORD0;
 };
 
+struct VertexShaderInstancedInput
+{
+    float4 position : POSITION;
+    float4 normal : NORMAL;
+    float2 textureUV : TEXCOORD0;
+    float4 world0 : WORLD0;
+    float4 world1 : WORLD1;
+    float4 world2 : WORLD2;
+    float4 world3 : WORLD3;
+};
+
 struct PixelShaderInput
 {
     float4 position : SV_POSITION;
@@ -9,6 +9,7 @@
 // 
 //*********************************************************
 
+
 #pragma once
 
 // CylinderMesh:
@@ -16,6 +17,7 @@
 // vertices and indices to represent a canonical cylinder (capped at
 // both ends) that is positioned at the origin with a radius of 1.0,
 // a height of 1.0 and with its axis in the +Z direction.
+// The second constructor takes a mesh already generated, e.g. by a MeshCache.
 
 #include "MeshObject.h"
 
@@ -23,4 +25,5 @@ ref class CylinderMesh: public MeshObject
 {
 internal:
     CylinderMesh(_In_ ID3D11Device *device, uint32 segments);
+    CylinderMesh(_In_ ID3D11Device *device, const MeshData& mesh);
 };
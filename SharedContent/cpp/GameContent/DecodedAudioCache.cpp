@@ -0,0 +1,116 @@
+//********************************************************* 
+// 
+// Copyright (c) Microsoft. All rights reserved. 
+// This code is licensed under the MIT License (MIT). 
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF 
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY 
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR 
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT. 
+// 
+//*********************************************************
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "DecodedAudioCache.h"
+
+DecodedAudioCache::DecodedAudioCache(size_t budgetBytes) :
+    m_budget(budgetBytes),
+    m_clock(0),
+    m_stats()
+{
+}
+
+void DecodedAudioCache::SetBudget(size_t budgetBytes)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_budget = budgetBytes;
+    EvictUnused();
+}
+
+size_t DecodedAudioCache::GetBudget() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_budget;
+}
+
+std::shared_ptr<const DecodedAudio> DecodedAudioCache::Acquire(const std::wstring& key, const LoadFunction& load)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        auto existing = m_entries.find(key);
+        if (existing != m_entries.end())
+        {
+            existing->second.lastUse = ++m_clock;
+            m_stats.hits++;
+            return existing->second.audio;
+        }
+        m_stats.misses++;
+    }
+
+    // Decode without holding the lock so that other assets can be served meanwhile.
+    auto audio = std::make_shared<DecodedAudio>();
+    if (!load(*audio))
+    {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(m_lock);
+    auto existing = m_entries.find(key);
+    if (existing != m_entries.end())
+    {
+        existing->second.lastUse = ++m_clock;
+        return existing->second.audio;
+    }
+
+    Entry entry;
+    entry.audio = audio;
+    entry.bytes = audio->format.size() + audio->data.size();
+    entry.lastUse = ++m_clock;
+    m_entries.emplace(key, entry);
+
+    m_stats.residentBytes += entry.bytes;
+    if (m_stats.residentBytes > m_stats.peakBytes)
+    {
+        m_stats.peakBytes = m_stats.residentBytes;
+    }
+
+    // The new entry is held by the caller, so it is never the one evicted.
+    EvictUnused();
+    return audio;
+}
+
+void DecodedAudioCache::Trim()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    EvictUnused();
+}
+
+DecodedAudioCacheStats DecodedAudioCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_stats;
+}
+
+void DecodedAudioCache::EvictUnused()
+{
+    while (m_stats.residentBytes > m_budget)
+    {
+        // The cache holds the only reference to entries nobody is playing.
+        auto victim = m_entries.end();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+        {
+            if (it->second.audio.use_count() == 1 && (victim == m_entries.end() || it->second.lastUse < victim->second.lastUse))
+            {
+                victim = it;
+            }
+        }
+
+        if (victim == m_entries.end())
+        {
+            return;
+        }
+
+        m_stats.residentBytes -= victim->second.bytes;
+        m_stats.evictions++;
+        m_entries.erase(victim);
+    }
+}
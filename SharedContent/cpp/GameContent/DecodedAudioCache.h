@@ -0,0 +1,85 @@
+//********************************************************* 
+// 
+// Copyright (c) Microsoft. All rights reserved. 
+// This code is licensed under the MIT License (MIT). 
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF 
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY 
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR 
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT. 
+// 
+//*********************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Decoded PCM audio and its format, shared read-only by every voice that plays it.
+struct DecodedAudio
+{
+    std::vector<uint8_t>    format;     // WAVEFORMATEX, including any extra bytes.
+    std::vector<uint8_t>    data;
+};
+
+struct DecodedAudioCacheStats
+{
+    uint64_t    hits;
+    uint64_t    misses;
+    uint64_t    evictions;
+    size_t      residentBytes;
+    size_t      peakBytes;
+};
+
+// DecodedAudioCache:
+// Reference counted cache of decoded audio, keyed by file name, shared by every sound created
+// from the same file: SoundEffects loaded through MediaReader in the games, and AudioFileReader
+// in SpatialSound.  This file only depends on the C++ standard library.
+// An entry stays resident while anyone holds the pointer returned by Acquire. Entries nobody holds are
+// kept for reuse until the total size exceeds the budget, and are then evicted least recently used first.
+// Entries in use are never evicted, so the budget can be exceeded while they are held.
+
+class DecodedAudioCache
+{
+public:
+    // Fills audio from the source; returns false if it could not be decoded.
+    typedef std::function<bool(DecodedAudio& audio)> LoadFunction;
+
+    explicit DecodedAudioCache(size_t budgetBytes);
+
+    DecodedAudioCache(const DecodedAudioCache&) = delete;
+    DecodedAudioCache& operator=(const DecodedAudioCache&) = delete;
+
+    void SetBudget(size_t budgetBytes);
+    size_t GetBudget() const;
+
+    // Returns the cached audio for key, decoding it with load on a miss. Returns nullptr if load fails.
+    // Concurrent misses for the same key may both decode; the first one inserted is kept.
+    std::shared_ptr<const DecodedAudio> Acquire(const std::wstring& key, const LoadFunction& load);
+
+    // Evicts unused entries until the cache fits in its budget.
+    void Trim();
+
+    DecodedAudioCacheStats GetStats() const;
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<const DecodedAudio>     audio;
+        size_t                                  bytes;
+        uint64_t                                lastUse;
+    };
+
+    void EvictUnused();
+
+private:
+    mutable std::mutex                          m_lock;
+    std::unordered_map<std::wstring, Entry>     m_entries;
+    size_t                                      m_budget;
+    uint64_t                                    m_clock;
+    DecodedAudioCacheStats                      m_stats;
+};
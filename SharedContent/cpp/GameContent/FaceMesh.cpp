@@ -11,50 +11,16 @@
 
 #include "pch.h"
 #include "FaceMesh.h"
-#include "DirectXSample.h"
-#include "ConstantBuffers.h"
-
-using namespace Microsoft::WRL;
-using namespace DirectX;
 
 FaceMesh::FaceMesh(_In_ ID3D11Device *device)
 {
-    D3D11_BUFFER_DESC bd = {0};
-    D3D11_SUBRESOURCE_DATA initData = {0};
-
-    PNTVertex target_vertices[] =
-    {
-        {XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 1.0f), XMFLOAT2(1.0f, 1.0f)},
-        {XMFLOAT3(1.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 1.0f), XMFLOAT2(0.0f, 1.0f)},
-        {XMFLOAT3(1.0f, 1.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 1.0f), XMFLOAT2(0.0f, 0.0f)},
-        {XMFLOAT3(0.0f, 1.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 1.0f), XMFLOAT2(1.0f, 0.0f)}
-    };
-    WORD target_indices[] =
-    {
-        0, 1, 2,
-        0, 2, 3,
-        0, 2, 1,
-        0, 3, 2
-    };
-
-    m_vertexCount = 4;
-    m_indexCount = 12;
-
-    bd.Usage = D3D11_USAGE_DEFAULT;
-    bd.ByteWidth = sizeof(PNTVertex) * m_vertexCount;
-    bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-    bd.CPUAccessFlags = 0;
-    initData.pSysMem = target_vertices;
-    DX::ThrowIfFailed(
-        device->CreateBuffer(&bd, &initData, &m_vertexBuffer)
-        );
+    MeshData mesh;
+    MeshGenerator::GenerateFace(mesh);
+    MeshGenerator::Optimize(mesh);
+    CreateBuffers(device, mesh);
+}
 
-    bd.Usage = D3D11_USAGE_DEFAULT;
-    bd.ByteWidth = sizeof(WORD) * m_indexCount;
-    bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
-    bd.CPUAccessFlags = 0;
-    initData.pSysMem = target_indices;
-    DX::ThrowIfFailed(
-        device->CreateBuffer(&bd, &initData, &m_indexBuffer)
-        );
+FaceMesh::FaceMesh(_In_ ID3D11Device *device, const MeshData& mesh)
+{
+    CreateBuffers(device, mesh);
 }
@@ -18,6 +18,7 @@
 // 1 unit in the +Y direction.
 // The face is defined to be two sided, so it is visible from either
 // side.
+// The second constructor takes a mesh already generated, e.g. by a MeshCache.
 
 #include "MeshObject.h"
 
@@ -25,4 +26,5 @@ ref class FaceMesh: public MeshObject
 {
 internal:
     FaceMesh(_In_ ID3D11Device *device);
+    FaceMesh(_In_ ID3D11Device *device, const MeshData& mesh);
 };
@@ -0,0 +1,256 @@
+//********************************************************* 
+// 
+// Copyright (c) Microsoft. All rights reserved. 
+// This code is licensed under the MIT License (MIT). 
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF 
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY 
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR 
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT. 
+// 
+//*********************************************************
+
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "FrameTimings.h"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace
+{
+    const uint32_t PhaseCount = static_cast<uint32_t>(FramePhase::Count);
+}
+
+//----------------------------------------------------------------------
+
+FrameTimings::FrameTimings()
+{
+    Reset();
+}
+
+//----------------------------------------------------------------------
+
+void FrameTimings::BeginFrame()
+{
+    double now = Now();
+    if (m_frameCount > 0)
+    {
+        FrameRecord& previous = Slot(m_frameCount - 1);
+        previous.phaseDuration[static_cast<uint32_t>(FramePhase::Frame)] =
+            now - previous.phaseStart[static_cast<uint32_t>(FramePhase::Frame)];
+    }
+
+    FrameRecord& record = Slot(m_frameCount);
+    record = FrameRecord();
+    record.frame = m_frameCount;
+    record.phaseStart[static_cast<uint32_t>(FramePhase::Frame)] = now;
+    m_frameCount++;
+}
+
+//----------------------------------------------------------------------
+
+void FrameTimings::AddPhase(FramePhase phase, double start, double duration)
+{
+    if (m_frameCount == 0 || phase == FramePhase::Frame || phase >= FramePhase::Count)
+    {
+        return;
+    }
+
+    FrameRecord& record = Slot(m_frameCount - 1);
+    uint32_t index = static_cast<uint32_t>(phase);
+    if (record.phaseDuration[index] == 0.0)
+    {
+        record.phaseStart[index] = start;
+    }
+
+    record.phaseDuration[index] += duration;
+}
+
+//----------------------------------------------------------------------
+
+void FrameTimings::AddPhysicsSteps(uint32_t steps)
+{
+    if (m_frameCount > 0)
+    {
+        Slot(m_frameCount - 1).physicsSteps += steps;
+    }
+}
+
+//----------------------------------------------------------------------
+
+double FrameTimings::Now() const
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_epoch).count();
+}
+
+//----------------------------------------------------------------------
+
+void FrameTimings::Reset()
+{
+    m_epoch = std::chrono::steady_clock::now();
+    m_frameCount = 0;
+}
+
+//----------------------------------------------------------------------
+
+uint32_t FrameTimings::FrameCount() const
+{
+    // The slot of the frame being recorded is not part of the history.
+    if (m_frameCount == 0)
+    {
+        return 0;
+    }
+
+    return static_cast<uint32_t>((std::min)(m_frameCount - 1, static_cast<uint64_t>(HistoryLength - 1)));
+}
+
+//----------------------------------------------------------------------
+
+const FrameRecord& FrameTimings::Frame(uint32_t index) const
+{
+    return Slot(m_frameCount - 1 - FrameCount() + index);
+}
+
+//----------------------------------------------------------------------
+
+double FrameTimings::Percentile(FramePhase phase, double percentile) const
+{
+    uint32_t count = FrameCount();
+    if (count == 0 || phase >= FramePhase::Count)
+    {
+        return 0.0;
+    }
+
+    double values[HistoryLength];
+    for (uint32_t i = 0; i < count; i++)
+    {
+        values[i] = Frame(i).phaseDuration[static_cast<uint32_t>(phase)];
+    }
+
+    // Rank of the sample at the requested percentile, rounded up so that 100 selects the largest.
+    double clamped = (percentile < 0.0) ? 0.0 : (percentile > 100.0) ? 100.0 : percentile;
+    uint32_t rank = static_cast<uint32_t>(clamped / 100.0 * count + 0.999999);
+    rank = (std::max)(1u, (std::min)(rank, count));
+
+    std::nth_element(values, values + rank - 1, values + count);
+    return values[rank - 1];
+}
+
+//----------------------------------------------------------------------
+
+double FrameTimings::AveragePhysicsSteps() const
+{
+    uint32_t count = FrameCount();
+    if (count == 0)
+    {
+        return 0.0;
+    }
+
+    uint64_t steps = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        steps += Frame(i).physicsSteps;
+    }
+
+    return static_cast<double>(steps) / count;
+}
+
+//----------------------------------------------------------------------
+
+void FrameTimings::WriteCsv(std::ostream& stream) const
+{
+    stream << "frame,physicsSteps";
+    for (uint32_t phase = 0; phase < PhaseCount; phase++)
+    {
+        stream << ',' << PhaseName(static_cast<FramePhase>(phase)) << "Ms";
+    }
+
+    stream << '\n' << std::fixed << std::setprecision(3);
+
+    uint32_t count = FrameCount();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const FrameRecord& record = Frame(i);
+        stream << record.frame << ',' << record.physicsSteps;
+        for (uint32_t phase = 0; phase < PhaseCount; phase++)
+        {
+            stream << ',' << record.phaseDuration[phase];
+        }
+
+        stream << '\n';
+    }
+}
+
+//----------------------------------------------------------------------
+
+void FrameTimings::WriteTrace(std::ostream& stream) const
+{
+    // Complete ("X") events with timestamps in microseconds.  Phases that did not run in a
+    // frame are left out.
+    stream << "{\"traceEvents\":[" << std::fixed << std::setprecision(1);
+
+    bool first = true;
+    uint32_t count = FrameCount();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const FrameRecord& record = Frame(i);
+        for (uint32_t phase = 0; phase < PhaseCount; phase++)
+        {
+            if (record.phaseDuration[phase] <= 0.0)
+            {
+                continue;
+            }
+
+            stream << (first ? "\n" : ",\n");
+            stream << "{\"name\":\"" << PhaseName(static_cast<FramePhase>(phase)) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+                << ",\"ts\":" << record.phaseStart[phase] * 1000.0
+                << ",\"dur\":" << record.phaseDuration[phase] * 1000.0;
+            if (phase == static_cast<uint32_t>(FramePhase::Frame))
+            {
+                stream << ",\"args\":{\"frame\":" << record.frame << ",\"physicsSteps\":" << record.physicsSteps << '}';
+            }
+
+            stream << '}';
+            first = false;
+        }
+    }
+
+    stream << "\n]}\n";
+}
+
+//----------------------------------------------------------------------
+
+const char* FrameTimings::PhaseName(FramePhase phase)
+{
+    switch (phase)
+    {
+    case FramePhase::Frame:
+        return "Frame";
+    case FramePhase::Update:
+        return "Update";
+    case FramePhase::Dynamics:
+        return "Dynamics";
+    case FramePhase::Render:
+        return "Render";
+    case FramePhase::Hud:
+        return "Hud";
+    case FramePhase::Present:
+        return "Present";
+    default:
+        return "Unknown";
+    }
+}
+
+//----------------------------------------------------------------------
+
+const FrameRecord& FrameTimings::Slot(uint64_t frame) const
+{
+    return m_history[frame % HistoryLength];
+}
+
+//----------------------------------------------------------------------
+
+FrameRecord& FrameTimings::Slot(uint64_t frame)
+{
+    return m_history[frame % HistoryLength];
+}
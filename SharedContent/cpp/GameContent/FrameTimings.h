@@ -0,0 +1,122 @@
+//********************************************************* 
+// 
+// Copyright (c) Microsoft. All rights reserved. 
+// This code is licensed under the MIT License (MIT). 
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF 
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY 
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR 
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT. 
+// 
+//*********************************************************
+
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+// Phases of one pass through the game loop.  Phases can nest: Update includes Dynamics and
+// Render includes Hud.  Frame is the time from the start of one frame to the start of the next.
+enum class FramePhase : uint32_t
+{
+    Frame,
+    Update,
+    Dynamics,
+    Render,
+    Hud,
+    Present,
+    Count
+};
+
+struct FrameRecord
+{
+    uint64_t    frame;
+    uint32_t    physicsSteps;                                       // Sub-steps taken by UpdateDynamics.
+    double      phaseStart[static_cast<uint32_t>(FramePhase::Count)];     // Milliseconds since the first frame.
+    double      phaseDuration[static_cast<uint32_t>(FramePhase::Count)];  // Milliseconds; summed if a phase runs more than once.
+};
+
+// FrameTimings:
+// Records how long each phase of the game loop takes, for the last HistoryLength frames.
+// Percentiles are computed over the frames in the history when asked for, so recording
+// only costs a clock read at the start and end of each phase.
+// All methods must be called from the game loop thread.
+
+class FrameTimings
+{
+public:
+    static const uint32_t HistoryLength = 256;
+
+    FrameTimings();
+
+    // Completes the previous frame and starts recording a new one.
+    void BeginFrame();
+
+    void AddPhase(FramePhase phase, double start, double duration);
+    void AddPhysicsSteps(uint32_t steps);
+
+    // Milliseconds since the first frame.
+    double Now() const;
+
+    void Reset();
+
+    // Number of completed frames in the history; the frame being recorded is not included.
+    uint32_t FrameCount() const;
+
+    // Completed frames, oldest first.
+    const FrameRecord& Frame(uint32_t index) const;
+
+    // Returns the duration in milliseconds below which the given percentage (0 to 100) of the
+    // completed frames in the history spent in the phase, or 0 if there are none.
+    double Percentile(FramePhase phase, double percentile) const;
+    double AveragePhysicsSteps() const;
+
+    // One line per completed frame with the duration of every phase.
+    void WriteCsv(std::ostream& stream) const;
+
+    // The completed frames as Chrome trace events (chrome://tracing, Windows Performance Analyzer
+    // and similar tools read this format).
+    void WriteTrace(std::ostream& stream) const;
+
+    static const char* PhaseName(FramePhase phase);
+
+private:
+    const FrameRecord& Slot(uint64_t frame) const;
+    FrameRecord& Slot(uint64_t frame);
+
+    std::chrono::steady_clock::time_point       m_epoch;
+    FrameRecord                                 m_history[HistoryLength];
+    uint64_t                                    m_frameCount;   // Frames begun since Reset.
+};
+
+// ScopedFrameTimer:
+// Adds the time between its construction and destruction to a phase of the current frame.
+// Does nothing if timings is null.
+
+class ScopedFrameTimer
+{
+public:
+    ScopedFrameTimer(FrameTimings* timings, FramePhase phase) :
+        m_timings(timings),
+        m_phase(phase),
+        m_start((timings != nullptr) ? timings->Now() : 0.0)
+    {
+    }
+
+    ~ScopedFrameTimer()
+    {
+        if (m_timings != nullptr)
+        {
+            m_timings->AddPhase(m_phase, m_start, m_timings->Now() - m_start);
+        }
+    }
+
+    ScopedFrameTimer(const ScopedFrameTimer&) = delete;
+    ScopedFrameTimer& operator=(const ScopedFrameTimer&) = delete;
+
+private:
+    FrameTimings*   m_timings;
+    FramePhase      m_phase;
+    double          m_start;
+};
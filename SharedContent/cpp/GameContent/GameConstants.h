@@ -19,9 +19,7 @@ namespace GameConstants
     static const float AmmoSize                 = 0.2f;
     static const float AmmoRadius               = AmmoSize * 0.5f;
     static const int MaxBackgroundTextures      = 3;
-
-    static const int InitialLoadingDelay        = 2000;     // Number of ms to wait before completion of initial load.
-    static const int LevelLoadingDelay          = 500;      // Number of ms to wait before completion of level load.
+    static const int MeshSegments               = 26;
 
     static const int WorldFloorId               = 80001;
     static const int WorldCeilingId             = 80002;
@@ -45,5 +43,7 @@ namespace GameConstants
         static const float MaxVelocity          = 10.0f;    // The velocity at which the bouncing sound is played at maximum volume.
         static const float MinVelocity          = 0.05f;    // The minimum contact velocity required to make a sound.
         static const float MinAdjustment        = 0.2f;     // The minimum volume adjustment based on contact velocity.
+        static const int MaxVoices              = 8;        // Impact sounds that can play at the same time.
+        static const float MaxDistance          = 20.0f;    // Impacts farther than this from the player are not played.
     }
 };
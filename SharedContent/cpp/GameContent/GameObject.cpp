@@ -14,8 +14,12 @@
 #include "ConstantBuffers.h"
 #include "GameConstants.h"
 
+#include <atomic>
+
 using namespace DirectX;
 
+static std::atomic<uint32> s_nextSoundSource(1);
+
 //--------------------------------------------------------------------------------
 
 GameObject::GameObject() :
@@ -36,6 +40,7 @@ GameObject::GameObject() :
     XMStoreFloat4x4(&m_modelMatrix, XMMatrixIdentity());
 
     m_hitTime         = 0.0f;
+    m_soundSource     = s_nextSoundSource++;
 
     m_animatePosition = nullptr;
 }
@@ -59,14 +64,7 @@ void GameObject::Render(
         XMMatrixTranspose(ModelMatrix())
         );
 
-    if (m_hit && m_hitMaterial != nullptr)
-    {
-        m_hitMaterial->RenderSetup(context, &constantBuffer);
-    }
-    else
-    {
-        m_normalMaterial->RenderSetup(context, &constantBuffer);
-    }
+    CurrentMaterial()->RenderSetup(context, &constantBuffer);
     context->UpdateSubresource(primitiveConstantBuffer, 0, nullptr, &constantBuffer, 0, 0);
 
     m_mesh->Render(context);
@@ -99,7 +97,7 @@ void GameObject::PlaySound(float impactSpeed, XMFLOAT3 eyePoint)
         // Sound is proportional to how hard the ball is hitting.
         volume = adjustment * volume;
 
-        m_hitSound->PlaySound(volume);
+        m_hitSound->PlaySound(volume, impactSpeed, distToPositionSquared, m_soundSource);
     }
 }
 
@@ -71,12 +71,16 @@ internal:
     void PlaySound(float impactSpeed, DirectX::XMFLOAT3 eyePoint);
 
     void Mesh(_In_ MeshObject^ mesh);
+    MeshObject^ Mesh();
 
     void NormalMaterial(_In_ Material^ material);
     Material^ NormalMaterial();
     void HitMaterial(_In_ Material^ material);
     Material^ HitMaterial();
 
+    // The material Render uses for the object's current hit state.
+    Material^ CurrentMaterial();
+
     void Position(DirectX::XMFLOAT3 position);
     void Position(DirectX::XMVECTOR position);
     void Velocity(DirectX::XMFLOAT3 velocity);
@@ -113,6 +117,7 @@ protected private:
     MeshObject^         m_mesh;
 
     SoundEffect^        m_hitSound;
+    uint32              m_soundSource;      // Unique per object, see SoundEffect::PlaySound.
 };
 
 
@@ -257,6 +262,16 @@ __forceinline void GameObject::Mesh(_In_ MeshObject^ mesh)
     m_mesh = mesh;
 }
 
+__forceinline MeshObject^ GameObject::Mesh()
+{
+    return m_mesh;
+}
+
+__forceinline Material^ GameObject::CurrentMaterial()
+{
+    return (m_hit && m_hitMaterial != nullptr) ? m_hitMaterial : m_normalMaterial;
+}
+
 __forceinline void GameObject::HitSound(_In_ SoundEffect^ hitSound)
 {
     m_hitSound = hitSound;
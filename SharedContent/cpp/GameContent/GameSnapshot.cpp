@@ -0,0 +1,400 @@
+//********************************************************* 
+// 
+// Copyright (c) Microsoft. All rights reserved. 
+// This code is licensed under the MIT License (MIT). 
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF 
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY 
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR 
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT. 
+// 
+//*********************************************************
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "GameSnapshot.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    // The format is little endian, which is the byte order of every platform the game runs on,
+    // so the packed arrays are copied directly.
+
+    void WriteUInt16(std::vector<uint8_t>& output, uint16_t value)
+    {
+        output.push_back(static_cast<uint8_t>(value));
+        output.push_back(static_cast<uint8_t>(value >> 8));
+    }
+
+    void WriteUInt32(std::vector<uint8_t>& output, uint32_t value)
+    {
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            output.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    }
+
+    void WriteFloat(std::vector<uint8_t>& output, float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        WriteUInt32(output, bits);
+    }
+
+    template <typename T>
+    void WriteArray(std::vector<uint8_t>& output, const std::vector<T>& values)
+    {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(values.data());
+        output.insert(output.end(), bytes, bytes + values.size() * sizeof(T));
+    }
+
+    void WriteEntities(std::vector<uint8_t>& output, const GameSnapshotEntities& entities)
+    {
+        WriteUInt32(output, static_cast<uint32_t>(entities.Count()));
+        output.push_back(entities.HasVelocities() ? 1 : 0);
+        WriteArray(output, entities.positions);
+        WriteArray(output, entities.velocities);
+        WriteArray(output, entities.flags);
+    }
+
+    uint16_t LoadUInt16(const uint8_t* data)
+    {
+        return static_cast<uint16_t>(data[0] | (data[1] << 8));
+    }
+
+    uint32_t LoadUInt32(const uint8_t* data)
+    {
+        return
+            static_cast<uint32_t>(data[0]) |
+            (static_cast<uint32_t>(data[1]) << 8) |
+            (static_cast<uint32_t>(data[2]) << 16) |
+            (static_cast<uint32_t>(data[3]) << 24);
+    }
+
+    // Sequential reader over the payload.  Every read checks the remaining size, so a
+    // payload that passed the checksum but is inconsistent cannot read out of bounds.
+    class PayloadReader
+    {
+    public:
+        PayloadReader(const uint8_t* data, size_t size) :
+            m_data(data),
+            m_remaining(size)
+        {
+        }
+
+        bool ReadUInt32(uint32_t* value)
+        {
+            if (m_remaining < 4)
+            {
+                return false;
+            }
+            *value = LoadUInt32(m_data);
+            Skip(4);
+            return true;
+        }
+
+        bool ReadFloat(float* value)
+        {
+            uint32_t bits;
+            if (!ReadUInt32(&bits))
+            {
+                return false;
+            }
+            memcpy(value, &bits, sizeof(bits));
+            return true;
+        }
+
+        template <typename T>
+        bool ReadArray(std::vector<T>& values, size_t count)
+        {
+            if (count > m_remaining / sizeof(T))
+            {
+                return false;
+            }
+            values.resize(count);
+            if (count > 0)
+            {
+                memcpy(values.data(), m_data, count * sizeof(T));
+                Skip(count * sizeof(T));
+            }
+            return true;
+        }
+
+        bool ReadEntities(GameSnapshotEntities& entities)
+        {
+            uint32_t count;
+            if (!ReadUInt32(&count) || m_remaining < 1)
+            {
+                return false;
+            }
+
+            bool hasVelocities = m_data[0] != 0;
+            Skip(1);
+
+            return
+                ReadArray(entities.positions, static_cast<size_t>(count) * 3) &&
+                ReadArray(entities.velocities, hasVelocities ? static_cast<size_t>(count) * 3 : 0) &&
+                ReadArray(entities.flags, count);
+        }
+
+        bool AtEnd() const { return m_remaining == 0; }
+
+    private:
+        void Skip(size_t size)
+        {
+            m_data += size;
+            m_remaining -= size;
+        }
+
+        const uint8_t*  m_data;
+        size_t          m_remaining;
+    };
+
+    // CRC-32 (IEEE 802.3) lookup table.
+    struct Crc32Table
+    {
+        Crc32Table()
+        {
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                uint32_t value = i;
+                for (int bit = 0; bit < 8; bit++)
+                {
+                    value = (value & 1) ? (0xEDB88320 ^ (value >> 1)) : (value >> 1);
+                }
+                values[i] = value;
+            }
+        }
+
+        uint32_t values[256];
+    };
+}
+
+//--------------------------------------------------------------------------------
+
+void GameSnapshotEntities::Resize(size_t count, bool withVelocities)
+{
+    positions.assign(count * 3, 0.0f);
+    velocities.assign(withVelocities ? count * 3 : 0, 0.0f);
+    flags.assign(count, 0);
+}
+
+//--------------------------------------------------------------------------------
+
+void GameSnapshotEntities::Set(size_t index, const float position[3], const float velocity[3], uint8_t entityFlags)
+{
+    std::copy(position, position + 3, &positions[index * 3]);
+    if (HasVelocities())
+    {
+        std::copy(velocity, velocity + 3, &velocities[index * 3]);
+    }
+    flags[index] = entityFlags;
+}
+
+//--------------------------------------------------------------------------------
+
+void GameSnapshotCodec::Encode(const GameSnapshot& snapshot, bool compress, std::vector<uint8_t>& blob)
+{
+    std::vector<uint8_t> payload;
+    payload.reserve(
+        12 + 10 +
+        (snapshot.ammo.positions.size() + snapshot.ammo.velocities.size() + snapshot.objects.positions.size() +
+        snapshot.objects.velocities.size()) * sizeof(float) + snapshot.ammo.Count() + snapshot.objects.Count()
+        );
+
+    WriteUInt32(payload, snapshot.ammoNext);
+    WriteFloat(payload, snapshot.levelDuration);
+    WriteFloat(payload, snapshot.levelPlayingTime);
+    WriteEntities(payload, snapshot.ammo);
+    WriteEntities(payload, snapshot.objects);
+
+    uint16_t flags = 0;
+    std::vector<uint8_t> compressed;
+    if (compress)
+    {
+        Compress(payload.data(), payload.size(), compressed);
+        if (compressed.size() < payload.size())
+        {
+            flags |= FlagRunLength;
+        }
+    }
+
+    const std::vector<uint8_t>& stored = (flags & FlagRunLength) ? compressed : payload;
+
+    blob.clear();
+    blob.reserve(HeaderSize + stored.size());
+    WriteUInt32(blob, Magic);
+    WriteUInt16(blob, Version);
+    WriteUInt16(blob, flags);
+    WriteUInt32(blob, static_cast<uint32_t>(payload.size()));
+    WriteUInt32(blob, static_cast<uint32_t>(stored.size()));
+    WriteUInt32(blob, Crc32(stored.data(), stored.size(), Crc32(blob.data(), blob.size())));
+    blob.insert(blob.end(), stored.begin(), stored.end());
+}
+
+//--------------------------------------------------------------------------------
+
+GameSnapshotResult GameSnapshotCodec::Decode(const uint8_t* data, size_t size, GameSnapshot& snapshot)
+{
+    if (size < HeaderSize)
+    {
+        return GameSnapshotResult::Truncated;
+    }
+
+    if (LoadUInt32(data) != Magic)
+    {
+        return GameSnapshotResult::BadMagic;
+    }
+
+    if (LoadUInt16(data + 4) > Version)
+    {
+        return GameSnapshotResult::UnsupportedVersion;
+    }
+
+    uint16_t flags = LoadUInt16(data + 6);
+    size_t decodedSize = LoadUInt32(data + 8);
+    size_t storedSize = LoadUInt32(data + 12);
+    uint32_t crc = LoadUInt32(data + 16);
+
+    if (storedSize > size - HeaderSize)
+    {
+        return GameSnapshotResult::Truncated;
+    }
+
+    // The checksum covers the header fields before it as well as the stored bytes.
+    const uint8_t* stored = data + HeaderSize;
+    if (Crc32(stored, storedSize, Crc32(data, HeaderSize - 4)) != crc)
+    {
+        return GameSnapshotResult::BadChecksum;
+    }
+
+    std::vector<uint8_t> decompressed;
+    const uint8_t* payload = stored;
+    size_t payloadSize = storedSize;
+    if (flags & FlagRunLength)
+    {
+        // Check the decoded size before Decompress reserves room for it.
+        if (decodedSize > static_cast<uint64_t>(storedSize) * MaxRunLengthExpansion)
+        {
+            return GameSnapshotResult::Corrupt;
+        }
+        if (!Decompress(stored, storedSize, decodedSize, decompressed))
+        {
+            return GameSnapshotResult::Corrupt;
+        }
+        payload = decompressed.data();
+        payloadSize = decompressed.size();
+    }
+    else if (decodedSize != storedSize)
+    {
+        return GameSnapshotResult::Corrupt;
+    }
+
+    PayloadReader reader(payload, payloadSize);
+    bool valid =
+        reader.ReadUInt32(&snapshot.ammoNext) &&
+        reader.ReadFloat(&snapshot.levelDuration) &&
+        reader.ReadFloat(&snapshot.levelPlayingTime) &&
+        reader.ReadEntities(snapshot.ammo) &&
+        reader.ReadEntities(snapshot.objects) &&
+        reader.AtEnd();
+
+    return valid ? GameSnapshotResult::Success : GameSnapshotResult::Corrupt;
+}
+
+//--------------------------------------------------------------------------------
+
+uint32_t GameSnapshotCodec::Crc32(const uint8_t* data, size_t size, uint32_t crc)
+{
+    static const Crc32Table table;
+
+    crc ^= 0xFFFFFFFF;
+    for (size_t i = 0; i < size; i++)
+    {
+        crc = table.values[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFF;
+}
+
+//--------------------------------------------------------------------------------
+
+void GameSnapshotCodec::Compress(const uint8_t* data, size_t size, std::vector<uint8_t>& output)
+{
+    // Each block starts with a control byte.  Values below 128 are followed by that many
+    // plus one literal bytes; values of 128 and above are followed by one byte that is
+    // repeated (control - 125) times, so runs are 3 to 130 bytes long.
+    output.clear();
+    output.reserve(size + size / 128 + 1);
+
+    size_t literalStart = 0;
+    size_t i = 0;
+    auto flushLiterals = [&](size_t end)
+    {
+        while (literalStart < end)
+        {
+            size_t count = (std::min)(end - literalStart, static_cast<size_t>(128));
+            output.push_back(static_cast<uint8_t>(count - 1));
+            output.insert(output.end(), data + literalStart, data + literalStart + count);
+            literalStart += count;
+        }
+    };
+
+    while (i < size)
+    {
+        size_t run = 1;
+        while (i + run < size && run < 130 && data[i + run] == data[i])
+        {
+            run++;
+        }
+
+        if (run >= 3)
+        {
+            flushLiterals(i);
+            output.push_back(static_cast<uint8_t>(run + 125));
+            output.push_back(data[i]);
+            i += run;
+            literalStart = i;
+        }
+        else
+        {
+            i += run;
+        }
+    }
+
+    flushLiterals(size);
+}
+
+//--------------------------------------------------------------------------------
+
+bool GameSnapshotCodec::Decompress(const uint8_t* data, size_t size, size_t decodedSize, std::vector<uint8_t>& output)
+{
+    output.clear();
+    output.reserve(decodedSize);
+
+    size_t i = 0;
+    while (i < size)
+    {
+        uint8_t control = data[i++];
+        if (control < 128)
+        {
+            size_t count = static_cast<size_t>(control) + 1;
+            if (count > size - i || output.size() + count > decodedSize)
+            {
+                return false;
+            }
+            output.insert(output.end(), data + i, data + i + count);
+            i += count;
+        }
+        else
+        {
+            size_t count = static_cast<size_t>(control) - 125;
+            if (i >= size || output.size() + count > decodedSize)
+            {
+                return false;
+            }
+            output.insert(output.end(), count, data[i++]);
+        }
+    }
+
+    return output.size() == decodedSize;
+}
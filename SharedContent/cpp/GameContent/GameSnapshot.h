@@ -0,0 +1,96 @@
+//********************************************************* 
+// 
+// Copyright (c) Microsoft. All rights reserved. 
+// This code is licensed under the MIT License (MIT). 
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF 
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY 
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR 
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT. 
+// 
+//*********************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Bits stored per entity in GameSnapshotEntities::flags.
+namespace GameSnapshotFlags
+{
+    const uint8_t Active   = 0x01;
+    const uint8_t Target   = 0x02;
+    const uint8_t OnGround = 0x04;
+}
+
+// Packed per-entity state: three floats per position and velocity, one byte of flags.
+// Velocities are optional and are not stored when the array is empty.
+struct GameSnapshotEntities
+{
+    std::vector<float>      positions;
+    std::vector<float>      velocities;
+    std::vector<uint8_t>    flags;
+
+    void Resize(size_t count, bool withVelocities);
+    size_t Count() const { return flags.size(); }
+    bool HasVelocities() const { return !velocities.empty(); }
+
+    void Set(size_t index, const float position[3], const float velocity[3], uint8_t entityFlags);
+    const float* Position(size_t index) const { return &positions[index * 3]; }
+    const float* Velocity(size_t index) const { return &velocities[index * 3]; }
+};
+
+// The in-level state of Simple3DGame that is saved on suspend.
+struct GameSnapshot
+{
+    uint32_t                ammoNext;
+    float                   levelDuration;
+    float                   levelPlayingTime;
+    GameSnapshotEntities    ammo;
+    GameSnapshotEntities    objects;
+};
+
+enum class GameSnapshotResult
+{
+    Success,
+    Truncated,              // The blob is shorter than its header says.
+    BadMagic,               // Not a snapshot.
+    UnsupportedVersion,     // Written by a newer build.
+    BadChecksum,
+    Corrupt                 // The checksum matched but the contents are inconsistent.
+};
+
+// GameSnapshotCodec:
+// Converts a GameSnapshot to and from a single versioned binary blob, so suspend writes
+// one value instead of one PersistentState entry per field.
+//
+// The blob is a 20 byte header (magic, version, flags, decoded size, stored size and a
+// CRC-32 of the rest of the header and the stored bytes) followed by the payload: the scalar fields and then, per
+// entity group, the count followed by the packed position, velocity and flag arrays.
+// When requested, the payload is run length encoded if that makes it smaller; flags
+// and the velocities of resting objects compress well.  Values are little endian.
+//
+// Decode validates the header and checksum, and the decoded size against the most that
+// the stored bytes can expand to, and then reads the payload into the
+// snapshot arrays in a single pass.  This file only depends on the C++ standard library.
+
+class GameSnapshotCodec
+{
+public:
+    static const uint32_t Magic = 0x53334453;       // "SD3S" in memory.
+    static const uint16_t Version = 2;
+    static const size_t HeaderSize = 20;
+
+    static void Encode(const GameSnapshot& snapshot, bool compress, std::vector<uint8_t>& blob);
+    static GameSnapshotResult Decode(const uint8_t* data, size_t size, GameSnapshot& snapshot);
+
+    // Pass the result of an earlier call as crc to continue its checksum.
+    static uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc = 0);
+
+private:
+    static const uint16_t FlagRunLength = 0x0001;
+    static const size_t MaxRunLengthExpansion = 65;     // A 2 byte run decodes to 130 bytes.
+
+    static void Compress(const uint8_t* data, size_t size, std::vector<uint8_t>& output);
+    static bool Decompress(const uint8_t* data, size_t size, size_t decodedSize, std::vector<uint8_t>& output);
+};
@@ -0,0 +1,329 @@
+//********************************************************* 
+// 
+// Copyright (c) Microsoft. All rights reserved. 
+// This code is licensed under the MIT License (MIT). 
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF 
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY 
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR 
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT. 
+// 
+//*********************************************************
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "InputEventQueue.h"
+
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+    const size_t HeaderSize = 16;
+    const size_t EventSize = 40;
+
+    void StoreUInt32(uint8_t* data, uint32_t value)
+    {
+        data[0] = static_cast<uint8_t>(value);
+        data[1] = static_cast<uint8_t>(value >> 8);
+        data[2] = static_cast<uint8_t>(value >> 16);
+        data[3] = static_cast<uint8_t>(value >> 24);
+    }
+
+    uint32_t LoadUInt32(const uint8_t* data)
+    {
+        return
+            static_cast<uint32_t>(data[0]) |
+            (static_cast<uint32_t>(data[1]) << 8) |
+            (static_cast<uint32_t>(data[2]) << 16) |
+            (static_cast<uint32_t>(data[3]) << 24);
+    }
+
+    void StoreFloat(uint8_t* data, float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        StoreUInt32(data, bits);
+    }
+
+    float LoadFloat(const uint8_t* data)
+    {
+        uint32_t bits = LoadUInt32(data);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    void StoreEvent(uint8_t* data, const InputEvent& inputEvent)
+    {
+        StoreUInt32(data, static_cast<uint32_t>(inputEvent.timestamp));
+        StoreUInt32(data + 4, static_cast<uint32_t>(inputEvent.timestamp >> 32));
+        StoreUInt32(data + 8, static_cast<uint32_t>(inputEvent.type));
+        StoreUInt32(data + 12, inputEvent.id);
+        StoreUInt32(data + 16, inputEvent.flags);
+        StoreFloat(data + 20, inputEvent.x);
+        StoreFloat(data + 24, inputEvent.y);
+        StoreFloat(data + 28, inputEvent.z);
+        StoreFloat(data + 32, inputEvent.w);
+        StoreFloat(data + 36, inputEvent.trigger);
+    }
+
+    bool LoadEvent(const uint8_t* data, InputEvent& inputEvent)
+    {
+        uint32_t type = LoadUInt32(data + 8);
+        if (type > static_cast<uint32_t>(InputEventType::Gamepad))
+        {
+            return false;
+        }
+
+        inputEvent.timestamp = static_cast<uint64_t>(LoadUInt32(data)) | (static_cast<uint64_t>(LoadUInt32(data + 4)) << 32);
+        inputEvent.type = static_cast<InputEventType>(type);
+        inputEvent.id = LoadUInt32(data + 12);
+        inputEvent.flags = LoadUInt32(data + 16);
+        inputEvent.x = LoadFloat(data + 20);
+        inputEvent.y = LoadFloat(data + 24);
+        inputEvent.z = LoadFloat(data + 28);
+        inputEvent.w = LoadFloat(data + 32);
+        inputEvent.trigger = LoadFloat(data + 36);
+        return true;
+    }
+
+    bool IsPointerEvent(InputEventType type)
+    {
+        return
+            type == InputEventType::PointerPressed ||
+            type == InputEventType::PointerMoved ||
+            type == InputEventType::PointerReleased ||
+            type == InputEventType::PointerExited;
+    }
+}
+
+//----------------------------------------------------------------------
+
+InputEventQueue::InputEventQueue() :
+    m_head(0),
+    m_tail(0),
+    m_dropped(0)
+{
+}
+
+//----------------------------------------------------------------------
+
+bool InputEventQueue::Push(const InputEvent& inputEvent)
+{
+    uint32_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_head.load(std::memory_order_acquire) >= Capacity)
+    {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    m_events[tail % Capacity] = inputEvent;
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+//----------------------------------------------------------------------
+
+void InputEventQueue::Drain(std::vector<InputEvent>& events)
+{
+    uint32_t head = m_head.load(std::memory_order_relaxed);
+    uint32_t tail = m_tail.load(std::memory_order_acquire);
+    for (; head != tail; head++)
+    {
+        events.push_back(m_events[head % Capacity]);
+    }
+
+    m_head.store(head, std::memory_order_release);
+}
+
+//----------------------------------------------------------------------
+
+void InputEventQueue::Clear()
+{
+    m_head.store(m_tail.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+//----------------------------------------------------------------------
+
+uint64_t InputEventQueue::DroppedCount() const
+{
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------
+
+uint64_t InputEventQueue::Now()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+//----------------------------------------------------------------------
+
+void InputEventQueue::Coalesce(std::vector<InputEvent>& events)
+{
+    // Walk backwards so each event can see whether a later one supersedes it.  A frame
+    // only holds a few pointers, so the pending moves are kept in a small vector.
+    std::vector<uint32_t> movedLater;
+    size_t laterMouseDelta = events.size();
+    std::vector<bool> keep(events.size(), true);
+
+    for (size_t i = events.size(); i-- > 0;)
+    {
+        InputEvent& inputEvent = events[i];
+        if (inputEvent.type == InputEventType::MouseDelta)
+        {
+            if (laterMouseDelta != events.size())
+            {
+                // Fold into the later delta, which keeps the later timestamp.
+                events[laterMouseDelta].x += inputEvent.x;
+                events[laterMouseDelta].y += inputEvent.y;
+                keep[i] = false;
+            }
+            else
+            {
+                laterMouseDelta = i;
+            }
+        }
+        else if (IsPointerEvent(inputEvent.type))
+        {
+            auto found = movedLater.begin();
+            while (found != movedLater.end() && *found != inputEvent.id)
+            {
+                ++found;
+            }
+
+            if (inputEvent.type == InputEventType::PointerMoved)
+            {
+                if (found != movedLater.end())
+                {
+                    keep[i] = false;
+                }
+                else
+                {
+                    movedLater.push_back(inputEvent.id);
+                }
+            }
+            else if (found != movedLater.end())
+            {
+                movedLater.erase(found);
+            }
+        }
+    }
+
+    size_t count = 0;
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        if (keep[i])
+        {
+            events[count++] = events[i];
+        }
+    }
+
+    events.resize(count);
+}
+
+//----------------------------------------------------------------------
+
+void InputRecording::Clear()
+{
+    m_events.clear();
+    m_frameStart.clear();
+}
+
+//----------------------------------------------------------------------
+
+void InputRecording::AddFrame(const std::vector<InputEvent>& events)
+{
+    m_frameStart.push_back(m_events.size());
+    m_events.insert(m_events.end(), events.begin(), events.end());
+}
+
+//----------------------------------------------------------------------
+
+bool InputRecording::GetFrame(uint32_t frame, std::vector<InputEvent>& events) const
+{
+    if (frame >= m_frameStart.size())
+    {
+        return false;
+    }
+
+    size_t end = (frame + 1 < m_frameStart.size()) ? m_frameStart[frame + 1] : m_events.size();
+    events.insert(events.end(), m_events.begin() + m_frameStart[frame], m_events.begin() + end);
+    return true;
+}
+
+//----------------------------------------------------------------------
+
+void InputRecording::Save(std::vector<uint8_t>& data) const
+{
+    data.resize(HeaderSize + m_frameStart.size() * 4 + m_events.size() * EventSize);
+    uint8_t* out = data.data();
+
+    StoreUInt32(out, Magic);
+    StoreUInt32(out + 4, Version);
+    StoreUInt32(out + 8, FrameCount());
+    StoreUInt32(out + 12, static_cast<uint32_t>(m_events.size()));
+    out += HeaderSize;
+
+    for (size_t frame = 0; frame < m_frameStart.size(); frame++)
+    {
+        size_t end = (frame + 1 < m_frameStart.size()) ? m_frameStart[frame + 1] : m_events.size();
+        StoreUInt32(out, static_cast<uint32_t>(end - m_frameStart[frame]));
+        out += 4;
+    }
+
+    for (const auto& inputEvent : m_events)
+    {
+        StoreEvent(out, inputEvent);
+        out += EventSize;
+    }
+}
+
+//----------------------------------------------------------------------
+
+bool InputRecording::Load(const uint8_t* data, size_t size)
+{
+    Clear();
+    if (size < HeaderSize || LoadUInt32(data) != Magic || LoadUInt32(data + 4) > Version)
+    {
+        return false;
+    }
+
+    size_t frameCount = LoadUInt32(data + 8);
+    size_t eventCount = LoadUInt32(data + 12);
+    if ((size - HeaderSize) / 4 < frameCount ||
+        (size - HeaderSize - frameCount * 4) / EventSize != eventCount ||
+        (size - HeaderSize - frameCount * 4) % EventSize != 0)
+    {
+        return false;
+    }
+
+    const uint8_t* counts = data + HeaderSize;
+    const uint8_t* events = counts + frameCount * 4;
+
+    m_frameStart.reserve(frameCount);
+    size_t total = 0;
+    for (size_t frame = 0; frame < frameCount; frame++)
+    {
+        m_frameStart.push_back(total);
+        total += LoadUInt32(counts + frame * 4);
+    }
+
+    if (total != eventCount)
+    {
+        Clear();
+        return false;
+    }
+
+    m_events.resize(eventCount);
+    for (size_t i = 0; i < eventCount; i++)
+    {
+        if (!LoadEvent(events + i * EventSize, m_events[i]))
+        {
+            Clear();
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,129 @@
+//********************************************************* 
+// 
+// Copyright (c) Microsoft. All rights reserved. 
+// This code is licensed under the MIT License (MIT). 
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF 
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY 
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR 
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT. 
+// 
+//*********************************************************
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class InputEventType : uint32_t
+{
+    PointerPressed,
+    PointerMoved,
+    PointerReleased,
+    PointerExited,
+    MouseDelta,             // Relative mouse movement, reported separately from pointer movement.
+    KeyDown,
+    KeyUp,
+    Gamepad                 // One reading of the active gamepad.
+};
+
+// Bits stored in InputEvent::flags for pointer events.
+namespace InputEventFlags
+{
+    const uint32_t Touch       = 0x01;      // Otherwise a mouse or pen.
+    const uint32_t LeftButton  = 0x02;
+    const uint32_t RightButton = 0x04;
+}
+
+// One input sample.  The meaning of the fields depends on the type:
+//     Pointer events - id is the pointer id and (x, y) the position in the window.
+//     MouseDelta     - (x, y) is the relative movement.
+//     KeyDown/KeyUp  - id is the virtual key.
+//     Gamepad        - id holds the pressed buttons, (x, y) the left thumbstick,
+//                      (z, w) the right thumbstick and trigger the right trigger.
+struct InputEvent
+{
+    uint64_t        timestamp;              // Microseconds, from InputEventQueue::Now.
+    InputEventType  type;
+    uint32_t        id;
+    uint32_t        flags;
+    float           x;
+    float           y;
+    float           z;
+    float           w;
+    float           trigger;
+};
+
+// InputEventQueue:
+// Carries input events from the thread that receives the window's input events to the
+// game loop without either side taking a lock.  Events are written into a fixed ring by
+// a single producer and drained once per frame by a single consumer.  When the ring is
+// full new events are dropped and counted, which only happens if the game loop stalls
+// for a long time.
+// This file only depends on the C++ standard library.
+
+class InputEventQueue
+{
+public:
+    static const uint32_t Capacity = 256;
+
+    InputEventQueue();
+
+    InputEventQueue(const InputEventQueue&) = delete;
+    InputEventQueue& operator=(const InputEventQueue&) = delete;
+
+    // Producer side.  Returns false if the event was dropped.
+    bool Push(const InputEvent& inputEvent);
+
+    // Consumer side.  Appends the queued events to events in the order they were pushed.
+    void Drain(std::vector<InputEvent>& events);
+    void Clear();
+
+    uint64_t DroppedCount() const;
+
+    // Microseconds on a steady clock shared by all events.
+    static uint64_t Now();
+
+    // Reduces a frame's worth of events without changing what they add up to: relative
+    // mouse movements are summed, and a pointer move is dropped when a later move of the
+    // same pointer follows before that pointer is pressed, released or exits.
+    static void Coalesce(std::vector<InputEvent>& events);
+
+private:
+    InputEvent              m_events[Capacity];
+
+    // The indices increase without wrapping to the ring size; each is written by one side.
+    std::atomic<uint32_t>   m_head;         // Next event to read, written by the consumer.
+    std::atomic<uint32_t>   m_tail;         // Next slot to write, written by the producer.
+    std::atomic<uint64_t>   m_dropped;
+};
+
+// InputRecording:
+// The events applied by the controller in each frame, so a session can be replayed
+// frame by frame.  Save and Load convert the recording to and from a little endian
+// blob: a 16 byte header (magic, version, frame count and event count), the number of
+// events in each frame and then the events.
+
+class InputRecording
+{
+public:
+    static const uint32_t Magic = 0x43524e49;       // "INRC" in memory.
+    static const uint32_t Version = 1;
+
+    void Clear();
+    void AddFrame(const std::vector<InputEvent>& events);
+
+    uint32_t FrameCount() const { return static_cast<uint32_t>(m_frameStart.size()); }
+    size_t EventCount() const { return m_events.size(); }
+
+    // Appends the events of the given frame; returns false past the end of the recording.
+    bool GetFrame(uint32_t frame, std::vector<InputEvent>& events) const;
+
+    void Save(std::vector<uint8_t>& data) const;
+    bool Load(const uint8_t* data, size_t size);
+
+private:
+    std::vector<InputEvent> m_events;
+    std::vector<size_t>     m_frameStart;       // Index of each frame's first event.
+};
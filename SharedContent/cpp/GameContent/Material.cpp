@@ -15,6 +15,9 @@
 
 using namespace DirectX;
 
+// Materials are only created on the rendering thread, so the id counter needs no locking.
+static uint32 s_nextSortId = 1;
+
 //--------------------------------------------------------------------------------
 
 Material::Material(
@@ -31,6 +34,8 @@ Material::Material(
     m_diffuseColor = diffuseColor;
     m_specularColor = specularColor;
     m_specularExponent = specularExponent;
+    m_textureTransform = XMFLOAT4(1.0f, 1.0f, 0.0f, 0.0f);
+    m_sortId = s_nextSortId++;
 
     m_vertexShader = vertexShader;
     m_pixelShader = pixelShader;
@@ -48,8 +53,27 @@ void Material::RenderSetup(
     constantBuffer->specularColor = m_specularColor;
     constantBuffer->specularPower = m_specularExponent;
     constantBuffer->diffuseColor = m_diffuseColor;
+    constantBuffer->textureTransform = m_textureTransform;
 
     context->PSSetShaderResources(0, 1, m_textureRV.GetAddressOf());
     context->VSSetShader(m_vertexShader.Get(), nullptr, 0);
     context->PSSetShader(m_pixelShader.Get(), nullptr, 0);
-}
\ No newline at end of file
+}
+
+//--------------------------------------------------------------------------------
+
+void Material::RenderSetupInstanced(
+    _In_ ID3D11DeviceContext* context,
+    _Inout_ ConstantBufferChangesEveryPrim* constantBuffer
+    )
+{
+    constantBuffer->meshColor = m_meshColor;
+    constantBuffer->specularColor = m_specularColor;
+    constantBuffer->specularPower = m_specularExponent;
+    constantBuffer->diffuseColor = m_diffuseColor;
+    constantBuffer->textureTransform = m_textureTransform;
+
+    context->PSSetShaderResources(0, 1, m_textureRV.GetAddressOf());
+    context->VSSetShader(m_instancedVertexShader.Get(), nullptr, 0);
+    context->PSSetShader(m_pixelShader.Get(), nullptr, 0);
+}
@@ -19,6 +19,11 @@
 // The RenderSetup method sets the appropriate values into the constantBuffer
 // and calls the appropriate D3D11 context methods to set up the rendering pipeline
 // in the graphics hardware.
+// RenderSetupInstanced does the same but binds the optional instanced vertex shader,
+// which reads the object to world matrix from a per-instance vertex stream.
+// Each material has a unique SortId, used to group draws that share a material.
+// The texture transform selects the part of the texture the mesh maps to, so several
+// materials can share one atlas texture.
 
 #include "ConstantBuffers.h"
 
@@ -40,19 +45,41 @@ internal:
         _Inout_ ConstantBufferChangesEveryPrim* constantBuffer
         );
 
+    void RenderSetupInstanced(
+        _In_ ID3D11DeviceContext* context,
+        _Inout_ ConstantBufferChangesEveryPrim* constantBuffer
+        );
+
     void SetTexture(_In_ ID3D11ShaderResourceView* textureResourceView)
     {
         m_textureRV = textureResourceView;
     }
 
+    // Texture coordinates are mapped to uv * (x, y) + (z, w).  Defaults to (1, 1, 0, 0).
+    void SetTextureTransform(DirectX::XMFLOAT4 textureTransform)
+    {
+        m_textureTransform = textureTransform;
+    }
+
+    void SetInstancedVertexShader(_In_opt_ ID3D11VertexShader* vertexShader)
+    {
+        m_instancedVertexShader = vertexShader;
+    }
+
+    bool SupportsInstancing() { return m_instancedVertexShader != nullptr; }
+    uint32 SortId() { return m_sortId; }
+
 protected private:
     DirectX::XMFLOAT4   m_meshColor;
     DirectX::XMFLOAT4   m_diffuseColor;
     DirectX::XMFLOAT4   m_hitColor;
     DirectX::XMFLOAT4   m_specularColor;
+    DirectX::XMFLOAT4   m_textureTransform;
     float               m_specularExponent;
+    uint32              m_sortId;
 
     Microsoft::WRL::ComPtr<ID3D11VertexShader>       m_vertexShader;
+    Microsoft::WRL::ComPtr<ID3D11VertexShader>       m_instancedVertexShader;
     Microsoft::WRL::ComPtr<ID3D11PixelShader>        m_pixelShader;
     Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_textureRV;
 };
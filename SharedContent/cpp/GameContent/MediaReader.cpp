@@ -31,7 +31,34 @@ WAVEFORMATEX *MediaReader::GetOutputWaveFormatEx()
     return &m_waveFormat;
 }
 
+DecodedAudioCache& MediaReader::GetCache()
+{
+    static DecodedAudioCache cache(DefaultCacheBudget);
+    return cache;
+}
+
 Platform::Array<byte>^ MediaReader::LoadMedia(_In_ Platform::String^ filename)
+{
+    DecodedAudio audio;
+    DecodeMedia(filename, audio);
+    return ref new Platform::Array<byte>(audio.data.data(), static_cast<unsigned int>(audio.data.size()));
+}
+
+std::shared_ptr<const DecodedAudio> MediaReader::LoadCachedMedia(_In_ Platform::String^ filename)
+{
+    // Decode errors are thrown out of the load function and through Acquire.
+    auto audio = GetCache().Acquire(filename->Data(), [this, filename](DecodedAudio& decoded)
+    {
+        DecodeMedia(filename, decoded);
+        return true;
+    });
+
+    // On a cache hit nothing was decoded, so the output format comes from the cached copy.
+    CopyMemory(&m_waveFormat, audio->format.data(), sizeof(m_waveFormat));
+    return audio;
+}
+
+void MediaReader::DecodeMedia(_In_ Platform::String^ filename, _Inout_ DecodedAudio& audio)
 {
     DX::ThrowIfFailed(
         MFStartup(MF_VERSION)
@@ -81,12 +108,16 @@ Platform::Array<byte>^ MediaReader::LoadMedia(_In_ Platform::String^ filename)
     CopyMemory(&m_waveFormat, waveFormat, sizeof(m_waveFormat));
     CoTaskMemFree(waveFormat);
 
+    auto format = reinterpret_cast<const uint8_t*>(&m_waveFormat);
+    audio.format.assign(format, format + sizeof(m_waveFormat));
+
     PROPVARIANT propVariant;
     DX::ThrowIfFailed(
         reader->GetPresentationAttribute(static_cast<uint32>(MF_SOURCE_READER_MEDIASOURCE), MF_PD_DURATION, &propVariant)
         );
     // 'duration' is in 100ns units; convert to seconds, and round up
-    // to the nearest whole byte.
+    // to the nearest whole byte.  This is only used to size the buffer up
+    // front; the decoded data grows if the estimate is short.
     LONGLONG duration = propVariant.uhVal.QuadPart;
     unsigned int maxStreamLengthInBytes =
         static_cast<unsigned int>(
@@ -94,13 +125,13 @@ Platform::Array<byte>^ MediaReader::LoadMedia(_In_ Platform::String^ filename)
             10000000
             );
 
-    Platform::Array<byte>^ fileData = ref new Platform::Array<byte>(maxStreamLengthInBytes);
+    audio.data.clear();
+    audio.data.reserve(maxStreamLengthInBytes);
 
     ComPtr<IMFSample> sample;
     ComPtr<IMFMediaBuffer> mediaBuffer;
     DWORD flags = 0;
 
-    int positionInData = 0;
     bool done = false;
     while (!done)
     {
@@ -120,16 +151,15 @@ Platform::Array<byte>^ MediaReader::LoadMedia(_In_ Platform::String^ filename)
                 mediaBuffer->Lock(&audioData, nullptr, &sampleBufferLength)
                 );
 
-            for (DWORD i = 0; i < sampleBufferLength; i++)
-            {
-                fileData[positionInData++] = audioData[i];
-            }
+            audio.data.insert(audio.data.end(), audioData, audioData + sampleBufferLength);
+
+            DX::ThrowIfFailed(
+                mediaBuffer->Unlock()
+                );
         }
         if (flags & MF_SOURCE_READERF_ENDOFSTREAM)
         {
             done = true;
         }
     }
-
-    return fileData;
 }
\ No newline at end of file
@@ -11,10 +11,14 @@
 
 #pragma once
 
+#include "DecodedAudioCache.h"
+
 // MediaReader:
 // This is a helper class for the SoundEffect class.  It reads small audio files
 // synchronously from the package installed folder and returns sound data as a
-// byte array.
+// byte array.  LoadCachedMedia returns the decoded data through a cache shared
+// by every MediaReader, so a file is decoded once no matter how many sound effects
+// use it.
 
 ref class MediaReader
 {
@@ -22,9 +26,16 @@ internal:
     MediaReader();
 
     Platform::Array<byte>^          LoadMedia(_In_ Platform::String^ filename);
+    std::shared_ptr<const DecodedAudio> LoadCachedMedia(_In_ Platform::String^ filename);
     WAVEFORMATEX*                   GetOutputWaveFormatEx();
 
+    // Decoded sound effects kept resident beyond the ones in use.
+    static const size_t             DefaultCacheBudget = 8 * 1024 * 1024;
+    static DecodedAudioCache&       GetCache();
+
 protected private:
+    void DecodeMedia(_In_ Platform::String^ filename, _Inout_ DecodedAudio& audio);
+
     Windows::Storage::StorageFolder^ m_installedLocation;
     Platform::String^               m_installedLocationPath;
     WAVEFORMATEX                    m_waveFormat;
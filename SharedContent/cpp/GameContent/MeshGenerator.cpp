@@ -0,0 +1,824 @@
+//********************************************************* 
+// 
+// Copyright (c) Microsoft. All rights reserved. 
+// This code is licensed under the MIT License (MIT). 
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF 
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY 
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR 
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT. 
+// 
+//*********************************************************
+
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "MeshGenerator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace
+{
+    const float Pi = 3.141592654f;
+    const float TwoPi = 6.283185307f;
+    const uint32_t Invalid = UINT32_MAX;
+
+    // A group is split off once the triangles read so far miss the cache at no more than this
+    // multiple of the rate for the whole mesh.
+    const float ClusterMissThreshold = 1.05f;
+
+    void AddVertex(MeshData& mesh, float px, float py, float pz, float nx, float ny, float nz, float u, float v)
+    {
+        MeshVertex vertex = { { px, py, pz }, { nx, ny, nz }, { u, v } };
+        mesh.vertices.push_back(vertex);
+    }
+
+    void AddTriangle(MeshData& mesh, uint32_t a, uint32_t b, uint32_t c)
+    {
+        mesh.indices.push_back(a);
+        mesh.indices.push_back(b);
+        mesh.indices.push_back(c);
+    }
+
+    void SetBounds(MeshData& mesh, float x, float y, float z, float radius)
+    {
+        mesh.boundingCenter[0] = x;
+        mesh.boundingCenter[1] = y;
+        mesh.boundingCenter[2] = z;
+        mesh.boundingRadius = radius;
+    }
+
+    void Reset(MeshData& mesh)
+    {
+        mesh.vertices.clear();
+        mesh.indices.clear();
+        SetBounds(mesh, 0.0f, 0.0f, 0.0f, 0.0f);
+    }
+
+    void AddQuads(MeshData& mesh, const float (*vertices)[8], size_t quadCount)
+    {
+        for (size_t q = 0; q < quadCount; q++)
+        {
+            uint32_t first = static_cast<uint32_t>(mesh.vertices.size());
+            for (size_t i = 0; i < 4; i++)
+            {
+                const float* v = vertices[q * 4 + i];
+                AddVertex(mesh, v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7]);
+            }
+
+            AddTriangle(mesh, first, first + 1, first + 2);
+            AddTriangle(mesh, first + 1, first + 3, first + 2);
+        }
+    }
+
+    // Simulates a FIFO post-transform cache.  A vertex is cached while fewer than size vertices
+    // have been added after it; advancing time by more than size empties the cache.
+    class CacheSimulation
+    {
+    public:
+        CacheSimulation(size_t vertexCount, uint32_t size) :
+            m_added(vertexCount, 0),
+            m_time(size + 1),
+            m_size(size)
+        {
+        }
+
+        bool Contains(uint32_t vertex) const { return m_time - m_added[vertex] <= m_size; }
+        uint32_t Age(uint32_t vertex) const { return m_time - m_added[vertex]; }
+
+        // Returns true on a miss.
+        bool Use(uint32_t vertex)
+        {
+            if (Contains(vertex))
+            {
+                return false;
+            }
+
+            m_added[vertex] = m_time++;
+            return true;
+        }
+
+        void Flush()
+        {
+            m_time += m_size + 1;
+        }
+
+    private:
+        std::vector<uint32_t>   m_added;
+        uint32_t                m_time;
+        uint32_t                m_size;
+    };
+
+    size_t CountCacheMisses(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize)
+    {
+        CacheSimulation cache(vertexCount, cacheSize);
+        size_t misses = 0;
+        for (uint32_t index : indices)
+        {
+            misses += cache.Use(index) ? 1 : 0;
+        }
+
+        return misses;
+    }
+
+    // Orders the triangles with Tipsify: the triangles around a fanning vertex are emitted
+    // together, and the next fanning vertex is one of their vertices that will still be in the
+    // cache once its own triangles are emitted.  Returns the new index list and, in clusters,
+    // the first triangle after each point where the walk had to restart from an unrelated vertex.
+    std::vector<uint32_t> Tipsify(
+        const std::vector<uint32_t>& indices,
+        size_t vertexCount,
+        uint32_t cacheSize,
+        std::vector<uint32_t>& clusters
+        )
+    {
+        size_t triangleCount = indices.size() / 3;
+
+        // The triangles using each vertex, stored back to back.
+        std::vector<uint32_t> first(vertexCount + 1, 0);
+        for (uint32_t index : indices)
+        {
+            first[index + 1]++;
+        }
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            first[v + 1] += first[v];
+        }
+
+        std::vector<uint32_t> adjacent(indices.size());
+        std::vector<uint32_t> fill(first.begin(), first.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            adjacent[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+
+        // Triangles not yet emitted for each vertex.
+        std::vector<uint32_t> live(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            live[v] = first[v + 1] - first[v];
+        }
+
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> deadEnds;
+        std::vector<uint32_t> candidates;
+        std::vector<uint32_t> output;
+        output.reserve(indices.size());
+        CacheSimulation cache(vertexCount, cacheSize);
+        size_t cursor = 0;
+
+        // Recently used vertices are tried first when the walk reaches a dead end; after that the
+        // walk continues from the next vertex in the original order that still has triangles.
+        auto skipDeadEnd = [&](bool& restarted) -> uint32_t
+        {
+            restarted = false;
+            while (!deadEnds.empty())
+            {
+                uint32_t vertex = deadEnds.back();
+                deadEnds.pop_back();
+                if (live[vertex] > 0)
+                {
+                    return vertex;
+                }
+            }
+
+            restarted = true;
+            for (; cursor < indices.size(); cursor++)
+            {
+                if (live[indices[cursor]] > 0)
+                {
+                    return indices[cursor];
+                }
+            }
+
+            return Invalid;
+        };
+
+        bool restarted;
+        uint32_t fanning = skipDeadEnd(restarted);
+        clusters.assign(1, 0);
+        while (fanning != Invalid)
+        {
+            candidates.clear();
+            for (uint32_t i = first[fanning]; i < first[fanning + 1]; i++)
+            {
+                uint32_t triangle = adjacent[i];
+                if (emitted[triangle])
+                {
+                    continue;
+                }
+
+                for (size_t k = 0; k < 3; k++)
+                {
+                    uint32_t vertex = indices[triangle * 3 + k];
+                    output.push_back(vertex);
+                    deadEnds.push_back(vertex);
+                    candidates.push_back(vertex);
+                    live[vertex]--;
+                    cache.Use(vertex);
+                }
+                emitted[triangle] = true;
+            }
+
+            // Prefer the oldest candidate that stays cached while its remaining triangles are
+            // emitted; any other candidate with triangles left scores zero.
+            uint32_t next = Invalid;
+            int64_t best = -1;
+            for (uint32_t vertex : candidates)
+            {
+                if (live[vertex] == 0)
+                {
+                    continue;
+                }
+
+                int64_t priority = 0;
+                if (static_cast<uint64_t>(cache.Age(vertex)) + 2 * live[vertex] <= cacheSize)
+                {
+                    priority = cache.Age(vertex);
+                }
+
+                if (priority > best)
+                {
+                    best = priority;
+                    next = vertex;
+                }
+            }
+
+            if (next == Invalid)
+            {
+                next = skipDeadEnd(restarted);
+                uint32_t emittedCount = static_cast<uint32_t>(output.size() / 3);
+                if (restarted && emittedCount > clusters.back() && emittedCount < triangleCount)
+                {
+                    clusters.push_back(emittedCount);
+                }
+            }
+
+            fanning = next;
+        }
+
+        return output;
+    }
+
+    // Splits each cluster further wherever the triangles read so far are about as cache friendly
+    // as the whole mesh, so that sorting has smaller groups to work with.  Each group is simulated
+    // with an empty cache, since after sorting it may follow any other group.
+    void SplitClusters(
+        const std::vector<uint32_t>& indices,
+        size_t vertexCount,
+        uint32_t cacheSize,
+        std::vector<uint32_t>& clusters
+        )
+    {
+        uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+
+        size_t totalMisses = CountCacheMisses(indices, vertexCount, cacheSize);
+        float threshold = ClusterMissThreshold * static_cast<float>(totalMisses) / static_cast<float>(triangleCount);
+
+        std::vector<uint32_t> split;
+        CacheSimulation cache(vertexCount, cacheSize);
+        for (size_t c = 0; c < clusters.size(); c++)
+        {
+            uint32_t end = (c + 1 < clusters.size()) ? clusters[c + 1] : triangleCount;
+            uint32_t start = clusters[c];
+            uint32_t misses = 0;
+            cache.Flush();
+            split.push_back(start);
+
+            for (uint32_t t = clusters[c]; t < end; t++)
+            {
+                for (size_t k = 0; k < 3; k++)
+                {
+                    misses += cache.Use(indices[t * 3 + k]) ? 1 : 0;
+                }
+
+                if (t + 1 < end && static_cast<float>(misses) <= threshold * static_cast<float>(t + 1 - start))
+                {
+                    start = t + 1;
+                    misses = 0;
+                    cache.Flush();
+                    split.push_back(start);
+                }
+            }
+        }
+
+        clusters.swap(split);
+    }
+
+    // Draws the clusters that face away from the middle of the mesh first, since they are the
+    // most likely to hide the rest of it.
+    std::vector<uint32_t> SortClusters(
+        const std::vector<MeshVertex>& vertices,
+        const std::vector<uint32_t>& indices,
+        const std::vector<uint32_t>& clusters
+        )
+    {
+        uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+
+        // Area weighted centroid and summed normal of each cluster.  The cross product of two
+        // edges is a normal with twice the triangle's area as its length.
+        struct ClusterInfo
+        {
+            double  centroid[3];
+            double  normal[3];
+            double  area;
+        };
+        std::vector<ClusterInfo> info(clusters.size());
+        double meshCentroid[3] = { 0.0, 0.0, 0.0 };
+        double meshArea = 0.0;
+
+        for (size_t c = 0; c < clusters.size(); c++)
+        {
+            uint32_t end = (c + 1 < clusters.size()) ? clusters[c + 1] : triangleCount;
+            ClusterInfo& cluster = info[c];
+            cluster = ClusterInfo();
+
+            for (uint32_t t = clusters[c]; t < end; t++)
+            {
+                const float* p0 = vertices[indices[t * 3]].position;
+                const float* p1 = vertices[indices[t * 3 + 1]].position;
+                const float* p2 = vertices[indices[t * 3 + 2]].position;
+
+                double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+                double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+                double n[3] =
+                {
+                    e1[1] * e2[2] - e1[2] * e2[1],
+                    e1[2] * e2[0] - e1[0] * e2[2],
+                    e1[0] * e2[1] - e1[1] * e2[0]
+                };
+                double area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+                for (size_t k = 0; k < 3; k++)
+                {
+                    cluster.centroid[k] += area * (p0[k] + p1[k] + p2[k]) / 3.0;
+                    cluster.normal[k] += n[k];
+                }
+                cluster.area += area;
+            }
+
+            for (size_t k = 0; k < 3; k++)
+            {
+                meshCentroid[k] += cluster.centroid[k];
+                cluster.centroid[k] = (cluster.area > 0.0) ? cluster.centroid[k] / cluster.area : 0.0;
+            }
+            meshArea += cluster.area;
+        }
+
+        for (size_t k = 0; k < 3; k++)
+        {
+            meshCentroid[k] = (meshArea > 0.0) ? meshCentroid[k] / meshArea : 0.0;
+        }
+
+        std::vector<double> potential(clusters.size());
+        for (size_t c = 0; c < clusters.size(); c++)
+        {
+            const ClusterInfo& cluster = info[c];
+            double length = std::sqrt(
+                cluster.normal[0] * cluster.normal[0] +
+                cluster.normal[1] * cluster.normal[1] +
+                cluster.normal[2] * cluster.normal[2]
+                );
+
+            potential[c] = 0.0;
+            if (length > 0.0)
+            {
+                for (size_t k = 0; k < 3; k++)
+                {
+                    potential[c] += (cluster.centroid[k] - meshCentroid[k]) * cluster.normal[k] / length;
+                }
+            }
+        }
+
+        std::vector<uint32_t> order(clusters.size());
+        for (size_t c = 0; c < clusters.size(); c++)
+        {
+            order[c] = static_cast<uint32_t>(c);
+        }
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+        {
+            return potential[a] > potential[b];
+        });
+
+        std::vector<uint32_t> output;
+        output.reserve(indices.size());
+        for (uint32_t c : order)
+        {
+            uint32_t end = (c + 1 < clusters.size()) ? clusters[c + 1] : triangleCount;
+            output.insert(output.end(), indices.begin() + clusters[c] * 3, indices.begin() + end * 3);
+        }
+
+        return output;
+    }
+
+    // Renumbers the vertices in the order the triangles first use them, so that vertex fetches
+    // move forward through the buffer.  Vertices no triangle uses are dropped.
+    void ReorderVertices(MeshData& mesh)
+    {
+        std::vector<uint32_t> remap(mesh.vertices.size(), Invalid);
+        std::vector<MeshVertex> vertices;
+        vertices.reserve(mesh.vertices.size());
+
+        for (uint32_t& index : mesh.indices)
+        {
+            if (remap[index] == Invalid)
+            {
+                remap[index] = static_cast<uint32_t>(vertices.size());
+                vertices.push_back(mesh.vertices[index]);
+            }
+            index = remap[index];
+        }
+
+        mesh.vertices.swap(vertices);
+    }
+
+    double Milliseconds(std::chrono::steady_clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+}
+
+//--------------------------------------------------------------------------------
+
+void MeshGenerator::Generate(MeshShape shape, uint32_t segments, MeshData& mesh)
+{
+    switch (shape)
+    {
+    case MeshShape::Sphere:
+        GenerateSphere(segments, mesh);
+        break;
+    case MeshShape::Cylinder:
+        GenerateCylinder(segments, mesh);
+        break;
+    case MeshShape::Face:
+        GenerateFace(mesh);
+        break;
+    case MeshShape::WorldCeiling:
+        GenerateWorldCeiling(mesh);
+        break;
+    case MeshShape::WorldFloor:
+        GenerateWorldFloor(mesh);
+        break;
+    case MeshShape::WorldWalls:
+        GenerateWorldWalls(mesh);
+        break;
+    }
+}
+
+//--------------------------------------------------------------------------------
+
+void MeshGenerator::GenerateSphere(uint32_t segments, MeshData& mesh)
+{
+    segments = std::max(segments, 4u);
+    uint32_t slices = segments / 2;
+
+    Reset(mesh);
+    mesh.vertices.reserve((slices + 1) * (segments + 1));
+    mesh.indices.reserve(slices * segments * 3 * 2);
+
+    // To make the texture look right on the top and bottom of the sphere
+    // each slice will have 'segments + 1' vertices.  The top and bottom
+    // vertices will all be coincident, but have different U texture cooordinates.
+    for (uint32_t a = 0; a <= slices; a++)
+    {
+        float angle1 = static_cast<float>(a) / static_cast<float>(slices) * Pi;
+        float z = std::cos(angle1);
+        float r = std::sin(angle1);
+        for (uint32_t b = 0; b <= segments; b++)
+        {
+            float angle2 = static_cast<float>(b) / static_cast<float>(segments) * TwoPi;
+            float x = r * std::cos(angle2);
+            float y = r * std::sin(angle2);
+            AddVertex(mesh, x, y, z, x, y, z, (1.0f - z) / 2.0f, static_cast<float>(b) / static_cast<float>(segments));
+        }
+    }
+
+    for (uint32_t a = 0; a < slices; a++)
+    {
+        uint32_t p1 = a * (segments + 1);
+        uint32_t p2 = (a + 1) * (segments + 1);
+
+        // Generate two triangles for each segment around the slice.
+        for (uint32_t b = 0; b < segments; b++)
+        {
+            if (a < (slices - 1))
+            {
+                // For all but the bottom slice add the triangle with one
+                // vertex in the a slice and two vertices in the a + 1 slice.
+                // Skip it for the bottom slice since the triangle would be
+                // degenerate as all the vertices in the bottom slice are coincident.
+                AddTriangle(mesh, b + p1, b + p2, b + p2 + 1);
+            }
+            if (a > 0)
+            {
+                // For all but the top slice add the triangle with two
+                // vertices in the a slice and one vertex in the a + 1 slice.
+                // Skip it for the top slice since the triangle would be
+                // degenerate as all the vertices in the top slice are coincident.
+                AddTriangle(mesh, b + p1, b + p2 + 1, b + p1 + 1);
+            }
+        }
+    }
+
+    SetBounds(mesh, 0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+//--------------------------------------------------------------------------------
+
+void MeshGenerator::GenerateCylinder(uint32_t segments, MeshData& mesh)
+{
+    segments = std::max(segments, 3u);
+
+    Reset(mesh);
+    mesh.vertices.reserve(6 * (segments + 1));
+    mesh.indices.reserve(3 * segments * 3 * 2);
+
+    // Six rings of 'segments + 1' vertices, from the top center down to the bottom center.
+    // The edges appear twice, once with normals for the caps and once for the side.
+    struct Ring
+    {
+        float   radius;
+        float   z;
+        float   normalScale;    // Scales the outward direction into the normal.
+        float   normalZ;
+        float   v;
+    };
+    const Ring rings[6] =
+    {
+        { 0.0f, 1.0f, 0.0f,  1.0f, 0.0f },     // Top center point (multiple points for texture coordinates).
+        { 1.0f, 1.0f, 0.0f,  1.0f, 0.0f },     // Top edge: normals point up for lighting of the top surface.
+        { 1.0f, 1.0f, 1.0f,  0.0f, 0.0f },     // Top edge: normals point out for lighting of the side surface.
+        { 1.0f, 0.0f, 1.0f,  0.0f, 1.0f },     // Bottom edge: normals point out for lighting of the side surface.
+        { 1.0f, 0.0f, 0.0f, -1.0f, 1.0f },     // Bottom edge: normals point down for lighting of the bottom surface.
+        { 0.0f, 0.0f, 0.0f, -1.0f, 1.0f },     // Bottom center point.
+    };
+
+    for (const Ring& ring : rings)
+    {
+        for (uint32_t a = 0; a <= segments; a++)
+        {
+            float angle = static_cast<float>(a) / static_cast<float>(segments) * TwoPi;
+            float x = std::cos(angle);
+            float y = std::sin(angle);
+            AddVertex(
+                mesh,
+                ring.radius * x, ring.radius * y, ring.z,
+                ring.normalScale * x, ring.normalScale * y, ring.normalZ,
+                static_cast<float>(a) / static_cast<float>(segments), ring.v
+                );
+        }
+    }
+
+    // The caps and the side each join a pair of rings.
+    for (uint32_t a = 0; a < 6; a += 2)
+    {
+        uint32_t p1 = a * (segments + 1);
+        uint32_t p2 = (a + 1) * (segments + 1);
+        for (uint32_t b = 0; b < segments; b++)
+        {
+            if (a < 4)
+            {
+                AddTriangle(mesh, b + p1, b + p2, b + p2 + 1);
+            }
+            if (a > 0)
+            {
+                AddTriangle(mesh, b + p1, b + p2 + 1, b + p1 + 1);
+            }
+        }
+    }
+
+    // Unit radius, running from z = 0 to z = 1.
+    SetBounds(mesh, 0.0f, 0.0f, 0.5f, 1.118034f);
+}
+
+//--------------------------------------------------------------------------------
+
+void MeshGenerator::GenerateFace(MeshData& mesh)
+{
+    Reset(mesh);
+    AddVertex(mesh, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f);
+    AddVertex(mesh, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f);
+    AddVertex(mesh, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f);
+    AddVertex(mesh, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f);
+
+    // Both windings, so the face can be seen from either side.
+    AddTriangle(mesh, 0, 1, 2);
+    AddTriangle(mesh, 0, 2, 3);
+    AddTriangle(mesh, 0, 2, 1);
+    AddTriangle(mesh, 0, 3, 2);
+
+    // The face covers the unit square in the z = 0 plane.
+    SetBounds(mesh, 0.5f, 0.5f, 0.0f, 0.70710678f);
+}
+
+//--------------------------------------------------------------------------------
+
+void MeshGenerator::GenerateWorldCeiling(MeshData& mesh)
+{
+    static const float vertices[][8] =
+    {
+        { -4.0f,  3.0f, -6.0f, 0.0f, -1.0f, 0.0f, -0.15f, 0.0f },
+        {  4.0f,  3.0f, -6.0f, 0.0f, -1.0f, 0.0f,  1.25f, 0.0f },
+        { -4.0f,  3.0f,  6.0f, 0.0f, -1.0f, 0.0f, -0.15f, 2.1f },
+        {  4.0f,  3.0f,  6.0f, 0.0f, -1.0f, 0.0f,  1.25f, 2.1f },
+    };
+
+    Reset(mesh);
+    AddQuads(mesh, vertices, 1);
+}
+
+//--------------------------------------------------------------------------------
+
+void MeshGenerator::GenerateWorldFloor(MeshData& mesh)
+{
+    static const float vertices[][8] =
+    {
+        { -4.0f, -3.0f,  6.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f },
+        {  4.0f, -3.0f,  6.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f },
+        { -4.0f, -3.0f, -6.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.5f },
+        {  4.0f, -3.0f, -6.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.5f },
+    };
+
+    Reset(mesh);
+    AddQuads(mesh, vertices, 1);
+}
+
+//--------------------------------------------------------------------------------
+
+void MeshGenerator::GenerateWorldWalls(MeshData& mesh)
+{
+    static const float vertices[][8] =
+    {
+        { -4.0f,  3.0f,  6.0f,  0.0f, 0.0f, -1.0f, 0.0f, 0.0f },
+        {  4.0f,  3.0f,  6.0f,  0.0f, 0.0f, -1.0f, 2.0f, 0.0f },
+        { -4.0f, -3.0f,  6.0f,  0.0f, 0.0f, -1.0f, 0.0f, 1.5f },
+        {  4.0f, -3.0f,  6.0f,  0.0f, 0.0f, -1.0f, 2.0f, 1.5f },
+
+        {  4.0f,  3.0f,  6.0f, -1.0f, 0.0f,  0.0f, 0.0f, 0.0f },
+        {  4.0f,  3.0f, -6.0f, -1.0f, 0.0f,  0.0f, 3.0f, 0.0f },
+        {  4.0f, -3.0f,  6.0f, -1.0f, 0.0f,  0.0f, 0.0f, 1.5f },
+        {  4.0f, -3.0f, -6.0f, -1.0f, 0.0f,  0.0f, 3.0f, 1.5f },
+
+        {  4.0f,  3.0f, -6.0f,  0.0f, 0.0f,  1.0f, 0.0f, 0.0f },
+        { -4.0f,  3.0f, -6.0f,  0.0f, 0.0f,  1.0f, 2.0f, 0.0f },
+        {  4.0f, -3.0f, -6.0f,  0.0f, 0.0f,  1.0f, 0.0f, 1.5f },
+        { -4.0f, -3.0f, -6.0f,  0.0f, 0.0f,  1.0f, 2.0f, 1.5f },
+
+        { -4.0f,  3.0f, -6.0f,  1.0f, 0.0f,  0.0f, 0.0f, 0.0f },
+        { -4.0f,  3.0f,  6.0f,  1.0f, 0.0f,  0.0f, 3.0f, 0.0f },
+        { -4.0f, -3.0f, -6.0f,  1.0f, 0.0f,  0.0f, 0.0f, 1.5f },
+        { -4.0f, -3.0f,  6.0f,  1.0f, 0.0f,  0.0f, 3.0f, 1.5f },
+    };
+
+    Reset(mesh);
+    AddQuads(mesh, vertices, 4);
+}
+
+//--------------------------------------------------------------------------------
+
+void MeshGenerator::Optimize(MeshData& mesh, uint32_t cacheSize)
+{
+    if (mesh.indices.size() < 3 || cacheSize == 0)
+    {
+        return;
+    }
+
+    size_t vertexCount = mesh.vertices.size();
+    std::vector<uint32_t> clusters;
+    std::vector<uint32_t> ordered = Tipsify(mesh.indices, vertexCount, cacheSize, clusters);
+    std::vector<uint32_t> restarts = clusters;
+    SplitClusters(ordered, vertexCount, cacheSize, clusters);
+    std::vector<uint32_t> sorted = SortClusters(mesh.vertices, ordered, clusters);
+
+    // Meshes that already load each vertex only once, like the cylinder, lose more to the extra
+    // groups than the threshold allows.  The walk's own restarts begin with a cold cache anyway,
+    // so sorting just those groups costs next to nothing.
+    size_t limit = static_cast<size_t>(ClusterMissThreshold * CountCacheMisses(ordered, vertexCount, cacheSize));
+    if (CountCacheMisses(sorted, vertexCount, cacheSize) > limit)
+    {
+        sorted = SortClusters(mesh.vertices, ordered, restarts);
+    }
+
+    mesh.indices.swap(sorted);
+    ReorderVertices(mesh);
+}
+
+//--------------------------------------------------------------------------------
+
+float MeshGenerator::AverageCacheMissRatio(const MeshData& mesh, uint32_t cacheSize)
+{
+    size_t triangleCount = mesh.indices.size() / 3;
+    if (triangleCount == 0)
+    {
+        return 0.0f;
+    }
+
+    size_t misses = CountCacheMisses(mesh.indices, mesh.vertices.size(), cacheSize);
+    return static_cast<float>(misses) / static_cast<float>(triangleCount);
+}
+
+//--------------------------------------------------------------------------------
+
+MeshCache::MeshCache() :
+    m_stats()
+{
+}
+
+//--------------------------------------------------------------------------------
+
+MeshCache::~MeshCache()
+{
+    // Generation tasks update m_stats, so they must finish before the members go away.  The
+    // lock is not held while waiting because the tasks take it when they finish.
+    std::vector<PendingMesh> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        for (const auto& entry : m_meshes)
+        {
+            pending.push_back(entry.second);
+        }
+    }
+
+    for (const auto& mesh : pending)
+    {
+        mesh.wait();
+    }
+}
+
+//--------------------------------------------------------------------------------
+
+void MeshCache::Request(const std::vector<MeshKey>& keys)
+{
+    for (const auto& key : keys)
+    {
+        Find(key);
+    }
+}
+
+//--------------------------------------------------------------------------------
+
+MeshCache::MeshHandle MeshCache::Get(MeshShape shape, uint32_t segments)
+{
+    MeshKey key = { shape, segments };
+    return Find(key).get();
+}
+
+//--------------------------------------------------------------------------------
+
+size_t MeshCache::Size() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_meshes.size();
+}
+
+//--------------------------------------------------------------------------------
+
+MeshCacheStats MeshCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_stats;
+}
+
+//--------------------------------------------------------------------------------
+
+MeshCache::PendingMesh MeshCache::Find(MeshKey key)
+{
+    if (!MeshGenerator::UsesSegments(key.shape))
+    {
+        key.segments = 0;
+    }
+
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_stats.requested++;
+
+    auto existing = m_meshes.find(key);
+    if (existing != m_meshes.end())
+    {
+        m_stats.hits++;
+        return existing->second;
+    }
+
+    PendingMesh pending = std::async(std::launch::async, &MeshCache::Generate, this, key).share();
+    m_meshes.emplace(key, pending);
+    return pending;
+}
+
+//--------------------------------------------------------------------------------
+
+MeshCache::MeshHandle MeshCache::Generate(MeshKey key)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    auto mesh = std::make_shared<MeshData>();
+    MeshGenerator::Generate(key.shape, key.segments, *mesh);
+    MeshGenerator::Optimize(*mesh);
+
+    double elapsed = Milliseconds(std::chrono::steady_clock::now() - start);
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_stats.generated++;
+        m_stats.generateMilliseconds += elapsed;
+    }
+
+    return mesh;
+}
@@ -0,0 +1,154 @@
+//********************************************************* 
+// 
+// Copyright (c) Microsoft. All rights reserved. 
+// This code is licensed under the MIT License (MIT). 
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF 
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY 
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR 
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT. 
+// 
+//*********************************************************
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Same layout as PNTVertex, so generated vertices can be copied straight into a vertex buffer.
+struct MeshVertex
+{
+    float       position[3];
+    float       normal[3];
+    float       textureCoordinate[2];
+};
+
+// An indexed triangle list.  Indices are 32-bit while the mesh is built; MeshObject
+// narrows them to 16 bits when the vertex count allows it.
+struct MeshData
+{
+    std::vector<MeshVertex>     vertices;
+    std::vector<uint32_t>       indices;
+    float                       boundingCenter[3];
+    float                       boundingRadius;     // Zero means the mesh is never culled.
+
+    bool FitsSixteenBitIndices() const { return vertices.size() <= 0x10000; }
+};
+
+enum class MeshShape
+{
+    Sphere,         // Radius 1.0 around the origin.
+    Cylinder,       // Radius 1.0 and height 1.0 along +Z, capped at both ends.
+    Face,           // The unit square in the z = 0 plane, visible from both sides.
+    WorldCeiling,
+    WorldFloor,
+    WorldWalls
+};
+
+struct MeshKey
+{
+    MeshShape   shape;
+    uint32_t    segments;   // Always 0 for the shapes that do not use it.
+
+    bool operator==(const MeshKey& other) const
+    {
+        return shape == other.shape && segments == other.segments;
+    }
+};
+
+struct MeshKeyHash
+{
+    size_t operator()(const MeshKey& key) const
+    {
+        return std::hash<uint32_t>()((static_cast<uint32_t>(key.shape) << 24) ^ key.segments);
+    }
+};
+
+// MeshGenerator:
+// Builds the game's meshes on the CPU, without touching D3D, so they can be generated on any
+// thread.  Optimize reorders a mesh for the GPU: triangles are ordered for the post-transform
+// vertex cache with Tipsify (Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex
+// Locality and Reduced Overdraw"), then groups of triangles are sorted so that the outward facing
+// ones are drawn first, and finally the vertices are renumbered in the order they are first used.
+// The mesh keeps the same triangles with the same winding.
+// This file only depends on the C++ standard library.
+
+class MeshGenerator
+{
+public:
+    // Sphere needs at least 4 segments and Cylinder at least 3; fewer are raised to that.
+    static void Generate(MeshShape shape, uint32_t segments, MeshData& mesh);
+
+    static void GenerateSphere(uint32_t segments, MeshData& mesh);
+    static void GenerateCylinder(uint32_t segments, MeshData& mesh);
+    static void GenerateFace(MeshData& mesh);
+    static void GenerateWorldCeiling(MeshData& mesh);
+    static void GenerateWorldFloor(MeshData& mesh);
+    static void GenerateWorldWalls(MeshData& mesh);
+
+    static void Optimize(MeshData& mesh, uint32_t cacheSize = DefaultCacheSize);
+
+    // Vertices transformed per triangle with a FIFO post-transform cache of the given size.
+    // Ranges from about 0.5 for a well ordered grid to 3.0 when nothing is reused.
+    static float AverageCacheMissRatio(const MeshData& mesh, uint32_t cacheSize = DefaultCacheSize);
+
+    // Small enough to fit every GPU the samples target.
+    static const uint32_t DefaultCacheSize = 16;
+
+    static bool UsesSegments(MeshShape shape)
+    {
+        return shape == MeshShape::Sphere || shape == MeshShape::Cylinder;
+    }
+};
+
+struct MeshCacheStats
+{
+    uint64_t    requested;              // Meshes asked for through Request or Get.
+    uint64_t    hits;                   // Requests answered by a mesh already cached or being generated.
+    uint64_t    generated;
+    double      generateMilliseconds;   // Generating and optimizing, summed over all threads.
+};
+
+// MeshCache:
+// Keeps one optimized copy of each (shape, segments) mesh for the life of the cache, so meshes
+// shared between levels, or needed again after the device is recreated, are only generated once.
+// Request starts generating the missing meshes in parallel on background threads and returns
+// immediately; Get waits for a mesh, generating it first if nobody requested it.
+// Meshes are immutable once generated and may be read from any thread.
+
+class MeshCache
+{
+public:
+    typedef std::shared_ptr<const MeshData> MeshHandle;
+
+    MeshCache();
+
+    // Waits for any meshes still being generated.
+    ~MeshCache();
+
+    MeshCache(const MeshCache&) = delete;
+    MeshCache& operator=(const MeshCache&) = delete;
+
+    void Request(const std::vector<MeshKey>& keys);
+
+    // Rethrows any exception thrown while generating the mesh.
+    MeshHandle Get(MeshShape shape, uint32_t segments);
+
+    size_t Size() const;
+    MeshCacheStats GetStats() const;
+
+private:
+    typedef std::shared_future<MeshHandle> PendingMesh;
+
+    PendingMesh Find(MeshKey key);
+    MeshHandle Generate(MeshKey key);
+
+    mutable std::mutex                                      m_lock;
+    std::unordered_map<MeshKey, PendingMesh, MeshKeyHash>   m_meshes;
+    MeshCacheStats                                          m_stats;
+};
@@ -17,9 +17,16 @@
 using namespace Microsoft::WRL;
 using namespace DirectX;
 
+// Meshes are only created on the rendering thread, so the id counter needs no locking.
+static uint32 s_nextSortId = 1;
+
 MeshObject::MeshObject():
     m_vertexCount(0),
-    m_indexCount(0)
+    m_indexCount(0),
+    m_indexFormat(DXGI_FORMAT_R16_UINT),
+    m_boundingCenter(0.0f, 0.0f, 0.0f),
+    m_boundingRadius(0.0f),
+    m_sortId(s_nextSortId++)
 {
 }
 
@@ -31,9 +38,73 @@ void MeshObject::Render(_In_ ID3D11DeviceContext *context)
     uint32 offset = 0;
 
     context->IASetVertexBuffers(0, 1, m_vertexBuffer.GetAddressOf(), &stride, &offset);
-    context->IASetIndexBuffer(m_indexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0);
+    context->IASetIndexBuffer(m_indexBuffer.Get(), m_indexFormat, 0);
     context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
     context->DrawIndexed(m_indexCount, 0, 0);
 }
 
 //--------------------------------------------------------------------------------
+
+void MeshObject::RenderInstanced(
+    _In_ ID3D11DeviceContext *context,
+    uint32 instanceCount,
+    uint32 startInstance
+    )
+{
+    uint32 stride = sizeof(PNTVertex);
+    uint32 offset = 0;
+
+    context->IASetVertexBuffers(0, 1, m_vertexBuffer.GetAddressOf(), &stride, &offset);
+    context->IASetIndexBuffer(m_indexBuffer.Get(), m_indexFormat, 0);
+    context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    context->DrawIndexedInstanced(m_indexCount, instanceCount, 0, 0, startInstance);
+}
+
+//--------------------------------------------------------------------------------
+
+void MeshObject::CreateBuffers(_In_ ID3D11Device *device, const MeshData& mesh)
+{
+    static_assert(sizeof(MeshVertex) == sizeof(PNTVertex), "MeshVertex must match the PNTVertex layout");
+
+    D3D11_BUFFER_DESC bd = {0};
+    D3D11_SUBRESOURCE_DATA initData = {0};
+
+    m_vertexCount = static_cast<int>(mesh.vertices.size());
+    m_indexCount = static_cast<int>(mesh.indices.size());
+    m_boundingCenter = XMFLOAT3(mesh.boundingCenter[0], mesh.boundingCenter[1], mesh.boundingCenter[2]);
+    m_boundingRadius = mesh.boundingRadius;
+
+    bd.Usage = D3D11_USAGE_DEFAULT;
+    bd.ByteWidth = sizeof(PNTVertex) * m_vertexCount;
+    bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    bd.CPUAccessFlags = 0;
+    initData.pSysMem = mesh.vertices.data();
+    DX::ThrowIfFailed(
+        device->CreateBuffer(&bd, &initData, &m_vertexBuffer)
+        );
+
+    // Half the index memory, and bandwidth, for every mesh small enough to allow it.
+    std::vector<uint16> shortIndices;
+    if (mesh.FitsSixteenBitIndices())
+    {
+        shortIndices.assign(mesh.indices.begin(), mesh.indices.end());
+        m_indexFormat = DXGI_FORMAT_R16_UINT;
+        bd.ByteWidth = sizeof(uint16) * m_indexCount;
+        initData.pSysMem = shortIndices.data();
+    }
+    else
+    {
+        m_indexFormat = DXGI_FORMAT_R32_UINT;
+        bd.ByteWidth = sizeof(uint32) * m_indexCount;
+        initData.pSysMem = mesh.indices.data();
+    }
+
+    bd.Usage = D3D11_USAGE_DEFAULT;
+    bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
+    bd.CPUAccessFlags = 0;
+    DX::ThrowIfFailed(
+        device->CreateBuffer(&bd, &initData, &m_indexBuffer)
+        );
+}
+
+//--------------------------------------------------------------------------------
@@ -20,6 +20,14 @@
 // just sets the IndexBuffer, VertexBuffer and topology to a TriangleList and
 // makes a  DrawIndexed call on the context.  It assumes all other state has
 // already been set on the context.
+// RenderInstanced does the same with DrawIndexedInstanced, leaving the instance
+// data stream to be bound by the caller.
+// Each mesh also carries an object space bounding sphere, used for culling, and a
+// unique SortId, used to group draws of the same mesh.
+// Derived classes build their geometry with MeshGenerator and pass it to
+// CreateBuffers, which uses 16-bit indices whenever the vertex count allows.
+
+#include "MeshGenerator.h"
 
 ref class MeshObject abstract
 {
@@ -27,10 +35,27 @@ internal:
     MeshObject();
 
     virtual void Render(_In_ ID3D11DeviceContext *context);
+    virtual void RenderInstanced(
+        _In_ ID3D11DeviceContext *context,
+        uint32 instanceCount,
+        uint32 startInstance
+        );
+
+    uint32 SortId() { return m_sortId; }
+
+    // A radius of zero means the mesh has no bounds and is never culled.
+    DirectX::XMFLOAT3 BoundingCenter() { return m_boundingCenter; }
+    float BoundingRadius() { return m_boundingRadius; }
 
 protected private:
+    void CreateBuffers(_In_ ID3D11Device *device, const MeshData& mesh);
+
     Microsoft::WRL::ComPtr<ID3D11Buffer>  m_vertexBuffer;
     Microsoft::WRL::ComPtr<ID3D11Buffer>  m_indexBuffer;
     int                                   m_vertexCount;
     int                                   m_indexCount;
+    DXGI_FORMAT                           m_indexFormat;
+    DirectX::XMFLOAT3                     m_boundingCenter;
+    float                                 m_boundingRadius;
+    uint32                                m_sortId;
 };
@@ -46,7 +46,11 @@ MoveLookController::MoveLookController(_In_ CoreWindow^ window, _In_ CoreDispatc
     m_state(MoveLookControllerState::None),
     m_gamepadStartButtonInUse(false),
     m_gamepadTriggerInUse(false),
-    m_gamepadsChanged(true)
+    m_gamepadsChanged(true),
+    m_lastGamepadTimestamp(0),
+    m_recording(false),
+    m_replaying(false),
+    m_replayFrame(0)
 {
     InitWindow(window);
 }
@@ -60,7 +64,11 @@ MoveLookController::MoveLookController(_In_ CoreWindow^ window):
     m_state(MoveLookControllerState::None),
     m_gamepadStartButtonInUse(false),
     m_gamepadTriggerInUse(false),
-    m_gamepadsChanged(true)
+    m_gamepadsChanged(true),
+    m_lastGamepadTimestamp(0),
+    m_recording(false),
+    m_replaying(false),
+    m_replayFrame(0)
 {
     InitWindow(window);
 }
@@ -109,7 +117,6 @@ bool MoveLookController::IsPauseRequested()
     switch (m_state)
     {
     case MoveLookControllerState::Active:
-        UpdatePollingDevices();
         if (m_pausePressed)
         {
 #ifdef MOVELOOKCONTROLLER_TRACE
@@ -155,7 +162,6 @@ bool MoveLookController::IsPressComplete()
     switch (m_state)
     {
     case MoveLookControllerState::WaitForInput:
-        UpdatePollingDevices();
         if (m_buttonPressed)
         {
 #ifdef MOVELOOKCONTROLLER_TRACE
@@ -176,19 +182,169 @@ bool MoveLookController::IsPressComplete()
 
 //----------------------------------------------------------------------
 
-void MoveLookController::OnPointerPressed(
-    _In_ CoreWindow^ /* sender */,
+// The input handlers run on the window's thread.  They only queue a timestamped event;
+// the events are applied on the game loop thread by Update.
+
+void MoveLookController::QueuePointerEvent(
+    _In_ InputEventType type,
     _In_ PointerEventArgs^ args
     )
 {
     PointerPoint^ point = args->CurrentPoint;
-    uint32 pointerID = point->PointerId;
-    Point pointerPosition = point->Position;
     PointerPointProperties^ pointProperties = point->Properties;
-    auto pointerDevice = point->PointerDevice;
-    auto pointerDeviceType = pointerDevice->PointerDeviceType;
 
-    XMFLOAT2 position = XMFLOAT2(pointerPosition.X, pointerPosition.Y);
+    InputEvent inputEvent = {};
+    inputEvent.timestamp = InputEventQueue::Now();
+    inputEvent.type = type;
+    inputEvent.id = point->PointerId;
+    if (point->PointerDevice->PointerDeviceType == Windows::Devices::Input::PointerDeviceType::Touch)
+    {
+        inputEvent.flags |= InputEventFlags::Touch;
+    }
+    if (pointProperties->IsLeftButtonPressed)
+    {
+        inputEvent.flags |= InputEventFlags::LeftButton;
+    }
+    if (pointProperties->IsRightButtonPressed)
+    {
+        inputEvent.flags |= InputEventFlags::RightButton;
+    }
+    inputEvent.x = point->Position.X;
+    inputEvent.y = point->Position.Y;
+
+    m_inputQueue.Push(inputEvent);
+}
+
+//----------------------------------------------------------------------
+
+void MoveLookController::QueueKeyEvent(
+    _In_ InputEventType type,
+    _In_ KeyEventArgs^ args
+    )
+{
+    InputEvent inputEvent = {};
+    inputEvent.timestamp = InputEventQueue::Now();
+    inputEvent.type = type;
+    inputEvent.id = static_cast<uint32>(args->VirtualKey);
+
+    m_inputQueue.Push(inputEvent);
+}
+
+//----------------------------------------------------------------------
+
+void MoveLookController::OnPointerPressed(
+    _In_ CoreWindow^ /* sender */,
+    _In_ PointerEventArgs^ args
+    )
+{
+    QueuePointerEvent(InputEventType::PointerPressed, args);
+}
+
+//----------------------------------------------------------------------
+
+void MoveLookController::OnPointerMoved(
+    _In_ CoreWindow^ /* sender */,
+    _In_ PointerEventArgs^ args
+    )
+{
+    QueuePointerEvent(InputEventType::PointerMoved, args);
+}
+
+//----------------------------------------------------------------------
+
+void MoveLookController::OnMouseMoved(
+    _In_ MouseDevice^ /* mouseDevice */,
+    _In_ MouseEventArgs^ args
+    )
+{
+    InputEvent inputEvent = {};
+    inputEvent.timestamp = InputEventQueue::Now();
+    inputEvent.type = InputEventType::MouseDelta;
+    inputEvent.x = static_cast<float>(args->MouseDelta.X);
+    inputEvent.y = static_cast<float>(args->MouseDelta.Y);
+
+    m_inputQueue.Push(inputEvent);
+}
+
+//----------------------------------------------------------------------
+
+void MoveLookController::OnPointerReleased(
+    _In_ CoreWindow^ /* sender */,
+    _In_ PointerEventArgs^ args
+    )
+{
+    QueuePointerEvent(InputEventType::PointerReleased, args);
+}
+
+//----------------------------------------------------------------------
+
+void MoveLookController::OnPointerExited(
+    _In_ CoreWindow^ /* sender */,
+    _In_ PointerEventArgs^ args
+    )
+{
+    QueuePointerEvent(InputEventType::PointerExited, args);
+}
+
+//----------------------------------------------------------------------
+
+void MoveLookController::OnKeyDown(
+    _In_ CoreWindow^ /* sender */,
+    _In_ KeyEventArgs^ args
+    )
+{
+    QueueKeyEvent(InputEventType::KeyDown, args);
+}
+
+//----------------------------------------------------------------------
+
+void MoveLookController::OnKeyUp(
+    _In_ CoreWindow^ /* sender */,
+    _In_ KeyEventArgs^ args
+    )
+{
+    QueueKeyEvent(InputEventType::KeyUp, args);
+}
+
+//----------------------------------------------------------------------
+
+void MoveLookController::ApplyInputEvent(_In_ const InputEvent& inputEvent)
+{
+    switch (inputEvent.type)
+    {
+    case InputEventType::PointerPressed:
+        ApplyPointerPressed(inputEvent);
+        break;
+    case InputEventType::PointerMoved:
+        ApplyPointerMoved(inputEvent);
+        break;
+    case InputEventType::PointerReleased:
+        ApplyPointerReleased(inputEvent);
+        break;
+    case InputEventType::PointerExited:
+        ApplyPointerExited(inputEvent);
+        break;
+    case InputEventType::MouseDelta:
+        ApplyMouseDelta(inputEvent);
+        break;
+    case InputEventType::KeyDown:
+        ApplyKeyDown(inputEvent);
+        break;
+    case InputEventType::KeyUp:
+        ApplyKeyUp(inputEvent);
+        break;
+    case InputEventType::Gamepad:
+        ApplyGamepad(inputEvent);
+        break;
+    }
+}
+
+//----------------------------------------------------------------------
+
+void MoveLookController::ApplyPointerPressed(_In_ const InputEvent& inputEvent)
+{
+    uint32 pointerID = inputEvent.id;
+    XMFLOAT2 position = XMFLOAT2(inputEvent.x, inputEvent.y);
 
 #ifdef MOVELOOKCONTROLLER_TRACE
     DebugTrace(L"%-7s (%d) at (%4.0f, %4.0f)", L"Pressed", pointerID, position.x, position.y);
@@ -212,9 +368,9 @@ void MoveLookController::OnPointerPressed(
         break;
 
     case MoveLookControllerState::Active:
-        switch (pointerDeviceType)
+        switch (inputEvent.flags & InputEventFlags::Touch)
         {
-        case Windows::Devices::Input::PointerDeviceType::Touch:
+        case InputEventFlags::Touch:
             if (position.x > m_moveUpperLeft.x &&
                 position.x < m_moveLowerRight.x &&
                 position.y > m_moveUpperLeft.y &&
@@ -261,8 +417,8 @@ void MoveLookController::OnPointerPressed(
             break;
 
         default:
-            bool rightButton = pointProperties->IsRightButtonPressed;
-            bool leftButton = pointProperties->IsLeftButtonPressed;
+            bool rightButton = (inputEvent.flags & InputEventFlags::RightButton) != 0;
+            bool leftButton = (inputEvent.flags & InputEventFlags::LeftButton) != 0;
 
             if (!m_autoFire && (!m_mouseLeftInUse && leftButton))
             {
@@ -314,18 +470,10 @@ void MoveLookController::OnPointerPressed(
 
 //----------------------------------------------------------------------
 
-void MoveLookController::OnPointerMoved(
-    _In_ CoreWindow^ /* sender */,
-    _In_ PointerEventArgs^ args
-    )
+void MoveLookController::ApplyPointerMoved(_In_ const InputEvent& inputEvent)
 {
-    PointerPoint^ point = args->CurrentPoint;
-    uint32 pointerID = point->PointerId;
-    Point pointerPosition = point->Position;
-    PointerPointProperties^ pointProperties = point->Properties;
-    auto pointerDevice = point->PointerDevice;
-
-    XMFLOAT2 position = XMFLOAT2(pointerPosition.X, pointerPosition.Y);     // convert to allow math
+    uint32 pointerID = inputEvent.id;
+    XMFLOAT2 position = XMFLOAT2(inputEvent.x, inputEvent.y);
 
 #ifdef MOVELOOKCONTROLLER_TRACE
     DebugTrace(L"%-7s (%d) at (%4.0f, %4.0f)", L"Moved", pointerID, position.x, position.y);
@@ -380,8 +528,8 @@ void MoveLookController::OnPointerMoved(
         }
         else if (pointerID == m_mousePointerID)
         {
-            m_mouseLeftInUse  = pointProperties->IsLeftButtonPressed;
-            m_mouseRightInUse = pointProperties->IsRightButtonPressed;
+            m_mouseLeftInUse  = (inputEvent.flags & InputEventFlags::LeftButton) != 0;
+            m_mouseRightInUse = (inputEvent.flags & InputEventFlags::RightButton) != 0;
             m_mouseLastPoint = position;                            // Save for next time through.
         }
 
@@ -396,19 +544,16 @@ void MoveLookController::OnPointerMoved(
 
 //----------------------------------------------------------------------
 
-void MoveLookController::OnMouseMoved(
-    _In_ MouseDevice^ /* mouseDevice */,
-    _In_ MouseEventArgs^ args
-    )
+void MoveLookController::ApplyMouseDelta(_In_ const InputEvent& inputEvent)
 {
-    // Handle Mouse Input via dedicated relative movement handler.
+    // Mouse input comes from the dedicated relative movement handler.
 
     switch (m_state)
     {
     case MoveLookControllerState::Active:
         XMFLOAT2 mouseDelta;
-        mouseDelta.x = static_cast<float>(args->MouseDelta.X);
-        mouseDelta.y = static_cast<float>(args->MouseDelta.Y);
+        mouseDelta.x = inputEvent.x;
+        mouseDelta.y = inputEvent.y;
 
         XMFLOAT2 rotationDelta;
         rotationDelta.x = mouseDelta.x * MoveLookConstants::RotationGain;   // Scale for control sensitivity.
@@ -438,17 +583,10 @@ void MoveLookController::OnMouseMoved(
 
 //----------------------------------------------------------------------
 
-void MoveLookController::OnPointerReleased(
-    _In_ CoreWindow^ /* sender */,
-    _In_ PointerEventArgs^ args
-    )
+void MoveLookController::ApplyPointerReleased(_In_ const InputEvent& inputEvent)
 {
-    PointerPoint^ point = args->CurrentPoint;
-    uint32 pointerID = point->PointerId;
-    Point pointerPosition = point->Position;
-    PointerPointProperties^ pointProperties = point->Properties;
-
-    XMFLOAT2 position = XMFLOAT2(pointerPosition.X, pointerPosition.Y);
+    uint32 pointerID = inputEvent.id;
+    XMFLOAT2 position = XMFLOAT2(inputEvent.x, inputEvent.y);
 
 #ifdef MOVELOOKCONTROLLER_TRACE
     DebugTrace(L"%-7s (%d) at (%4.0f, %4.0f)\n", L"Release", pointerID, position.x, position.y);
@@ -486,8 +624,8 @@ void MoveLookController::OnPointerReleased(
         }
         else if (pointerID == m_mousePointerID)
         {
-            bool rightButton = pointProperties->IsRightButtonPressed;
-            bool leftButton = pointProperties->IsLeftButtonPressed;
+            bool rightButton = (inputEvent.flags & InputEventFlags::RightButton) != 0;
+            bool leftButton = (inputEvent.flags & InputEventFlags::LeftButton) != 0;
 
             m_mouseInUse = false;
 
@@ -501,17 +639,10 @@ void MoveLookController::OnPointerReleased(
 
 //----------------------------------------------------------------------
 
-void MoveLookController::OnPointerExited(
-    _In_ CoreWindow^ /* sender */,
-    _In_ PointerEventArgs^ args
-    )
+void MoveLookController::ApplyPointerExited(_In_ const InputEvent& inputEvent)
 {
-    PointerPoint^ point = args->CurrentPoint;
-    uint32 pointerID = point->PointerId;
-    Point pointerPosition = point->Position;
-    PointerPointProperties^ pointProperties = point->Properties;
-
-    XMFLOAT2 position  = XMFLOAT2(pointerPosition.X, pointerPosition.Y);
+    uint32 pointerID = inputEvent.id;
+    XMFLOAT2 position = XMFLOAT2(inputEvent.x, inputEvent.y);
 
 #ifdef MOVELOOKCONTROLLER_TRACE
     DebugTrace(L"%-7s (%d) at (%4.0f, %4.0f)\n", L"Exit", pointerID, position.x, position.y);
@@ -560,13 +691,10 @@ void MoveLookController::OnPointerExited(
 
 //----------------------------------------------------------------------
 
-void MoveLookController::OnKeyDown(
-    _In_ CoreWindow^ /* sender */,
-    _In_ KeyEventArgs^ args
-    )
+void MoveLookController::ApplyKeyDown(_In_ const InputEvent& inputEvent)
 {
     Windows::System::VirtualKey Key;
-    Key = args->VirtualKey;
+    Key = static_cast<VirtualKey>(inputEvent.id);
 
     // Figure out the command from the keyboard.
     if (Key == VirtualKey::W)
@@ -587,13 +715,10 @@ void MoveLookController::OnKeyDown(
 
 //----------------------------------------------------------------------
 
-void MoveLookController::OnKeyUp(
-    _In_ CoreWindow^ /* sender */,
-    _In_ KeyEventArgs^ args
-    )
+void MoveLookController::ApplyKeyUp(_In_ const InputEvent& inputEvent)
 {
     Windows::System::VirtualKey Key;
-    Key = args->VirtualKey;
+    Key = static_cast<VirtualKey>(inputEvent.id);
 
     // Figure out the command from the keyboard.
     if (Key == VirtualKey::W)
@@ -647,11 +772,12 @@ void MoveLookController::ResetState()
     m_up = false;
     m_down = false;
     m_pause = false;
+    m_lastGamepadTimestamp = 0;
 }
 
 //----------------------------------------------------------------------
 
-void MoveLookController::UpdatePollingDevices()
+void MoveLookController::PollGamepad()
 {
     if (m_gamepadsChanged)
     {
@@ -679,12 +805,47 @@ void MoveLookController::UpdatePollingDevices()
         return;
     }
 
+    // The reading is taken on the game loop thread, so it goes straight into this frame's
+    // events after the queued ones instead of through the queue.
     GamepadReading reading = m_activeGamepad->GetCurrentReading();
 
+    InputEvent inputEvent = {};
+    inputEvent.timestamp = InputEventQueue::Now();
+    inputEvent.type = InputEventType::Gamepad;
+    inputEvent.id = static_cast<uint32>(reading.Buttons);
+    inputEvent.x = static_cast<float>(reading.LeftThumbstickX);
+    inputEvent.y = static_cast<float>(reading.LeftThumbstickY);
+    inputEvent.z = static_cast<float>(reading.RightThumbstickX);
+    inputEvent.w = static_cast<float>(reading.RightThumbstickY);
+    inputEvent.trigger = static_cast<float>(reading.RightTrigger);
+
+    m_frameEvents.push_back(inputEvent);
+}
+
+//----------------------------------------------------------------------
+
+void MoveLookController::ApplyGamepad(_In_ const InputEvent& inputEvent)
+{
+    GamepadButtons buttons = static_cast<GamepadButtons>(inputEvent.id);
+
+    // The look rate is per second, so scale it by the time since the previous reading.
+    // The first reading after a reset, and a reading after a long stall, count as one
+    // nominal frame.
+    float elapsed = MoveLookConstants::NominalFrameTime;
+    if (m_lastGamepadTimestamp != 0 && inputEvent.timestamp > m_lastGamepadTimestamp)
+    {
+        elapsed = static_cast<float>(inputEvent.timestamp - m_lastGamepadTimestamp) / 1000000.0f;
+        if (elapsed > MoveLookConstants::MaxGamepadStepTime)
+        {
+            elapsed = MoveLookConstants::NominalFrameTime;
+        }
+    }
+    m_lastGamepadTimestamp = inputEvent.timestamp;
+
     switch (m_state)
     {
     case MoveLookControllerState::WaitForInput:
-        if ((reading.Buttons & GamepadButtons::Menu) == GamepadButtons::Menu)
+        if ((buttons & GamepadButtons::Menu) == GamepadButtons::Menu)
         {
             m_gamepadStartButtonInUse = true;
         }
@@ -697,7 +858,7 @@ void MoveLookController::UpdatePollingDevices()
         break;
 
     case MoveLookControllerState::Active:
-        if ((reading.Buttons & GamepadButtons::Menu) == GamepadButtons::Menu)
+        if ((buttons & GamepadButtons::Menu) == GamepadButtons::Menu)
         {
             m_gamepadStartButtonInUse = true;
         }
@@ -710,17 +871,17 @@ void MoveLookController::UpdatePollingDevices()
         // Use the left thumbstick on the game controller to control
         // the eye point position control. Thumbstick input is defined from [-1, 1].
         // We use a deadzone in the middle range to avoid drift.
-        if (reading.LeftThumbstickX > THUMBSTICK_DEADZONE ||
-            reading.LeftThumbstickX < -THUMBSTICK_DEADZONE)
+        if (inputEvent.x > THUMBSTICK_DEADZONE ||
+            inputEvent.x < -THUMBSTICK_DEADZONE)
         {
-            float x = static_cast<float>(reading.LeftThumbstickX);
+            float x = inputEvent.x;
             m_moveCommand.x -= (x > 0) ? 1 : -1;
         }
 
-        if (reading.LeftThumbstickY > THUMBSTICK_DEADZONE ||
-            reading.LeftThumbstickY < -THUMBSTICK_DEADZONE)
+        if (inputEvent.y > THUMBSTICK_DEADZONE ||
+            inputEvent.y < -THUMBSTICK_DEADZONE)
         {
-            float y = static_cast<float>(reading.LeftThumbstickY);
+            float y = inputEvent.y;
             m_moveCommand.y += (y > 0) ? 1 : -1;
         }
 
@@ -728,10 +889,10 @@ void MoveLookController::UpdatePollingDevices()
         // the look at control. Thumbstick input is defined from [-1, 1].
         // We use a deadzone in the middle range to avoid drift.
         XMFLOAT2 pointerDelta;
-        if (reading.RightThumbstickX > THUMBSTICK_DEADZONE ||
-            reading.RightThumbstickX < -THUMBSTICK_DEADZONE)
+        if (inputEvent.z > THUMBSTICK_DEADZONE ||
+            inputEvent.z < -THUMBSTICK_DEADZONE)
         {
-            float x = static_cast<float>(reading.RightThumbstickX);
+            float x = inputEvent.z;
             pointerDelta.x = x * x * x;
         }
         else
@@ -739,10 +900,10 @@ void MoveLookController::UpdatePollingDevices()
             pointerDelta.x = 0.0f;
         }
 
-        if (reading.RightThumbstickY > THUMBSTICK_DEADZONE ||
-            reading.RightThumbstickY < -THUMBSTICK_DEADZONE)
+        if (inputEvent.w > THUMBSTICK_DEADZONE ||
+            inputEvent.w < -THUMBSTICK_DEADZONE)
         {
-            float y = static_cast<float>(reading.RightThumbstickY);
+            float y = inputEvent.w;
             pointerDelta.y = y * y * y;
         }
         else
@@ -751,8 +912,8 @@ void MoveLookController::UpdatePollingDevices()
         }
 
         XMFLOAT2 rotationDelta;
-        rotationDelta.x = pointerDelta.x *  0.08f;       // Scale for control sensitivity.
-        rotationDelta.y = pointerDelta.y *  0.08f;
+        rotationDelta.x = pointerDelta.x * MoveLookConstants::GamepadLookRate * elapsed;   // Scale for control sensitivity.
+        rotationDelta.y = pointerDelta.y * MoveLookConstants::GamepadLookRate * elapsed;
 
         // Update our orientation based on the command.
         m_pitch += rotationDelta.y;
@@ -764,7 +925,7 @@ void MoveLookController::UpdatePollingDevices()
 
         // Check the state of the Right Trigger button.  This is used to indicate fire control.
 
-        if (reading.RightTrigger > TRIGGER_DEADZONE)
+        if (inputEvent.trigger > TRIGGER_DEADZONE)
         {
             if (!m_autoFire && !m_gamepadTriggerInUse)
             {
@@ -1002,9 +1163,79 @@ bool MoveLookController::AutoFire()
 
 //----------------------------------------------------------------------
 
+void MoveLookController::StartRecording()
+{
+    m_recordedInput.Clear();
+    m_recording = true;
+}
+
+//----------------------------------------------------------------------
+
+void MoveLookController::StopRecording()
+{
+    m_recording = false;
+}
+
+//----------------------------------------------------------------------
+
+const InputRecording& MoveLookController::RecordedInput()
+{
+    return m_recordedInput;
+}
+
+//----------------------------------------------------------------------
+
+void MoveLookController::StartReplay(_In_ const InputRecording& recording)
+{
+    m_recording = false;
+    m_replayInput = recording;
+    m_replayFrame = 0;
+    m_replaying = true;
+    m_lastGamepadTimestamp = 0;
+}
+
+//----------------------------------------------------------------------
+
+bool MoveLookController::IsReplaying()
+{
+    return m_replaying;
+}
+
+//----------------------------------------------------------------------
+
+uint64 MoveLookController::DroppedInputEvents()
+{
+    return m_inputQueue.DroppedCount();
+}
+
+//----------------------------------------------------------------------
+
 void MoveLookController::Update()
 {
-    UpdatePollingDevices();
+    // Gather this frame's input: the events queued by the input handlers since the last
+    // update followed by a gamepad reading, or the next frame of a replay.  Applying them
+    // in order here keeps all controller state on the game loop thread.
+    m_frameEvents.clear();
+    if (m_replaying)
+    {
+        m_inputQueue.Clear();
+        m_replaying = m_replayInput.GetFrame(m_replayFrame++, m_frameEvents);
+    }
+    else
+    {
+        m_inputQueue.Drain(m_frameEvents);
+        PollGamepad();
+        InputEventQueue::Coalesce(m_frameEvents);
+        if (m_recording)
+        {
+            m_recordedInput.AddFrame(m_frameEvents);
+        }
+    }
+
+    for (const auto& inputEvent : m_frameEvents)
+    {
+        ApplyInputEvent(inputEvent);
+    }
 
     if (m_moveInUse)
     {
@@ -11,6 +11,8 @@
 
 #pragma once
 
+#include "InputEventQueue.h"
+
 // MoveLookController:
 // This is the class that handles input events and turns it into player
 // intent for movement ("move") camera ("look") and other actions.
@@ -68,8 +70,8 @@
 //     P key - is mapped to IsPauseRequested
 //
 // This class enables game controllers (e.g. Xbox controller) which follow a polling model:
-//      UpdatePollingDevices - will be called at the beginning of update
-//          and as a part of checking for pause requests
+//      PollGamepad - will be called at the beginning of update to add a reading
+//          to the input for the frame
 //      PollingFireInUse - can use used to indicate a fire button is 
 //          currently depressed.
 //      ResetState - can be augumented to reset an stored state associated
@@ -79,7 +81,8 @@
 //     GamepadButtons::Menu - is mapped to IsPressComplete in the WaitForInput state and
 //         IsPauseRequested in the Active state.
 //     Left Thumb stick - is mapped to the move control in Active mode
-//     Right Thumb stick - is mapped to the look control in Active mode
+//     Right Thumb stick - is mapped to the look control in Active mode.  The look rate
+//         is per second, so it does not change with the frame rate
 //     Right Trigger - is mapped to IsFiring in Active mode or "Fire" button.
 //
 // Because the MoveLookController can be use in a variety of environments
@@ -90,9 +93,16 @@
 // used in a CoreWindow/DirectX app.
 //
 // The MoveLookController collects input from each of the input events.
-// On the Update method it calls UpdatePollingDevices to update state.
-// All the inputs are coalesced and merged to generate a velocity vector
-// and update the Pitch and Yaw values.
+// The input handlers only add a timestamped InputEvent to a lock-free queue, so
+// they never touch the controller state from the window's thread.  The Update
+// method drains the queue, adds a gamepad reading, coalesces redundant pointer and
+// mouse moves, and then applies the events in order.  All the inputs are merged
+// to generate a velocity vector and update the Pitch and Yaw values.
+// IsPressComplete and IsPauseRequested report the input applied by the last Update.
+//
+// The events applied in each Update can be recorded and later replayed in place of
+// live input (StartRecording, StartReplay), which reproduces the controller output
+// frame by frame.
 
 // Uncomment the next line to print debug tracing information.
 // #define MOVELOOKCONTROLLER_TRACE 1
@@ -108,6 +118,9 @@ namespace MoveLookConstants
 {
     static const float RotationGain = 0.008f;       // Sensitivity adjustment for look controller.
     static const float MovementGain = 2.0f;         // Sensitivity adjustment for move controller.
+    static const float GamepadLookRate = 4.8f;      // Radians per second at full deflection of the right thumbstick.
+    static const float NominalFrameTime = 1.0f / 60.0f;
+    static const float MaxGamepadStepTime = 0.1f;   // Longer gaps between readings count as one nominal frame.
 };
 
 ref class MoveLookController
@@ -154,13 +167,43 @@ internal:
     bool AutoFire();
     void AutoFire(_In_ bool AutoFire);
 
+    // Recording keeps the events applied by each Update.  A replay applies one recorded
+    // frame per Update instead of live input until it runs out.
+    void StartRecording();
+    void StopRecording();
+    const InputRecording& RecordedInput();
+    void StartReplay(_In_ const InputRecording& recording);
+    bool IsReplaying();
+
+    // Events lost because the queue was full.
+    uint64 DroppedInputEvents();
+
 private:
     void ResetState();
-    void UpdatePollingDevices();
+    void PollGamepad();
     bool PollingFireInUse() { return m_gamepadTriggerInUse; }
     void ShowCursor();
     void HideCursor();
 
+    void QueuePointerEvent(
+        _In_ InputEventType type,
+        _In_ Windows::UI::Core::PointerEventArgs^ args
+        );
+    void QueueKeyEvent(
+        _In_ InputEventType type,
+        _In_ Windows::UI::Core::KeyEventArgs^ args
+        );
+
+    void ApplyInputEvent(_In_ const InputEvent& inputEvent);
+    void ApplyPointerPressed(_In_ const InputEvent& inputEvent);
+    void ApplyPointerMoved(_In_ const InputEvent& inputEvent);
+    void ApplyPointerReleased(_In_ const InputEvent& inputEvent);
+    void ApplyPointerExited(_In_ const InputEvent& inputEvent);
+    void ApplyMouseDelta(_In_ const InputEvent& inputEvent);
+    void ApplyKeyDown(_In_ const InputEvent& inputEvent);
+    void ApplyKeyUp(_In_ const InputEvent& inputEvent);
+    void ApplyGamepad(_In_ const InputEvent& inputEvent);
+
     void OnPointerPressed(
         _In_ Windows::UI::Core::CoreWindow^ sender,
         _In_ Windows::UI::Core::PointerEventArgs^ args
@@ -269,4 +312,15 @@ private:
     std::atomic<bool>                   m_gamepadsChanged;
     bool                                m_gamepadStartButtonInUse;
     bool                                m_gamepadTriggerInUse;
+    uint64                              m_lastGamepadTimestamp;     // Zero until the first reading after a reset.
+
+    // Input events waiting for the next Update, and the events applied by it.
+    InputEventQueue                     m_inputQueue;
+    std::vector<InputEvent>             m_frameEvents;
+
+    bool                                m_recording;
+    InputRecording                      m_recordedInput;
+    bool                                m_replaying;
+    InputRecording                      m_replayInput;
+    uint32                              m_replayFrame;
 };
@@ -0,0 +1,200 @@
+//********************************************************* 
+// 
+// Copyright (c) Microsoft. All rights reserved. 
+// This code is licensed under the MIT License (MIT). 
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF 
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY 
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR 
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT. 
+// 
+//*********************************************************
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <cmath>
+
+//--------------------------------------------------------------------------------
+
+RenderQueue::RenderQueue() :
+    m_stats()
+{
+}
+
+//--------------------------------------------------------------------------------
+
+void RenderQueue::Clear()
+{
+    m_items.clear();
+    m_order.clear();
+    m_batches.clear();
+    m_drawOrder.clear();
+    m_instanceData.clear();
+    m_stats = RenderQueueStats();
+}
+
+//--------------------------------------------------------------------------------
+
+void RenderQueue::Reserve(size_t itemCount)
+{
+    m_items.reserve(itemCount);
+    m_order.reserve(itemCount);
+    m_drawOrder.reserve(itemCount);
+    m_instanceData.reserve(itemCount * 16);
+}
+
+//--------------------------------------------------------------------------------
+
+void RenderQueue::Add(const RenderQueueItem& item)
+{
+    m_items.push_back(item);
+}
+
+//--------------------------------------------------------------------------------
+
+void RenderQueue::Build(const RenderFrustum* frusta, size_t frustumCount)
+{
+    m_order.clear();
+    m_batches.clear();
+    m_drawOrder.clear();
+    m_instanceData.clear();
+
+    for (uint32_t i = 0; i < m_items.size(); i++)
+    {
+        if (IsVisible(m_items[i], frusta, frustumCount))
+        {
+            m_order.push_back(std::make_pair(m_items[i].sortKey, i));
+        }
+    }
+
+    // The item index is the second half of the pair, so equal keys stay in submission order.
+    std::sort(m_order.begin(), m_order.end());
+
+    m_instanceData.resize(m_order.size() * 16);
+    float* instance = m_instanceData.data();
+    for (const auto& entry : m_order)
+    {
+        const RenderQueueItem& item = m_items[entry.second];
+        uint32_t position = static_cast<uint32_t>(m_drawOrder.size());
+
+        if (m_batches.empty() || m_batches.back().sortKey != item.sortKey)
+        {
+            RenderBatch batch = { item.sortKey, position, 0 };
+            m_batches.push_back(batch);
+        }
+        m_batches.back().instanceCount++;
+
+        m_drawOrder.push_back(item.objectIndex);
+        std::copy(item.world, item.world + 16, instance);
+        instance += 16;
+    }
+
+    m_stats.submitted = static_cast<uint32_t>(m_items.size());
+    m_stats.culled = static_cast<uint32_t>(m_items.size() - m_order.size());
+    m_stats.batches = static_cast<uint32_t>(m_batches.size());
+}
+
+//--------------------------------------------------------------------------------
+
+bool RenderQueue::IsVisible(const RenderQueueItem& item, const RenderFrustum* frusta, size_t frustumCount)
+{
+    if (frustumCount == 0 || item.boundsRadius <= 0.0f)
+    {
+        return true;
+    }
+
+    for (size_t f = 0; f < frustumCount; f++)
+    {
+        bool inside = true;
+        for (int p = 0; p < 6 && inside; p++)
+        {
+            const float* plane = frusta[f].planes[p];
+            float distance =
+                plane[0] * item.boundsCenter[0] +
+                plane[1] * item.boundsCenter[1] +
+                plane[2] * item.boundsCenter[2] +
+                plane[3];
+            inside = distance >= -item.boundsRadius;
+        }
+
+        if (inside)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//--------------------------------------------------------------------------------
+
+uint64_t RenderQueue::MakeSortKey(uint32_t pipelineId, uint32_t materialId, uint32_t meshId)
+{
+    return
+        (static_cast<uint64_t>(pipelineId & 0xFFFF) << 48) |
+        (static_cast<uint64_t>(materialId & 0xFFFFFF) << 24) |
+        static_cast<uint64_t>(meshId & 0xFFFFFF);
+}
+
+//--------------------------------------------------------------------------------
+
+void RenderQueue::ExtractFrustum(const float viewProjection[16], RenderFrustum* frustum)
+{
+    // With row vectors, clip space coordinate c is the dot product of the position with column c.
+    auto column = [viewProjection](int c, int r) { return viewProjection[r * 4 + c]; };
+
+    for (int r = 0; r < 4; r++)
+    {
+        frustum->planes[0][r] = column(3, r) + column(0, r);    // Left
+        frustum->planes[1][r] = column(3, r) - column(0, r);    // Right
+        frustum->planes[2][r] = column(3, r) + column(1, r);    // Bottom
+        frustum->planes[3][r] = column(3, r) - column(1, r);    // Top
+        frustum->planes[4][r] = column(2, r);                   // Near
+        frustum->planes[5][r] = column(3, r) - column(2, r);    // Far
+    }
+
+    for (auto& plane : frustum->planes)
+    {
+        float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length > 0.0f)
+        {
+            for (auto& value : plane)
+            {
+                value /= length;
+            }
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------
+
+void RenderQueue::TransformBounds(
+    const float world[16],
+    const float localCenter[3],
+    float localRadius,
+    float center[3],
+    float* radius
+    )
+{
+    for (int c = 0; c < 3; c++)
+    {
+        center[c] =
+            localCenter[0] * world[0 * 4 + c] +
+            localCenter[1] * world[1 * 4 + c] +
+            localCenter[2] * world[2 * 4 + c] +
+            world[3 * 4 + c];
+    }
+
+    float maxScaleSquared = 0.0f;
+    for (int r = 0; r < 3; r++)
+    {
+        float scaleSquared =
+            world[r * 4 + 0] * world[r * 4 + 0] +
+            world[r * 4 + 1] * world[r * 4 + 1] +
+            world[r * 4 + 2] * world[r * 4 + 2];
+        maxScaleSquared = (std::max)(maxScaleSquared, scaleSquared);
+    }
+
+    *radius = localRadius * std::sqrt(maxScaleSquared);
+}
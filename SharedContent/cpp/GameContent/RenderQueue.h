@@ -0,0 +1,112 @@
+//********************************************************* 
+// 
+// Copyright (c) Microsoft. All rights reserved. 
+// This code is licensed under the MIT License (MIT). 
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF 
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY 
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR 
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT. 
+// 
+//*********************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// One object submitted to the RenderQueue.
+struct RenderQueueItem
+{
+    uint64_t    sortKey;            // Items with equal keys are drawn together as one batch.
+    uint32_t    objectIndex;        // Caller's index of the object, handed back in draw order.
+    float       world[16];          // Row major object to world matrix; copied to the instance data.
+    float       boundsCenter[3];    // World space bounding sphere.
+    float       boundsRadius;       // A radius of zero (or less) means the item is never culled.
+};
+
+// A run of consecutive instances that share a sort key.
+struct RenderBatch
+{
+    uint64_t    sortKey;
+    uint32_t    firstInstance;      // Index into the instance data and draw order lists.
+    uint32_t    instanceCount;
+};
+
+// Six planes (a, b, c, d) with a*x + b*y + c*z + d >= 0 inside the frustum.
+struct RenderFrustum
+{
+    float       planes[6][4];
+};
+
+struct RenderQueueStats
+{
+    uint32_t    submitted;
+    uint32_t    culled;
+    uint32_t    batches;
+};
+
+// RenderQueue:
+// Builds the list of draws for a frame.  Objects are submitted with a sort key describing
+// their pipeline state (shaders, material and mesh), culled against one or more view frusta,
+// sorted by key and grouped into batches of identical state so that each batch can be
+// issued as a single instanced draw.  The world matrices of the visible objects are packed
+// contiguously in batch order so they can be copied into one dynamic instance buffer.
+//
+// When rendering in stereo the queue is built once against both eye frusta and replayed
+// for each eye.  This class only depends on the C++ standard library.
+
+class RenderQueue
+{
+public:
+    static const uint32_t InstanceStride = 16 * sizeof(float);
+
+    RenderQueue();
+
+    void Clear();
+    void Reserve(size_t itemCount);
+    void Add(const RenderQueueItem& item);
+
+    // Culls, sorts and batches the submitted items.  An item is kept if its bounds intersect
+    // any of the frusta; if frustumCount is zero nothing is culled.  Items with equal keys keep
+    // their submission order.
+    void Build(const RenderFrustum* frusta, size_t frustumCount);
+
+    const std::vector<RenderBatch>& Batches() const { return m_batches; }
+
+    // Object indices and world matrices of the visible items, in draw order.
+    const std::vector<uint32_t>& DrawOrder() const { return m_drawOrder; }
+    const float* InstanceData() const { return m_instanceData.data(); }
+    uint32_t InstanceCount() const { return static_cast<uint32_t>(m_drawOrder.size()); }
+
+    RenderQueueStats Stats() const { return m_stats; }
+
+    // Packs the pipeline, material and mesh ids into a key so that items sort by shaders first,
+    // then by material and then by mesh.  The ids are truncated to 16, 24 and 24 bits.
+    static uint64_t MakeSortKey(uint32_t pipelineId, uint32_t materialId, uint32_t meshId);
+
+    // Extracts the frustum planes from a row major (row vector) view projection matrix that maps
+    // to clip space with 0 <= z <= w.  The planes are normalized.
+    static void ExtractFrustum(const float viewProjection[16], RenderFrustum* frustum);
+
+    // Transforms a local bounding sphere by a row major world matrix.  The radius is scaled by the
+    // largest axis scale so the result stays conservative for non-uniform scales.
+    static void TransformBounds(
+        const float world[16],
+        const float localCenter[3],
+        float localRadius,
+        float center[3],
+        float* radius
+        );
+
+private:
+    static bool IsVisible(const RenderQueueItem& item, const RenderFrustum* frusta, size_t frustumCount);
+
+    std::vector<RenderQueueItem>                    m_items;
+    std::vector<std::pair<uint64_t, uint32_t>>      m_order;       // (sort key, item index) of visible items.
+    std::vector<RenderBatch>                        m_batches;
+    std::vector<uint32_t>                           m_drawOrder;
+    std::vector<float>                              m_instanceData;
+    RenderQueueStats                                m_stats;
+};
@@ -14,7 +14,9 @@
 #include "DirectXSample.h"
 
 SoundEffect::SoundEffect():
-    m_audioAvailable(false)
+    m_audioAvailable(false),
+    m_mixer(nullptr),
+    m_mixerSound(0)
 {
 }
 
@@ -26,6 +28,7 @@ void SoundEffect::Initialize(
     _In_ Platform::Array<byte>^ soundData)
 {
     m_soundData = soundData;
+    m_cachedSoundData = nullptr;
 
     if (masteringEngine == nullptr)
     {
@@ -46,6 +49,33 @@ void SoundEffect::Initialize(
 
 //----------------------------------------------------------------------
 
+void SoundEffect::Initialize(
+    _In_ IXAudio2 *masteringEngine,
+    _In_ WAVEFORMATEX *sourceFormat,
+    _In_ std::shared_ptr<const DecodedAudio> soundData)
+{
+    // Holding the cached data keeps it resident for as long as this sound effect exists.
+    Initialize(masteringEngine, sourceFormat, static_cast<Platform::Array<byte>^>(nullptr));
+    m_cachedSoundData = soundData;
+}
+
+//----------------------------------------------------------------------
+
+void SoundEffect::Initialize(
+    _In_ SoundEffectMixer^ mixer,
+    _In_ uint32 mixerSound)
+{
+    // The mixer holds the sound data and the voices, so this sound effect needs neither.
+    m_soundData = nullptr;
+    m_cachedSoundData = nullptr;
+    m_audioAvailable = false;
+
+    m_mixer = mixer;
+    m_mixerSound = mixerSound;
+}
+
+//----------------------------------------------------------------------
+
 void SoundEffect::PlaySound(_In_ float volume)
 {
     XAUDIO2_BUFFER buffer = {0};
@@ -65,8 +95,16 @@ void SoundEffect::PlaySound(_In_ float volume)
         );
 
     // Queue the memory buffer for playback and start the voice.
-    buffer.AudioBytes = m_soundData->Length;
-    buffer.pAudioData = m_soundData->Data;
+    if (m_cachedSoundData)
+    {
+        buffer.AudioBytes = static_cast<UINT32>(m_cachedSoundData->data.size());
+        buffer.pAudioData = m_cachedSoundData->data.data();
+    }
+    else
+    {
+        buffer.AudioBytes = m_soundData->Length;
+        buffer.pAudioData = m_soundData->Data;
+    }
     buffer.Flags = XAUDIO2_END_OF_STREAM;
 
     DX::ThrowIfFailed(
@@ -81,3 +119,27 @@ void SoundEffect::PlaySound(_In_ float volume)
 }
 
 //----------------------------------------------------------------------
+
+void SoundEffect::PlaySound(
+    _In_ float volume,
+    _In_ float impactSpeed,
+    _In_ float distanceSquared,
+    _In_ uint32 source
+    )
+{
+    if (m_mixer == nullptr)
+    {
+        PlaySound(volume);
+        return;
+    }
+
+    SoundEvent soundEvent;
+    soundEvent.sound = m_mixerSound;
+    soundEvent.source = source;
+    soundEvent.volume = volume;
+    soundEvent.impactSpeed = impactSpeed;
+    soundEvent.distanceSquared = distanceSquared;
+    m_mixer->Queue(soundEvent);
+}
+
+//----------------------------------------------------------------------
@@ -11,10 +11,17 @@
 
 #pragma once
 
+#include "DecodedAudioCache.h"
+#include "SoundEffectMixer.h"
+
 // SoundEffect:
 // This class plays a sound using XAudio2.  It uses a mastering voice provided
 // from the Audio class.  The sound data can be read from disk using the MediaReader
-// class.
+// class; sound effects loaded with MediaReader::LoadCachedMedia share one decoded
+// copy of each file.
+// A sound effect initialized with a SoundEffectMixer has no voice of its own; the
+// impacts passed to PlaySound are queued on the mixer, which plays them at the end
+// of the frame on its shared voices.
 
 ref class SoundEffect
 {
@@ -27,10 +34,33 @@ internal:
         _In_ Platform::Array<byte>^ soundData
         );
 
+    void Initialize(
+        _In_ IXAudio2*                              masteringEngine,
+        _In_ WAVEFORMATEX*                          sourceFormat,
+        _In_ std::shared_ptr<const DecodedAudio>    soundData
+        );
+
+    void Initialize(
+        _In_ SoundEffectMixer^  mixer,
+        _In_ uint32             mixerSound
+        );
+
     void PlaySound(_In_ float volume);
 
+    // source identifies the object making the sound, so that its impacts in one frame
+    // can be merged.  Without a mixer this is the same as PlaySound(volume).
+    void PlaySound(
+        _In_ float  volume,
+        _In_ float  impactSpeed,
+        _In_ float  distanceSquared,
+        _In_ uint32 source
+        );
+
 protected private:
     bool                    m_audioAvailable;
     IXAudio2SourceVoice*    m_sourceVoice;
     Platform::Array<byte>^  m_soundData;
+    std::shared_ptr<const DecodedAudio> m_cachedSoundData;
+    SoundEffectMixer^       m_mixer;
+    uint32                  m_mixerSound;
 };
@@ -0,0 +1,135 @@
+//********************************************************* 
+// 
+// Copyright (c) Microsoft. All rights reserved. 
+// This code is licensed under the MIT License (MIT). 
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF 
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY 
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR 
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT. 
+// 
+//*********************************************************
+
+
+#include "pch.h"
+#include "SoundEffectMixer.h"
+#include "DirectXSample.h"
+
+SoundEffectMixer::SoundEffectMixer() :
+    m_audioAvailable(false),
+    m_bytesPerSecond(0),
+    m_operationSet(0)
+{
+}
+
+//----------------------------------------------------------------------
+
+void SoundEffectMixer::Initialize(
+    _In_ IXAudio2* masteringEngine,
+    _In_ WAVEFORMATEX* sourceFormat,
+    _In_ uint32 voiceCount,
+    _In_ float maxDistance
+    )
+{
+    m_mixer.reset(new SoundMixer(voiceCount, maxDistance));
+    m_bytesPerSecond = sourceFormat->nAvgBytesPerSec;
+
+    if (masteringEngine == nullptr)
+    {
+        // Audio is not available, events are still mixed but nothing is played.
+        m_audioAvailable = false;
+        return;
+    }
+
+    m_masteringEngine = masteringEngine;
+    m_voices.resize(m_mixer->VoiceCount());
+    for (auto& voice : m_voices)
+    {
+        DX::ThrowIfFailed(
+            masteringEngine->CreateSourceVoice(
+                &voice,
+                sourceFormat
+                )
+            );
+    }
+    m_audioAvailable = true;
+}
+
+//----------------------------------------------------------------------
+
+uint32 SoundEffectMixer::AddSound(_In_ std::shared_ptr<const DecodedAudio> soundData)
+{
+    // The mixer only needs to know how long the sound plays for.
+    float duration = (m_bytesPerSecond != 0) ?
+        static_cast<float>(soundData->data.size()) / static_cast<float>(m_bytesPerSecond) :
+        0.0f;
+
+    m_sounds.push_back(soundData);
+    return m_mixer->AddSound(duration);
+}
+
+//----------------------------------------------------------------------
+
+void SoundEffectMixer::Queue(_In_ const SoundEvent& soundEvent)
+{
+    m_mixer->Queue(soundEvent);
+}
+
+//----------------------------------------------------------------------
+
+void SoundEffectMixer::Submit(_In_ float elapsedSeconds)
+{
+    const std::vector<SoundVoiceStart>& starts = m_mixer->Mix(elapsedSeconds);
+    if (!m_audioAvailable || starts.empty())
+    {
+        return;
+    }
+
+    // Each frame gets its own operation set, so the sounds of a frame start together.
+    // XAUDIO2_COMMIT_NOW is reserved for changes that apply immediately.
+    if (++m_operationSet == XAUDIO2_COMMIT_NOW)
+    {
+        m_operationSet++;
+    }
+
+    for (const auto& start : starts)
+    {
+        IXAudio2SourceVoice* voice = m_voices[start.voice];
+        const DecodedAudio& sound = *m_sounds[start.sound];
+
+        // Interrupt whatever the voice is currently playing.
+        DX::ThrowIfFailed(
+            voice->Stop()
+            );
+        DX::ThrowIfFailed(
+            voice->FlushSourceBuffers()
+            );
+
+        XAUDIO2_BUFFER buffer = {0};
+        buffer.AudioBytes = static_cast<UINT32>(sound.data.size());
+        buffer.pAudioData = sound.data.data();
+        buffer.Flags = XAUDIO2_END_OF_STREAM;
+
+        DX::ThrowIfFailed(
+            voice->SetVolume(start.volume, m_operationSet)
+            );
+        DX::ThrowIfFailed(
+            voice->SubmitSourceBuffer(&buffer)
+            );
+        DX::ThrowIfFailed(
+            voice->Start(0, m_operationSet)
+            );
+    }
+
+    DX::ThrowIfFailed(
+        m_masteringEngine->CommitChanges(m_operationSet)
+        );
+}
+
+//----------------------------------------------------------------------
+
+SoundMixerStats SoundEffectMixer::GetStats()
+{
+    return m_mixer->GetStats();
+}
+
+//----------------------------------------------------------------------
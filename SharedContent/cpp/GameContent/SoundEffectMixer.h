@@ -0,0 +1,53 @@
+//********************************************************* 
+// 
+// Copyright (c) Microsoft. All rights reserved. 
+// This code is licensed under the MIT License (MIT). 
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF 
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY 
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR 
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT. 
+// 
+//*********************************************************
+
+
+#pragma once
+
+#include "DecodedAudioCache.h"
+#include "SoundMixer.h"
+
+// SoundEffectMixer:
+// Plays the impact sounds of every object on a fixed pool of XAudio2 source voices.
+// Sound effects initialized with a mixer queue their events here instead of driving a
+// voice of their own, and Submit starts the voices chosen by SoundMixer once per frame.
+// The voices started in one frame are committed together as one XAudio2 operation set.
+// All sounds must be in the format given to Initialize.
+
+ref class SoundEffectMixer
+{
+internal:
+    SoundEffectMixer();
+
+    void Initialize(
+        _In_ IXAudio2*      masteringEngine,
+        _In_ WAVEFORMATEX*  sourceFormat,
+        _In_ uint32         voiceCount,
+        _In_ float          maxDistance
+        );
+
+    // Returns the index to use in SoundEvent::sound.
+    uint32 AddSound(_In_ std::shared_ptr<const DecodedAudio> soundData);
+
+    void Queue(_In_ const SoundEvent& soundEvent);
+    void Submit(_In_ float elapsedSeconds);
+
+    SoundMixerStats GetStats();
+
+protected private:
+    bool                                                m_audioAvailable;
+    Microsoft::WRL::ComPtr<IXAudio2>                    m_masteringEngine;
+    uint32                                              m_bytesPerSecond;
+    std::unique_ptr<SoundMixer>                         m_mixer;
+    std::vector<IXAudio2SourceVoice*>                   m_voices;
+    std::vector<std::shared_ptr<const DecodedAudio>>    m_sounds;
+    uint32                                              m_operationSet;
+};
@@ -0,0 +1,200 @@
+//********************************************************* 
+// 
+// Copyright (c) Microsoft. All rights reserved. 
+// This code is licensed under the MIT License (MIT). 
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF 
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY 
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR 
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT. 
+// 
+//*********************************************************
+
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "SoundMixer.h"
+
+#include <algorithm>
+
+//--------------------------------------------------------------------------------
+
+SoundMixer::SoundMixer(uint32_t voiceCount, float maxDistance) :
+    m_voices(std::max(voiceCount, 1u)),
+    m_maxDistanceSquared(maxDistance * maxDistance),
+    m_stats()
+{
+    Reset();
+}
+
+//--------------------------------------------------------------------------------
+
+uint32_t SoundMixer::AddSound(float durationSeconds)
+{
+    m_durations.push_back(std::max(durationSeconds, 0.0f));
+    return static_cast<uint32_t>(m_durations.size() - 1);
+}
+
+//--------------------------------------------------------------------------------
+
+void SoundMixer::Queue(const SoundEvent& soundEvent)
+{
+    m_stats.queued++;
+
+    if (!(soundEvent.volume > 0.0f) ||
+        !(soundEvent.distanceSquared <= m_maxDistanceSquared) ||
+        soundEvent.sound >= m_durations.size())
+    {
+        m_stats.culled++;
+        return;
+    }
+
+    // An object can hit several things in one frame but only plays one sound at a time, so
+    // keep the loudest of its events.
+    auto existing = m_eventBySource.find(soundEvent.source);
+    if (existing != m_eventBySource.end())
+    {
+        m_stats.merged++;
+        SoundEvent& merged = m_events[existing->second];
+        if (soundEvent.volume > merged.volume)
+        {
+            merged = soundEvent;
+            m_priorities[existing->second] = Priority(soundEvent.impactSpeed, soundEvent.distanceSquared);
+        }
+        return;
+    }
+
+    m_eventBySource.emplace(soundEvent.source, m_events.size());
+    m_events.push_back(soundEvent);
+    m_priorities.push_back(Priority(soundEvent.impactSpeed, soundEvent.distanceSquared));
+}
+
+//--------------------------------------------------------------------------------
+
+const std::vector<SoundVoiceStart>& SoundMixer::Mix(float elapsedSeconds)
+{
+    m_starts.clear();
+
+    for (auto& voice : m_voices)
+    {
+        voice.remaining = std::max(voice.remaining - std::max(elapsedSeconds, 0.0f), 0.0f);
+    }
+
+    // Most important first, in queue order between equals.
+    m_order.resize(m_events.size());
+    for (size_t i = 0; i < m_order.size(); i++)
+    {
+        m_order[i] = i;
+    }
+    std::stable_sort(m_order.begin(), m_order.end(), [this](size_t a, size_t b)
+    {
+        return m_priorities[a] > m_priorities[b];
+    });
+
+    for (size_t index : m_order)
+    {
+        const SoundEvent& soundEvent = m_events[index];
+        float priority = m_priorities[index];
+
+        // Prefer the source's own voice, then a free one, then the least important one.
+        uint32_t chosen = VoiceCount();
+        uint32_t weakest = 0;
+        for (uint32_t v = 0; v < VoiceCount(); v++)
+        {
+            const Voice& voice = m_voices[v];
+            if (voice.remaining > 0.0f && voice.source == soundEvent.source)
+            {
+                chosen = v;
+                break;
+            }
+            if (voice.remaining <= 0.0f && chosen == VoiceCount())
+            {
+                chosen = v;
+            }
+            if (CurrentPriority(voice) < CurrentPriority(m_voices[weakest]))
+            {
+                weakest = v;
+            }
+        }
+
+        if (chosen == VoiceCount())
+        {
+            if (!(CurrentPriority(m_voices[weakest]) < priority))
+            {
+                m_stats.dropped++;
+                continue;
+            }
+
+            chosen = weakest;
+            m_stats.stolen++;
+        }
+
+        Voice& voice = m_voices[chosen];
+        voice.source = soundEvent.source;
+        voice.priority = priority;
+        voice.duration = m_durations[soundEvent.sound];
+        voice.remaining = voice.duration;
+
+        SoundVoiceStart start;
+        start.voice = chosen;
+        start.sound = soundEvent.sound;
+        start.volume = soundEvent.volume;
+        m_starts.push_back(start);
+        m_stats.started++;
+    }
+
+    m_events.clear();
+    m_priorities.clear();
+    m_eventBySource.clear();
+    return m_starts;
+}
+
+//--------------------------------------------------------------------------------
+
+void SoundMixer::Reset()
+{
+    for (auto& voice : m_voices)
+    {
+        voice.source = 0;
+        voice.priority = 0.0f;
+        voice.duration = 0.0f;
+        voice.remaining = 0.0f;
+    }
+
+    m_events.clear();
+    m_priorities.clear();
+    m_eventBySource.clear();
+    m_starts.clear();
+}
+
+//--------------------------------------------------------------------------------
+
+uint32_t SoundMixer::ActiveVoiceCount() const
+{
+    uint32_t count = 0;
+    for (const auto& voice : m_voices)
+    {
+        if (voice.remaining > 0.0f)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+//--------------------------------------------------------------------------------
+
+float SoundMixer::Priority(float impactSpeed, float distanceSquared)
+{
+    // Impact energy, falling off with the square of the distance.
+    return (impactSpeed * impactSpeed) / (1.0f + std::max(distanceSquared, 0.0f));
+}
+
+//--------------------------------------------------------------------------------
+
+float SoundMixer::CurrentPriority(const Voice& voice) const
+{
+    if (voice.remaining <= 0.0f || voice.duration <= 0.0f)
+    {
+        return 0.0f;
+    }
+    return voice.priority * (voice.remaining / voice.duration);
+}
@@ -0,0 +1,103 @@
+//********************************************************* 
+// 
+// Copyright (c) Microsoft. All rights reserved. 
+// This code is licensed under the MIT License (MIT). 
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF 
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY 
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR 
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT. 
+// 
+//*********************************************************
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// One impact that should make a sound.
+struct SoundEvent
+{
+    uint32_t    sound;              // Index returned by SoundMixer::AddSound.
+    uint32_t    source;             // Identifies the object making the sound.
+    float       volume;
+    float       impactSpeed;
+    float       distanceSquared;    // From the listener.
+};
+
+// A voice to start this frame.  Whatever the voice was playing is cut off.
+struct SoundVoiceStart
+{
+    uint32_t    voice;
+    uint32_t    sound;
+    float       volume;
+};
+
+struct SoundMixerStats
+{
+    uint64_t    queued;         // Events passed to Queue.
+    uint64_t    merged;         // Events folded into an earlier event from the same source.
+    uint64_t    culled;         // Silent events and events beyond the maximum distance.
+    uint64_t    started;        // Voices started, including stolen ones.
+    uint64_t    stolen;         // Voices cut off to play a more important event.
+    uint64_t    dropped;        // Events that lost to more important sounds for a voice.
+};
+
+// SoundMixer:
+// Decides which impact sounds play on a fixed pool of voices.  Events are queued while the
+// physics runs and mixed once per frame: the events of one source are merged into its loudest,
+// silent and distant events are culled, and the rest take voices in order of priority, which
+// grows with the impact energy and falls with the distance to the listener.  When every voice
+// is busy an event steals the voice with the lowest remaining priority, if that is lower than
+// its own.  A playing voice's priority fades as the sound plays out, so sounds that are nearly
+// over are the first to go.  A source that is already playing restarts on its own voice, as it
+// did when each object had a voice of its own.
+// The mixer only makes the decisions; the caller starts the voices it returns.
+// This file only depends on the C++ standard library.
+
+class SoundMixer
+{
+public:
+    SoundMixer(uint32_t voiceCount, float maxDistance);
+
+    // Returns the index to use in SoundEvent::sound.
+    uint32_t AddSound(float durationSeconds);
+
+    void Queue(const SoundEvent& soundEvent);
+
+    // Advances the playing voices by elapsedSeconds and assigns voices to the queued events.
+    // The returned starts are valid until the next call.
+    const std::vector<SoundVoiceStart>& Mix(float elapsedSeconds);
+
+    // Forgets the queued events and marks every voice as free.
+    void Reset();
+
+    uint32_t VoiceCount() const { return static_cast<uint32_t>(m_voices.size()); }
+    uint32_t ActiveVoiceCount() const;
+    SoundMixerStats GetStats() const { return m_stats; }
+
+    static float Priority(float impactSpeed, float distanceSquared);
+
+private:
+    struct Voice
+    {
+        uint32_t    source;
+        float       priority;       // Of the event that started the voice.
+        float       duration;
+        float       remaining;      // Zero when the voice is free.
+    };
+
+    float CurrentPriority(const Voice& voice) const;
+
+    std::vector<float>                      m_durations;
+    std::vector<Voice>                      m_voices;
+    std::vector<SoundEvent>                 m_events;
+    std::vector<float>                      m_priorities;       // Of each queued event.
+    std::unordered_map<uint32_t, size_t>    m_eventBySource;    // Index into m_events.
+    std::vector<size_t>                     m_order;
+    std::vector<SoundVoiceStart>            m_starts;
+    float                                   m_maxDistanceSquared;
+    SoundMixerStats                         m_stats;
+};
@@ -9,12 +9,14 @@
 // 
 //*********************************************************
 
+
 #pragma once
 
 // SphereMesh:
 // This class derives from MeshObject and creates a ID3D11Buffer of
 // vertices and indices to represent a canonical sphere that is
 // positioned at the origin with a radius of 1.0.
+// The second constructor takes a mesh already generated, e.g. by a MeshCache.
 
 #include "MeshObject.h"
 
@@ -22,4 +24,5 @@ ref class SphereMesh: public MeshObject
 {
 internal:
     SphereMesh(_In_ ID3D11Device *device, uint32 segments);
+    SphereMesh(_In_ ID3D11Device *device, const MeshData& mesh);
 };
@@ -0,0 +1,285 @@
+//********************************************************* 
+// 
+// Copyright (c) Microsoft. All rights reserved. 
+// This code is licensed under the MIT License (MIT). 
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF 
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY 
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR 
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT. 
+// 
+//*********************************************************
+
+
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "TargetAtlas.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    const uint64_t FnvOffsetBasis = 14695981039346656037ull;
+    const uint64_t FnvPrime = 1099511628211ull;
+    const uint32_t RepeatFlag = 0x80000000u;
+    const uint32_t MaxRun = 0x7fffffffu;
+    const size_t HeaderSize = 24;
+
+    void HashBytes(uint64_t& hash, const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++)
+        {
+            hash = (hash ^ bytes[i]) * FnvPrime;
+        }
+    }
+
+    void HashValue(uint64_t& hash, uint32_t value)
+    {
+        HashBytes(hash, &value, sizeof(value));
+    }
+
+    void Append(std::vector<uint8_t>& blob, uint32_t value)
+    {
+        uint8_t bytes[4] =
+        {
+            static_cast<uint8_t>(value),
+            static_cast<uint8_t>(value >> 8),
+            static_cast<uint8_t>(value >> 16),
+            static_cast<uint8_t>(value >> 24)
+        };
+        blob.insert(blob.end(), bytes, bytes + 4);
+    }
+
+    uint32_t Read(const uint8_t* data)
+    {
+        return static_cast<uint32_t>(data[0]) |
+            (static_cast<uint32_t>(data[1]) << 8) |
+            (static_cast<uint32_t>(data[2]) << 16) |
+            (static_cast<uint32_t>(data[3]) << 24);
+    }
+
+    uint32_t Pixel(const uint8_t* pixels, size_t rowPitch, uint32_t width, size_t index)
+    {
+        uint32_t pixel;
+        memcpy(&pixel, pixels + (index / width) * rowPitch + (index % width) * 4, sizeof(pixel));
+        return pixel;
+    }
+}
+
+//--------------------------------------------------------------------------------
+
+TargetAtlasLayout::TargetAtlasLayout() :
+    m_width(0),
+    m_height(0),
+    m_cellSize(0),
+    m_cellCount(0),
+    m_columns(1)
+{
+}
+
+//--------------------------------------------------------------------------------
+
+bool TargetAtlasLayout::Build(size_t nameCount, float dpi, uint32_t maxDimension)
+{
+    *this = TargetAtlasLayout();
+    if (nameCount == 0 || nameCount > UINT32_MAX / 2 || !(dpi > 0.0f))
+    {
+        return false;
+    }
+
+    uint32_t cellCount = static_cast<uint32_t>(nameCount * 2);
+
+    // As square as possible, with the spare cells in the last row.
+    uint32_t columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(cellCount))));
+    uint32_t rows = (cellCount + columns - 1) / columns;
+
+    double scaled = std::floor(BaseCellSize * static_cast<double>(dpi) / 96.0 + 0.5);
+    uint32_t cellSize = (scaled < MinCellSize) ? MinCellSize : (scaled > 16384.0) ? 16384 : static_cast<uint32_t>(scaled);
+    while (static_cast<uint64_t>(columns) * cellSize > maxDimension || static_cast<uint64_t>(rows) * cellSize > maxDimension)
+    {
+        if (cellSize / 2 < MinCellSize)
+        {
+            return false;
+        }
+        cellSize /= 2;
+    }
+
+    m_width = columns * cellSize;
+    m_height = rows * cellSize;
+    m_cellSize = cellSize;
+    m_cellCount = cellCount;
+    m_columns = columns;
+    return true;
+}
+
+//--------------------------------------------------------------------------------
+
+AtlasRegion TargetAtlasLayout::Region(uint32_t cell) const
+{
+    float width = static_cast<float>(m_width);
+    float height = static_cast<float>(m_height);
+
+    AtlasRegion region;
+    region.scaleU = static_cast<float>(m_cellSize - 1) / width;
+    region.scaleV = static_cast<float>(m_cellSize - 1) / height;
+    region.offsetU = (static_cast<float>(CellX(cell)) + 0.5f) / width;
+    region.offsetV = (static_cast<float>(CellY(cell)) + 0.5f) / height;
+    return region;
+}
+
+//--------------------------------------------------------------------------------
+
+uint64_t TargetAtlasCache::Key(
+    const std::vector<std::wstring>& names,
+    float dpi,
+    uint32_t width,
+    uint32_t height,
+    uint32_t contentVersion
+    )
+{
+    uint64_t hash = FnvOffsetBasis;
+    HashValue(hash, contentVersion);
+    HashValue(hash, width);
+    HashValue(hash, height);
+
+    uint32_t dpiBits;
+    memcpy(&dpiBits, &dpi, sizeof(dpiBits));
+    HashValue(hash, dpiBits);
+
+    HashValue(hash, static_cast<uint32_t>(names.size()));
+    for (const auto& name : names)
+    {
+        // Lengths keep {"1", "23"} apart from {"12", "3"}.
+        HashValue(hash, static_cast<uint32_t>(name.size()));
+        for (wchar_t c : name)
+        {
+            HashValue(hash, static_cast<uint32_t>(c));
+        }
+    }
+
+    return hash;
+}
+
+//--------------------------------------------------------------------------------
+
+void TargetAtlasCache::Save(
+    uint64_t key,
+    uint32_t width,
+    uint32_t height,
+    const uint8_t* pixels,
+    size_t rowPitch,
+    std::vector<uint8_t>& blob
+    )
+{
+    blob.clear();
+    Append(blob, Magic);
+    Append(blob, Version);
+    Append(blob, static_cast<uint32_t>(key));
+    Append(blob, static_cast<uint32_t>(key >> 32));
+    Append(blob, width);
+    Append(blob, height);
+
+    size_t count = static_cast<size_t>(width) * height;
+    size_t i = 0;
+    while (i < count)
+    {
+        uint32_t pixel = Pixel(pixels, rowPitch, width, i);
+        size_t run = 1;
+        while (i + run < count && run < MaxRun && Pixel(pixels, rowPitch, width, i + run) == pixel)
+        {
+            run++;
+        }
+
+        // Two equal pixels already cost no more as a repeat than as literals.
+        if (run >= 2)
+        {
+            Append(blob, RepeatFlag | static_cast<uint32_t>(run));
+            Append(blob, pixel);
+            i += run;
+            continue;
+        }
+
+        // Collect literals until the next pair of equal pixels.
+        size_t literals = 1;
+        while (i + literals < count && literals < MaxRun &&
+            (i + literals + 1 >= count ||
+             Pixel(pixels, rowPitch, width, i + literals) != Pixel(pixels, rowPitch, width, i + literals + 1)))
+        {
+            literals++;
+        }
+
+        Append(blob, static_cast<uint32_t>(literals));
+        for (size_t k = 0; k < literals; k++)
+        {
+            Append(blob, Pixel(pixels, rowPitch, width, i + k));
+        }
+        i += literals;
+    }
+}
+
+//--------------------------------------------------------------------------------
+
+bool TargetAtlasCache::Load(
+    const uint8_t* blob,
+    size_t size,
+    uint64_t key,
+    uint32_t width,
+    uint32_t height,
+    std::vector<uint32_t>& pixels
+    )
+{
+    pixels.clear();
+    if (blob == nullptr || size < HeaderSize ||
+        Read(blob) != Magic ||
+        Read(blob + 4) != Version ||
+        (Read(blob + 8) | (static_cast<uint64_t>(Read(blob + 12)) << 32)) != key ||
+        Read(blob + 16) != width ||
+        Read(blob + 20) != height)
+    {
+        return false;
+    }
+
+    size_t count = static_cast<size_t>(width) * height;
+    pixels.reserve(count);
+
+    size_t offset = HeaderSize;
+    while (pixels.size() < count)
+    {
+        if (size - offset < 4)
+        {
+            pixels.clear();
+            return false;
+        }
+
+        uint32_t header = Read(blob + offset);
+        offset += 4;
+        size_t run = header & MaxRun;
+        size_t words = (header & RepeatFlag) ? 1 : run;
+        if (run == 0 || run > count - pixels.size() || (size - offset) / 4 < words)
+        {
+            pixels.clear();
+            return false;
+        }
+
+        if (header & RepeatFlag)
+        {
+            pixels.insert(pixels.end(), run, Read(blob + offset));
+        }
+        else
+        {
+            for (size_t k = 0; k < run; k++)
+            {
+                pixels.push_back(Read(blob + offset + k * 4));
+            }
+        }
+        offset += words * 4;
+    }
+
+    if (offset != size)
+    {
+        pixels.clear();
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,123 @@
+//********************************************************* 
+// 
+// Copyright (c) Microsoft. All rights reserved. 
+// This code is licensed under the MIT License (MIT). 
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF 
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY 
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR 
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT. 
+// 
+//*********************************************************
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Each target name has a texture for its normal state and one for when it has been hit.
+enum class TargetVariant : uint32_t
+{
+    Normal = 0,
+    Hit = 1
+};
+
+// Maps a mesh's 0 to 1 texture coordinates into one atlas cell: uv * scale + offset.
+// Packed as a float4 (scaleU, scaleV, offsetU, offsetV) for the shaders.
+struct AtlasRegion
+{
+    float       scaleU;
+    float       scaleV;
+    float       offsetU;
+    float       offsetV;
+};
+
+// TargetAtlasLayout:
+// Places the two variants of every target name in a grid of square cells, one texture for
+// all of them.  Cells are sized for the DPI, 512 pixels at 96 DPI as the separate textures
+// were, and are halved until the atlas fits the largest texture the device supports.
+// The regions map to the centers of a cell's edge texels, so linear filtering never blends
+// in a neighbouring cell.
+// This file only depends on the C++ standard library.
+
+class TargetAtlasLayout
+{
+public:
+    static const uint32_t BaseCellSize = 512;
+    static const uint32_t MinCellSize = 32;
+
+    TargetAtlasLayout();
+
+    // Returns false if there are no names, or the cells do not fit even at MinCellSize.
+    bool Build(size_t nameCount, float dpi, uint32_t maxDimension);
+
+    uint32_t Width() const { return m_width; }
+    uint32_t Height() const { return m_height; }
+    uint32_t CellSize() const { return m_cellSize; }
+    uint32_t CellCount() const { return m_cellCount; }
+
+    uint32_t CellIndex(size_t name, TargetVariant variant) const
+    {
+        return static_cast<uint32_t>(name * 2 + static_cast<uint32_t>(variant));
+    }
+
+    // Pixel position of the top left corner of a cell.
+    uint32_t CellX(uint32_t cell) const { return (cell % m_columns) * m_cellSize; }
+    uint32_t CellY(uint32_t cell) const { return (cell / m_columns) * m_cellSize; }
+
+    AtlasRegion Region(uint32_t cell) const;
+
+private:
+    uint32_t    m_width;
+    uint32_t    m_height;
+    uint32_t    m_cellSize;
+    uint32_t    m_cellCount;
+    uint32_t    m_columns;
+};
+
+// TargetAtlasCache:
+// Saves a drawn atlas so later launches can load it instead of drawing it again.  The key
+// covers everything the pixels depend on: the names, the DPI, the atlas size and a content
+// version that is bumped whenever the way targets are drawn changes.  Pixels are 32-bit and
+// stored with a simple run-length encoding, which suits the flat colored rings well.
+// Blob layout, little endian: magic, version, key (64-bit), width, height, then runs.  Each
+// run starts with a 32-bit word whose top bit marks a repeat of the one pixel that follows;
+// otherwise the low 31 bits count the literal pixels that follow.
+
+class TargetAtlasCache
+{
+public:
+    static const uint32_t Magic = 0x54415454;       // "TTAT" in memory.
+    static const uint32_t Version = 1;
+
+    static uint64_t Key(
+        const std::vector<std::wstring>& names,
+        float dpi,
+        uint32_t width,
+        uint32_t height,
+        uint32_t contentVersion
+        );
+
+    // rowPitch is in bytes, so a mapped texture can be saved directly.
+    static void Save(
+        uint64_t key,
+        uint32_t width,
+        uint32_t height,
+        const uint8_t* pixels,
+        size_t rowPitch,
+        std::vector<uint8_t>& blob
+        );
+
+    // Returns false, leaving pixels empty, if the blob is damaged or was saved for another key
+    // or size.  On success pixels holds width * height tightly packed pixels.
+    static bool Load(
+        const uint8_t* blob,
+        size_t size,
+        uint64_t key,
+        uint32_t width,
+        uint32_t height,
+        std::vector<uint32_t>& pixels
+        );
+};
@@ -190,68 +190,11 @@ void TargetTexture::CreateTextureResourceView(
     }
 #endif
 
-    ComPtr<IDXGISurface> dxgiSurface;
-    DX::ThrowIfFailed(
-        offscreenTexture.As(&dxgiSurface)
-        );
-
-    // Create a D2D render target which can draw into our offscreen D3D
-    // surface. Given that we use a constant size for the texture, we
-    // fix the DPI at 96.
-
-    D2D1_BITMAP_PROPERTIES1 properties;
-    properties.pixelFormat.format = DXGI_FORMAT_B8G8R8A8_UNORM;
-    properties.pixelFormat.alphaMode = D2D1_ALPHA_MODE_PREMULTIPLIED;
-    properties.dpiX = 96;
-    properties.dpiY = 96;
-    properties.bitmapOptions = D2D1_BITMAP_OPTIONS_TARGET | D2D1_BITMAP_OPTIONS_CANNOT_DRAW;
-    properties.colorContext = nullptr;
-
-    ComPtr<ID2D1Bitmap1> renderTarget;
-    DX::ThrowIfFailed(
-        m_d2dContext->CreateBitmapFromDxgiSurface(
-            dxgiSurface.Get(),
-            &properties,
-            &renderTarget
-            )
-        );
-
-    m_d2dContext->SetTarget(renderTarget.Get());
     float saveDpiX;
     float saveDpiY;
-
-    m_d2dContext->GetDpi(&saveDpiX, &saveDpiY);
-    m_d2dContext->SetDpi(96.0f, 96.0f);
-
-    m_d2dContext->BeginDraw();
-    m_d2dContext->SetTransform(D2D1::Matrix3x2F::Identity());
-
-    D2D1_SIZE_F renderTargetSize = renderTarget->GetSize();
-
-    m_d2dContext->Clear(D2D1::ColorF(D2D1::ColorF::White));
-    m_d2dContext->FillGeometry(m_circleGeometry5.Get(), m_redBrush.Get());
-    m_d2dContext->FillGeometry(m_circleGeometry4.Get(), m_blueBrush.Get());
-    m_d2dContext->FillGeometry(m_circleGeometry3.Get(), m_greenBrush.Get());
-    m_d2dContext->FillGeometry(m_circleGeometry2.Get(), m_yellowBrush.Get());
-    m_d2dContext->FillGeometry(m_circleGeometry1.Get(), m_blackBrush.Get());
-    m_d2dContext->DrawText(
-        name->Data(),
-        name->Length(),
-        m_textFormat.Get(),
-        D2D1::RectF(0, 0, renderTargetSize.width, renderTargetSize.height),
-        m_whiteBrush.Get()
-        );
-
-    // We ignore D2DERR_RECREATE_TARGET here. This error indicates that the device
-    // is lost. It will be handled during the next call to Present.
-    HRESULT hr = m_d2dContext->EndDraw();
-    if (hr != D2DERR_RECREATE_TARGET)
-    {
-        DX::ThrowIfFailed(hr);
-    }
-
-    m_d2dContext->SetTarget(nullptr);
-    m_d2dContext->SetDpi(saveDpiX, saveDpiY);
+    BeginDraw(offscreenTexture.Get(), &saveDpiX, &saveDpiY);
+    DrawTarget(name->Data(), name->Length(), TargetVariant::Normal, D2D1::Point2F(0.0f, 0.0f), 512.0f);
+    EndDraw(saveDpiX, saveDpiY);
 
     *textureResourceView = texture.Detach();
 }
@@ -295,14 +238,159 @@ void TargetTexture::CreateHitTextureResourceView(
     }
 #endif
 
+    float saveDpiX;
+    float saveDpiY;
+    BeginDraw(offscreenTexture.Get(), &saveDpiX, &saveDpiY);
+    DrawTarget(name->Data(), name->Length(), TargetVariant::Hit, D2D1::Point2F(0.0f, 0.0f), 512.0f);
+    EndDraw(saveDpiX, saveDpiY);
+
+    *textureResourceView = texture.Detach();
+}
+//----------------------------------------------------------------------
+bool TargetTexture::CreateAtlas(
+    _In_ const std::vector<std::wstring>& names,
+    _In_ float dpi,
+    _In_ const std::vector<uint8_t>& cachedAtlas,
+    _Out_ TargetAtlasLayout* layout,
+    _Out_ ID3D11ShaderResourceView** textureResourceView,
+    _Out_ std::vector<uint8_t>* atlasToCache
+    )
+{
+    *textureResourceView = nullptr;
+    atlasToCache->clear();
+
+    // Use the largest texture the feature level allows, but no more than 4096 x 4096 so
+    // the atlas never takes more memory than the separate textures did at high DPI.
+    D3D_FEATURE_LEVEL featureLevel = m_d3dDevice->GetFeatureLevel();
+    uint32 maxDimension =
+        (featureLevel >= D3D_FEATURE_LEVEL_10_0) ? 4096 :
+        (featureLevel >= D3D_FEATURE_LEVEL_9_3) ? D3D_FL9_3_REQ_TEXTURE2D_U_OR_V_DIMENSION :
+        D3D_FL9_1_REQ_TEXTURE2D_U_OR_V_DIMENSION;
+
+    if (!layout->Build(names.size(), dpi, maxDimension))
+    {
+        return false;
+    }
+
+    uint32 width = layout->Width();
+    uint32 height = layout->Height();
+    uint64 key = TargetAtlasCache::Key(names, dpi, width, height, AtlasContentVersion);
+
+    D3D11_TEXTURE2D_DESC texDesc;
+    texDesc.ArraySize = 1;
+    texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    texDesc.CPUAccessFlags = 0;
+    texDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    texDesc.Height = height;
+    texDesc.Width = width;
+    texDesc.MipLevels = 1;
+    texDesc.MiscFlags = 0;
+    texDesc.SampleDesc.Count = 1;
+    texDesc.SampleDesc.Quality = 0;
+    texDesc.Usage = D3D11_USAGE_DEFAULT;
+
+    ComPtr<ID3D11Texture2D> atlasTexture;
+    std::vector<uint32_t> pixels;
+    if (TargetAtlasCache::Load(cachedAtlas.data(), cachedAtlas.size(), key, width, height, pixels))
+    {
+        D3D11_SUBRESOURCE_DATA initialData;
+        initialData.pSysMem = pixels.data();
+        initialData.SysMemPitch = width * 4;
+        initialData.SysMemSlicePitch = 0;
+
+        DX::ThrowIfFailed(
+            m_d3dDevice->CreateTexture2D(&texDesc, &initialData, &atlasTexture)
+            );
+    }
+    else
+    {
+        texDesc.BindFlags |= D3D11_BIND_RENDER_TARGET;
+        DX::ThrowIfFailed(
+            m_d3dDevice->CreateTexture2D(&texDesc, nullptr, &atlasTexture)
+            );
+
+        float saveDpiX;
+        float saveDpiY;
+        BeginDraw(atlasTexture.Get(), &saveDpiX, &saveDpiY);
+        for (size_t i = 0; i < names.size(); i++)
+        {
+            for (TargetVariant variant : { TargetVariant::Normal, TargetVariant::Hit })
+            {
+                uint32 cell = layout->CellIndex(i, variant);
+                DrawTarget(
+                    names[i].c_str(),
+                    static_cast<uint32>(names[i].size()),
+                    variant,
+                    D2D1::Point2F(static_cast<float>(layout->CellX(cell)), static_cast<float>(layout->CellY(cell))),
+                    static_cast<float>(layout->CellSize())
+                    );
+            }
+        }
+
+        // Only save the atlas if it was completely drawn.
+        if (EndDraw(saveDpiX, saveDpiY))
+        {
+            D3D11_TEXTURE2D_DESC stagingDesc = texDesc;
+            stagingDesc.BindFlags = 0;
+            stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+            stagingDesc.Usage = D3D11_USAGE_STAGING;
+
+            ComPtr<ID3D11Texture2D> stagingTexture;
+            DX::ThrowIfFailed(
+                m_d3dDevice->CreateTexture2D(&stagingDesc, nullptr, &stagingTexture)
+                );
+
+            ComPtr<ID3D11DeviceContext1> d3dContext;
+            m_d3dDevice->GetImmediateContext1(&d3dContext);
+            d3dContext->CopyResource(stagingTexture.Get(), atlasTexture.Get());
+
+            D3D11_MAPPED_SUBRESOURCE mapped;
+            DX::ThrowIfFailed(
+                d3dContext->Map(stagingTexture.Get(), 0, D3D11_MAP_READ, 0, &mapped)
+                );
+            TargetAtlasCache::Save(
+                key,
+                width,
+                height,
+                static_cast<const uint8_t*>(mapped.pData),
+                mapped.RowPitch,
+                *atlasToCache
+                );
+            d3dContext->Unmap(stagingTexture.Get(), 0);
+        }
+    }
+
+    ComPtr<ID3D11ShaderResourceView> texture;
+    DX::ThrowIfFailed(
+        m_d3dDevice->CreateShaderResourceView(atlasTexture.Get(), nullptr, &texture)
+        );
+#if defined(_DEBUG)
+    {
+        char debugName[] = "Simple3DGame TargetAtlas";
+        DX::ThrowIfFailed(
+            texture->SetPrivateData(WKPDID_D3DDebugObjectName, sizeof(debugName) - 1, debugName)
+            );
+    }
+#endif
+
+    *textureResourceView = texture.Detach();
+    return true;
+}
+//----------------------------------------------------------------------
+void TargetTexture::BeginDraw(
+    _In_ ID3D11Texture2D* texture,
+    _Out_ float* saveDpiX,
+    _Out_ float* saveDpiY
+    )
+{
     ComPtr<IDXGISurface> dxgiSurface;
     DX::ThrowIfFailed(
-        offscreenTexture.As(&dxgiSurface)
+        texture->QueryInterface(IID_PPV_ARGS(&dxgiSurface))
         );
 
     // Create a D2D render target which can draw into our offscreen D3D
-    // surface. Given that we use a constant size for the texture, we
-    // fix the DPI at 96.
+    // surface. The targets are drawn in 512 x 512 units and scaled to the
+    // size of their cell, so we fix the DPI at 96.
 
     D2D1_BITMAP_PROPERTIES1 properties;
     properties.pixelFormat.format = DXGI_FORMAT_B8G8R8A8_UNORM;
@@ -322,31 +410,63 @@ void TargetTexture::CreateHitTextureResourceView(
         );
 
     m_d2dContext->SetTarget(renderTarget.Get());
-    float saveDpiX;
-    float saveDpiY;
 
-    m_d2dContext->GetDpi(&saveDpiX, &saveDpiY);
+    m_d2dContext->GetDpi(saveDpiX, saveDpiY);
     m_d2dContext->SetDpi(96.0f, 96.0f);
 
     m_d2dContext->BeginDraw();
-    m_d2dContext->SetTransform(D2D1::Matrix3x2F::Identity());
+}
+//----------------------------------------------------------------------
+void TargetTexture::DrawTarget(
+    _In_reads_(nameLength) const wchar_t* name,
+    _In_ uint32 nameLength,
+    _In_ TargetVariant variant,
+    _In_ D2D1_POINT_2F origin,
+    _In_ float cellSize
+    )
+{
+    // The hit version swaps the ring colors around and inverts the background.
+    bool hit = (variant == TargetVariant::Hit);
+    ID2D1SolidColorBrush* backgroundBrush = hit ? m_blackBrush.Get() : m_whiteBrush.Get();
+    ID2D1SolidColorBrush* ringBrushes[5] =
+    {
+        hit ? m_yellowBrush.Get() : m_redBrush.Get(),
+        hit ? m_greenBrush.Get() : m_blueBrush.Get(),
+        hit ? m_blueBrush.Get() : m_greenBrush.Get(),
+        hit ? m_redBrush.Get() : m_yellowBrush.Get(),
+        hit ? m_whiteBrush.Get() : m_blackBrush.Get()
+    };
+    ID2D1SolidColorBrush* textBrush = hit ? m_blackBrush.Get() : m_whiteBrush.Get();
+
+    float scale = cellSize / 512.0f;
+    m_d2dContext->SetTransform(
+        D2D1::Matrix3x2F::Scale(scale, scale) * D2D1::Matrix3x2F::Translation(origin.x, origin.y)
+        );
 
-    D2D1_SIZE_F renderTargetSize = renderTarget->GetSize();
+    // Clip to the cell, so that large text does not spill into a neighbouring target.
+    D2D1_RECT_F cell = D2D1::RectF(0.0f, 0.0f, 512.0f, 512.0f);
+    m_d2dContext->PushAxisAlignedClip(cell, D2D1_ANTIALIAS_MODE_ALIASED);
 
-    m_d2dContext->Clear(D2D1::ColorF(D2D1::ColorF::Black));
-    m_d2dContext->FillGeometry(m_circleGeometry5.Get(), m_yellowBrush.Get());
-    m_d2dContext->FillGeometry(m_circleGeometry4.Get(), m_greenBrush.Get());
-    m_d2dContext->FillGeometry(m_circleGeometry3.Get(), m_blueBrush.Get());
-    m_d2dContext->FillGeometry(m_circleGeometry2.Get(), m_redBrush.Get());
-    m_d2dContext->FillGeometry(m_circleGeometry1.Get(), m_whiteBrush.Get());
+    m_d2dContext->FillRectangle(cell, backgroundBrush);
+    m_d2dContext->FillGeometry(m_circleGeometry5.Get(), ringBrushes[0]);
+    m_d2dContext->FillGeometry(m_circleGeometry4.Get(), ringBrushes[1]);
+    m_d2dContext->FillGeometry(m_circleGeometry3.Get(), ringBrushes[2]);
+    m_d2dContext->FillGeometry(m_circleGeometry2.Get(), ringBrushes[3]);
+    m_d2dContext->FillGeometry(m_circleGeometry1.Get(), ringBrushes[4]);
     m_d2dContext->DrawText(
-        name->Data(),
-        name->Length(),
+        name,
+        nameLength,
         m_textFormat.Get(),
-        D2D1::RectF(0, 0, renderTargetSize.width, renderTargetSize.height),
-        m_blackBrush.Get()
+        cell,
+        textBrush
         );
 
+    m_d2dContext->PopAxisAlignedClip();
+    m_d2dContext->SetTransform(D2D1::Matrix3x2F::Identity());
+}
+//----------------------------------------------------------------------
+bool TargetTexture::EndDraw(_In_ float saveDpiX, _In_ float saveDpiY)
+{
     // We ignore D2DERR_RECREATE_TARGET here. This error indicates that the device
     // is lost. It will be handled during the next call to Present.
     HRESULT hr = m_d2dContext->EndDraw();
@@ -358,6 +478,6 @@ void TargetTexture::CreateHitTextureResourceView(
     m_d2dContext->SetTarget(nullptr);
     m_d2dContext->SetDpi(saveDpiX, saveDpiY);
 
-    *textureResourceView = texture.Detach();
+    return hr != D2DERR_RECREATE_TARGET;
 }
 //----------------------------------------------------------------------
@@ -17,6 +17,11 @@
 // hit and the other is when it is not.
 // The class creates the necessary resources to draw the texture into
 // an off screen resource at initialization time.
+// CreateAtlas draws both versions of every target into one texture instead, laid out
+// by TargetAtlasLayout.  The drawn atlas is returned as a blob the caller can save, and
+// a saved blob is uploaded directly on later launches instead of drawing it again.
+
+#include "TargetAtlas.h"
 
 ref class TargetTexture
 {
@@ -37,7 +42,37 @@ internal:
         _Out_ ID3D11ShaderResourceView** textureResourceView
         );
 
+    // Bump this whenever the way targets are drawn changes, so that atlases saved by
+    // older versions are drawn again.
+    static const uint32 AtlasContentVersion = 1;
+
+    // cachedAtlas may be empty.  atlasToCache is left empty when cachedAtlas was used,
+    // otherwise it holds the newly drawn atlas.  Returns false, creating nothing, if the
+    // targets do not fit in one texture on this device.
+    bool CreateAtlas(
+        _In_ const std::vector<std::wstring>& names,
+        _In_ float dpi,
+        _In_ const std::vector<uint8_t>& cachedAtlas,
+        _Out_ TargetAtlasLayout* layout,
+        _Out_ ID3D11ShaderResourceView** textureResourceView,
+        _Out_ std::vector<uint8_t>* atlasToCache
+        );
+
 protected private:
+    void BeginDraw(
+        _In_ ID3D11Texture2D* texture,
+        _Out_ float* saveDpiX,
+        _Out_ float* saveDpiY
+        );
+    void DrawTarget(
+        _In_reads_(nameLength) const wchar_t* name,
+        _In_ uint32 nameLength,
+        _In_ TargetVariant variant,
+        _In_ D2D1_POINT_2F origin,
+        _In_ float cellSize
+        );
+    bool EndDraw(_In_ float saveDpiX, _In_ float saveDpiY);
+
     Microsoft::WRL::ComPtr<ID3D11Device1>           m_d3dDevice;
     Microsoft::WRL::ComPtr<ID2D1Factory1>           m_d2dFactory;
     Microsoft::WRL::ComPtr<ID2D1DeviceContext>      m_d2dContext;
@@ -16,7 +16,7 @@ PixelShaderFlatInput main(VertextShaderInput input)
     PixelShaderFlatInput output = (PixelShaderFlatInput)0;
 
     output.position = mul(mul(mul(input.position, world), view), projection);
-    output.textureUV = input.textureUV;
+    output.textureUV = input.textureUV * textureTransform.xy + textureTransform.zw;
 
     // compute view space normal
     float3 normal = normalize (mul(mul(input.normal.xyz, (float3x3)world), (float3x3)view));
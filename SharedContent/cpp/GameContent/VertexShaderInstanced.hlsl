@@ -0,0 +1,39 @@
+//********************************************************* 
+// 
+// Copyright (c) Microsoft. All rights reserved. 
+// This code is licensed under the MIT License (MIT). 
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF 
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY 
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR 
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT. 
+// 
+//*********************************************************
+
+#include "ConstantBuffers.hlsli"
+
+// Same as VertexShader, but the object to world matrix comes from the per-instance
+// vertex stream instead of the ConstantBufferChangesEveryPrim constant buffer.
+PixelShaderInput main(VertexShaderInstancedInput input)
+{
+    PixelShaderInput output = (PixelShaderInput)0;
+
+    // The instance rows are stored untransposed, one matrix row per element.
+    float4x4 instanceWorld = float4x4(input.world0, input.world1, input.world2, input.world3);
+
+    output.position = mul(mul(mul(input.position, instanceWorld), view), projection);
+    output.textureUV = input.textureUV * textureTransform.xy + textureTransform.zw;
+
+    // compute view space normal
+    output.normal = normalize (mul(mul(input.normal.xyz, (float3x3)instanceWorld), (float3x3)view));
+
+    // Vertex pos in view space (normalize in pixel shader)
+    output.vertexToEye = -mul(mul(input.position, instanceWorld), view).xyz;
+
+    // Compute view space vertex to light vectors (normalized)
+    output.vertexToLight0 = normalize(mul(lightPosition[0], view ).xyz + output.vertexToEye);
+    output.vertexToLight1 = normalize(mul(lightPosition[1], view ).xyz + output.vertexToEye);
+    output.vertexToLight2 = normalize(mul(lightPosition[2], view ).xyz + output.vertexToEye);
+    output.vertexToLight3 = normalize(mul(lightPosition[3], view ).xyz + output.vertexToEye);
+
+    return output;
+}
@@ -19,11 +19,14 @@
 // of the world.
 // The vertices are defined by a position, a normal and a single
 // 2D texture coordinate.
+// Each class also has a constructor that takes a mesh already generated,
+// e.g. by a MeshCache.
 
 ref class WorldCeilingMesh: public MeshObject
 {
 internal:
     WorldCeilingMesh(_In_ ID3D11Device *device);
+    WorldCeilingMesh(_In_ ID3D11Device *device, const MeshData& mesh);
 };
 
 // WorldFloorMesh:
@@ -35,6 +38,7 @@ ref class WorldFloorMesh: public MeshObject
 {
 internal:
     WorldFloorMesh(_In_ ID3D11Device *device);
+    WorldFloorMesh(_In_ ID3D11Device *device, const MeshData& mesh);
 };
 
 // WorldWallsMesh:
@@ -46,4 +50,5 @@ ref class WorldWallsMesh: public MeshObject
 {
 internal:
     WorldWallsMesh(_In_ ID3D11Device *device);
+    WorldWallsMesh(_In_ ID3D11Device *device, const MeshData& mesh);
 };
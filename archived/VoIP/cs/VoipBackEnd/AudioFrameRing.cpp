@@ -0,0 +1,109 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "AudioFrameRing.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace VoipBackEnd;
+
+AudioFrameRing::AudioFrameRing(uint32_t frameSize, uint32_t frameCount) :
+    m_frameSize(std::max<uint32_t>(1, frameSize)),
+    m_frameCount(std::max<uint32_t>(1, frameCount)),
+    m_storage(static_cast<size_t>(m_frameSize) * m_frameCount),
+    m_sequences(m_frameCount)
+{
+    Reset();
+}
+
+uint32_t AudioFrameRing::Write(const uint8_t* data, uint32_t byteCount)
+{
+    uint32_t published = 0;
+    uint64_t head = m_head.load(std::memory_order_relaxed);
+
+    while (byteCount > 0)
+    {
+        uint32_t slot = static_cast<uint32_t>(head % m_frameCount);
+        if (m_filled == 0)
+        {
+            // Decide once per frame whether it has somewhere to go, so a frame is never half kept.
+            m_dropping = (head - m_tail.load(std::memory_order_acquire) >= m_frameCount);
+        }
+
+        uint32_t count = std::min(byteCount, m_frameSize - m_filled);
+        if (!m_dropping)
+        {
+            memcpy(&m_storage[static_cast<size_t>(slot) * m_frameSize + m_filled], data, count);
+        }
+
+        data += count;
+        byteCount -= count;
+        m_filled += count;
+
+        if (m_filled == m_frameSize)
+        {
+            if (m_dropping)
+            {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            else
+            {
+                m_sequences[slot] = m_nextSequence;
+                m_head.store(++head, std::memory_order_release);
+                published++;
+            }
+
+            m_nextSequence++;
+            m_filled = 0;
+        }
+    }
+
+    return published;
+}
+
+bool AudioFrameRing::Peek(Frame& frame)
+{
+    uint64_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail == m_head.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    uint32_t slot = static_cast<uint32_t>(tail % m_frameCount);
+    frame.sequence = m_sequences[slot];
+    frame.data = &m_storage[static_cast<size_t>(slot) * m_frameSize];
+    return true;
+}
+
+void AudioFrameRing::Pop()
+{
+    uint64_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail != m_head.load(std::memory_order_acquire))
+    {
+        m_tail.store(tail + 1, std::memory_order_release);
+    }
+}
+
+uint64_t AudioFrameRing::GetDroppedFrames() const
+{
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+void AudioFrameRing::Reset()
+{
+    m_nextSequence = 0;
+    m_filled = 0;
+    m_dropping = false;
+    m_head.store(0, std::memory_order_relaxed);
+    m_tail.store(0, std::memory_order_relaxed);
+    m_dropped.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,78 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+// Hands captured audio from the capture thread to the sender thread without locks. Audio is cut
+// into frames of a fixed duration, so each frame becomes one transport message and its sequence
+// number gives its position in the stream. This file only depends on the C++ standard library.
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace VoipBackEnd
+{
+    // Single-producer, single-consumer ring of fixed-size frames.
+    //
+    // The producer hands over audio in whatever amounts the device delivers; Write copies it into
+    // the frame being filled and publishes each frame once it is full. If the consumer falls so far
+    // behind that no frame is free, the audio is dropped a whole frame at a time but the sequence
+    // number still advances, so the far end sees a gap rather than audio played late.
+    class AudioFrameRing
+    {
+    public:
+        struct Frame
+        {
+            uint64_t    sequence;   // Frames captured before this one, including dropped ones.
+            uint8_t*    data;       // GetFrameSize() bytes, owned by the ring.
+        };
+
+        AudioFrameRing(uint32_t frameSize, uint32_t frameCount);
+
+        AudioFrameRing(const AudioFrameRing&) = delete;
+        AudioFrameRing& operator=(const AudioFrameRing&) = delete;
+
+        uint32_t GetFrameSize() const { return m_frameSize; }
+
+        // Producer side. Returns the number of frames published.
+        uint32_t Write(const uint8_t* data, uint32_t byteCount);
+
+        // Consumer side. Peek returns the oldest published frame, which stays valid until Pop.
+        bool Peek(Frame& frame);
+        void Pop();
+
+        // Either side. Frames dropped because the ring was full.
+        uint64_t GetDroppedFrames() const;
+
+        // Only while neither side is running.
+        void Reset();
+
+    private:
+        const uint32_t          m_frameSize;
+        const uint32_t          m_frameCount;
+        std::vector<uint8_t>    m_storage;
+        std::vector<uint64_t>   m_sequences;
+
+        // Producer state.
+        uint64_t                m_nextSequence;
+        uint32_t                m_filled;           // Bytes written into the frame being filled.
+        bool                    m_dropping;         // The frame being filled had no room in the ring.
+
+        // Frames [m_tail, m_head) are published. Each index is written by one side only, and the
+        // padding keeps them on separate cache lines so the two threads do not contend for one.
+        // alignas would need aligned new, which this project's language level doesn't have.
+        std::atomic<uint64_t>   m_head;
+        char                    m_headPadding[64 - sizeof(std::atomic<uint64_t>)];
+        std::atomic<uint64_t>   m_tail;
+        char                    m_tailPadding[64 - sizeof(std::atomic<uint64_t>)];
+        std::atomic<uint64_t>   m_dropped;
+    };
+}
@@ -0,0 +1,414 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "AudioJitterBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace VoipBackEnd;
+
+namespace
+{
+    // Concealment repeats this much of the last audio played.
+    const uint32_t HistoryMilliseconds = 10;
+
+    // Packets are dropped from the front once the buffer spans this many times the maximum depth.
+    const uint32_t CapacityFactor = 2;
+
+    // A packet further than this from the play position means the sender's clock jumped.
+    const uint32_t ResyncMilliseconds = 1000;
+
+    uint32_t MillisecondsToFrames(uint32_t sampleRate, uint32_t milliseconds)
+    {
+        return std::max<uint32_t>(1, static_cast<uint32_t>(static_cast<uint64_t>(sampleRate) * milliseconds / 1000));
+    }
+}
+
+AudioJitterBuffer::AudioJitterBuffer(uint32_t sampleRate, uint32_t channels, uint32_t bitsPerSample) :
+    m_sampleRate(std::max<uint32_t>(1, sampleRate)),
+    m_channels(std::max<uint32_t>(1, channels)),
+    m_bytesPerSample(std::max<uint32_t>(1, bitsPerSample / 8)),
+    m_frameSize(m_channels * m_bytesPerSample),
+    m_minDepthFrames(MillisecondsToFrames(m_sampleRate, MinDepthMilliseconds)),
+    m_maxDepthFrames(MillisecondsToFrames(m_sampleRate, MaxDepthMilliseconds)),
+    m_fadeFrames(MillisecondsToFrames(m_sampleRate, ConcealmentFadeMilliseconds)),
+    m_historyFrames(MillisecondsToFrames(m_sampleRate, HistoryMilliseconds)),
+    m_history(m_historyFrames * m_frameSize)
+{
+    m_packets.reserve(64);
+    Reset();
+}
+
+void AudioJitterBuffer::Insert(uint64_t position, const uint8_t* data, uint32_t frameCount, uint64_t arrivalMicroseconds)
+{
+    if (data == nullptr || frameCount == 0)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_stats.packetsReceived++;
+
+    uint64_t reference = m_havePosition ? m_playPosition : m_packets.empty() ? position : m_packets.front().position;
+    uint64_t distance = (position > reference) ? position - reference : reference - position;
+    if (distance > static_cast<uint64_t>(m_sampleRate) * ResyncMilliseconds / 1000)
+    {
+        ResetLocked();
+        m_stats.resyncs++;
+    }
+
+    // Late packets still say something about the network, so they count towards the jitter.
+    UpdateTarget(position, frameCount, arrivalMicroseconds);
+
+    // Work out which part of the packet is new: not yet due, and not already buffered.
+    uint64_t start = position;
+    uint64_t end = position + frameCount;
+    if (m_havePosition && start < m_playPosition)
+    {
+        if (end <= m_playPosition)
+        {
+            m_stats.packetsLate++;
+            return;
+        }
+
+        start = m_playPosition;
+    }
+
+    auto next = std::upper_bound(m_packets.begin(), m_packets.end(), start,
+        [](uint64_t value, const Packet& packet) { return value < packet.position; });
+    if (next != m_packets.begin())
+    {
+        const Packet& previous = *(next - 1);
+        start = std::max(start, previous.position + previous.frameCount);
+    }
+
+    if (next != m_packets.end())
+    {
+        end = std::min(end, next->position);
+    }
+
+    if (start >= end)
+    {
+        m_stats.packetsDuplicate++;
+        return;
+    }
+
+    Packet packet;
+    packet.position = start;
+    packet.frameCount = static_cast<uint32_t>(end - start);
+    if (!m_spare.empty())
+    {
+        packet.data = std::move(m_spare.back());
+        m_spare.pop_back();
+    }
+
+    const uint8_t* source = data + (start - position) * m_frameSize;
+    packet.data.assign(source, source + packet.frameCount * m_frameSize);
+    m_packets.insert(next, std::move(packet));
+
+    // Past this point the sender is far ahead of playback; skip the oldest audio rather than
+    // letting the latency grow without bound.
+    uint64_t capacity = static_cast<uint64_t>(m_maxDepthFrames) * CapacityFactor;
+    while (m_packets.size() > 1 &&
+        m_packets.back().position + m_packets.back().frameCount - m_packets.front().position > capacity)
+    {
+        RecycleFront();
+        m_stats.packetsOverflow++;
+    }
+
+    if (m_havePosition)
+    {
+        m_playPosition = std::max(m_playPosition, m_packets.front().position);
+    }
+}
+
+void AudioJitterBuffer::Read(uint8_t* output, uint32_t frameCount)
+{
+    if (output == nullptr || frameCount == 0)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    if (!m_playing)
+    {
+        if (m_packets.empty() || BufferedFramesLocked() < std::max(m_targetDepthFrames, frameCount))
+        {
+            Conceal(output, frameCount);
+            return;
+        }
+
+        // Resume from the earliest audio still buffered; anything before it is gone.
+        if (!m_havePosition || m_playPosition < m_packets.front().position)
+        {
+            m_playPosition = m_packets.front().position;
+        }
+
+        m_havePosition = true;
+        m_playing = true;
+    }
+
+    uint32_t buffered = BufferedFramesLocked();
+    if (buffered > m_targetDepthFrames + m_minDepthFrames)
+    {
+        m_shrinking = true;
+    }
+    else if (buffered <= m_targetDepthFrames)
+    {
+        m_shrinking = false;
+    }
+
+    if (m_shrinking && frameCount > 1)
+    {
+        // Take about 3% more audio than was asked for and squeeze it into the output.
+        uint32_t inputFrames = frameCount + frameCount / 32 + 1;
+        m_scratch.resize(static_cast<size_t>(inputFrames) * m_frameSize);
+        Gather(m_scratch.data(), inputFrames);
+        Resample(m_scratch.data(), inputFrames, output, frameCount);
+        m_stats.framesSkipped += inputFrames - frameCount;
+    }
+    else
+    {
+        Gather(output, frameCount);
+    }
+}
+
+void AudioJitterBuffer::Reset()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    ResetLocked();
+
+    m_jitter = 0.0;
+    m_targetDepthFrames = m_minDepthFrames * 2;
+    m_stats = JitterBufferStats();
+}
+
+uint32_t AudioJitterBuffer::GetBufferedFrames() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return BufferedFramesLocked();
+}
+
+JitterBufferStats AudioJitterBuffer::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    JitterBufferStats stats = m_stats;
+    stats.targetDepthFrames = m_targetDepthFrames;
+    stats.jitterFrames = static_cast<uint32_t>(m_jitter * m_sampleRate / 1000000.0);
+    return stats;
+}
+
+void AudioJitterBuffer::ResetLocked()
+{
+    while (!m_packets.empty())
+    {
+        RecycleFront();
+    }
+
+    m_historyFilled = 0;
+    m_playPosition = 0;
+    m_havePosition = false;
+    m_playing = false;
+    m_shrinking = false;
+    m_concealedRun = 0;
+    m_haveTransit = false;
+    m_lastTransit = 0.0;
+}
+
+uint32_t AudioJitterBuffer::BufferedFramesLocked() const
+{
+    if (m_packets.empty())
+    {
+        return 0;
+    }
+
+    // While playing, gaps ahead of the play position still count: they are time that has to be
+    // concealed before the buffered audio comes up.
+    uint64_t start = m_playing ? m_playPosition : m_packets.front().position;
+    uint64_t end = m_packets.back().position + m_packets.back().frameCount;
+    return (end > start) ? static_cast<uint32_t>(end - start) : 0;
+}
+
+void AudioJitterBuffer::UpdateTarget(uint64_t position, uint32_t frameCount, uint64_t arrivalMicroseconds)
+{
+    // RFC 3550 interarrival jitter: a running average of how much the transit time changes from
+    // one packet to the next. The transit time includes an unknown clock offset, which cancels.
+    double transit = static_cast<double>(arrivalMicroseconds) - static_cast<double>(position) * 1000000.0 / m_sampleRate;
+    if (m_haveTransit)
+    {
+        m_jitter += (std::fabs(transit - m_lastTransit) - m_jitter) / 16.0;
+    }
+
+    m_lastTransit = transit;
+    m_haveTransit = true;
+
+    // Enough to cover one packet plus most of the arrival spread.
+    double jitterFrames = m_jitter * m_sampleRate / 1000000.0;
+    double target = static_cast<double>(frameCount) + 4.0 * jitterFrames;
+    target = std::min(std::max(target, static_cast<double>(m_minDepthFrames)), static_cast<double>(m_maxDepthFrames));
+    m_targetDepthFrames = static_cast<uint32_t>(target);
+}
+
+void AudioJitterBuffer::Gather(uint8_t* output, uint32_t frameCount)
+{
+    uint32_t done = 0;
+    while (done < frameCount)
+    {
+        while (!m_packets.empty() && m_packets.front().position + m_packets.front().frameCount <= m_playPosition)
+        {
+            RecycleFront();
+        }
+
+        uint8_t* destination = output + static_cast<size_t>(done) * m_frameSize;
+        uint32_t remaining = frameCount - done;
+
+        if (m_packets.empty())
+        {
+            // Ran dry. Hold the play position and fill up to the target again before resuming.
+            Conceal(destination, remaining);
+            m_playing = false;
+            m_shrinking = false;
+            m_stats.underruns++;
+            return;
+        }
+
+        const Packet& front = m_packets.front();
+        if (front.position > m_playPosition)
+        {
+            // Lost or still in flight; by now it is too late either way.
+            uint32_t gap = static_cast<uint32_t>(std::min<uint64_t>(remaining, front.position - m_playPosition));
+            Conceal(destination, gap);
+            m_playPosition += gap;
+            done += gap;
+            continue;
+        }
+
+        uint32_t offset = static_cast<uint32_t>(m_playPosition - front.position);
+        uint32_t count = std::min(remaining, front.frameCount - offset);
+        const uint8_t* source = front.data.data() + static_cast<size_t>(offset) * m_frameSize;
+        memcpy(destination, source, static_cast<size_t>(count) * m_frameSize);
+        KeepHistory(source, count);
+
+        m_concealedRun = 0;
+        m_stats.framesPlayed += count;
+        m_playPosition += count;
+        done += count;
+    }
+}
+
+void AudioJitterBuffer::Conceal(uint8_t* output, uint32_t frameCount)
+{
+    // Silence before anything has played is just the start of the call, not a loss.
+    if (m_havePosition)
+    {
+        m_stats.framesConcealed += frameCount;
+    }
+
+    bool supported = (m_bytesPerSample == 2 || m_bytesPerSample == 4);
+    uint32_t done = 0;
+    if (supported && m_historyFilled != 0)
+    {
+        for (; done < frameCount && m_concealedRun < m_fadeFrames; done++, m_concealedRun++)
+        {
+            const uint8_t* source = m_history.data() + static_cast<size_t>(m_concealedRun % m_historyFilled) * m_frameSize;
+            uint8_t* destination = output + static_cast<size_t>(done) * m_frameSize;
+            int64_t gain = (static_cast<int64_t>(m_fadeFrames - m_concealedRun) << 16) / m_fadeFrames;
+            for (uint32_t channel = 0; channel < m_channels; channel++)
+            {
+                int64_t sample = LoadSample(source + channel * m_bytesPerSample);
+                StoreSample(destination + channel * m_bytesPerSample, static_cast<int32_t>((sample * gain) >> 16));
+            }
+        }
+    }
+
+    memset(output + static_cast<size_t>(done) * m_frameSize, 0, static_cast<size_t>(frameCount - done) * m_frameSize);
+    m_concealedRun = std::min(m_fadeFrames, m_concealedRun + (frameCount - done));
+}
+
+void AudioJitterBuffer::Resample(const uint8_t* input, uint32_t inputFrames, uint8_t* output, uint32_t outputFrames) const
+{
+    if (m_bytesPerSample != 2 && m_bytesPerSample != 4)
+    {
+        // No sample arithmetic for this format; dropping the tail is the best that can be done.
+        memcpy(output, input, static_cast<size_t>(outputFrames) * m_frameSize);
+        return;
+    }
+
+    // Linear interpolation in 16.16 fixed point, mapping the first and last frames onto each other.
+    uint64_t step = (static_cast<uint64_t>(inputFrames - 1) << 16) / (outputFrames - 1);
+    for (uint32_t i = 0; i < outputFrames; i++)
+    {
+        uint64_t point = i * step;
+        uint32_t index = static_cast<uint32_t>(point >> 16);
+        int64_t fraction = static_cast<int64_t>(point & 0xFFFF);
+        uint32_t following = std::min(index + 1, inputFrames - 1);
+
+        const uint8_t* a = input + static_cast<size_t>(index) * m_frameSize;
+        const uint8_t* b = input + static_cast<size_t>(following) * m_frameSize;
+        uint8_t* destination = output + static_cast<size_t>(i) * m_frameSize;
+        for (uint32_t channel = 0; channel < m_channels; channel++)
+        {
+            int64_t first = LoadSample(a + channel * m_bytesPerSample);
+            int64_t second = LoadSample(b + channel * m_bytesPerSample);
+            StoreSample(destination + channel * m_bytesPerSample, static_cast<int32_t>(first + (((second - first) * fraction) >> 16)));
+        }
+    }
+}
+
+void AudioJitterBuffer::KeepHistory(const uint8_t* data, uint32_t frameCount)
+{
+    if (frameCount >= m_historyFrames)
+    {
+        memcpy(m_history.data(), data + static_cast<size_t>(frameCount - m_historyFrames) * m_frameSize, m_history.size());
+        m_historyFilled = m_historyFrames;
+        return;
+    }
+
+    uint32_t keep = std::min(m_historyFilled, m_historyFrames - frameCount);
+    memmove(m_history.data(), m_history.data() + static_cast<size_t>(m_historyFilled - keep) * m_frameSize, static_cast<size_t>(keep) * m_frameSize);
+    memcpy(m_history.data() + static_cast<size_t>(keep) * m_frameSize, data, static_cast<size_t>(frameCount) * m_frameSize);
+    m_historyFilled = keep + frameCount;
+}
+
+void AudioJitterBuffer::RecycleFront()
+{
+    m_spare.push_back(std::move(m_packets.front().data));
+    m_packets.erase(m_packets.begin());
+}
+
+int32_t AudioJitterBuffer::LoadSample(const uint8_t* data) const
+{
+    if (m_bytesPerSample == 2)
+    {
+        int16_t value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    int32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+void AudioJitterBuffer::StoreSample(uint8_t* data, int32_t value) const
+{
+    if (m_bytesPerSample == 2)
+    {
+        int16_t narrow = static_cast<int16_t>(value);
+        memcpy(data, &narrow, sizeof(narrow));
+        return;
+    }
+
+    memcpy(data, &value, sizeof(value));
+}
@@ -0,0 +1,128 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+// Playout buffer between the network transport and the render client. Packets are placed on the
+// sender's sample clock, so they play in order however they arrive, and the render thread takes a
+// fixed number of frames whenever the device asks for more. This file only depends on the C++
+// standard library.
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace VoipBackEnd
+{
+    struct JitterBufferStats
+    {
+        uint64_t packetsReceived;
+        uint64_t packetsLate;           // Arrived after their audio was due and were dropped.
+        uint64_t packetsDuplicate;
+        uint64_t packetsOverflow;       // Pushed out because the buffer was full.
+        uint64_t resyncs;               // The sender's clock jumped, so the buffer started over.
+        uint64_t framesPlayed;          // Received audio that was rendered.
+        uint64_t framesConcealed;       // Made up to cover lost, late or missing audio.
+        uint64_t framesSkipped;         // Played out early to shrink the buffer.
+        uint64_t underruns;             // Times the buffer ran dry and had to fill up again.
+        uint32_t targetDepthFrames;
+        uint32_t jitterFrames;          // Estimated inter-arrival jitter.
+    };
+
+    // Adaptive jitter buffer for interleaved 16 or 32-bit integer PCM.
+    //
+    // Insert is called by the network thread with the packet's position, in frames, on the
+    // sender's clock. Read is called by the render thread and always produces the number of frames
+    // asked for. Gaps are covered by repeating the last audio played, fading to silence over
+    // ConcealmentFadeMilliseconds. When the buffer runs dry it conceals and waits until it holds
+    // the target depth again before resuming.
+    //
+    // The target depth follows the inter-arrival jitter, estimated as in RFC 3550. When the buffer
+    // holds more than the target plus MinDepthMilliseconds, playback runs about 3% fast until it
+    // is back down to the target, so the added latency shrinks again once the network settles.
+    class AudioJitterBuffer
+    {
+    public:
+        static const uint32_t MinDepthMilliseconds = 20;
+        static const uint32_t MaxDepthMilliseconds = 300;
+        static const uint32_t ConcealmentFadeMilliseconds = 60;
+
+        AudioJitterBuffer(uint32_t sampleRate, uint32_t channels, uint32_t bitsPerSample);
+
+        AudioJitterBuffer(const AudioJitterBuffer&) = delete;
+        AudioJitterBuffer& operator=(const AudioJitterBuffer&) = delete;
+
+        // Network side. arrivalMicroseconds is the local time the packet arrived, on any steady
+        // clock.
+        void Insert(uint64_t position, const uint8_t* data, uint32_t frameCount, uint64_t arrivalMicroseconds);
+
+        // Render side.
+        void Read(uint8_t* output, uint32_t frameCount);
+
+        void Reset();
+
+        uint32_t GetSampleRate() const { return m_sampleRate; }
+        uint32_t GetFrameSize() const { return m_frameSize; }
+
+        // Frames between the play position and the end of the newest packet.
+        uint32_t GetBufferedFrames() const;
+
+        JitterBufferStats GetStats() const;
+
+    private:
+        struct Packet
+        {
+            uint64_t                position;
+            uint32_t                frameCount;
+            std::vector<uint8_t>    data;
+        };
+
+        void ResetLocked();
+        uint32_t BufferedFramesLocked() const;
+        void UpdateTarget(uint64_t position, uint32_t frameCount, uint64_t arrivalMicroseconds);
+        void Gather(uint8_t* output, uint32_t frameCount);
+        void Conceal(uint8_t* output, uint32_t frameCount);
+        void Resample(const uint8_t* input, uint32_t inputFrames, uint8_t* output, uint32_t outputFrames) const;
+        void KeepHistory(const uint8_t* data, uint32_t frameCount);
+        void RecycleFront();
+
+        int32_t LoadSample(const uint8_t* data) const;
+        void StoreSample(uint8_t* data, int32_t value) const;
+
+        const uint32_t                      m_sampleRate;
+        const uint32_t                      m_channels;
+        const uint32_t                      m_bytesPerSample;
+        const uint32_t                      m_frameSize;
+        const uint32_t                      m_minDepthFrames;
+        const uint32_t                      m_maxDepthFrames;
+        const uint32_t                      m_fadeFrames;
+        const uint32_t                      m_historyFrames;
+
+        mutable std::mutex                  m_lock;
+
+        std::vector<Packet>                 m_packets;          // Sorted by position, never overlapping.
+        std::vector<std::vector<uint8_t>>   m_spare;            // Packet storage kept for reuse.
+        std::vector<uint8_t>                m_history;          // The last real audio played.
+        uint32_t                            m_historyFilled;
+        std::vector<uint8_t>                m_scratch;
+        uint64_t                            m_playPosition;
+        bool                                m_havePosition;     // Something has played since the last reset.
+        bool                                m_playing;          // False while filling up to the target.
+        bool                                m_shrinking;
+        uint32_t                            m_concealedRun;     // Frames concealed since the last real audio.
+
+        bool                                m_haveTransit;
+        double                              m_lastTransit;      // Microseconds.
+        double                              m_jitter;           // Microseconds.
+        uint32_t                            m_targetDepthFrames;
+
+        JitterBufferStats                   m_stats;
+    };
+}
@@ -14,6 +14,8 @@
 #include "BackEndNativeBuffer.h"
 #include "BackEndAudioHelpers.h"
 
+#include <chrono>
+
 using namespace VoipBackEnd;
 using namespace Windows::System::Threading;
 using namespace Windows::Media::Devices;
@@ -29,55 +31,36 @@ BackEndAudio::BackEndAudio() :
     m_pCaptureClient(NULL),
     m_sourceFrameSizeInBytes(0),
     hCaptureEvent(NULL),
+    hRenderEvent(NULL),
+    hSendEvent(NULL),
     hShutdownEvent(NULL),
     m_CaptureThread(nullptr),
+    m_RenderThread(nullptr),
+    m_SendThread(nullptr),
     transportController(nullptr),
     started(false)
 {
     this->onTransportMessageReceivedHandler = ref new MessageReceivedEventHandler(this, &BackEndAudio::OnTransportMessageReceived);
 }
 
-void BackEndAudio::OnTransportMessageReceived(Windows::Storage::Streams::IBuffer^ stream, UINT64, UINT64)
+void BackEndAudio::OnTransportMessageReceived(Windows::Storage::Streams::IBuffer^ stream, UINT64 hnsPresentationTime, UINT64)
 {
     BYTE* pBuffer = NativeBuffer::GetBytesFromIBuffer(stream);
-    int size = stream->Length;
+    unsigned int size = stream->Length;
 
-    while (m_pRenderClient && size && pBuffer)
+    if (!m_jitterBuffer || !pBuffer || size < m_jitterBuffer->GetFrameSize())
     {
-        HRESULT hr = E_FAIL;
-        unsigned int padding = 0;
-
-        hr = m_pDefaultRenderDevice->GetCurrentPadding(&padding);
-        if (SUCCEEDED(hr))
-        {
-            BYTE* pRenderBuffer = NULL;
-            unsigned int incomingFrameCount = size / m_sourceFrameSizeInBytes;
-            unsigned int framesToWrite = m_nMaxFrameCount - padding;
-            
-            if (framesToWrite > incomingFrameCount)
-            {
-                framesToWrite = incomingFrameCount;
-            }
-
-            if (framesToWrite)
-            {
-                hr = m_pRenderClient->GetBuffer(framesToWrite, &pRenderBuffer);
-
-                if (SUCCEEDED(hr))
-                {
-                    unsigned int bytesToBeWritten = framesToWrite * m_sourceFrameSizeInBytes;
-
-                    memcpy(pRenderBuffer, pBuffer, bytesToBeWritten);
+        return;
+    }
 
-                    // Release the buffer
-                    m_pRenderClient->ReleaseBuffer(framesToWrite, 0);
+    // The sender stamps each packet with its position in the stream; turn it back into frames so
+    // the jitter buffer can put packets in order and spot the missing ones. The render thread
+    // takes the audio out when the device asks for it.
+    UINT64 sampleRate = m_jitterBuffer->GetSampleRate();
+    UINT64 position = (hnsPresentationTime / 10000000) * sampleRate + (hnsPresentationTime % 10000000) * sampleRate / 10000000;
+    UINT64 arrival = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
 
-                    pBuffer += bytesToBeWritten;
-                    size -= bytesToBeWritten;
-                }
-            }
-        }
-    }
+    m_jitterBuffer->Insert(position, pBuffer, size / m_jitterBuffer->GetFrameSize(), arrival);
 }
 
 void BackEndAudio::Start()
@@ -121,6 +104,20 @@ void BackEndAudio::Stop()
         m_CaptureThread = nullptr;
     }
 
+    if (m_RenderThread != nullptr)
+    {
+        m_RenderThread->Cancel();
+        m_RenderThread->Close();
+        m_RenderThread = nullptr;
+    }
+
+    if (m_SendThread != nullptr)
+    {
+        m_SendThread->Cancel();
+        m_SendThread->Close();
+        m_SendThread = nullptr;
+    }
+
     if (m_pDefaultRenderDevice)
     {
         m_pDefaultRenderDevice->Stop();
@@ -178,6 +175,23 @@ void BackEndAudio::Stop()
         hCaptureEvent = NULL;
     }
 
+    if (hRenderEvent)
+    {
+        CloseHandle(hRenderEvent);
+        hRenderEvent = NULL;
+    }
+
+    if (hSendEvent)
+    {
+        CloseHandle(hSendEvent);
+        hSendEvent = NULL;
+    }
+
+    if (m_jitterBuffer)
+    {
+        m_jitterBuffer->Reset();
+    }
+
     if (hShutdownEvent)
     {
         CloseHandle(hShutdownEvent);
@@ -191,62 +205,132 @@ void BackEndAudio::Stop()
 void BackEndAudio::CaptureThread(Windows::Foundation::IAsyncAction^ operation)
 {
     HRESULT hr = m_pDefaultCaptureDevice->Start();
-    BYTE *pLocalBuffer = new BYTE[MAX_RAW_BUFFER_SIZE];
     HANDLE eventHandles[] = {
                              hCaptureEvent,        // WAIT_OBJECT0 
                              hShutdownEvent        // WAIT_OBJECT0 + 1
                             };
 
-    if (SUCCEEDED(hr) && pLocalBuffer)
+    while (SUCCEEDED(hr))
     {
-        unsigned int uAccumulatedBytes = 0;
-        while (SUCCEEDED(hr))
+        DWORD waitResult = WaitForMultipleObjectsEx(SIZEOF_ARRAY(eventHandles), eventHandles, FALSE, INFINITE, FALSE);
+        if (WAIT_OBJECT_0 == waitResult)
         {
-            DWORD waitResult = WaitForMultipleObjectsEx(SIZEOF_ARRAY(eventHandles), eventHandles, FALSE, INFINITE, FALSE);
-            if (WAIT_OBJECT_0 == waitResult)
+            BYTE* pbData = nullptr;
+            UINT32 nFrames = 0;
+            DWORD dwFlags = 0;
+            hr = m_pCaptureClient->GetBuffer(&pbData, &nFrames, &dwFlags, nullptr, nullptr);
+
+            if (SUCCEEDED(hr))
             {
-                BYTE* pbData = nullptr;
-                UINT32 nFrames = 0;
-                DWORD dwFlags = 0;
-                if (SUCCEEDED(hr))
+                // Cut the audio into packets for the send thread. This never waits on the network;
+                // if the send thread falls behind, whole packets are dropped and the far end
+                // conceals them
+                if (m_captureRing->Write(pbData, nFrames * m_sourceFrameSizeInBytes) > 0)
                 {
-                    hr = m_pCaptureClient->GetBuffer(&pbData, &nFrames, &dwFlags, nullptr, nullptr);
-                    unsigned int incomingBufferSize = nFrames * m_sourceFrameSizeInBytes;
-
-                    if (MAX_RAW_BUFFER_SIZE - uAccumulatedBytes < incomingBufferSize)
-                    {
-                        // Send what has been accumulated
-                        if (transportController)
-                        {
-                            transportController->WriteAudio(pLocalBuffer, uAccumulatedBytes);
-                        }
-
-                        // Reset our counter
-                        uAccumulatedBytes = 0;
-                    }
-
-                    memcpy(pLocalBuffer + uAccumulatedBytes, pbData, incomingBufferSize);
-                    uAccumulatedBytes += incomingBufferSize;
+                    SetEvent(hSendEvent);
                 }
 
-                if (SUCCEEDED(hr))
-                {
-                    hr = m_pCaptureClient->ReleaseBuffer(nFrames);
-                }
+                hr = m_pCaptureClient->ReleaseBuffer(nFrames);
             }
-            else if (WAIT_OBJECT_0 + 1 == waitResult)
+        }
+        else if (WAIT_OBJECT_0 + 1 == waitResult)
+        {
+            // We're being asked to shutdown
+            break;
+        }
+        else
+        {
+            // Unknown return value
+            DbgRaiseAssertionFailure();
+        }
+    }
+}
+
+void BackEndAudio::SendThread(Windows::Foundation::IAsyncAction^ operation)
+{
+    HANDLE eventHandles[] = {
+                             hSendEvent,           // WAIT_OBJECT0 
+                             hShutdownEvent        // WAIT_OBJECT0 + 1
+                            };
+
+    UINT64 sampleRate = m_pwfx->nSamplesPerSec;
+    UINT64 packetFrames = m_captureRing->GetFrameSize() / m_sourceFrameSizeInBytes;
+    UINT64 hnsSampleDuration = packetFrames * 10000000 / sampleRate;
+
+    while (true)
+    {
+        DWORD waitResult = WaitForMultipleObjectsEx(SIZEOF_ARRAY(eventHandles), eventHandles, FALSE, INFINITE, FALSE);
+        if (WAIT_OBJECT_0 == waitResult)
+        {
+            // Each packet is stamped with its position in the stream, so the far end can put them
+            // back in order and tell which ones are missing
+            AudioFrameRing::Frame frame;
+            while (m_captureRing->Peek(frame))
             {
-                // We're being asked to shutdown
-                break;
+                if (transportController)
+                {
+                    UINT64 hnsPresentationTime = frame.sequence * packetFrames * 10000000 / sampleRate;
+                    transportController->WriteAudio(frame.data, m_captureRing->GetFrameSize(), hnsPresentationTime, hnsSampleDuration);
+                }
+
+                m_captureRing->Pop();
             }
-            else
+        }
+        else if (WAIT_OBJECT_0 + 1 == waitResult)
+        {
+            // We're being asked to shutdown
+            break;
+        }
+        else
+        {
+            // Unknown return value
+            DbgRaiseAssertionFailure();
+        }
+    }
+}
+
+void BackEndAudio::RenderThread(Windows::Foundation::IAsyncAction^ operation)
+{
+    HANDLE eventHandles[] = {
+                             hRenderEvent,         // WAIT_OBJECT0 
+                             hShutdownEvent        // WAIT_OBJECT0 + 1
+                            };
+
+    HRESULT hr = S_OK;
+    while (SUCCEEDED(hr))
+    {
+        DWORD waitResult = WaitForMultipleObjectsEx(SIZEOF_ARRAY(eventHandles), eventHandles, FALSE, INFINITE, FALSE);
+        if (WAIT_OBJECT_0 == waitResult)
+        {
+            // The device wants more audio; fill whatever space it has from the jitter buffer,
+            // which conceals anything that has not arrived in time
+            unsigned int padding = 0;
+            hr = m_pDefaultRenderDevice->GetCurrentPadding(&padding);
+
+            unsigned int framesToWrite = m_nMaxFrameCount - padding;
+            if (SUCCEEDED(hr) && framesToWrite)
             {
-                // Unknown return value
-                DbgRaiseAssertionFailure();
+                BYTE* pRenderBuffer = NULL;
+                hr = m_pRenderClient->GetBuffer(framesToWrite, &pRenderBuffer);
+
+                if (SUCCEEDED(hr))
+                {
+                    m_jitterBuffer->Read(pRenderBuffer, framesToWrite);
+                    hr = m_pRenderClient->ReleaseBuffer(framesToWrite, 0);
+                }
             }
         }
+        else if (WAIT_OBJECT_0 + 1 == waitResult)
+        {
+            // We're being asked to shutdown
+            break;
+        }
+        else
+        {
+            // Unknown return value
+            DbgRaiseAssertionFailure();
+        }
     }
-    delete[] pLocalBuffer;
 }
 
 HRESULT BackEndAudio::StartAudioThreads()
@@ -256,8 +340,19 @@ HRESULT BackEndAudio::StartAudioThreads()
     {
         return HRESULT_FROM_WIN32(GetLastError());
     }
+
+    hSendEvent = CreateEventEx(NULL, NULL, 0, EVENT_ALL_ACCESS);
+    if (!hSendEvent)
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    // Nothing else touches the ring until the threads below start
+    m_captureRing->Reset();
     
     m_CaptureThread = ThreadPool::RunAsync(ref new WorkItemHandler(this, &BackEndAudio::CaptureThread), WorkItemPriority::High, WorkItemOptions::TimeSliced);
+    m_SendThread = ThreadPool::RunAsync(ref new WorkItemHandler(this, &BackEndAudio::SendThread), WorkItemPriority::High, WorkItemOptions::TimeSliced);
+    m_RenderThread = ThreadPool::RunAsync(ref new WorkItemHandler(this, &BackEndAudio::RenderThread), WorkItemPriority::High, WorkItemOptions::TimeSliced);
     return S_OK;
 }
 
@@ -298,6 +393,18 @@ STDMETHODIMP BackEndAudio::OnCaptureActivateCompleted()
         *m_pwfx = temp;
         m_sourceFrameSizeInBytes = (m_pwfx->wBitsPerSample / 8) * m_pwfx->nChannels;
 
+        // The far end sends the same format, so incoming audio is buffered in it too
+        if (!m_jitterBuffer)
+        {
+            m_jitterBuffer.reset(new AudioJitterBuffer(m_pwfx->nSamplesPerSec, m_pwfx->nChannels, m_pwfx->wBitsPerSample));
+        }
+
+        if (!m_captureRing)
+        {
+            unsigned int packetFrames = m_pwfx->nSamplesPerSec * AUDIO_PACKET_DURATION_MS / 1000;
+            m_captureRing.reset(new AudioFrameRing(packetFrames * m_sourceFrameSizeInBytes, CAPTURE_RING_PACKETS));
+        }
+
         hr = m_pDefaultCaptureDevice->Initialize(AUDCLNT_SHAREMODE_SHARED, 0x88140000, 1000 * 10000, 0, m_pwfx, NULL);
     }
 
@@ -361,13 +468,27 @@ STDMETHODIMP BackEndAudio::OnRenderActivateCompleted()
     {
         FillPcmFormat(format, pwfx->nChannels, pwfx->nSamplesPerSec, pwfx->wBitsPerSample);
         hr = m_pDefaultRenderDevice->Initialize(AUDCLNT_SHAREMODE_SHARED,
-            0,
-            2000 * 10000,  // Seconds in hns
+            AUDCLNT_STREAMFLAGS_EVENTCALLBACK,
+            AUDIO_PACKET_DURATION_MS * 10000,  // Milliseconds in hns; the jitter buffer holds the rest
             0, // periodicity
             &format,
             NULL);
     }
 
+    if (SUCCEEDED(hr))
+    {
+        hRenderEvent = CreateEventEx(NULL, NULL, 0, EVENT_ALL_ACCESS);
+        if (NULL == hRenderEvent)
+        {
+            hr = HRESULT_FROM_WIN32(GetLastError());
+        }
+    }
+
+    if (SUCCEEDED(hr))
+    {
+        hr = m_pDefaultRenderDevice->SetEventHandle(hRenderEvent);
+    }
+
     if (SUCCEEDED(hr))
     {
         hr = m_pDefaultRenderDevice->GetService(__uuidof(IAudioRenderClient), (void**)&m_pRenderClient);
@@ -11,7 +11,8 @@
 #pragma once
 #include "windows.h"
 
-#define MAX_RAW_BUFFER_SIZE 1024*128
+#define AUDIO_PACKET_DURATION_MS 20
+#define CAPTURE_RING_PACKETS 16
 
 #include <synchapi.h>
 #include <audioclient.h>
@@ -19,6 +20,10 @@
 #include <wrl\implements.h>
 
 #include "BackEndTransport.h"
+#include "AudioFrameRing.h"
+#include "AudioJitterBuffer.h"
+
+#include <memory>
 
 using namespace Microsoft::WRL;
 
@@ -68,7 +73,9 @@ namespace VoipBackEnd
         HRESULT InitCapture();
         HRESULT StartAudioThreads();
         void CaptureThread(Windows::Foundation::IAsyncAction^ operation);
-        void OnTransportMessageReceived(Windows::Storage::Streams::IBuffer^ stream, UINT64, UINT64);
+        void RenderThread(Windows::Foundation::IAsyncAction^ operation);
+        void SendThread(Windows::Foundation::IAsyncAction^ operation);
+        void OnTransportMessageReceived(Windows::Storage::Streams::IBuffer^ stream, UINT64 hnsPresentationTime, UINT64 hnsSampleDuration);
             
         BackEndTransport^ transportController;
 
@@ -94,11 +101,21 @@ namespace VoipBackEnd
         // Audio buffer size
         UINT32 m_nMaxFrameCount;
         HANDLE hCaptureEvent;
+        HANDLE hRenderEvent;
+
+        // Incoming audio waits here until the render device asks for it
+        std::unique_ptr<AudioJitterBuffer> m_jitterBuffer;
+
+        // Captured audio waits here, cut into packets, until the send thread passes it to the transport
+        std::unique_ptr<AudioFrameRing> m_captureRing;
+        HANDLE hSendEvent;
 
         // Event for stopping audio capture/render
         HANDLE hShutdownEvent;
 
         Windows::Foundation::IAsyncAction^ m_CaptureThread;
+        Windows::Foundation::IAsyncAction^ m_RenderThread;
+        Windows::Foundation::IAsyncAction^ m_SendThread;
 
         ComPtr<CaptureActivationHelper> m_spCaptureActivationHelper;
         ComPtr<RenderActivationHelper> m_spRenderActivationHelper;
@@ -24,16 +24,38 @@ using namespace Windows::Networking::Sockets;
 using namespace Windows::Networking;
 using namespace Concurrency;
 
+namespace
+{
+    // Datagrams that can be in flight at once; a 20ms audio packet needs one
+    const unsigned int DatagramCount = 16;
+
+    // Largest message the receiver will put back together
+    const unsigned int MaxMessageSize = 16 * 1024 * 1024;
+}
+
 BackEndTransport::BackEndTransport() :
     isConnected(false),
     isListening(false),
     outputStream(nullptr),
-    writer(nullptr),
-    headerSize(sizeof(UINT32)*2 + sizeof(UINT64)*2),
-    MaxPacketSize(50*1024)
+    MaxPacketSize(50*1024),
+    fragmenter(MaxPacketSize),
+    audioReassembler(MaxMessageSize),
+    videoReassembler(MaxMessageSize)
 {
     InitializeCriticalSectionEx(&lock, 0, 0);
     InitializeCriticalSectionEx(&readLock, 0, 0);
+
+    for (unsigned int i = 0; i < DatagramCount; i++)
+    {
+        auto datagram = std::make_shared<DatagramBuffer>();
+        datagram->bytes.resize(MaxPacketSize);
+        datagram->inUse = false;
+        if (SUCCEEDED(MakeAndInitialize<NativeBuffer>(&datagram->nativeBuffer, datagram->bytes.data(), MaxPacketSize, FALSE)))
+        {
+            datagrams.push_back(datagram);
+        }
+    }
+
     Listen("12345");
 }
 
@@ -82,9 +104,9 @@ void VoipBackEnd::BackEndTransport::Disconnect()
     isConnected = false;
 }
 
-void BackEndTransport::WriteAudio(BYTE* bytes, int byteCount)
+void BackEndTransport::WriteAudio(BYTE* bytes, int byteCount, UINT64 hnsPresentationTime, UINT64 hnsSampleDuration)
 {
-    Write(bytes, byteCount, TransportMessageType::Audio, 0, 0);
+    Write(bytes, byteCount, TransportMessageType::Audio, hnsPresentationTime, hnsSampleDuration);
 }
 
 void BackEndTransport::WriteVideo(BYTE* bytes, int byteCount, UINT64 hnsPresenationTime, UINT64 hnsSampleDuration)
@@ -95,9 +117,6 @@ void BackEndTransport::WriteVideo(BYTE* bytes, int byteCount, UINT64 hnsPresenat
 
 void BackEndTransport::Write(BYTE* bytes, unsigned int byteCount, TransportMessageType::Value dataType, UINT64 hnsPresentationTime, UINT64 hnsSampleDuration)
 {
-    
-    unsigned int chunkSize = byteCount > MaxPacketSize - headerSize ? MaxPacketSize - headerSize: byteCount;
-    
     if (!isConnected)
     {
         Connect("127.0.0.1", "12345");
@@ -105,103 +124,135 @@ void BackEndTransport::Write(BYTE* bytes, unsigned int byteCount, TransportMessa
 
     if (isConnected)
     {
-        DataWriter^ dWriter;
-        
-        try
-        {
-            EnterCriticalSection(&lock);
-            dWriter = this->GetWriter();
+        // Messages that do not fit in one datagram go out as several fragments, which the
+        // receiver puts back together
+        std::lock_guard<std::mutex> guard(writeLock);
+        fragmenter.Begin(bytes, byteCount, dataType, hnsPresentationTime, hnsSampleDuration);
 
-            Array<BYTE>^ byteArray = ref new Array<BYTE>((BYTE*)bytes, chunkSize);
-            
-            dWriter->WriteUInt32(chunkSize);
-            dWriter->WriteUInt32(dataType);
-            dWriter->WriteUInt64(hnsPresentationTime);
-            dWriter->WriteUInt64(hnsSampleDuration);
-            dWriter->WriteBytes(byteArray);
-
-            String^ debugStr = "[BackEndTransport::Write] Size:" + chunkSize.ToString() + 
-                L" Type:" + ((UINT32)dataType).ToString() +
-                " Presentation:" + hnsPresentationTime.ToString() + 
-                " Duration:" + hnsSampleDuration + 
-                " Unconsumed buffer:" + dWriter->UnstoredBufferLength +  "\n";
-
-            OutputDebugString(debugStr->Data());
-        }
-        catch (Exception^ ex)
+        while (true)
         {
-            OutputDebugString(ex->Message->Data());
-        }
+            std::shared_ptr<DatagramBuffer> datagram = AcquireDatagram();
+            if (!datagram)
+            {
+                // Every datagram is still being sent. The receiver drops the partial message.
+                break;
+            }
+
+            unsigned int datagramSize = fragmenter.Next(datagram->bytes.data());
+            if (datagramSize == 0)
+            {
+                datagram->inUse = false;
+                break;
+            }
 
-        // Write the locally buffered data to the network. Please note that write operation will succeed
-        // even if the server is not listening.
-        task<unsigned int>(this->GetWriter()->StoreAsync()).then([this] (task<unsigned int> writeTask)
-        {
             try
             {
-                // Try getting an excpetion.
-                writeTask.get();
-                LeaveCriticalSection(&lock);
+                datagram->nativeBuffer->put_Length(datagramSize);
+
+                // Write the datagram to the network. Please note that write operation will succeed
+                // even if the server is not listening.
+                task<unsigned int>(socket->OutputStream->WriteAsync(NativeBuffer::GetIBufferFromNativeBuffer(datagram->nativeBuffer))).then([datagram] (task<unsigned int> writeTask)
+                {
+                    try
+                    {
+                        // Try getting an excpetion.
+                        writeTask.get();
+                    }
+                    catch (Exception^ exception)
+                    {
+                    }
+
+                    datagram->inUse = false;
+                });
             }
-            catch (Exception^ exception)
+            catch (Exception^ ex)
             {
+                datagram->inUse = false;
+                OutputDebugString(ex->Message->Data());
+                break;
             }
-        });
+        }
     }
 }
 
+std::shared_ptr<BackEndTransport::DatagramBuffer> BackEndTransport::AcquireDatagram()
+{
+    for (auto& datagram : datagrams)
+    {
+        bool expected = false;
+        if (datagram->inUse.compare_exchange_strong(expected, true))
+        {
+            return datagram;
+        }
+    }
+
+    return nullptr;
+}
+
 void BackEndTransport::OnConnectionReceived(DatagramSocket^ socket, DatagramSocketMessageReceivedEventArgs^ eventArguments)
 {
     if (outputStream != nullptr)
     {
         try
         {
-            EnterCriticalSection(&readLock);
-
             DataReader^ reader = eventArguments->GetDataReader();
-            unsigned int dataSize = reader->ReadUInt32();
-            if(dataSize > MaxPacketSize)
+            unsigned int datagramSize = reader->UnconsumedBufferLength;
+            IBuffer^ buffer = reader->ReadBuffer(datagramSize);
+            BYTE* pBuffer = NativeBuffer::GetBytesFromIBuffer(buffer);
+
+            TransportFrameHeader header;
+            if (!ReadTransportFrameHeader(pBuffer, datagramSize, header))
             {
-                dataSize = MaxPacketSize;
+                return;
             }
 
-            unsigned int dataType = reader->ReadUInt32();
-            UINT64 hnsPresentationTime = reader->ReadUInt64();
-            UINT64 hnsSampleDuration = reader->ReadUInt64();
-            IBuffer^ buffer = reader->ReadBuffer(dataSize);
-
-            String^ debugStr = "[BackEndTransport::OnConnectionReceived] Size:" + dataSize.ToString() + 
-                L" Type:" + dataType.ToString() + 
-                " Presentation:" + hnsPresentationTime.ToString() + 
-                " Duration:" + hnsSampleDuration + 
-                " Unconsumed buffer:" + reader->UnconsumedBufferLength +
-                " IBuffer:" + buffer->Length +  "\n";
-                        
-            LeaveCriticalSection(&readLock);
-            OutputDebugString(debugStr->Data());
+            TransportReassembler* reassembler = nullptr;
+            switch(header.type)
+            {
+                case TransportMessageType::Audio:
+                    reassembler = &audioReassembler;
+                    break;
+                case TransportMessageType::Video:
+                    reassembler = &videoReassembler;
+                    break;
+                default:
+                    return;
+            }
 
-            BYTE* pBuffer = NULL;
+            // Nothing is delivered until the last fragment of a message is in
             BYTE* pBufferCopy = NULL;
-            ComPtr<NativeBuffer> spNativeBuffer = NULL;
-            pBuffer = NativeBuffer::GetBytesFromIBuffer(buffer);
-            pBufferCopy = new BYTE[dataSize];
+            unsigned int dataSize = 0;
+
+            EnterCriticalSection(&readLock);
+            if (reassembler->Add(header, pBuffer + TransportFrameHeaderSize))
+            {
+                dataSize = reassembler->GetMessageSize();
+                pBufferCopy = new BYTE[dataSize];
+                memcpy_s((void*) pBufferCopy, dataSize, (void*) reassembler->GetMessage(), dataSize);
+            }
+            LeaveCriticalSection(&readLock);
 
-            memcpy_s((void*) pBufferCopy, dataSize, (void*) pBuffer, dataSize);
             buffer = nullptr;
             pBuffer = NULL;
+            if (pBufferCopy == NULL)
+            {
+                return;
+            }
+
+            ComPtr<NativeBuffer> spNativeBuffer = NULL;
             // Now wrap this buffer with our NativeBuffer object
             if (FAILED(MakeAndInitialize<NativeBuffer>(&spNativeBuffer, pBufferCopy, dataSize, TRUE)))
             {
                 return;
             }
             
-            switch(dataType)
+            switch(header.type)
             {
                 case TransportMessageType::Audio:
-                    AudioMessageReceived(NativeBuffer::GetIBufferFromNativeBuffer(spNativeBuffer), hnsPresentationTime, hnsSampleDuration);
+                    AudioMessageReceived(NativeBuffer::GetIBufferFromNativeBuffer(spNativeBuffer), header.hnsPresentationTime, header.hnsSampleDuration);
                     break;
                 case TransportMessageType::Video:
-                    VideoMessageReceived(NativeBuffer::GetIBufferFromNativeBuffer(spNativeBuffer), hnsPresentationTime, hnsSampleDuration);
+                    VideoMessageReceived(NativeBuffer::GetIBufferFromNativeBuffer(spNativeBuffer), header.hnsPresentationTime, header.hnsSampleDuration);
                     break;
                 default:
                     break;
@@ -335,16 +386,6 @@ void BackEndTransport::OnMessage(DatagramSocket^ socket, DatagramSocketMessageRe
     }
 }
 
-DataWriter^ BackEndTransport::GetWriter()
-{
-    if (writer == nullptr)
-    {
-        writer = ref new DataWriter(socket->OutputStream);
-    }
-
-    return writer;
-}
-
 
 BackEndTransport::~BackEndTransport()
 {
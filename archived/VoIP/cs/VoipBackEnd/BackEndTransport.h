@@ -13,6 +13,12 @@
 #include <ppltasks.h>
 #include <ppl.h>
 #include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "BackEndNativeBuffer.h"
+#include "TransportFraming.h"
 
 using namespace Concurrency;
 
@@ -46,7 +52,7 @@ namespace VoipBackEnd
         // Destructor
         virtual ~BackEndTransport();
 
-        void WriteAudio(BYTE* bytes, int byteCount);
+        void WriteAudio(BYTE* bytes, int byteCount, UINT64 hnsPresentationTime, UINT64 hnsSampleDuration);
         void WriteVideo(BYTE* bytes, int byteCount, UINT64 hnsPresentationTime, UINT64 hnsSampleDuration);
 
         void Connect(Platform::String^ hostNameStr, Platform::String^ remotePort);
@@ -66,8 +72,6 @@ namespace VoipBackEnd
         void OnConnectionReceived(Windows::Networking::Sockets::DatagramSocket^ socket, Windows::Networking::Sockets::DatagramSocketMessageReceivedEventArgs^ eventArguments);
         void OnMessage(Windows::Networking::Sockets::DatagramSocket^ socket, Windows::Networking::Sockets::DatagramSocketMessageReceivedEventArgs^ eventArguments);
 
-        Windows::Storage::Streams::DataWriter^ GetWriter();
-
         bool isConnected;
         bool isListening;
 
@@ -75,9 +79,6 @@ namespace VoipBackEnd
         Windows::Networking::Sockets::DatagramSocket^ socket;
             
         Windows::Storage::Streams::IOutputStream^ outputStream;
-        Windows::Storage::Streams::DataWriter^ writer;
-            
-        const unsigned int headerSize; 
 
         cancellation_token_source cancelToken;
             
@@ -86,6 +87,24 @@ namespace VoipBackEnd
         CRITICAL_SECTION lock;
         CRITICAL_SECTION readLock;
         const unsigned int MaxPacketSize;
+
+        // A datagram buffer that is allocated once and reused as soon as the socket has sent it
+        struct DatagramBuffer
+        {
+            std::vector<BYTE> bytes;
+            Microsoft::WRL::ComPtr<NativeBuffer> nativeBuffer;
+            std::atomic<bool> inUse;
+        };
+
+        std::shared_ptr<DatagramBuffer> AcquireDatagram();
+
+        std::vector<std::shared_ptr<DatagramBuffer>> datagrams;
+        std::mutex writeLock;
+        TransportFragmenter fragmenter;
+
+        // Incoming fragments are put back together per stream, under readLock
+        TransportReassembler audioReassembler;
+        TransportReassembler videoReassembler;
     };
 }
 
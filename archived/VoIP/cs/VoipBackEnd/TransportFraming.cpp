@@ -0,0 +1,202 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+// This file does not use the precompiled header so that it stays free of Windows dependencies.
+#include "TransportFraming.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace VoipBackEnd;
+
+namespace
+{
+    void Store32(uint8_t* data, uint32_t value)
+    {
+        data[0] = static_cast<uint8_t>(value >> 24);
+        data[1] = static_cast<uint8_t>(value >> 16);
+        data[2] = static_cast<uint8_t>(value >> 8);
+        data[3] = static_cast<uint8_t>(value);
+    }
+
+    void Store64(uint8_t* data, uint64_t value)
+    {
+        Store32(data, static_cast<uint32_t>(value >> 32));
+        Store32(data + 4, static_cast<uint32_t>(value));
+    }
+
+    uint32_t Load32(const uint8_t* data)
+    {
+        return (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) |
+            (static_cast<uint32_t>(data[2]) << 8) | static_cast<uint32_t>(data[3]);
+    }
+
+    uint64_t Load64(const uint8_t* data)
+    {
+        return (static_cast<uint64_t>(Load32(data)) << 32) | Load32(data + 4);
+    }
+}
+
+void VoipBackEnd::WriteTransportFrameHeader(const TransportFrameHeader& header, uint8_t* data)
+{
+    Store32(data, header.payloadSize);
+    Store32(data + 4, header.type);
+    Store64(data + 8, header.hnsPresentationTime);
+    Store64(data + 16, header.hnsSampleDuration);
+    Store32(data + 24, header.messageSize);
+    Store32(data + 28, header.fragmentOffset);
+}
+
+bool VoipBackEnd::ReadTransportFrameHeader(const uint8_t* data, uint32_t size, TransportFrameHeader& header)
+{
+    if (data == nullptr || size < TransportFrameHeaderSize)
+    {
+        return false;
+    }
+
+    header.payloadSize = Load32(data);
+    header.type = Load32(data + 4);
+    header.hnsPresentationTime = Load64(data + 8);
+    header.hnsSampleDuration = Load64(data + 16);
+    header.messageSize = Load32(data + 24);
+    header.fragmentOffset = Load32(data + 28);
+
+    return header.payloadSize <= size - TransportFrameHeaderSize &&
+        header.fragmentOffset <= header.messageSize &&
+        header.payloadSize <= header.messageSize - header.fragmentOffset;
+}
+
+//--------------------------------------------------------------------------------------
+
+TransportFragmenter::TransportFragmenter(uint32_t maxDatagramSize) :
+    m_maxPayloadSize(std::max(maxDatagramSize, TransportFrameHeaderSize + 1) - TransportFrameHeaderSize),
+    m_message(nullptr),
+    m_header(),
+    m_pending(false)
+{
+}
+
+void TransportFragmenter::Begin(const uint8_t* message, uint32_t messageSize, uint32_t type, uint64_t hnsPresentationTime, uint64_t hnsSampleDuration)
+{
+    m_message = message;
+    m_header.payloadSize = 0;
+    m_header.type = type;
+    m_header.hnsPresentationTime = hnsPresentationTime;
+    m_header.hnsSampleDuration = hnsSampleDuration;
+    m_header.messageSize = (message != nullptr) ? messageSize : 0;
+    m_header.fragmentOffset = 0;
+    m_pending = true;
+}
+
+uint32_t TransportFragmenter::Next(uint8_t* datagram)
+{
+    if (!m_pending)
+    {
+        return 0;
+    }
+
+    m_header.payloadSize = std::min(m_maxPayloadSize, m_header.messageSize - m_header.fragmentOffset);
+    WriteTransportFrameHeader(m_header, datagram);
+    if (m_header.payloadSize > 0)
+    {
+        memcpy(datagram + TransportFrameHeaderSize, m_message + m_header.fragmentOffset, m_header.payloadSize);
+    }
+
+    uint32_t size = TransportFrameHeaderSize + m_header.payloadSize;
+    m_header.fragmentOffset += m_header.payloadSize;
+    m_pending = (m_header.fragmentOffset < m_header.messageSize);
+    return size;
+}
+
+//--------------------------------------------------------------------------------------
+
+TransportReassembler::TransportReassembler(uint32_t maxMessageSize) :
+    m_maxMessageSize(maxMessageSize),
+    m_header(),
+    m_message(nullptr),
+    m_received(0),
+    m_assembling(false),
+    m_haveDropped(false),
+    m_droppedTime(0),
+    m_droppedSize(0),
+    m_dropped(0)
+{
+}
+
+bool TransportReassembler::Add(const TransportFrameHeader& header, const uint8_t* payload)
+{
+    m_message = nullptr;
+
+    bool continues = m_assembling &&
+        header.fragmentOffset == m_received &&
+        header.fragmentOffset != 0 &&
+        header.messageSize == m_header.messageSize &&
+        header.hnsPresentationTime == m_header.hnsPresentationTime;
+
+    if (!continues)
+    {
+        if (m_assembling)
+        {
+            // The rest of the previous message is not coming.
+            m_assembling = false;
+            Drop(m_header);
+        }
+
+        if (header.fragmentOffset != 0 || header.messageSize > m_maxMessageSize)
+        {
+            // The start of this message was lost, or it is too large to hold.
+            Drop(header);
+            return false;
+        }
+
+        m_header = header;
+        m_received = 0;
+
+        if (header.payloadSize == header.messageSize)
+        {
+            // The whole message is in one datagram, so there is nothing to copy.
+            m_message = payload;
+            return true;
+        }
+
+        if (m_buffer.size() < header.messageSize)
+        {
+            m_buffer.resize(header.messageSize);
+        }
+
+        m_assembling = true;
+    }
+
+    memcpy(m_buffer.data() + m_received, payload, header.payloadSize);
+    m_received += header.payloadSize;
+
+    if (m_received < m_header.messageSize)
+    {
+        return false;
+    }
+
+    m_assembling = false;
+    m_message = m_buffer.data();
+    return true;
+}
+
+void TransportReassembler::Drop(const TransportFrameHeader& header)
+{
+    // Later fragments of a message that is already lost are not counted again.
+    if (m_haveDropped && header.hnsPresentationTime == m_droppedTime && header.messageSize == m_droppedSize)
+    {
+        return;
+    }
+
+    m_haveDropped = true;
+    m_droppedTime = header.hnsPresentationTime;
+    m_droppedSize = header.messageSize;
+    m_dropped++;
+}
@@ -0,0 +1,96 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+#pragma once
+
+// Datagram framing for BackEndTransport. Messages larger than one datagram are split into
+// fragments on the way out and put back together on the way in, so nothing is cut off. This file
+// only depends on the C++ standard library.
+
+#include <cstdint>
+#include <vector>
+
+namespace VoipBackEnd
+{
+    // Every datagram starts with this header, big-endian. The first four fields are the ones the
+    // transport has always sent; messageSize and fragmentOffset say where the payload belongs.
+    struct TransportFrameHeader
+    {
+        uint32_t payloadSize;           // Bytes following the header in this datagram.
+        uint32_t type;                  // TransportMessageType.
+        uint64_t hnsPresentationTime;
+        uint64_t hnsSampleDuration;
+        uint32_t messageSize;           // Bytes in the whole message.
+        uint32_t fragmentOffset;        // Where this payload starts within the message.
+    };
+
+    const uint32_t TransportFrameHeaderSize = 32;
+
+    void WriteTransportFrameHeader(const TransportFrameHeader& header, uint8_t* data);
+
+    // Returns false if the datagram is too short or the header does not describe a valid fragment.
+    bool ReadTransportFrameHeader(const uint8_t* data, uint32_t size, TransportFrameHeader& header);
+
+    // Splits one message into datagrams no larger than maxDatagramSize. Nothing is copied until
+    // Next writes a datagram, so the message must stay valid until Next returns 0.
+    class TransportFragmenter
+    {
+    public:
+        explicit TransportFragmenter(uint32_t maxDatagramSize);
+
+        void Begin(const uint8_t* message, uint32_t messageSize, uint32_t type, uint64_t hnsPresentationTime, uint64_t hnsSampleDuration);
+
+        // Writes the next datagram into the buffer, which must hold maxDatagramSize bytes, and
+        // returns its size, or 0 once the whole message has been written. An empty message still
+        // produces one datagram.
+        uint32_t Next(uint8_t* datagram);
+
+    private:
+        const uint32_t          m_maxPayloadSize;
+        const uint8_t*          m_message;
+        TransportFrameHeader    m_header;
+        bool                    m_pending;
+    };
+
+    // Collects the fragments of one stream's messages. Fragments must arrive in order, which holds
+    // on the loopback path this transport uses; if one goes missing, the message it belonged to is
+    // dropped and counted.
+    class TransportReassembler
+    {
+    public:
+        explicit TransportReassembler(uint32_t maxMessageSize);
+
+        // Takes the header and payload of one datagram. Returns true when they complete a message,
+        // which is then available through GetMessage until the next call.
+        bool Add(const TransportFrameHeader& header, const uint8_t* payload);
+
+        const TransportFrameHeader& GetHeader() const { return m_header; }
+        const uint8_t* GetMessage() const { return m_message; }
+        uint32_t GetMessageSize() const { return m_header.messageSize; }
+
+        uint64_t GetDroppedMessages() const { return m_dropped; }
+
+    private:
+        void Drop(const TransportFrameHeader& header);
+
+        const uint32_t          m_maxMessageSize;
+        std::vector<uint8_t>    m_buffer;
+        TransportFrameHeader    m_header;
+        const uint8_t*          m_message;
+        uint32_t                m_received;         // Bytes of the message in m_buffer so far.
+        bool                    m_assembling;
+
+        // The last message dropped, so each one is only counted once.
+        bool                    m_haveDropped;
+        uint64_t                m_droppedTime;
+        uint32_t                m_droppedSize;
+        uint64_t                m_dropped;
+    };
+}